@@ -0,0 +1,140 @@
+﻿#include "xrtc/base/async_file_writer.h"
+
+#include <string.h>
+
+#include <chrono>
+
+#include <rtc_base/logging.h>
+#include <rtc_base/platform_thread_types.h>
+
+namespace xrtc {
+
+namespace {
+// 缓冲区积累到一定大小才唤醒写线程，减少线程切换和系统调用
+const size_t kWakeupBytes = 64 * 1024;
+// 数据量较小时，写线程定时写入，避免数据长时间停留在内存中
+const int kFlushIntervalMs = 100;
+} // namespace
+
+AsyncFileWriter::AsyncFileWriter(size_t max_pending_bytes) :
+    max_pending_bytes_(max_pending_bytes)
+{
+}
+
+AsyncFileWriter::~AsyncFileWriter() {
+    Close();
+}
+
+bool AsyncFileWriter::Open(const std::string& path,
+    const std::string& thread_name)
+{
+    if (file_) {
+        RTC_LOG(LS_WARNING) << "AsyncFileWriter already open";
+        return false;
+    }
+
+    file_ = fopen(path.c_str(), "wb");
+    if (!file_) {
+        RTC_LOG(LS_WARNING) << "AsyncFileWriter open file failed: " << path;
+        return false;
+    }
+
+    pending_buffer_.reserve(kWakeupBytes * 2);
+    running_ = true;
+    write_thread_ = new std::thread([=]() {
+        rtc::SetCurrentThreadName(thread_name.c_str());
+        WriteLoop();
+    });
+
+    return true;
+}
+
+void AsyncFileWriter::Close() {
+    if (!write_thread_) {
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    cond_var_.notify_one();
+
+    if (write_thread_->joinable()) {
+        write_thread_->join();
+    }
+    delete write_thread_;
+    write_thread_ = nullptr;
+
+    fclose(file_);
+    file_ = nullptr;
+
+    if (dropped_bytes_ > 0) {
+        RTC_LOG(LS_WARNING) << "AsyncFileWriter dropped bytes: " << dropped_bytes_;
+    }
+}
+
+bool AsyncFileWriter::Write(const void* header, size_t header_len,
+    const void* data, size_t len)
+{
+    bool wakeup = false;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!running_) {
+            return false;
+        }
+
+        size_t size = pending_buffer_.size();
+        if (size + header_len + len > max_pending_bytes_) {
+            dropped_bytes_ += header_len + len;
+            return false;
+        }
+
+        pending_buffer_.resize(size + header_len + len);
+        if (header_len > 0) {
+            memcpy(pending_buffer_.data() + size, header, header_len);
+        }
+        if (len > 0) {
+            memcpy(pending_buffer_.data() + size + header_len, data, len);
+        }
+        wakeup = size < kWakeupBytes && pending_buffer_.size() >= kWakeupBytes;
+    }
+
+    if (wakeup) {
+        cond_var_.notify_one();
+    }
+
+    return true;
+}
+
+void AsyncFileWriter::WriteLoop() {
+    std::vector<uint8_t> write_buffer;
+    write_buffer.reserve(kWakeupBytes * 2);
+
+    bool running = true;
+    while (running) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cond_var_.wait_for(lock, std::chrono::milliseconds(kFlushIntervalMs),
+                [=]() {
+                    return !running_ || pending_buffer_.size() >= kWakeupBytes;
+                });
+            running = running_;
+            // 交换缓冲区，写磁盘时不持有锁
+            write_buffer.swap(pending_buffer_);
+        }
+
+        if (!write_buffer.empty()) {
+            if (fwrite(write_buffer.data(), 1, write_buffer.size(), file_) !=
+                write_buffer.size())
+            {
+                RTC_LOG(LS_WARNING) << "AsyncFileWriter write file failed";
+            }
+            write_buffer.clear();
+        }
+    }
+
+    fflush(file_);
+}
+
+} // namespace xrtc
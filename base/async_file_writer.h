@@ -0,0 +1,53 @@
+﻿#ifndef XRTCSDK_XRTC_BASE_ASYNC_FILE_WRITER_H_
+#define XRTCSDK_XRTC_BASE_ASYNC_FILE_WRITER_H_
+
+#include <stdio.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace xrtc {
+
+// 异步写文件，调用线程只是把数据拷贝到内存缓冲区，由单独的写线程写入磁盘，
+// 不会因为磁盘I/O阻塞调用线程。缓冲区超过上限时丢弃新的数据
+class AsyncFileWriter {
+public:
+    explicit AsyncFileWriter(size_t max_pending_bytes = 16 * 1024 * 1024);
+    ~AsyncFileWriter();
+
+    bool Open(const std::string& path, const std::string& thread_name);
+    // 将缓冲区中剩余的数据写入文件后关闭
+    void Close();
+    bool IsOpen() const { return file_ != nullptr; }
+
+    // 两段数据作为一个整体写入，要么都写入，要么都丢弃
+    bool Write(const void* data, size_t len) {
+        return Write(data, len, nullptr, 0);
+    }
+    bool Write(const void* header, size_t header_len,
+        const void* data, size_t len);
+
+    int64_t dropped_bytes() const { return dropped_bytes_; }
+
+private:
+    void WriteLoop();
+
+private:
+    size_t max_pending_bytes_;
+    FILE* file_ = nullptr;
+    std::thread* write_thread_ = nullptr;
+    bool running_ = false;
+    std::mutex mutex_;
+    std::condition_variable cond_var_;
+    // 待写入的数据，写线程每次整体交换出去，调用线程不需要等待磁盘I/O
+    std::vector<uint8_t> pending_buffer_;
+    std::atomic<int64_t> dropped_bytes_{ 0 };
+};
+
+} // namespace xrtc
+
+#endif // XRTCSDK_XRTC_BASE_ASYNC_FILE_WRITER_H_
@@ -0,0 +1,336 @@
+﻿#include "xrtc/base/thread_registry.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#endif
+
+#include <algorithm>
+
+#include <rtc_base/logging.h>
+#include <rtc_base/platform_thread_types.h>
+#include <rtc_base/time_utils.h>
+
+namespace xrtc {
+
+namespace {
+
+#ifdef __linux__
+// Linux的线程名最长15个字节
+const size_t kMaxThreadNameLen = 15;
+#endif
+
+uint64_t CurrentThreadId() {
+#ifdef _WIN32
+    return (uint64_t)GetCurrentThreadId();
+#elif defined(__linux__)
+    return (uint64_t)syscall(SYS_gettid);
+#else
+    return (uint64_t)rtc::CurrentThreadId();
+#endif
+}
+
+} // namespace
+
+const char* ThreadRoleToString(ThreadRole role) {
+    switch (role) {
+    case ThreadRole::kApi:
+        return "api";
+    case ThreadRole::kWorker:
+        return "worker";
+    case ThreadRole::kNetwork:
+        return "network";
+    case ThreadRole::kEncode:
+        return "encode";
+    case ThreadRole::kHttp:
+        return "http";
+    case ThreadRole::kPacer:
+        return "pacer";
+    default:
+        return "unknown";
+    }
+}
+
+struct ThreadRegistry::ThreadInfo {
+    ThreadRole role = ThreadRole::kApi;
+    // 不带前缀的线程名
+    std::string name;
+#ifdef _WIN32
+    HANDLE handle = nullptr;
+#elif defined(__linux__)
+    pthread_t thread;
+    pid_t tid = 0;
+    clockid_t clock_id;
+#endif
+    // 每个CpuStatsBaseline上一次统计的CPU时间和统计时间
+    int64_t last_cpu_time_us[(int)CpuStatsBaseline::kNumBaselines] = {};
+    int64_t last_sample_time_us[(int)CpuStatsBaseline::kNumBaselines] = {};
+
+    int64_t CpuTimeUs() const {
+#ifdef _WIN32
+        FILETIME creation_time, exit_time, kernel_time, user_time;
+        if (!GetThreadTimes(handle, &creation_time, &exit_time,
+            &kernel_time, &user_time))
+        {
+            return 0;
+        }
+        // FILETIME的单位是100ns
+        uint64_t kernel = ((uint64_t)kernel_time.dwHighDateTime << 32) |
+            kernel_time.dwLowDateTime;
+        uint64_t user = ((uint64_t)user_time.dwHighDateTime << 32) |
+            user_time.dwLowDateTime;
+        return (int64_t)((kernel + user) / 10);
+#elif defined(__linux__)
+        struct timespec ts;
+        if (clock_gettime(clock_id, &ts) != 0) {
+            return 0;
+        }
+        return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#else
+        return 0;
+#endif
+    }
+};
+
+ThreadRegistry::ThreadRegistry() {
+}
+
+ThreadRegistry::~ThreadRegistry() {
+#ifdef _WIN32
+    for (auto& item : threads_) {
+        CloseHandle(item.second->handle);
+    }
+#endif
+}
+
+void ThreadRegistry::RegisterCurrentThread(ThreadRole role,
+    const std::string& name)
+{
+    auto info = std::make_unique<ThreadInfo>();
+    info->role = role;
+    info->name = name;
+#ifdef _WIN32
+    info->handle = OpenThread(THREAD_SET_INFORMATION | THREAD_QUERY_INFORMATION,
+        FALSE, GetCurrentThreadId());
+#elif defined(__linux__)
+    info->thread = pthread_self();
+    info->tid = (pid_t)syscall(SYS_gettid);
+    pthread_getcpuclockid(info->thread, &info->clock_id);
+#endif
+    int64_t cpu_time_us = info->CpuTimeUs();
+    int64_t now_us = rtc::TimeMicros();
+    for (int i = 0; i < (int)CpuStatsBaseline::kNumBaselines; ++i) {
+        info->last_cpu_time_us[i] = cpu_time_us;
+        info->last_sample_time_us[i] = now_us;
+    }
+
+    std::unique_lock<std::mutex> auto_lock(mtx_);
+    ThreadConfig& config = configs_[(int)role];
+    rtc::SetCurrentThreadName((config.name_prefix + name).c_str());
+    if (configured_[(int)role]) {
+        ApplyConfig(info.get(), config);
+    }
+    threads_[CurrentThreadId()] = std::move(info);
+}
+
+void ThreadRegistry::UnregisterCurrentThread() {
+    std::unique_lock<std::mutex> auto_lock(mtx_);
+    auto iter = threads_.find(CurrentThreadId());
+    if (iter == threads_.end()) {
+        return;
+    }
+
+#ifdef _WIN32
+    CloseHandle(iter->second->handle);
+#endif
+    threads_.erase(iter);
+}
+
+bool ThreadRegistry::SetConfig(ThreadRole role, const ThreadConfig& config) {
+    if (role >= ThreadRole::kNumRoles) {
+        return false;
+    }
+
+    RTC_LOG(LS_INFO) << "set thread config, role: " << ThreadRoleToString(role)
+        << ", cpus: " << config.cpus.size()
+        << ", nice: " << config.nice
+        << ", realtime_priority: " << config.realtime_priority
+        << ", name_prefix: " << config.name_prefix;
+
+    std::unique_lock<std::mutex> auto_lock(mtx_);
+    configs_[(int)role] = config;
+    configured_[(int)role] = true;
+
+    bool ok = true;
+    for (auto& item : threads_) {
+        if (item.second->role == role) {
+            ok = ApplyConfig(item.second.get(), config) && ok;
+        }
+    }
+    return ok;
+}
+
+ThreadConfig ThreadRegistry::GetConfig(ThreadRole role) {
+    std::unique_lock<std::mutex> auto_lock(mtx_);
+    return role < ThreadRole::kNumRoles ? configs_[(int)role] : ThreadConfig();
+}
+
+std::vector<ThreadCpuStats> ThreadRegistry::GetCpuStats(CpuStatsBaseline baseline) {
+    std::vector<ThreadCpuStats> result;
+    if (baseline >= CpuStatsBaseline::kNumBaselines) {
+        return result;
+    }
+
+    int index = (int)baseline;
+    int64_t now_us = rtc::TimeMicros();
+
+    std::unique_lock<std::mutex> auto_lock(mtx_);
+    for (auto& item : threads_) {
+        ThreadInfo* info = item.second.get();
+        int64_t cpu_time_us = info->CpuTimeUs();
+
+        ThreadCpuStats stats;
+        stats.role = info->role;
+        stats.name = configs_[(int)info->role].name_prefix + info->name;
+        stats.cpu_time_ms = cpu_time_us / 1000;
+        int64_t elapsed_us = now_us - info->last_sample_time_us[index];
+        if (elapsed_us > 0) {
+            stats.cpu_usage = (cpu_time_us - info->last_cpu_time_us[index]) * 100.0 /
+                elapsed_us;
+        }
+        result.push_back(stats);
+
+        info->last_cpu_time_us[index] = cpu_time_us;
+        info->last_sample_time_us[index] = now_us;
+    }
+
+    return result;
+}
+
+// 调用时持有mtx_
+bool ThreadRegistry::ApplyConfig(ThreadInfo* info, const ThreadConfig& config) {
+    bool ok = true;
+    std::string name = config.name_prefix + info->name;
+
+#ifdef _WIN32
+    // 线程名只在登记时设置，Windows上修改其它线程的名称需要较新的系统版本
+    DWORD_PTR process_mask = 0;
+    DWORD_PTR system_mask = 0;
+    GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask);
+    DWORD_PTR mask = process_mask;
+    if (!config.cpus.empty()) {
+        mask = 0;
+        for (int cpu : config.cpus) {
+            if (cpu >= 0 && cpu < (int)(sizeof(DWORD_PTR) * 8)) {
+                mask |= (DWORD_PTR)1 << cpu;
+            }
+        }
+    }
+    if (!SetThreadAffinityMask(info->handle, mask)) {
+        RTC_LOG(LS_WARNING) << "set thread affinity failed, thread: " << name
+            << ", err: " << GetLastError();
+        ok = false;
+    }
+
+    int priority = THREAD_PRIORITY_NORMAL;
+    if (config.realtime_priority > 0) {
+        priority = THREAD_PRIORITY_TIME_CRITICAL;
+    }
+    else if (config.nice <= -10) {
+        priority = THREAD_PRIORITY_HIGHEST;
+    }
+    else if (config.nice < 0) {
+        priority = THREAD_PRIORITY_ABOVE_NORMAL;
+    }
+    else if (config.nice >= 10) {
+        priority = THREAD_PRIORITY_LOWEST;
+    }
+    else if (config.nice > 0) {
+        priority = THREAD_PRIORITY_BELOW_NORMAL;
+    }
+    if (!SetThreadPriority(info->handle, priority)) {
+        RTC_LOG(LS_WARNING) << "set thread priority failed, thread: " << name
+            << ", err: " << GetLastError();
+        ok = false;
+    }
+#elif defined(__linux__)
+    pthread_setname_np(info->thread, name.substr(0, kMaxThreadNameLen).c_str());
+
+    // cpus为空时恢复为进程的CPU集合
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    if (config.cpus.empty()) {
+        sched_getaffinity(getpid(), sizeof(cpu_set), &cpu_set);
+    }
+    else {
+        for (int cpu : config.cpus) {
+            if (cpu >= 0 && cpu < CPU_SETSIZE) {
+                CPU_SET(cpu, &cpu_set);
+            }
+        }
+    }
+    int ret = pthread_setaffinity_np(info->thread, sizeof(cpu_set), &cpu_set);
+    if (ret != 0) {
+        RTC_LOG(LS_WARNING) << "set thread affinity failed, thread: " << name
+            << ", err: " << strerror(ret);
+        ok = false;
+    }
+
+    struct sched_param param;
+    memset(&param, 0, sizeof(param));
+    int policy = SCHED_OTHER;
+    if (config.realtime_priority > 0) {
+        policy = SCHED_FIFO;
+        param.sched_priority = std::min(config.realtime_priority,
+            sched_get_priority_max(SCHED_FIFO));
+    }
+    ret = pthread_setschedparam(info->thread, policy, &param);
+    if (ret != 0) {
+        RTC_LOG(LS_WARNING) << "set thread sched policy failed, thread: " << name
+            << ", policy: " << policy << ", err: " << strerror(ret);
+        ok = false;
+    }
+
+    // nice值在Linux上是线程级别的，只对普通调度生效
+    if (SCHED_OTHER == policy &&
+        setpriority(PRIO_PROCESS, info->tid, config.nice) != 0)
+    {
+        RTC_LOG(LS_WARNING) << "set thread nice failed, thread: " << name
+            << ", nice: " << config.nice << ", err: " << strerror(errno);
+        ok = false;
+    }
+#else
+    RTC_LOG(LS_WARNING) << "thread config is not supported on this platform";
+    ok = false;
+#endif
+
+    return ok;
+}
+
+ScopedThreadRegistration::ScopedThreadRegistration(ThreadRegistry* registry,
+    ThreadRole role, const std::string& name) :
+    registry_(registry)
+{
+    if (registry_) {
+        registry_->RegisterCurrentThread(role, name);
+    }
+    else {
+        rtc::SetCurrentThreadName(name.c_str());
+    }
+}
+
+ScopedThreadRegistration::~ScopedThreadRegistration() {
+    if (registry_) {
+        registry_->UnregisterCurrentThread();
+    }
+}
+
+} // namespace xrtc
@@ -0,0 +1,99 @@
+﻿#ifndef XRTCSDK_XRTC_BASE_THREAD_REGISTRY_H_
+#define XRTCSDK_XRTC_BASE_THREAD_REGISTRY_H_
+
+#include <stdint.h>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace xrtc {
+
+// SDK创建的线程的类别，每一类可以单独配置
+enum class ThreadRole {
+    kApi,
+    kWorker,
+    kNetwork,
+    kEncode,
+    kHttp,
+    kPacer,
+    kNumRoles,
+};
+
+const char* ThreadRoleToString(ThreadRole role);
+
+struct ThreadConfig {
+    // 允许运行的CPU编号，为空表示不限制
+    std::vector<int> cpus;
+    // 普通调度下的nice值，范围[-20, 19]，小于0通常需要权限
+    int nice = 0;
+    // 大于0时使用SCHED_FIFO，范围[1, 99]，需要CAP_SYS_NICE权限，此时忽略nice
+    // Windows上映射为THREAD_PRIORITY_TIME_CRITICAL
+    int realtime_priority = 0;
+    // 线程名的前缀，用于在top、perf中区分同一台机器上的多个进程
+    std::string name_prefix;
+};
+
+struct ThreadCpuStats {
+    ThreadRole role = ThreadRole::kApi;
+    std::string name;
+    // 线程启动以来的CPU时间，包括用户态和内核态
+    int64_t cpu_time_ms = 0;
+    // 距离上一次统计的CPU占用，100表示占满一个核
+    double cpu_usage = 0.0;
+};
+
+// CPU占用的统计起点，主动查询和定时上报各自计算距离自己上一次统计的占用
+enum class CpuStatsBaseline {
+    kQuery,
+    kPeriodicReport,
+    kNumBaselines,
+};
+
+// 登记SDK创建的线程，统一设置CPU亲和性、调度优先级和线程名，并统计每个线程的CPU时间
+// 线程需要在自己的线程中登记和注销，配置可以在任意线程中修改，对已经登记的线程立即生效
+class ThreadRegistry {
+public:
+    ThreadRegistry();
+    ~ThreadRegistry();
+
+    void RegisterCurrentThread(ThreadRole role, const std::string& name);
+    void UnregisterCurrentThread();
+
+    // 返回false表示有线程设置失败，通常是没有权限，失败的线程保持原来的设置
+    bool SetConfig(ThreadRole role, const ThreadConfig& config);
+    ThreadConfig GetConfig(ThreadRole role);
+
+    // 计算距离baseline上一次统计的CPU占用，并把当前时间作为该baseline新的起点
+    std::vector<ThreadCpuStats> GetCpuStats(
+        CpuStatsBaseline baseline = CpuStatsBaseline::kQuery);
+
+private:
+    struct ThreadInfo;
+    bool ApplyConfig(ThreadInfo* info, const ThreadConfig& config);
+
+private:
+    std::mutex mtx_;
+    ThreadConfig configs_[(int)ThreadRole::kNumRoles];
+    // 没有设置过配置的线程保持系统默认的设置
+    bool configured_[(int)ThreadRole::kNumRoles] = {};
+    // key是系统的线程id
+    std::map<uint64_t, std::unique_ptr<ThreadInfo>> threads_;
+};
+
+// 在线程函数开始处定义，线程退出时自动注销，registry为空时只设置线程名
+class ScopedThreadRegistration {
+public:
+    ScopedThreadRegistration(ThreadRegistry* registry, ThreadRole role,
+        const std::string& name);
+    ~ScopedThreadRegistration();
+
+private:
+    ThreadRegistry* registry_;
+};
+
+} // namespace xrtc
+
+#endif // XRTCSDK_XRTC_BASE_THREAD_REGISTRY_H_
@@ -1,11 +1,26 @@
 ﻿#include "xrtc/base/xrtc_global.h"
 
+#include <algorithm>
+#include <functional>
+
+#include <rtc_base/logging.h>
+#include <api/task_queue/default_task_queue_factory.h>
 #include <modules/video_capture/video_capture_factory.h>
+#include <system_wrappers/include/clock.h>
+#include <rtc_base/task_utils/to_queued_task.h>
 
+#include "xrtc/xrtc.h"
 #include "xrtc/base/xrtc_http.h"
+#include "xrtc/rtc/modules/pacing/pacer_scheduler.h"
 
 namespace xrtc {
 
+namespace {
+// pacer的发送间隔是毫秒级，少量线程就可以服务所有连接
+const size_t kNumPacerThreads = 2;
+const uint32_t kThreadCpuStatsIntervalMs = 5000;
+} // namespace
+
 // 单例
 XRTCGlobal* XRTCGlobal::Instance() {
     static XRTCGlobal* const instance = new XRTCGlobal();
@@ -13,10 +28,11 @@ XRTCGlobal* XRTCGlobal::Instance() {
 }
 
 XRTCGlobal::XRTCGlobal() :
+    thread_registry_(std::make_unique<ThreadRegistry>()),
     api_thread_(rtc::Thread::Create()),
     worker_thread_(rtc::Thread::Create()),
-    network_thread_(rtc::Thread::CreateWithSocketServer()),
-    video_device_info_(webrtc::VideoCaptureFactory::CreateDeviceInfo())
+    video_device_info_(webrtc::VideoCaptureFactory::CreateDeviceInfo()),
+    task_queue_factory_(webrtc::CreateDefaultTaskQueueFactory())
 {
     api_thread_->SetName("api_thread", nullptr);
     api_thread_->Start();
@@ -24,18 +40,122 @@ XRTCGlobal::XRTCGlobal() :
     worker_thread_->SetName("worker_thread", nullptr);
     worker_thread_->Start();
 
-    network_thread_->SetName("network_thread", nullptr);
-    network_thread_->Start();
+    // rtc::Thread的线程需要在线程内部登记，这些线程不会退出，不需要注销
+    api_thread_->PostTask(webrtc::ToQueuedTask([=]() {
+        thread_registry_->RegisterCurrentThread(ThreadRole::kApi, "api_thread");
+    }));
+    worker_thread_->PostTask(webrtc::ToQueuedTask([=]() {
+        thread_registry_->RegisterCurrentThread(ThreadRole::kWorker, "worker_thread");
+    }));
+
+    // pacer的线程数固定，和连接数、网络线程数无关
+    pacer_scheduler_ = std::make_unique<PacerScheduler>(
+        webrtc::Clock::GetRealTimeClock(), kNumPacerThreads,
+        thread_registry_.get());
+
+    // 默认只有一个网络线程，需要更多时调用SetNetworkThreadNum
+    shards_.reserve(kMaxNetworkThreads);
+    shards_.push_back(CreateNetworkShard(0));
 
-    http_manager_ = new HttpManager();
+    http_manager_ = new HttpManager(thread_registry_.get());
     http_manager_->Start();
 
-    ice::NetworkConfig config;
-    port_allocator_ = std::make_unique<ice::PortAllocator>(config);
+    api_thread_->PostDelayedTask(webrtc::ToQueuedTask([=]() {
+        ReportThreadCpuStats();
+    }), kThreadCpuStatsIntervalMs);
 }
 
 XRTCGlobal::~XRTCGlobal() {
 
 }
 
+std::unique_ptr<NetworkShard> XRTCGlobal::CreateNetworkShard(size_t index) {
+    std::string suffix = index > 0 ? "_" + std::to_string(index) : "";
+    auto shard = std::make_unique<NetworkShard>();
+    shard->index = index;
+
+    shard->network_thread = rtc::Thread::CreateWithSocketServer();
+    shard->network_thread->SetName("network_thread" + suffix, nullptr);
+    shard->network_thread->Start();
+    std::string thread_name = "network_thread" + suffix;
+    shard->network_thread->PostTask(webrtc::ToQueuedTask([=]() {
+        thread_registry_->RegisterCurrentThread(ThreadRole::kNetwork, thread_name);
+    }));
+
+    // 每个分片使用独立的端口分配器，只在该分片的网络线程中访问
+    ice::NetworkConfig config;
+    shard->port_allocator = std::make_unique<ice::PortAllocator>(config);
+
+    shard->controller_task_queue = std::make_unique<rtc::TaskQueue>(
+        task_queue_factory_->CreateTaskQueue("rtp_send_task_queue" + suffix,
+            webrtc::TaskQueueFactory::Priority::NORMAL));
+
+    return shard;
+}
+
+void XRTCGlobal::SetNetworkThreadNum(size_t num) {
+    num = std::max<size_t>(1, std::min(num, kMaxNetworkThreads));
+
+    std::unique_lock<std::mutex> auto_lock(shards_mtx_);
+    while (shards_.size() < num) {
+        shards_.push_back(CreateNetworkShard(shards_.size()));
+    }
+
+    RTC_LOG(LS_INFO) << "network thread num: " << shards_.size();
+}
+
+size_t XRTCGlobal::network_thread_num() {
+    std::unique_lock<std::mutex> auto_lock(shards_mtx_);
+    return shards_.size();
+}
+
+NetworkShard* XRTCGlobal::AcquireNetworkShard(const std::string& key) {
+    std::unique_lock<std::mutex> auto_lock(shards_mtx_);
+    NetworkShard* shard = nullptr;
+    if (!key.empty()) {
+        shard = shards_[std::hash<std::string>()(key) % shards_.size()].get();
+    }
+    else {
+        // 连接数相同时选择编号小的分片
+        for (auto& item : shards_) {
+            if (!shard || item->num_connections < shard->num_connections) {
+                shard = item.get();
+            }
+        }
+    }
+
+    ++shard->num_connections;
+    return shard;
+}
+
+void XRTCGlobal::ReleaseNetworkShard(NetworkShard* shard) {
+    if (!shard) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> auto_lock(shards_mtx_);
+    --shard->num_connections;
+}
+
+bool XRTCGlobal::SetThreadConfig(ThreadRole role, const ThreadConfig& config) {
+    return thread_registry_->SetConfig(role, config);
+}
+
+std::vector<ThreadCpuStats> XRTCGlobal::GetThreadCpuStats() {
+    return thread_registry_->GetCpuStats();
+}
+
+// 在api线程中执行
+void XRTCGlobal::ReportThreadCpuStats() {
+    if (engine_observer_) {
+        // 使用独立的统计起点，GetThreadCpuStats的调用不会影响上报的周期
+        engine_observer_->OnThreadCpuStats(
+            thread_registry_->GetCpuStats(CpuStatsBaseline::kPeriodicReport));
+    }
+
+    api_thread_->PostDelayedTask(webrtc::ToQueuedTask([=]() {
+        ReportThreadCpuStats();
+    }), kThreadCpuStatsIntervalMs);
+}
+
 } // namespace xrtc
\ No newline at end of file
@@ -1,14 +1,34 @@
 ﻿#ifndef XRTCSDK_XRTC_BASE_XRTC_GLOBAL_H_
 #define XRTCSDK_XRTC_BASE_XRTC_GLOBAL_H_
 
+#include <mutex>
+#include <string>
+#include <vector>
+
 #include <rtc_base/thread.h>
+#include <rtc_base/task_queue.h>
+#include <api/task_queue/task_queue_factory.h>
 #include <modules/video_capture/video_capture.h>
 #include <ice/port_allocator.h>
 
+#include "xrtc/base/thread_registry.h"
+
 namespace xrtc {
 
 class XRTCEngineObserver;
 class HttpManager;
+class PacerScheduler;
+
+// 网络线程的分片，分配到同一个分片的PeerConnection共享网络线程、端口分配器和
+// 拥塞控制的任务队列，不同的分片之间互不影响
+struct NetworkShard {
+    size_t index = 0;
+    std::unique_ptr<rtc::Thread> network_thread;
+    std::unique_ptr<ice::PortAllocator> port_allocator;
+    std::unique_ptr<rtc::TaskQueue> controller_task_queue;
+    // 分配到该分片的连接数，由XRTCGlobal的锁保护
+    int num_connections = 0;
+};
 
 // 单例模式
 class XRTCGlobal {
@@ -22,27 +42,58 @@ public:
 
     rtc::Thread* api_thread() { return api_thread_.get(); }
     rtc::Thread* worker_thread() { return worker_thread_.get(); }
-    rtc::Thread* network_thread() { return network_thread_.get(); }
+    // 第0个分片的网络线程
+    rtc::Thread* network_thread() { return shards_[0]->network_thread.get(); }
     webrtc::VideoCaptureModule::DeviceInfo* video_device_info() {
         return video_device_info_.get();
     }
 
     HttpManager* http_manager() { return http_manager_; }
 
-    ice::PortAllocator* port_allocator() { return port_allocator_.get(); }
+    ice::PortAllocator* port_allocator() { return shards_[0]->port_allocator.get(); }
+
+    // 所有连接共享的pacer调度器
+    PacerScheduler* pacer_scheduler() { return pacer_scheduler_.get(); }
+
+    // 设置网络线程的个数，最多kMaxNetworkThreads个，只能增加，已经分配的连接不会迁移
+    void SetNetworkThreadNum(size_t num);
+    size_t network_thread_num();
+    // 为新的连接分配分片，key为空时选择连接数最少的分片，否则按照key的hash选择，
+    // 相同key的连接总是在同一个分片。连接关闭时需要调用ReleaseNetworkShard
+    NetworkShard* AcquireNetworkShard(const std::string& key = "");
+    void ReleaseNetworkShard(NetworkShard* shard);
+
+    static const size_t kMaxNetworkThreads = 16;
+
+    // SDK创建的所有线程都登记在这里
+    ThreadRegistry* thread_registry() { return thread_registry_.get(); }
+    // 设置某一类线程的CPU集合、nice或SCHED_FIFO优先级和线程名前缀，
+    // 已经运行的线程立即生效，之后创建的线程在启动时生效
+    bool SetThreadConfig(ThreadRole role, const ThreadConfig& config);
+    // 每个线程的CPU时间，占用率是距离上一次调用的平均值，
+    // 另外每隔5秒通过XRTCEngineObserver::OnThreadCpuStats上报一次，上报的是5秒内的平均值
+    std::vector<ThreadCpuStats> GetThreadCpuStats();
 
 private:
     XRTCGlobal();
     ~XRTCGlobal();
 
+    std::unique_ptr<NetworkShard> CreateNetworkShard(size_t index);
+    void ReportThreadCpuStats();
+
 private:
+    // 需要在其它线程之前创建
+    std::unique_ptr<ThreadRegistry> thread_registry_;
     std::unique_ptr<rtc::Thread> api_thread_;
     std::unique_ptr<rtc::Thread> worker_thread_;
-    std::unique_ptr<rtc::Thread> network_thread_;
     std::unique_ptr<webrtc::VideoCaptureModule::DeviceInfo> video_device_info_;
     XRTCEngineObserver* engine_observer_ = nullptr;
     HttpManager* http_manager_ = nullptr;
-    std::unique_ptr<ice::PortAllocator> port_allocator_;
+    std::unique_ptr<webrtc::TaskQueueFactory> task_queue_factory_;
+    std::unique_ptr<PacerScheduler> pacer_scheduler_;
+    std::mutex shards_mtx_;
+    // 预先分配容量，增加分片时不会移动已有的元素，network_thread()不需要加锁
+    std::vector<std::unique_ptr<NetworkShard>> shards_;
 };
 
 } // namespace xrtc
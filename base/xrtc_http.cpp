@@ -79,7 +79,9 @@ HttpReply HttpRequestTask::Resp(int err, const std::string& err_msg, long status
 	return reply;
 }
 
-HttpManager::HttpManager() {
+HttpManager::HttpManager(ThreadRegistry* thread_registry) :
+	thread_registry_(thread_registry)
+{
 	curl_global_init(CURL_GLOBAL_ALL);
 	multi_ = curl_multi_init();
 	/* Limit the amount of simultaneous connections curl should allow: */
@@ -141,7 +143,8 @@ void HttpManager::Start() {
 
 	running_ = true;
 	http_thread_ = new std::thread([=]() {
-		rtc::SetCurrentThreadName("http_thread");
+		ScopedThreadRegistration thread_registration(thread_registry_,
+			ThreadRole::kHttp, "http_thread");
 
 		CURLMsg* msg = nullptr;
 		int still_alive = 0;
@@ -15,6 +15,8 @@
 
 namespace xrtc {
 
+class ThreadRegistry;
+
 class HttpRequest {
 public:
     enum class HttpMethod {
@@ -127,7 +129,8 @@ private:
 
 class HttpManager {
 public:
-    HttpManager();
+    // thread_registry不为空时，http线程登记到其中
+    explicit HttpManager(ThreadRegistry* thread_registry = nullptr);
     ~HttpManager();
 
     static std::string UrlEncode(const std::string& content);
@@ -145,6 +148,7 @@ private:
     std::shared_ptr<HttpRequestTask> GetHttpRequestTask(CURL* handle);
 
 private:
+    ThreadRegistry* thread_registry_;
     std::mutex mutex_;
     CURLM* multi_ = nullptr;
     std::thread* http_thread_ = nullptr;
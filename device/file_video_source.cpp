@@ -0,0 +1,273 @@
+﻿#include "xrtc/device/file_video_source.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <rtc_base/logging.h>
+#include <rtc_base/string_encode.h>
+
+#include "xrtc/base/xrtc_json.h"
+#include "xrtc/media/base/media_frame.h"
+
+namespace xrtc {
+
+namespace {
+const char kY4MFileMagic[] = "YUV4MPEG2";
+const char kY4MFrameMagic[] = "FRAME";
+} // namespace
+
+// 只读的内存映射文件
+class MappedFile {
+public:
+    ~MappedFile() {
+#ifdef _WIN32
+        if (data_) {
+            UnmapViewOfFile(data_);
+        }
+        if (mapping_) {
+            CloseHandle(mapping_);
+        }
+        if (file_ != INVALID_HANDLE_VALUE) {
+            CloseHandle(file_);
+        }
+#else
+        if (data_) {
+            munmap((void*)data_, size_);
+        }
+        if (fd_ >= 0) {
+            close(fd_);
+        }
+#endif
+    }
+
+    bool Open(const std::string& path) {
+#ifdef _WIN32
+        file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file_ == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+
+        LARGE_INTEGER file_size;
+        if (!GetFileSizeEx(file_, &file_size) || 0 == file_size.QuadPart) {
+            return false;
+        }
+        size_ = (size_t)file_size.QuadPart;
+
+        mapping_ = CreateFileMappingA(file_, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (!mapping_) {
+            return false;
+        }
+
+        data_ = (const uint8_t*)MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+#else
+        fd_ = open(path.c_str(), O_RDONLY);
+        if (fd_ < 0) {
+            return false;
+        }
+
+        struct stat st;
+        if (fstat(fd_, &st) < 0 || 0 == st.st_size) {
+            return false;
+        }
+        size_ = (size_t)st.st_size;
+
+        void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+        if (MAP_FAILED == data) {
+            return false;
+        }
+        // 顺序读取，让内核提前预读
+        madvise(data, size_, MADV_SEQUENTIAL);
+        data_ = (const uint8_t*)data;
+#endif
+        return data_ != nullptr;
+    }
+
+    const uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    HANDLE file_ = INVALID_HANDLE_VALUE;
+    HANDLE mapping_ = NULL;
+#else
+    int fd_ = -1;
+#endif
+};
+
+FileVideoSource::FileVideoSource(const std::string& path) :
+    PacedVideoSource("FileVideoSource", "file_video_source_thread"),
+    path_(path)
+{
+}
+
+FileVideoSource::~FileVideoSource() {
+}
+
+void FileVideoSource::Setup(const std::string& json_config) {
+    JsonValue value;
+    if (!value.FromJson(json_config)) {
+        RTC_LOG(LS_WARNING) << "FileVideoSource invalid config: " << json_config;
+        return;
+    }
+
+    JsonObject jobj = value.ToObject();
+    JsonObject jsource = jobj["file_video_source"].ToObject();
+    is_y4m_ = (jsource["format"].ToString("y4m") == "y4m");
+    width_ = (int)jsource["width"].ToInt(width_);
+    height_ = (int)jsource["height"].ToInt(height_);
+    fps_configured_ = jsource.Has("fps");
+    fps_ = (int)jsource["fps"].ToInt(fps_);
+    loop_ = jsource["loop"].ToBool(loop_);
+}
+
+XRTCError FileVideoSource::OnStart() {
+    if (!OpenFile()) {
+        RTC_LOG(LS_WARNING) << "FileVideoSource open file failed: " << path_;
+        return XRTCError::kVideoCreateCaptureErr;
+    }
+
+    if (is_y4m_ && !ParseY4MHeader()) {
+        RTC_LOG(LS_WARNING) << "FileVideoSource invalid y4m header: " << path_;
+        file_.reset();
+        return XRTCError::kVideoNoCapabilitiesErr;
+    }
+
+    if (width_ <= 0 || height_ <= 0) {
+        RTC_LOG(LS_WARNING) << "FileVideoSource invalid size, width: "
+            << width_ << ", height: " << height_;
+        file_.reset();
+        return XRTCError::kVideoNoCapabilitiesErr;
+    }
+
+    frame_size_ = width_ * height_ +
+        2 * ((width_ + 1) / 2) * ((height_ + 1) / 2);
+    read_offset_ = first_frame_offset_;
+
+    RTC_LOG(LS_INFO) << "FileVideoSource open file: " << path_
+        << ", width: " << width_ << ", height: " << height_ << ", fps: " << fps_;
+    return XRTCError::kNoErr;
+}
+
+void FileVideoSource::OnStop() {
+    file_.reset();
+}
+
+bool FileVideoSource::OpenFile() {
+    file_ = std::make_unique<MappedFile>();
+    if (!file_->Open(path_)) {
+        file_.reset();
+        return false;
+    }
+
+    first_frame_offset_ = 0;
+    return true;
+}
+
+// YUV4MPEG2 W640 H480 F30:1 Ip A1:1 C420jpeg\n
+bool FileVideoSource::ParseY4MHeader() {
+    const char* data = (const char*)file_->data();
+    size_t size = file_->size();
+    const char* end = (const char*)memchr(data, '\n', size);
+    if (!end || strncmp(data, kY4MFileMagic, strlen(kY4MFileMagic)) != 0) {
+        return false;
+    }
+
+    std::vector<std::string> fields;
+    rtc::tokenize(std::string(data, end - data), ' ', &fields);
+    for (auto& field : fields) {
+        if (field.size() < 2) {
+            continue;
+        }
+
+        std::string param = field.substr(1);
+        switch (field[0]) {
+        case 'W':
+            width_ = atoi(param.c_str());
+            break;
+        case 'H':
+            height_ = atoi(param.c_str());
+            break;
+        case 'F': {
+            // 配置了帧率时以配置为准
+            int num = 0;
+            int den = 0;
+            if (!fps_configured_ && sscanf(param.c_str(), "%d:%d", &num, &den) == 2 && den > 0) {
+                fps_ = (num + den / 2) / den;
+            }
+            break;
+        }
+        case 'C':
+            // 只支持8bit的420采样格式，420p10等高位深格式的帧大小不同
+            if (param != "420" && param != "420jpeg" && param != "420paldv" &&
+                param != "420mpeg2")
+            {
+                RTC_LOG(LS_WARNING) << "unsupported y4m colorspace: " << param;
+                return false;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    first_frame_offset_ = end - data + 1;
+    return true;
+}
+
+const uint8_t* FileVideoSource::NextFrame() {
+    const uint8_t* data = file_->data();
+    size_t size = file_->size();
+    for (int retry = 0; retry < 2; ++retry) {
+        size_t offset = read_offset_;
+        if (is_y4m_) {
+            // FRAME[ params]\n
+            const uint8_t* line_end = nullptr;
+            if (offset + strlen(kY4MFrameMagic) < size &&
+                memcmp(data + offset, kY4MFrameMagic, strlen(kY4MFrameMagic)) == 0)
+            {
+                line_end = (const uint8_t*)memchr(data + offset, '\n', size - offset);
+            }
+            offset = line_end ? line_end - data + 1 : size;
+        }
+
+        if (offset + frame_size_ <= size) {
+            read_offset_ = offset + frame_size_;
+            return data + offset;
+        }
+
+        // 文件读取完成，循环播放时从第一帧重新开始
+        if (!loop_ || read_offset_ == first_frame_offset_) {
+            return nullptr;
+        }
+        read_offset_ = first_frame_offset_;
+    }
+
+    return nullptr;
+}
+
+std::shared_ptr<MediaFrame> FileVideoSource::CaptureFrame(int64_t now_ms) {
+    const uint8_t* frame_data = NextFrame();
+    if (!frame_data) {
+        RTC_LOG(LS_INFO) << "FileVideoSource reach end of file: " << path_;
+        return nullptr;
+    }
+
+    std::shared_ptr<MediaFrame> video_frame = CreateI420Frame(width_, height_);
+    memcpy(video_frame->data[0], frame_data, frame_size_);
+    return video_frame;
+}
+
+} // namespace xrtc
@@ -0,0 +1,58 @@
+﻿#ifndef XRTCSDK_XRTC_DEVICE_FILE_VIDEO_SOURCE_H_
+#define XRTCSDK_XRTC_DEVICE_FILE_VIDEO_SOURCE_H_
+
+#include <memory>
+#include <string>
+
+#include "xrtc/device/paced_video_source.h"
+
+namespace xrtc {
+
+class MappedFile;
+
+// 从Y4M或者裸I420文件中读取视频帧，不依赖摄像头，用于无头环境下的测试和压测
+// 配置示例：
+// {"file_video_source": {"format": "y4m", "width": 640, "height": 480,
+//   "fps": 30, "loop": true}}
+// fps为0表示不限速，尽可能快地输出；y4m格式的宽高和帧率可以从文件头中获取，
+// 没有配置fps时才使用文件头中的帧率
+class FileVideoSource : public PacedVideoSource {
+public:
+    void Setup(const std::string& json_config) override;
+
+private:
+    FileVideoSource(const std::string& path);
+    ~FileVideoSource() override;
+
+    // PacedVideoSource
+    XRTCError OnStart() override;
+    void OnStop() override;
+    std::shared_ptr<MediaFrame> CaptureFrame(int64_t now_ms) override;
+
+    bool OpenFile();
+    bool ParseY4MHeader();
+    // 返回下一帧I420数据的起始位置，文件读取完成返回nullptr
+    const uint8_t* NextFrame();
+
+    friend class XRTCEngine;
+
+private:
+    std::string path_;
+
+    // 配置
+    bool is_y4m_ = true;
+    int width_ = 0;
+    int height_ = 0;
+    // 配置了fps时，即使为0也不使用y4m文件头中的帧率
+    bool fps_configured_ = false;
+    bool loop_ = true;
+
+    std::unique_ptr<MappedFile> file_;
+    size_t first_frame_offset_ = 0;
+    size_t read_offset_ = 0;
+    size_t frame_size_ = 0;
+};
+
+} // namespace xrtc
+
+#endif // XRTCSDK_XRTC_DEVICE_FILE_VIDEO_SOURCE_H_
@@ -0,0 +1,203 @@
+﻿#include "xrtc/device/paced_video_source.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include <rtc_base/logging.h>
+#include <rtc_base/task_utils/to_queued_task.h>
+#include <rtc_base/time_utils.h>
+
+#include "xrtc/base/xrtc_global.h"
+#include "xrtc/media/base/media_frame.h"
+
+namespace xrtc {
+
+namespace {
+// 不限速时，最多允许多少帧还没有被消费者处理
+const int kMaxPendingFrames = 4;
+} // namespace
+
+PacedVideoSource::PacedVideoSource(const std::string& name,
+    const std::string& thread_name) :
+    name_(name),
+    thread_name_(thread_name),
+    current_thread_(rtc::Thread::Current())
+{
+}
+
+PacedVideoSource::~PacedVideoSource() {
+}
+
+void PacedVideoSource::Start() {
+    RTC_LOG(LS_INFO) << name_ << " Start call";
+    current_thread_->PostTask(webrtc::ToQueuedTask([=] {
+        RTC_LOG(LS_INFO) << name_ << " Start PostTask";
+
+        XRTCError err = XRTCError::kNoErr;
+
+        do {
+            if (has_start_) {
+                RTC_LOG(LS_WARNING) << name_ << " already start, ignore";
+                break;
+            }
+
+            err = OnStart();
+            if (err != XRTCError::kNoErr) {
+                break;
+            }
+
+            running_ = true;
+            thread_ = new std::thread([=]() {
+                rtc::SetCurrentThreadName(thread_name_.c_str());
+                RunLoop();
+            });
+
+            has_start_ = true;
+
+        } while (0);
+
+        // 回调启动结果
+        if (err != XRTCError::kNoErr) {
+            if (XRTCGlobal::Instance()->engine_observer()) {
+                XRTCGlobal::Instance()->engine_observer()->OnVideoSourceFailed(this, err);
+            }
+        }
+        else {
+            if (XRTCGlobal::Instance()->engine_observer()) {
+                XRTCGlobal::Instance()->engine_observer()->OnVideoSourceSuccess(this);
+            }
+        }
+
+    }));
+}
+
+void PacedVideoSource::Stop() {
+    RTC_LOG(LS_INFO) << name_ << " Stop call";
+    current_thread_->PostTask(webrtc::ToQueuedTask([=] {
+        RTC_LOG(LS_INFO) << name_ << " Stop PostTask";
+        StopThread();
+    }));
+}
+
+void PacedVideoSource::StopThread() {
+    if (!has_start_) {
+        return;
+    }
+
+    running_ = false;
+    if (thread_ && thread_->joinable()) {
+        thread_->join();
+        delete thread_;
+        thread_ = nullptr;
+    }
+
+    OnStop();
+    start_time_ = 0;
+    last_ts_ = -1;
+    has_start_ = false;
+}
+
+void PacedVideoSource::Destroy() {
+    RTC_LOG(LS_INFO) << name_ << " Destroy call";
+    current_thread_->PostTask(webrtc::ToQueuedTask([=] {
+        RTC_LOG(LS_INFO) << name_ << " Destroy PostTask";
+        // 没有调用Stop就销毁时，生成线程还在访问该对象，需要在子类析构之前停止
+        StopThread();
+        delete this;
+    }));
+}
+
+void PacedVideoSource::AddConsumer(IXRTCConsumer* consumer) {
+    current_thread_->PostTask(webrtc::ToQueuedTask([=] {
+        RTC_LOG(LS_INFO) << name_ << " add consumer: " << consumer;
+        consumer_list_.push_back(consumer);
+    }));
+}
+
+void PacedVideoSource::RemoveConsumer(IXRTCConsumer* consumer) {
+    current_thread_->PostTask(webrtc::ToQueuedTask([=] {
+        RTC_LOG(LS_INFO) << name_ << " Remove consumer: " << consumer;
+        auto iter = consumer_list_.begin();
+        for (; iter != consumer_list_.end(); ++iter) {
+            if (*iter == consumer) {
+                consumer_list_.erase(iter);
+                break;
+            }
+        }
+    }));
+}
+
+std::shared_ptr<MediaFrame> PacedVideoSource::CreateI420Frame(int width, int height) {
+    int chroma_width = (width + 1) / 2;
+    int chroma_height = (height + 1) / 2;
+    int frame_size = width * height + 2 * chroma_width * chroma_height;
+
+    std::shared_ptr<MediaFrame> video_frame = std::make_shared<MediaFrame>(frame_size);
+    video_frame->fmt.media_type = MainMediaType::kMainTypeVideo;
+    video_frame->fmt.sub_fmt.video_fmt.type = SubMediaType::kSubTypeI420;
+    video_frame->fmt.sub_fmt.video_fmt.width = width;
+    video_frame->fmt.sub_fmt.video_fmt.height = height;
+    video_frame->stride[0] = width;
+    video_frame->stride[1] = chroma_width;
+    video_frame->stride[2] = chroma_width;
+    video_frame->data_len[0] = width * height;
+    video_frame->data_len[1] = chroma_width * chroma_height;
+    video_frame->data_len[2] = chroma_width * chroma_height;
+    video_frame->data[1] = video_frame->data[0] + video_frame->data_len[0];
+    video_frame->data[2] = video_frame->data[1] + video_frame->data_len[1];
+    return video_frame;
+}
+
+void PacedVideoSource::RunLoop() {
+    RTC_LOG(LS_INFO) << name_ << " thread running, fps: " << fps_;
+
+    int64_t frame_interval_us = fps_ > 0 ? rtc::kNumMicrosecsPerSec / fps_ : 0;
+    int64_t next_frame_time_us = rtc::TimeMicros();
+    while (running_) {
+        if (frame_interval_us > 0) {
+            int64_t wait_us = next_frame_time_us - rtc::TimeMicros();
+            if (wait_us > 0) {
+                std::this_thread::sleep_for(std::chrono::microseconds(wait_us));
+                continue;
+            }
+            next_frame_time_us += frame_interval_us;
+        }
+        else if (pending_frames_ >= kMaxPendingFrames) {
+            // 不限速时，消费者来不及处理，等待一下
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+
+        int64_t now = rtc::TimeMillis();
+        std::shared_ptr<MediaFrame> video_frame = CaptureFrame(now);
+        if (!video_frame) {
+            RTC_LOG(LS_INFO) << name_ << " no more frames, thread exit";
+            break;
+        }
+
+        DeliverFrame(video_frame, now);
+    }
+}
+
+void PacedVideoSource::DeliverFrame(std::shared_ptr<MediaFrame> video_frame,
+    int64_t now_ms)
+{
+    if (0 == start_time_) {
+        start_time_ = now_ms;
+    }
+
+    // 不限速或者帧间隔小于1ms时，相邻帧的毫秒时间相同
+    last_ts_ = std::max(now_ms - start_time_, last_ts_ + 1);
+    video_frame->ts = static_cast<uint32_t>(last_ts_);
+    video_frame->capture_time_ms = now_ms;
+
+    ++pending_frames_;
+    current_thread_->PostTask(webrtc::ToQueuedTask(task_safety_, [=] {
+        for (auto consumer : consumer_list_) {
+            consumer->OnFrame(video_frame);
+        }
+        --pending_frames_;
+    }));
+}
+
+} // namespace xrtc
@@ -0,0 +1,74 @@
+﻿#ifndef XRTCSDK_XRTC_DEVICE_PACED_VIDEO_SOURCE_H_
+#define XRTCSDK_XRTC_DEVICE_PACED_VIDEO_SOURCE_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <rtc_base/thread.h>
+#include <rtc_base/task_utils/pending_task_safety_flag.h>
+
+#include "xrtc/xrtc.h"
+
+namespace xrtc {
+
+class MediaFrame;
+
+// 在独立线程中按照帧率生成视频帧的视频源的公共部分，文件和测试图像视频源共用：
+// 启动、停止和销毁的生命周期，消费者列表，按照帧率限速或者不限速时的反压，以及帧的时间戳
+// 接口在创建对象的线程中执行，子类只需要实现OnStart和CaptureFrame
+class PacedVideoSource : public IVideoSource {
+public:
+    void Start() override;
+    void Stop() override;
+    void Destroy() override;
+    void AddConsumer(IXRTCConsumer* consumer) override;
+    void RemoveConsumer(IXRTCConsumer* consumer) override;
+
+protected:
+    // name用于日志，thread_name为生成线程的名称
+    PacedVideoSource(const std::string& name, const std::string& thread_name);
+    virtual ~PacedVideoSource();
+
+    // 在创建对象的线程中调用，返回错误时不启动生成线程
+    virtual XRTCError OnStart() = 0;
+    // 生成线程退出之后调用
+    virtual void OnStop() {}
+    // 在生成线程中调用，填充一帧图像，返回nullptr表示没有更多的帧，线程退出
+    virtual std::shared_ptr<MediaFrame> CaptureFrame(int64_t now_ms) = 0;
+
+    static std::shared_ptr<MediaFrame> CreateI420Frame(int width, int height);
+
+protected:
+    // 为0表示不限速，尽可能快地输出，OnStart之后不能再修改
+    int fps_ = 0;
+
+private:
+    // 停止并等待生成线程退出，Stop和Destroy都需要调用
+    void StopThread();
+    void RunLoop();
+    void DeliverFrame(std::shared_ptr<MediaFrame> frame, int64_t now_ms);
+
+private:
+    std::string name_;
+    std::string thread_name_;
+    rtc::Thread* current_thread_;
+    bool has_start_ = false;
+    std::vector<IXRTCConsumer*> consumer_list_;
+
+    std::thread* thread_ = nullptr;
+    std::atomic<bool> running_{ false };
+    // 已经投递但是消费者还没有处理的帧数，不限速时用于反压
+    std::atomic<int> pending_frames_{ 0 };
+    int64_t start_time_ = 0;
+    // 上一帧的时间戳，编码器用时间戳作为pts，需要严格递增
+    int64_t last_ts_ = -1;
+    // 对象销毁之后，已经投递还没有执行的帧不再回调消费者
+    webrtc::ScopedTaskSafety task_safety_;
+};
+
+} // namespace xrtc
+
+#endif // XRTCSDK_XRTC_DEVICE_PACED_VIDEO_SOURCE_H_
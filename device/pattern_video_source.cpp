@@ -0,0 +1,212 @@
+﻿#include "xrtc/device/pattern_video_source.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include <rtc_base/logging.h>
+
+#include "xrtc/base/xrtc_json.h"
+#include "xrtc/media/base/media_frame.h"
+
+namespace xrtc {
+
+namespace {
+// 渐变色每一帧移动的像素
+const int kGradientSpeed = 4;
+// 文字每一帧滚动的像素
+const int kTextSpeed = 6;
+
+const int kGlyphWidth = 5;
+const int kGlyphHeight = 7;
+
+// 5x7点阵字体，每一行的低5位有效
+struct Glyph {
+    char c;
+    uint8_t rows[kGlyphHeight];
+};
+
+const Glyph kGlyphs[] = {
+    { '0', { 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E } },
+    { '1', { 0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E } },
+    { '2', { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F } },
+    { '3', { 0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E } },
+    { '4', { 0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02 } },
+    { '5', { 0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E } },
+    { '6', { 0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E } },
+    { '7', { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 } },
+    { '8', { 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E } },
+    { '9', { 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C } },
+    { ':', { 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00 } },
+    { '.', { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C } },
+    { '#', { 0x0A, 0x0A, 0x1F, 0x0A, 0x1F, 0x0A, 0x0A } },
+};
+
+const uint8_t* FindGlyph(char c) {
+    for (const auto& glyph : kGlyphs) {
+        if (glyph.c == c) {
+            return glyph.rows;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace
+
+PatternVideoSource::PatternVideoSource() :
+    PacedVideoSource("PatternVideoSource", "pattern_video_source_thread")
+{
+    fps_ = 30;
+}
+
+PatternVideoSource::~PatternVideoSource() {
+}
+
+void PatternVideoSource::Setup(const std::string& json_config) {
+    JsonValue value;
+    if (!value.FromJson(json_config)) {
+        RTC_LOG(LS_WARNING) << "PatternVideoSource invalid config: " << json_config;
+        return;
+    }
+
+    JsonObject jobj = value.ToObject();
+    JsonObject jsource = jobj["pattern_video_source"].ToObject();
+    std::string pattern = jsource["pattern"].ToString("gradient");
+    if (pattern == "noise") {
+        pattern_ = Pattern::kNoise;
+    }
+    else if (pattern == "text") {
+        pattern_ = Pattern::kText;
+    }
+    else {
+        pattern_ = Pattern::kGradient;
+    }
+
+    width_ = (int)jsource["width"].ToInt(width_);
+    height_ = (int)jsource["height"].ToInt(height_);
+    fps_ = (int)jsource["fps"].ToInt(fps_);
+    entropy_ = std::min<int>((int)jsource["entropy"].ToInt(entropy_), 100);
+}
+
+XRTCError PatternVideoSource::OnStart() {
+    if (width_ <= 0 || height_ <= 0) {
+        RTC_LOG(LS_WARNING) << "PatternVideoSource invalid size, width: "
+            << width_ << ", height: " << height_;
+        return XRTCError::kVideoNoCapabilitiesErr;
+    }
+
+    frame_count_ = 0;
+    RTC_LOG(LS_INFO) << "PatternVideoSource width: " << width_
+        << ", height: " << height_ << ", fps: " << fps_;
+    return XRTCError::kNoErr;
+}
+
+std::shared_ptr<MediaFrame> PatternVideoSource::CaptureFrame(int64_t now_ms) {
+    std::shared_ptr<MediaFrame> video_frame = CreateI420Frame(width_, height_);
+    FillGradient(video_frame.get());
+    if (Pattern::kNoise == pattern_) {
+        AddNoise(video_frame.get());
+    }
+    else if (Pattern::kText == pattern_) {
+        DrawText(video_frame.get(), now_ms);
+    }
+
+    ++frame_count_;
+    return video_frame;
+}
+
+// 亮度沿着对角线渐变，色度水平和垂直渐变，整体随着帧号移动
+void PatternVideoSource::FillGradient(MediaFrame* frame) {
+    int offset = frame_count_ * kGradientSpeed;
+    uint8_t* y = (uint8_t*)frame->data[0];
+    for (int row = 0; row < height_; ++row) {
+        uint8_t* line = y + row * frame->stride[0];
+        for (int col = 0; col < width_; ++col) {
+            line[col] = (uint8_t)(row + col + offset);
+        }
+    }
+
+    int chroma_width = (width_ + 1) / 2;
+    int chroma_height = (height_ + 1) / 2;
+    uint8_t* u = (uint8_t*)frame->data[1];
+    uint8_t* v = (uint8_t*)frame->data[2];
+    for (int row = 0; row < chroma_height; ++row) {
+        uint8_t* uline = u + row * frame->stride[1];
+        uint8_t* vline = v + row * frame->stride[2];
+        for (int col = 0; col < chroma_width; ++col) {
+            uline[col] = (uint8_t)(128 + ((col + offset) & 0x3f) - 32);
+            vline[col] = (uint8_t)(128 + ((row + offset) & 0x3f) - 32);
+        }
+    }
+}
+
+// 噪声的幅度由entropy决定，100时亮度完全随机，编码器几乎无法压缩
+void PatternVideoSource::AddNoise(MediaFrame* frame) {
+    if (entropy_ <= 0) {
+        return;
+    }
+
+    int amplitude = entropy_ * 256 / 100;
+    uint8_t* y = (uint8_t*)frame->data[0];
+    for (int row = 0; row < height_; ++row) {
+        uint8_t* line = y + row * frame->stride[0];
+        for (int col = 0; col < width_; ++col) {
+            int noise = (int)(NextRandom() % amplitude) - amplitude / 2;
+            line[col] = (uint8_t)std::min(255, std::max(0, line[col] + noise));
+        }
+    }
+}
+
+// 在画面中间滚动显示采集时间和帧号
+void PatternVideoSource::DrawText(MediaFrame* frame, int64_t now_ms) {
+    char text[64];
+    int64_t seconds = now_ms / 1000;
+    snprintf(text, sizeof(text), "%02d:%02d:%02d.%03d #%06u",
+        (int)(seconds / 3600 % 24), (int)(seconds / 60 % 60), (int)(seconds % 60),
+        (int)(now_ms % 1000), frame_count_);
+
+    int scale = std::max(1, height_ / 60);
+    int glyph_advance = (kGlyphWidth + 1) * scale;
+    int text_width = (int)strlen(text) * glyph_advance;
+    int x0 = width_ - (int)((frame_count_ * kTextSpeed) % (width_ + text_width));
+    int y0 = (height_ - kGlyphHeight * scale) / 2;
+
+    uint8_t* y = (uint8_t*)frame->data[0];
+    for (size_t i = 0; text[i]; ++i) {
+        const uint8_t* rows = FindGlyph(text[i]);
+        if (!rows) {
+            continue;
+        }
+
+        int gx = x0 + (int)i * glyph_advance;
+        for (int r = 0; r < kGlyphHeight * scale; ++r) {
+            int py = y0 + r;
+            if (py < 0 || py >= height_) {
+                continue;
+            }
+            uint8_t* line = y + py * frame->stride[0];
+            uint8_t bits = rows[r / scale];
+            for (int c = 0; c < kGlyphWidth * scale; ++c) {
+                int px = gx + c;
+                if (px < 0 || px >= width_) {
+                    continue;
+                }
+                bool on = (bits >> (kGlyphWidth - 1 - c / scale)) & 0x1;
+                line[px] = on ? 235 : 16;
+            }
+        }
+    }
+}
+
+// xorshift32，只用于生成噪声，不需要高质量的随机数
+uint32_t PatternVideoSource::NextRandom() {
+    uint32_t x = random_state_;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    random_state_ = x;
+    return x;
+}
+
+} // namespace xrtc
@@ -0,0 +1,55 @@
+﻿#ifndef XRTCSDK_XRTC_DEVICE_PATTERN_VIDEO_SOURCE_H_
+#define XRTCSDK_XRTC_DEVICE_PATTERN_VIDEO_SOURCE_H_
+
+#include <memory>
+#include <string>
+
+#include "xrtc/device/paced_video_source.h"
+
+namespace xrtc {
+
+// 不依赖任何I/O，直接生成测试图像的视频源，用于控制编码器的输入复杂度
+// 配置示例：
+// {"pattern_video_source": {"pattern": "noise", "width": 1280, "height": 720,
+//   "fps": 30, "entropy": 50}}
+// pattern: gradient 移动的渐变色；noise 在渐变色上叠加噪声，entropy[0, 100]控制噪声的强度；
+// text 滚动显示采集时间和帧号，可以用来测量端到端的延迟
+class PatternVideoSource : public PacedVideoSource {
+public:
+    enum class Pattern {
+        kGradient,
+        kNoise,
+        kText,
+    };
+
+    void Setup(const std::string& json_config) override;
+
+private:
+    PatternVideoSource();
+    ~PatternVideoSource() override;
+
+    // PacedVideoSource
+    XRTCError OnStart() override;
+    std::shared_ptr<MediaFrame> CaptureFrame(int64_t now_ms) override;
+
+    void FillGradient(MediaFrame* frame);
+    void AddNoise(MediaFrame* frame);
+    void DrawText(MediaFrame* frame, int64_t now_ms);
+    uint32_t NextRandom();
+
+    friend class XRTCEngine;
+
+private:
+    // 配置
+    Pattern pattern_ = Pattern::kGradient;
+    int width_ = 640;
+    int height_ = 480;
+    int entropy_ = 50;
+
+    uint32_t frame_count_ = 0;
+    uint32_t random_state_ = 0x12345678;
+};
+
+} // namespace xrtc
+
+#endif // XRTCSDK_XRTC_DEVICE_PATTERN_VIDEO_SOURCE_H_
@@ -18,6 +18,16 @@ MediaObject* MediaChain::FindObjectById(MediaObjectId mid) const {
     return nullptr;
 }
 
+std::vector<MediaObject*> MediaChain::FindObjectsById(MediaObjectId mid) const {
+    std::vector<MediaObject*> objects;
+    for (auto obj : media_objects_) {
+        if (obj->mid() == mid) {
+            objects.push_back(obj);
+        }
+    }
+    return objects;
+}
+
 bool MediaChain::ConnectMediaObject(MediaObject* from, MediaObject* to) {
     if (!from || !to) {
         return false;
@@ -49,6 +59,12 @@ void MediaChain::SetupChain(const std::string& json_config) {
 }
 
 bool MediaChain::StartChain() {
+    for (auto obj : media_objects_) {
+        for (auto out_pin : obj->GetAllOutPins()) {
+            out_pin->Start();
+        }
+    }
+
     for (auto obj : media_objects_) {
         if (!obj->Start()) {
             return false;
@@ -62,6 +78,14 @@ void MediaChain::StopChain() {
     for (auto obj : media_objects_) {
         obj->Stop();
     }
+
+    // 对象停止之后不会再产生数据，再停止所有的分支线程，
+    // 之后析构对象时不会有分支线程访问已经释放的InPin
+    for (auto obj : media_objects_) {
+        for (auto out_pin : obj->GetAllOutPins()) {
+            out_pin->Stop();
+        }
+    }
 }
 
 } // namespace xrtc
\ No newline at end of file
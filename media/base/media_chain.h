@@ -14,6 +14,9 @@ namespace xrtc {
  enum class MediaObjectId {
     kMidUnknownId,
     kMidX264EncoderFilterId,
+    kMidVideoScalerFilterId,
+    kMidFrameRateAdapterFilterId,
+    kMidH264DecoderFilterId,
  };
 
 class MediaObject {
@@ -30,7 +33,7 @@ public:
 
     MediaObjectId mid() const { return mid_; }
 private:
-    mid_;
+    MediaObjectId mid_;
 };
 
 class XRTC_API MediaChain {
@@ -45,6 +48,8 @@ public:
     virtual void OnChainFailed(MediaObject*, XRTCError) {}
 
     MediaObject* FindObjectById(MediaObjectId mid) const ;
+    // 同一类对象可能有多个，例如simulcast时每一层一个编码器
+    std::vector<MediaObject*> FindObjectsById(MediaObjectId mid) const;
 
 protected:
     void AddMediaObject(MediaObject* obj);
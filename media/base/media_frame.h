@@ -27,6 +27,18 @@ struct VideoFormat {
     bool idr;
 };
 
+// 发送端每一帧经过的各个阶段，用于统计每个阶段的延迟
+enum FrameStage {
+    kFrameStageCapture,        // 采集
+    kFrameStageEncodeQueue,    // 进入编码队列
+    kFrameStageEncodeStart,    // 开始编码
+    kFrameStageEncodeEnd,      // 编码完成
+    kFrameStagePacketize,      // RTP打包完成
+    kFrameStagePacerEnqueue,   // 进入pacer队列
+    kFrameStageLastPacketSent, // 最后一个包发送到网络
+    kFrameStageNum,
+};
+
 class MediaFormat {
 public:
     MainMediaType media_type;
@@ -42,16 +54,21 @@ public:
         memset(data, 0, sizeof(data));
         memset(data_len, 0, sizeof(data_len));
         memset(stride, 0, sizeof(stride));
-        data[0] = new char[size];
+        memset(stage_time_ms, 0, sizeof(stage_time_ms));
+        buffer_ = new char[size];
+        data[0] = buffer_;
         data_len[0] = size;
     }
 
     ~MediaFrame() {
-        if (data[0]) {
-            delete[] data[0];
-            data[0] = nullptr;
+        if (buffer_) {
+            delete[] buffer_;
+            buffer_ = nullptr;
         }
     }
+
+    // 分配的内存，data[0]不一定指向起始位置，例如需要按照SIMD的要求对齐时
+    char* buffer() { return buffer_; }
     
 public:
     int max_size;
@@ -61,6 +78,16 @@ public:
     int stride[4];
     uint32_t ts = 0;
     int64_t capture_time_ms = 0;
+    // simulcast的层，按分辨率从低到高编号
+    int simulcast_index = 0;
+    // 时间层，0为基础层，num_temporal_layers - 1层的帧没有被参考，可以直接丢弃
+    int temporal_id = 0;
+    int num_temporal_layers = 1;
+    // 每个阶段的时间点(ms)，0表示没有记录
+    int64_t stage_time_ms[kFrameStageNum];
+
+private:
+    char* buffer_ = nullptr;
 };
 
 } // namespace xrtc
@@ -1,10 +1,94 @@
 ﻿#include "xrtc/media/base/out_pin.h"
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include <rtc_base/logging.h>
+#include <rtc_base/thread.h>
+
 #include "xrtc/media/base/media_chain.h"
 #include "xrtc/media/base/in_pin.h"
 
 namespace xrtc {
 
+// 多分支时的一个分支，拥有独立的队列和推送线程
+class OutPinBranch {
+public:
+    OutPinBranch(InPin* in_pin, size_t max_queue_size) :
+        in_pin_(in_pin),
+        max_queue_size_(max_queue_size)
+    {
+        thread_ = std::thread([=]() {
+            rtc::SetCurrentThreadName("out_pin_branch_thread");
+            Run();
+        });
+    }
+
+    ~OutPinBranch() {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            running_ = false;
+        }
+        cond_var_.notify_one();
+
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+
+        if (dropped_frames_ > 0) {
+            RTC_LOG(LS_WARNING) << "OutPinBranch dropped frames: " << dropped_frames_
+                << ", in_pin: " << in_pin_;
+        }
+    }
+
+    void Push(std::shared_ptr<MediaFrame> frame) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            // 分支处理不过来，丢弃最旧的帧，保证下游拿到的是最新的数据
+            if (queue_.size() >= max_queue_size_) {
+                queue_.pop_front();
+                ++dropped_frames_;
+            }
+            queue_.push_back(std::move(frame));
+        }
+        cond_var_.notify_one();
+    }
+
+private:
+    void Run() {
+        while (true) {
+            std::shared_ptr<MediaFrame> frame;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cond_var_.wait(lock, [=]() {
+                    return !running_ || !queue_.empty();
+                });
+
+                if (!running_) {
+                    break;
+                }
+
+                frame = std::move(queue_.front());
+                queue_.pop_front();
+            }
+
+            in_pin_->PushMediaFrame(frame);
+        }
+    }
+
+private:
+    InPin* in_pin_;
+    size_t max_queue_size_;
+    std::deque<std::shared_ptr<MediaFrame>> queue_;
+    std::mutex mutex_;
+    std::condition_variable cond_var_;
+    bool running_ = true;
+    int64_t dropped_frames_ = 0;
+    std::thread thread_;
+};
+
 OutPin::OutPin(MediaObject* obj) : BasePin(obj) {
 }
 
@@ -16,14 +100,57 @@ bool OutPin::ConnectTo(InPin* in_pin) {
         return false;
     }
 
-    in_pin_ = in_pin;
+    std::unique_lock<std::mutex> auto_lock(mtx_);
+    in_pins_.push_back(in_pin);
+    if (!stopped_) {
+        MaybeCreateBranches();
+    }
 
     return true;
 }
 
+void OutPin::Start() {
+    std::unique_lock<std::mutex> auto_lock(mtx_);
+    stopped_ = false;
+    MaybeCreateBranches();
+}
+
+void OutPin::Stop() {
+    std::vector<std::unique_ptr<OutPinBranch>> branches;
+    {
+        std::unique_lock<std::mutex> auto_lock(mtx_);
+        stopped_ = true;
+        branches.swap(branches_);
+    }
+    // 在锁外等待分支线程退出，分支线程只访问下游的InPin，不会回调OutPin
+    branches.clear();
+}
+
+void OutPin::MaybeCreateBranches() {
+    // 从一个分支变为多个分支，所有分支都切换到独立线程推送
+    if (in_pins_.size() <= 1) {
+        return;
+    }
+
+    for (size_t i = branches_.size(); i < in_pins_.size(); ++i) {
+        branches_.push_back(std::make_unique<OutPinBranch>(
+            in_pins_[i], branch_queue_size_));
+    }
+}
+
 void OutPin::PushMediaFrame(std::shared_ptr<MediaFrame> frame) {
-    if (in_pin_) {
-        in_pin_->PushMediaFrame(frame);
+    std::unique_lock<std::mutex> auto_lock(mtx_);
+    if (stopped_) {
+        return;
+    }
+
+    if (!branches_.empty()) {
+        for (auto& branch : branches_) {
+            branch->Push(frame);
+        }
+    }
+    else if (!in_pins_.empty()) {
+        in_pins_[0]->PushMediaFrame(frame);
     }
 }
 
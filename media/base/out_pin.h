@@ -1,12 +1,20 @@
 ﻿#ifndef XRTCSDK_XRTC_MEDIA_BASE_OUT_PIN_H_
 #define XRTCSDK_XRTC_MEDIA_BASE_OUT_PIN_H_
 
+#include <mutex>
+#include <vector>
+
 #include "xrtc/media/base/base_pin.h"
 
 namespace xrtc {
 
 class InPin;
+class OutPinBranch;
 
+// 一个OutPin可以连接多个InPin，所有分支共享同一个MediaFrame，不做拷贝
+// 只有一个分支时直接在调用线程中推送；有多个分支时，每个分支有独立的
+// 有界队列和线程，队列满时丢弃最旧的帧，慢的分支不会阻塞其它分支
+// 需要在推送数据之前完成所有的连接，Stop之后分支线程全部退出，推送的数据被丢弃
 class OutPin : public BasePin {
 public:
     OutPin() = delete;
@@ -14,12 +22,26 @@ public:
     ~OutPin() override;
 
     bool ConnectTo(InPin* in_pin);
+    // 由MediaChain在StartChain/StopChain中调用，Stop返回之后分支线程不会再访问下游的InPin
+    void Start();
+    void Stop();
+    // 多分支时每个分支队列的最大帧数，需要在连接之前设置
+    void set_branch_queue_size(size_t size) { branch_queue_size_ = size; }
 
     // BasePin
     void PushMediaFrame(std::shared_ptr<MediaFrame> frame) override;
 
 private:
-    InPin* in_pin_ = nullptr;
+    // 调用时持有mtx_
+    void MaybeCreateBranches();
+
+private:
+    // 保护in_pins_、branches_和stopped_，推送线程和连接、停止的线程可能不同
+    std::mutex mtx_;
+    std::vector<InPin*> in_pins_;
+    std::vector<std::unique_ptr<OutPinBranch>> branches_;
+    size_t branch_queue_size_ = 3;
+    bool stopped_ = false;
 };
 
 } // namespace xrtc
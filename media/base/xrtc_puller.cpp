@@ -0,0 +1,68 @@
+﻿#include "xrtc/media/base/xrtc_puller.h"
+
+#include <rtc_base/logging.h>
+#include <rtc_base/task_utils/to_queued_task.h>
+#include <rtc_base/string_encode.h>
+
+#include "xrtc/base/xrtc_global.h"
+#include "xrtc/media/chain/xrtc_pull_stream.h"
+
+namespace xrtc {
+
+XRTCPuller::XRTCPuller(XRTCRender* render) :
+    render_(render),
+    current_thread_(rtc::Thread::Current())
+{
+}
+
+XRTCPuller::~XRTCPuller() {
+
+}
+
+void XRTCPuller::StartPull(const std::string& url) {
+    RTC_LOG(LS_INFO) << "XRTCPuller StartPull call";
+    current_thread_->PostTask(webrtc::ToQueuedTask([=]() {
+        RTC_LOG(LS_INFO) << "XRTCPuller StartPull PostTask";
+
+        // xrtc://www.str2num.com/pull?uid=xxx&streamName=xxx
+        url_ = url;
+        // 解析url中的协议，根据协议创建具体的处理链条
+        std::vector<std::string> fields;
+        rtc::tokenize(url_, ':', &fields);
+        if (fields.size() < 2) {
+            RTC_LOG(LS_WARNING) << "invalid url: " << url;
+            if (XRTCGlobal::Instance()->engine_observer()) {
+                XRTCGlobal::Instance()->engine_observer()->OnPullFailed(
+                    this, XRTCError::kPullInvalidUrlErr);
+            }
+            return;
+        }
+
+        std::string protocol = fields[0];
+        if ("xrtc" == protocol) {
+            media_chain_ = std::make_unique<XRTCPullStream>(this, render_);
+            media_chain_->Start();
+        }
+
+    }));
+}
+
+void XRTCPuller::StopPull() {
+    RTC_LOG(LS_INFO) << "XRTCPuller StopPull call";
+    current_thread_->PostTask(webrtc::ToQueuedTask([=]() {
+        RTC_LOG(LS_INFO) << "XRTCPuller StopPull PostTask";
+        if (media_chain_) {
+            media_chain_->Stop();
+        }
+    }));
+}
+
+void XRTCPuller::Destroy() {
+    RTC_LOG(LS_INFO) << "XRTCPuller Destroy call";
+    current_thread_->PostTask(webrtc::ToQueuedTask([=]() {
+        RTC_LOG(LS_INFO) << "XRTCPuller Destroy PostTask";
+        delete this;
+    }));
+}
+
+} // namespace xrtc
\ No newline at end of file
@@ -0,0 +1,35 @@
+﻿#ifndef XRTCSDK_XRTC_MEDIA_BASE_XRTC_PULLER_H_
+#define XRTCSDK_XRTC_MEDIA_BASE_XRTC_PULLER_H_
+
+#include <rtc_base/thread.h>
+
+#include "xrtc/xrtc.h"
+#include "xrtc/device/xrtc_render.h"
+#include "xrtc/media/base/media_chain.h"
+
+namespace xrtc {
+
+class XRTC_API XRTCPuller {
+public:
+    void StartPull(const std::string& url);
+    void StopPull();
+    void Destroy();
+
+    std::string Url() { return url_; }
+
+private:
+    XRTCPuller(XRTCRender* render);
+    ~XRTCPuller();
+
+    friend class XRTCEngine;
+
+private:
+    XRTCRender* render_;
+    std::string url_;
+    rtc::Thread* current_thread_;
+    std::unique_ptr<MediaChain> media_chain_;
+};
+
+} // namespace xrtc
+
+#endif // XRTCSDK_XRTC_MEDIA_BASE_XRTC_PULLER_H_
\ No newline at end of file
@@ -12,9 +12,16 @@ XRTCPreview::XRTCPreview(IVideoSource* video_source, XRTCRender* render) :
     current_thread_(rtc::Thread::Current()),
     video_source_(video_source),
     render_(render),
-    xrtc_video_source_(std::make_unique<XRTCVideoSource>()),
-    d3d9_render_sink_(std::make_unique<D3D9RenderSink>())
-{            
+    xrtc_video_source_(std::make_unique<XRTCVideoSource>())
+{
+#ifdef _WIN32
+    if (render_ && render_->canvas()) {
+        render_sink_ = std::make_unique<D3D9RenderSink>();
+    }
+#endif
+    if (!render_sink_) {
+        render_sink_ = std::make_unique<NullRenderSink>();
+    }
 }
 
 XRTCPreview::~XRTCPreview() {
@@ -41,20 +48,22 @@ void XRTCPreview::Start() {
 
             video_source_->AddConsumer(xrtc_video_source_.get());
             AddMediaObject(xrtc_video_source_.get());
-            AddMediaObject(d3d9_render_sink_.get());
+            AddMediaObject(render_sink_.get());
 
-            if (!ConnectMediaObject(xrtc_video_source_.get(), d3d9_render_sink_.get())) {
+            if (!ConnectMediaObject(xrtc_video_source_.get(), render_sink_.get())) {
                 err = XRTCError::kChainConnectErr;
-                RTC_LOG(LS_WARNING) << "XRTCPreview failed: xrtc_video_source connect d3d9_render_sink error";
+                RTC_LOG(LS_WARNING) << "XRTCPreview failed: xrtc_video_source connect render_sink error";
                 break;
             }
 
-            RTC_LOG(LS_WARNING) << "xrtc_video_source connect d3d9_render_sink success";
+            RTC_LOG(LS_WARNING) << "xrtc_video_source connect render_sink success";
 
             JsonObject json_config;
-            JsonObject j_d3d9_render_sink;
-            j_d3d9_render_sink["hwnd"] = (long long)render_->canvas();
-            json_config["d3d9_render_sink"] = j_d3d9_render_sink;
+            if (render_) {
+                JsonObject j_d3d9_render_sink;
+                j_d3d9_render_sink["hwnd"] = (long long)render_->canvas();
+                json_config["d3d9_render_sink"] = j_d3d9_render_sink;
+            }
 
             SetupChain(JsonValue(json_config).ToJson());
 
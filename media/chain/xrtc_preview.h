@@ -7,7 +7,10 @@
 #include "xrtc/device/xrtc_render.h"
 #include "xrtc/media/base/media_chain.h"
 #include "xrtc/media/source/xrtc_video_source.h"
+#include "xrtc/media/sink/null_render_sink.h"
+#ifdef _WIN32
 #include "xrtc/media/sink/d3d9_render_sink.h"
+#endif
 
 namespace xrtc {
 
@@ -29,7 +32,8 @@ private:
     IVideoSource* video_source_;
     XRTCRender* render_;
     std::unique_ptr<XRTCVideoSource> xrtc_video_source_;
-    std::unique_ptr<D3D9RenderSink> d3d9_render_sink_;
+    // 有窗口时用D3D9RenderSink显示，没有窗口或者不是Windows时用NullRenderSink
+    std::unique_ptr<MediaObject> render_sink_;
     bool has_start_ = false;
 };
 
@@ -0,0 +1,141 @@
+﻿#include "xrtc/media/chain/xrtc_pull_stream.h"
+
+#include <rtc_base/logging.h>
+
+#include "xrtc/base/xrtc_json.h"
+#include "xrtc/base/xrtc_utils.h"
+#include "xrtc/media/base/xrtc_puller.h"
+#include "xrtc/base/xrtc_global.h"
+
+namespace xrtc {
+
+XRTCPullStream::XRTCPullStream(XRTCPuller* puller, XRTCRender* render) :
+    puller_(puller),
+    render_(render),
+    xrtc_media_source_(std::make_unique<XRTCMediaSource>(this)),
+    h264_decoder_filter_(std::make_unique<H264DecoderFilter>())
+{
+#ifdef _WIN32
+    if (render_ && render_->canvas()) {
+        render_sink_ = std::make_unique<D3D9RenderSink>();
+    }
+#endif
+    if (!render_sink_) {
+        render_sink_ = std::make_unique<NullRenderSink>();
+    }
+}
+
+XRTCPullStream::~XRTCPullStream() {
+
+}
+
+void XRTCPullStream::Start() {
+    RTC_LOG(LS_INFO) << "XRTCPullStream Start";
+
+    XRTCError err = XRTCError::kNoErr;
+
+    do {
+        // 拉流url中可以携带录制参数，保存接收到的H264码流
+        // 没有窗口时可以定期保存解码后的图像
+        // xrtc://www.str2num.com/pull?uid=xxx&streamName=xxx&h264Dump=pull.h264&snapshot=pull.y4m
+        std::string protocol, host, action;
+        std::map<std::string, std::string> request_params;
+        ParseUrl(puller_->Url(), protocol, host, action, request_params);
+        if (!request_params["h264Dump"].empty()) {
+            h264_file_sink_ = std::make_unique<H264FileSink>();
+        }
+
+        AddMediaObject(xrtc_media_source_.get());
+        if (h264_file_sink_) {
+            AddMediaObject(h264_file_sink_.get());
+        }
+        AddMediaObject(h264_decoder_filter_.get());
+        AddMediaObject(render_sink_.get());
+
+        // h264_file_sink串联在xrtc_media_source和解码器之间，帧数据原样转发
+        if (h264_file_sink_) {
+            if (!ConnectMediaObject(xrtc_media_source_.get(), h264_file_sink_.get())) {
+                err = XRTCError::kChainConnectErr;
+                RTC_LOG(LS_WARNING) << "xrtc_media_source connect to h264_file_sink failed";
+                break;
+            }
+
+            if (!ConnectMediaObject(h264_file_sink_.get(), h264_decoder_filter_.get())) {
+                err = XRTCError::kChainConnectErr;
+                RTC_LOG(LS_WARNING) << "h264_file_sink connect to h264_decoder_filter failed";
+                break;
+            }
+        }
+        else if (!ConnectMediaObject(xrtc_media_source_.get(), h264_decoder_filter_.get())) {
+            err = XRTCError::kChainConnectErr;
+            RTC_LOG(LS_WARNING) << "xrtc_media_source connect to h264_decoder_filter failed";
+            break;
+        }
+
+        if (!ConnectMediaObject(h264_decoder_filter_.get(), render_sink_.get())) {
+            err = XRTCError::kChainConnectErr;
+            RTC_LOG(LS_WARNING) << "h264_decoder_filter connect to render_sink failed";
+            break;
+        }
+
+        // 解码器丢帧等待关键帧时，通过拉流的PeerConnection发送PLI
+        h264_decoder_filter_->SignalKeyFrameRequest.connect(xrtc_media_source_.get(),
+            &XRTCMediaSource::OnKeyFrameRequest);
+
+        // 安装参数
+        JsonObject jobj;
+        JsonObject j_xrtc_media_source;
+        j_xrtc_media_source["url"] = puller_->Url();
+        jobj["xrtc_media_source"] = j_xrtc_media_source;
+        if (render_) {
+            JsonObject j_d3d9_render_sink;
+            j_d3d9_render_sink["hwnd"] = (long long)render_->canvas();
+            jobj["d3d9_render_sink"] = j_d3d9_render_sink;
+        }
+        if (!request_params["snapshot"].empty()) {
+            JsonObject j_null_render_sink;
+            j_null_render_sink["snapshot_path"] = request_params["snapshot"];
+            jobj["null_render_sink"] = j_null_render_sink;
+        }
+        if (h264_file_sink_) {
+            JsonObject j_h264_file_sink;
+            j_h264_file_sink["path"] = request_params["h264Dump"];
+            jobj["h264_file_sink"] = j_h264_file_sink;
+        }
+        SetupChain(JsonValue(jobj).ToJson());
+
+        if (!StartChain()) {
+            err = XRTCError::kChainStartErr;
+            RTC_LOG(LS_WARNING) << "PullStream StartChain failed";
+            break;
+        }
+
+    } while (false);
+
+    if (err != XRTCError::kNoErr) {
+        if (XRTCGlobal::Instance()->engine_observer()) {
+            XRTCGlobal::Instance()->engine_observer()->OnPullFailed(puller_, err);
+        }
+    }
+}
+
+void XRTCPullStream::Stop() {
+    StopChain();
+}
+
+void XRTCPullStream::Destroy() {
+}
+
+void XRTCPullStream::OnChainSuccess() {
+    if (XRTCGlobal::Instance()->engine_observer()) {
+        XRTCGlobal::Instance()->engine_observer()->OnPullSuccess(puller_);
+    }
+}
+
+void XRTCPullStream::OnChainFailed(MediaObject*, XRTCError err) {
+    if (XRTCGlobal::Instance()->engine_observer()) {
+        XRTCGlobal::Instance()->engine_observer()->OnPullFailed(puller_, err);
+    }
+}
+
+} // namespace xrtc
\ No newline at end of file
@@ -0,0 +1,43 @@
+﻿#ifndef XRTCSDK_XRTC_MEDIA_CHAIN_XRTC_PULL_STREAM_H_
+#define XRTCSDK_XRTC_MEDIA_CHAIN_XRTC_PULL_STREAM_H_
+
+#include "xrtc/device/xrtc_render.h"
+#include "xrtc/media/base/media_chain.h"
+#include "xrtc/media/source/xrtc_media_source.h"
+#include "xrtc/media/filter/h264_decoder_filter.h"
+#include "xrtc/media/sink/h264_file_sink.h"
+#include "xrtc/media/sink/null_render_sink.h"
+#ifdef _WIN32
+#include "xrtc/media/sink/d3d9_render_sink.h"
+#endif
+
+namespace xrtc {
+
+class XRTCPuller;
+
+class XRTCPullStream : public MediaChain {
+public:
+    XRTCPullStream(XRTCPuller* puller, XRTCRender* render);
+    ~XRTCPullStream() override;
+
+    // MediaChain
+    void Start() override;
+    void Stop() override;
+    void Destroy() override;
+    void OnChainSuccess() override;
+    void OnChainFailed(MediaObject*, XRTCError err) override;
+
+private:
+    XRTCPuller* puller_;
+    XRTCRender* render_;
+    std::unique_ptr<XRTCMediaSource> xrtc_media_source_;
+    std::unique_ptr<H264DecoderFilter> h264_decoder_filter_;
+    // 有窗口时用D3D9RenderSink显示，没有窗口或者不是Windows时用NullRenderSink
+    std::unique_ptr<MediaObject> render_sink_;
+    // 可选的录制，拉流url中带有h264Dump参数时创建
+    std::unique_ptr<H264FileSink> h264_file_sink_;
+};
+
+} // namespace xrtc
+
+#endif // XRTCSDK_XRTC_MEDIA_CHAIN_XRTC_PULL_STREAM_H_
\ No newline at end of file
@@ -1,10 +1,14 @@
 ﻿#include "xrtc/media/chain/xrtc_push_stream.h"
 
+#include <stdlib.h>
+
 #include <rtc_base/logging.h>
 
 #include "xrtc/base/xrtc_json.h"
+#include "xrtc/base/xrtc_utils.h"
 #include "xrtc/media/base/xrtc_pusher.h"
 #include "xrtc/base/xrtc_global.h"
+#include "xrtc/rtc/video/simulcast_rate_allocator.h"
 
 namespace xrtc {
 
@@ -12,7 +16,10 @@ XRTCPushStream::XRTCPushStream(XRTCPusher* pusher, IVideoSource* video_source) :
     pusher_(pusher),
     video_source_(video_source),
     xrtc_video_source_(std::make_unique<XRTCVideoSource>()),
-    x264_encoder_filter_(std::make_unique<X264EncoderFilter>()),
+    video_scaler_filter_(std::make_unique<VideoScalerFilter>()),
+    frame_rate_adapter_filter_(std::make_unique<FrameRateAdapterFilter>()),
+    x264_encoder_filter_(std::make_unique<X264EncoderFilter>(0,
+        XRTCGlobal::Instance()->thread_registry())),
     xrtc_media_sink_(std::make_unique<XRTCMediaSink>(this))
 {
 }
@@ -33,29 +40,148 @@ void XRTCPushStream::Start() {
             break;
         }
 
+        // 推流url中可以携带录制参数，用于离线分析
+        // xrtc://www.str2num.com/push?uid=xxx&streamName=xxx&h264Dump=push.h264&rtpDump=push.rtpdump
+        std::string protocol, host, action;
+        std::map<std::string, std::string> request_params;
+        ParseUrl(pusher_->Url(), protocol, host, action, request_params);
+        if (!request_params["h264Dump"].empty()) {
+            h264_file_sink_ = std::make_unique<H264FileSink>();
+        }
+        if (!request_params["rtpDump"].empty()) {
+            rtp_dump_sink_ = std::make_unique<RtpDumpSink>();
+        }
+
+        // simulcast=3表示同时推三种分辨率，原来的编码链路作为最高层
+        std::vector<SimulcastLayerConfig> layers = SimulcastRateAllocator::DefaultLayers(
+            request_params["simulcast"].empty() ? 1 : atoi(request_params["simulcast"].c_str()));
+        int num_layers = (int)layers.size();
+        ThreadRegistry* thread_registry = XRTCGlobal::Instance()->thread_registry();
+        x264_encoder_filter_ = std::make_unique<X264EncoderFilter>(num_layers - 1,
+            thread_registry);
+        layer_scaler_filters_.clear();
+        layer_encoder_filters_.clear();
+        for (int i = 0; i < num_layers - 1; ++i) {
+            auto scaler_filter = std::make_unique<VideoScalerFilter>();
+            scaler_filter->SetFixedScale(layers[i].scale_down_by);
+            layer_scaler_filters_.push_back(std::move(scaler_filter));
+            layer_encoder_filters_.push_back(std::make_unique<X264EncoderFilter>(i,
+                thread_registry));
+        }
+
+        // temporalLayers=2或3开启时间分层，拥塞时发送端和SFU可以直接丢弃高时间层
+        if (!request_params["temporalLayers"].empty()) {
+            int temporal_layers = atoi(request_params["temporalLayers"].c_str());
+            x264_encoder_filter_->SetTemporalLayers(temporal_layers);
+            for (auto& encoder_filter : layer_encoder_filters_) {
+                encoder_filter->SetTemporalLayers(temporal_layers);
+            }
+        }
+
         video_source_->AddConsumer(xrtc_video_source_.get());
 
         AddMediaObject(xrtc_video_source_.get());
+        AddMediaObject(video_scaler_filter_.get());
+        AddMediaObject(frame_rate_adapter_filter_.get());
         AddMediaObject(x264_encoder_filter_.get());
+        // 最高层的filter先加入，按id查找时找到的是做码率自适应的那一个
+        for (int i = 0; i < num_layers - 1; ++i) {
+            AddMediaObject(layer_scaler_filters_[i].get());
+            AddMediaObject(layer_encoder_filters_[i].get());
+        }
+        if (h264_file_sink_) {
+            AddMediaObject(h264_file_sink_.get());
+        }
+        if (rtp_dump_sink_) {
+            AddMediaObject(rtp_dump_sink_.get());
+        }
         AddMediaObject(xrtc_media_sink_.get());
         
-        if (!ConnectMediaObject(xrtc_video_source_.get(), x264_encoder_filter_.get())) {
+        if (!ConnectMediaObject(xrtc_video_source_.get(), video_scaler_filter_.get())) {
+            err = XRTCError::kChainConnectErr;
+            RTC_LOG(LS_WARNING) << "xrtc_video_source connect to video_scaler_filter failed";
+            break;
+        }
+
+        // 帧率自适应放在缩放之后，按照实际编码的分辨率计算帧率
+        if (!ConnectMediaObject(video_scaler_filter_.get(), frame_rate_adapter_filter_.get())) {
             err = XRTCError::kChainConnectErr;
-            RTC_LOG(LS_WARNING) << "xrtc_video_source connect to x264_encoder_filter failed";
+            RTC_LOG(LS_WARNING) << "video_scaler_filter connect to frame_rate_adapter_filter failed";
             break;
         }
 
-        if (!ConnectMediaObject(x264_encoder_filter_.get(), xrtc_media_sink_.get())) {
+        if (!ConnectMediaObject(frame_rate_adapter_filter_.get(), x264_encoder_filter_.get())) {
+            err = XRTCError::kChainConnectErr;
+            RTC_LOG(LS_WARNING) << "frame_rate_adapter_filter connect to x264_encoder_filter failed";
+            break;
+        }
+
+        x264_encoder_filter_->SignalFrameEncoded.connect(frame_rate_adapter_filter_.get(),
+            &FrameRateAdapterFilter::OnFrameEncoded);
+        // CPU过载时，编码器先降低preset，然后由上游的filter降低分辨率和帧率
+        x264_encoder_filter_->SignalCpuAdaptation.connect(video_scaler_filter_.get(),
+            &VideoScalerFilter::OnCpuAdaptation);
+        x264_encoder_filter_->SignalCpuAdaptation.connect(frame_rate_adapter_filter_.get(),
+            &FrameRateAdapterFilter::OnCpuAdaptation);
+        frame_rate_adapter_filter_->SetCpuAdaptationEnabled(true);
+
+        // h264_file_sink串联在编码器和xrtc_media_sink之间，帧数据原样转发
+        if (h264_file_sink_) {
+            if (!ConnectMediaObject(x264_encoder_filter_.get(), h264_file_sink_.get())) {
+                err = XRTCError::kChainConnectErr;
+                RTC_LOG(LS_WARNING) << "x264_encoder_filter connect to h264_file_sink failed";
+                break;
+            }
+
+            if (!ConnectMediaObject(h264_file_sink_.get(), xrtc_media_sink_.get())) {
+                err = XRTCError::kChainConnectErr;
+                RTC_LOG(LS_WARNING) << "h264_file_sink connect to xrtc_media_sink failed";
+                break;
+            }
+        }
+        else if (!ConnectMediaObject(x264_encoder_filter_.get(), xrtc_media_sink_.get())) {
             err = XRTCError::kChainConnectErr;
             RTC_LOG(LS_WARNING) << "x264_encoder_filter connect to xrtc_media_sink failed";
             break;
         }
 
+        // 低层从采集分支出来，缩放到固定分辨率后单独编码
+        bool layer_connected = true;
+        for (int i = 0; i < num_layers - 1 && layer_connected; ++i) {
+            layer_connected = ConnectMediaObject(xrtc_video_source_.get(), layer_scaler_filters_[i].get())
+                && ConnectMediaObject(layer_scaler_filters_[i].get(), layer_encoder_filters_[i].get())
+                && ConnectMediaObject(layer_encoder_filters_[i].get(), xrtc_media_sink_.get());
+        }
+
+        if (!layer_connected) {
+            err = XRTCError::kChainConnectErr;
+            RTC_LOG(LS_WARNING) << "simulcast layer connect failed";
+            break;
+        }
+
+        if (rtp_dump_sink_) {
+            xrtc_media_sink_->peer_connection()->SignalPacketSent.connect(
+                rtp_dump_sink_.get(), &RtpDumpSink::OnPacketSent);
+        }
+
         // 安装参数
         JsonObject jobj;
         JsonObject j_xrtc_media_sink;
         j_xrtc_media_sink["url"] = pusher_->Url();
+        j_xrtc_media_sink["simulcast"] = num_layers;
+        // 开启时间分层时编码器切换profile，SDP中的profile-level-id需要一致
+        j_xrtc_media_sink["temporal_layers"] = x264_encoder_filter_->temporal_layers();
         jobj["xrtc_media_sink"] = j_xrtc_media_sink;
+        if (h264_file_sink_) {
+            JsonObject j_h264_file_sink;
+            j_h264_file_sink["path"] = request_params["h264Dump"];
+            jobj["h264_file_sink"] = j_h264_file_sink;
+        }
+        if (rtp_dump_sink_) {
+            JsonObject j_rtp_dump_sink;
+            j_rtp_dump_sink["path"] = request_params["rtpDump"];
+            jobj["rtp_dump_sink"] = j_rtp_dump_sink;
+        }
         SetupChain(JsonValue(jobj).ToJson());
 
         if (!StartChain()) {
@@ -3,8 +3,12 @@
 
 #include "xrtc/media/base/media_chain.h"
 #include "xrtc/media/source/xrtc_video_source.h"
+#include "xrtc/media/filter/video_scaler_filter.h"
+#include "xrtc/media/filter/frame_rate_adapter_filter.h"
 #include "xrtc/media/filter/x264_encoder_filter.h"
 #include "xrtc/media/sink/xrtc_media_sink.h"
+#include "xrtc/media/sink/h264_file_sink.h"
+#include "xrtc/media/sink/rtp_dump_sink.h"
 
 namespace xrtc {
 
@@ -26,8 +30,16 @@ private:
     XRTCPusher* pusher_;
     IVideoSource* video_source_;
     std::unique_ptr<XRTCVideoSource> xrtc_video_source_;
+    std::unique_ptr<VideoScalerFilter> video_scaler_filter_;
+    std::unique_ptr<FrameRateAdapterFilter> frame_rate_adapter_filter_;
     std::unique_ptr<X264EncoderFilter> x264_encoder_filter_;
     std::unique_ptr<XRTCMediaSink> xrtc_media_sink_;
+    // 可选的录制，推流url中带有h264Dump或者rtpDump参数时创建
+    std::unique_ptr<H264FileSink> h264_file_sink_;
+    std::unique_ptr<RtpDumpSink> rtp_dump_sink_;
+    // simulcast的低层，推流url中带有simulcast参数时创建，按分辨率从低到高排列
+    std::vector<std::unique_ptr<VideoScalerFilter>> layer_scaler_filters_;
+    std::vector<std::unique_ptr<X264EncoderFilter>> layer_encoder_filters_;
 };
 
 } // namespace xrtc
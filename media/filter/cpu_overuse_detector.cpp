@@ -0,0 +1,72 @@
+﻿#include "xrtc/media/filter/cpu_overuse_detector.h"
+
+namespace xrtc {
+
+namespace {
+// 编码耗时超过帧间隔的85%认为过载，低于50%认为可以恢复
+const double kHighUsage = 0.85;
+const double kLowUsage = 0.5;
+// 编码队列中积压的帧数超过该值，直接认为过载
+const size_t kMaxQueueSize = 3;
+// 过载需要持续的时间，恢复需要更长的时间，避免来回切换
+const int64_t kOveruseHoldTimeMs = 2000;
+const int64_t kUnderuseHoldTimeMs = 10000;
+// 每次调整之后，等待新的参数生效
+const int64_t kAdaptIntervalMs = 3000;
+const double kUsageAlpha = 0.05;
+} // namespace
+
+CpuOveruseDetector::CpuOveruseDetector() {
+}
+
+CpuOveruseDetector::~CpuOveruseDetector() {
+}
+
+CpuOveruseDetector::State CpuOveruseDetector::OnFrameEncoded(
+    int64_t encode_time_ms, int64_t frame_interval_ms,
+    size_t queue_size, int64_t now_ms)
+{
+    if (frame_interval_ms <= 0) {
+        return State::kNormal;
+    }
+
+    double usage = (double)encode_time_ms / frame_interval_ms;
+    encode_usage_ += kUsageAlpha * (usage - encode_usage_);
+
+    if (last_adapt_time_ms_ >= 0 && now_ms - last_adapt_time_ms_ < kAdaptIntervalMs) {
+        return State::kNormal;
+    }
+
+    if (encode_usage_ > kHighUsage || queue_size > kMaxQueueSize) {
+        underuse_start_time_ms_ = -1;
+        if (overuse_start_time_ms_ < 0) {
+            overuse_start_time_ms_ = now_ms;
+        }
+        if (now_ms - overuse_start_time_ms_ >= kOveruseHoldTimeMs) {
+            return State::kOveruse;
+        }
+    }
+    else if (encode_usage_ < kLowUsage && queue_size <= 1) {
+        overuse_start_time_ms_ = -1;
+        if (underuse_start_time_ms_ < 0) {
+            underuse_start_time_ms_ = now_ms;
+        }
+        if (now_ms - underuse_start_time_ms_ >= kUnderuseHoldTimeMs) {
+            return State::kUnderuse;
+        }
+    }
+    else {
+        overuse_start_time_ms_ = -1;
+        underuse_start_time_ms_ = -1;
+    }
+
+    return State::kNormal;
+}
+
+void CpuOveruseDetector::Reset(int64_t now_ms) {
+    overuse_start_time_ms_ = -1;
+    underuse_start_time_ms_ = -1;
+    last_adapt_time_ms_ = now_ms;
+}
+
+} // namespace xrtc
@@ -0,0 +1,55 @@
+﻿#ifndef XRTCSDK_XRTC_MEDIA_FILTER_CPU_OVERUSE_DETECTOR_H_
+#define XRTCSDK_XRTC_MEDIA_FILTER_CPU_OVERUSE_DETECTOR_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace xrtc {
+
+// CPU降级的状态，level为0表示没有降级，依次降低x264 preset、分辨率、帧率
+struct CpuAdaptation {
+    int level = 0;
+    // x264 preset比配置的快几档
+    int preset_step = 0;
+    // 在码率决定的分辨率基础上再降低几级
+    int resolution_step = 0;
+    // 帧率降低的档位
+    int framerate_step = 0;
+    // 编码耗时占帧间隔的比例(%)
+    int encode_usage_percent = 0;
+    // 累计的过载和恢复次数
+    int overuse_count = 0;
+    int underuse_count = 0;
+};
+
+// 统计编码耗时和编码队列长度，判断编码线程是否跟不上采集
+class CpuOveruseDetector {
+public:
+    enum class State {
+        kNormal,
+        kOveruse,
+        kUnderuse,
+    };
+
+    CpuOveruseDetector();
+    ~CpuOveruseDetector();
+
+    // 每编码完一帧调用一次，frame_interval_ms为实际的输入帧间隔
+    State OnFrameEncoded(int64_t encode_time_ms, int64_t frame_interval_ms,
+        size_t queue_size, int64_t now_ms);
+    // 调整编码参数之后调用，重新开始统计
+    void Reset(int64_t now_ms);
+
+    int encode_usage_percent() const { return (int)(encode_usage_ * 100); }
+
+private:
+    double encode_usage_ = 0.0;
+    int64_t overuse_start_time_ms_ = -1;
+    int64_t underuse_start_time_ms_ = -1;
+    // 上一次调整的时间，调整之后需要等待一段时间才能再次调整
+    int64_t last_adapt_time_ms_ = -1;
+};
+
+} // namespace xrtc
+
+#endif // XRTCSDK_XRTC_MEDIA_FILTER_CPU_OVERUSE_DETECTOR_H_
@@ -0,0 +1,100 @@
+﻿#include "xrtc/media/filter/encoder_rate_controller.h"
+
+#include <algorithm>
+
+namespace xrtc {
+
+namespace {
+// 给RTP头部、重传和填充留出余量
+const double kEncoderTargetRatio = 0.85;
+// 码率变化小于该比例不重新配置
+const double kMinChangeRatio = 0.1;
+// 每次升码率最多增加的比例
+const double kMaxIncreaseRatio = 1.25;
+// 两次重新配置之间的最小间隔，降码率可以更频繁
+const int64_t kMinDecreaseIntervalMs = 200;
+const int64_t kMinIncreaseIntervalMs = 1000;
+// VBV最多使用pacer排队时间的1/4
+const int64_t kMinVbvWindowMs = 200;
+const int64_t kMaxVbvWindowMs = 1000;
+const int64_t kStatsWindowMs = 1000;
+} // namespace
+
+EncoderRateController::EncoderRateController(int64_t max_queue_time_ms) :
+    vbv_window_ms_(std::max(kMinVbvWindowMs,
+        std::min(max_queue_time_ms / 4, kMaxVbvWindowMs)))
+{
+}
+
+EncoderRateController::~EncoderRateController() {
+}
+
+bool EncoderRateController::OnTargetBitrate(int64_t target_bps, int64_t now_ms) {
+    int target_kbps = (int)(target_bps / 1000);
+    if (target_kbps <= 0) {
+        return false;
+    }
+
+    target_bitrate_kbps_ = target_kbps;
+    int desired_kbps = std::max(1, (int)(target_kbps * kEncoderTargetRatio));
+    int current_kbps = config_.bitrate_kbps;
+    if (0 == current_kbps) {
+        ApplyBitrate(desired_kbps, now_ms);
+        return true;
+    }
+
+    int64_t elapsed_ms = now_ms - last_reconfig_time_ms_;
+    if (desired_kbps < current_kbps) {
+        if (desired_kbps > current_kbps * (1 - kMinChangeRatio) ||
+            elapsed_ms < kMinDecreaseIntervalMs)
+        {
+            return false;
+        }
+        ApplyBitrate(desired_kbps, now_ms);
+        return true;
+    }
+
+    if (desired_kbps < current_kbps * (1 + kMinChangeRatio) ||
+        elapsed_ms < kMinIncreaseIntervalMs)
+    {
+        return false;
+    }
+    ApplyBitrate(std::min(desired_kbps, (int)(current_kbps * kMaxIncreaseRatio)), now_ms);
+    return true;
+}
+
+bool EncoderRateController::OnFrameEncoded(size_t frame_size, int64_t now_ms,
+    EncoderRateStats* stats)
+{
+    if (stats_start_time_ms_ < 0) {
+        stats_start_time_ms_ = now_ms;
+    }
+    stats_bytes_ += frame_size;
+
+    int64_t elapsed_ms = now_ms - stats_start_time_ms_;
+    if (elapsed_ms < kStatsWindowMs) {
+        return false;
+    }
+
+    stats->target_bitrate_kbps = target_bitrate_kbps_;
+    stats->encoder_bitrate_kbps = config_.bitrate_kbps;
+    // bit/ms即kbps
+    stats->achieved_bitrate_kbps = (int)(stats_bytes_ * 8 / elapsed_ms);
+    stats->reconfig_count = reconfig_count_;
+
+    stats_start_time_ms_ = now_ms;
+    stats_bytes_ = 0;
+    return true;
+}
+
+void EncoderRateController::ApplyBitrate(int bitrate_kbps, int64_t now_ms) {
+    config_.bitrate_kbps = bitrate_kbps;
+    // 实时通信不允许超过目标码率，缓冲区按照时间窗口计算，而不是和码率相同
+    config_.vbv_max_bitrate_kbps = bitrate_kbps;
+    config_.vbv_buffer_size_kbits = std::max(1,
+        (int)(bitrate_kbps * vbv_window_ms_ / 1000));
+    last_reconfig_time_ms_ = now_ms;
+    ++reconfig_count_;
+}
+
+} // namespace xrtc
@@ -0,0 +1,63 @@
+﻿#ifndef XRTCSDK_XRTC_MEDIA_FILTER_ENCODER_RATE_CONTROLLER_H_
+#define XRTCSDK_XRTC_MEDIA_FILTER_ENCODER_RATE_CONTROLLER_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace xrtc {
+
+// 配置给编码器的码率控制参数，单位和x264一致(kbps, kbit)
+struct EncoderRateConfig {
+    int bitrate_kbps = 0;
+    int vbv_max_bitrate_kbps = 0;
+    int vbv_buffer_size_kbits = 0;
+};
+
+// 编码码率的统计，每个统计周期回调一次
+// 通过XRTCEngineObserver::OnEncoderRateStats(const EncoderRateStats&)在api线程上报，
+// 该回调需要在公开头文件xrtc/xrtc.h的XRTCEngineObserver中声明
+struct EncoderRateStats {
+    // 拥塞控制给出的目标码率
+    int target_bitrate_kbps = 0;
+    // 实际配置给编码器的码率
+    int encoder_bitrate_kbps = 0;
+    // 编码器实际输出的码率
+    int achieved_bitrate_kbps = 0;
+    // 累计重新配置编码器的次数
+    int reconfig_count = 0;
+};
+
+// 把拥塞控制的目标码率(bps)转换成编码器的码率配置
+// 降码率要快，避免pacer队列堆积；升码率每次只升一部分，避免跟着带宽估计的尖峰来回震荡
+// VBV按照pacer队列允许的最大排队时间来设置，编码器的突发数据能够在该时间内发送出去
+class EncoderRateController {
+public:
+    explicit EncoderRateController(int64_t max_queue_time_ms);
+    ~EncoderRateController();
+
+    // 每编码一帧之前调用，返回true表示需要重新配置编码器
+    bool OnTargetBitrate(int64_t target_bps, int64_t now_ms);
+    // 返回true表示一个统计周期结束，stats有效
+    bool OnFrameEncoded(size_t frame_size, int64_t now_ms, EncoderRateStats* stats);
+
+    // 还没有目标码率时，编码器使用配置文件中的码率
+    bool has_config() const { return config_.bitrate_kbps > 0; }
+    const EncoderRateConfig& config() const { return config_; }
+
+private:
+    void ApplyBitrate(int bitrate_kbps, int64_t now_ms);
+
+private:
+    int64_t vbv_window_ms_;
+    EncoderRateConfig config_;
+    int target_bitrate_kbps_ = 0;
+    int64_t last_reconfig_time_ms_ = -1;
+    int reconfig_count_ = 0;
+    // 编码输出码率的统计
+    int64_t stats_start_time_ms_ = -1;
+    size_t stats_bytes_ = 0;
+};
+
+} // namespace xrtc
+
+#endif // XRTCSDK_XRTC_MEDIA_FILTER_ENCODER_RATE_CONTROLLER_H_
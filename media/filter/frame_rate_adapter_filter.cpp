@@ -0,0 +1,161 @@
+﻿#include "xrtc/media/filter/frame_rate_adapter_filter.h"
+
+#include <algorithm>
+
+#include <rtc_base/logging.h>
+#include <rtc_base/time_utils.h>
+
+#include "xrtc/base/xrtc_json.h"
+#include "xrtc/media/base/in_pin.h"
+#include "xrtc/media/base/out_pin.h"
+
+namespace xrtc {
+
+namespace {
+// 每个像素每帧最少需要的比特数，低于该值时降低帧率
+const double kMinBitsPerPixel = 0.05;
+// 编码耗时最多占用帧间隔的比例，超过时降低帧率
+const double kMaxEncodeUsage = 0.8;
+// 目标帧率接近输入帧率时不丢帧
+const double kPassThroughRatio = 0.95;
+// 平滑系数
+const double kInputFpsAlpha = 0.1;
+const int64_t kEncodeTimeAlpha = 10;
+// CPU降级时，每一档相对于输入帧率的比例
+const double kCpuFramerateFactors[] = { 1.0, 2.0 / 3.0, 0.5 };
+} // namespace
+
+FrameRateAdapterFilter::FrameRateAdapterFilter() :
+    MediaObject(MediaObjectId::kMidFrameRateAdapterFilterId),
+    in_pin_(std::make_unique<InPin>(this)),
+    out_pin_(std::make_unique<OutPin>(this))
+{
+    MediaFormat fmt;
+    fmt.media_type = MainMediaType::kMainTypeVideo;
+    fmt.sub_fmt.video_fmt.type = SubMediaType::kSubTypeI420;
+    in_pin_->set_format(fmt);
+    out_pin_->set_format(fmt);
+}
+
+FrameRateAdapterFilter::~FrameRateAdapterFilter() {
+}
+
+bool FrameRateAdapterFilter::Start() {
+    RTC_LOG(LS_INFO) << "FrameRateAdapterFilter Start, enable: " << enable_
+        << ", min_fps: " << min_fps_;
+    return true;
+}
+
+void FrameRateAdapterFilter::Setup(const std::string& json_config) {
+    JsonValue value;
+    value.FromJson(json_config);
+    JsonObject jobj = value.ToObject();
+    if (jobj.Has("frame_rate_adapter_filter")) {
+        JsonObject jadapter = jobj["frame_rate_adapter_filter"].ToObject();
+        enable_ = jadapter["enable"].ToBool(enable_);
+        min_fps_ = std::max(1, (int)jadapter["min_fps"].ToInt(min_fps_));
+    }
+}
+
+void FrameRateAdapterFilter::Stop() {
+    RTC_LOG(LS_INFO) << "FrameRateAdapterFilter Stop, dropped frames: " << dropped_frames_;
+}
+
+void FrameRateAdapterFilter::SetTargetBitrate(webrtc::DataRate bitrate) {
+    if (!bitrate.IsZero()) {
+        target_bitrate_bps_ = bitrate.bps();
+    }
+}
+
+void FrameRateAdapterFilter::OnFrameEncoded(X264EncoderFilter*,
+    int64_t encode_time_ms)
+{
+    int64_t encode_time_us = encode_time_ms * rtc::kNumMicrosecsPerMillisec;
+    int64_t avg = avg_encode_time_us_;
+    if (0 == avg) {
+        avg_encode_time_us_ = encode_time_us;
+    }
+    else {
+        avg_encode_time_us_ = avg + (encode_time_us - avg) / kEncodeTimeAlpha;
+    }
+}
+
+void FrameRateAdapterFilter::OnCpuAdaptation(X264EncoderFilter*,
+    const CpuAdaptation& adaptation)
+{
+    cpu_framerate_step_ = std::min(adaptation.framerate_step,
+        (int)(sizeof(kCpuFramerateFactors) / sizeof(kCpuFramerateFactors[0])) - 1);
+}
+
+void FrameRateAdapterFilter::SetCpuAdaptationEnabled(bool enabled) {
+    cpu_adaptation_enabled_ = enabled;
+}
+
+double FrameRateAdapterFilter::TargetFps(int pixels) const {
+    double fps = input_fps_ * kCpuFramerateFactors[cpu_framerate_step_];
+
+    // 码率限制的帧率
+    int64_t target_bps = target_bitrate_bps_;
+    if (target_bps > 0 && pixels > 0) {
+        fps = std::min(fps, target_bps / (pixels * kMinBitsPerPixel));
+    }
+
+    // CPU限制的帧率，开启CPU降级时由降级档位决定
+    int64_t encode_time_us = avg_encode_time_us_;
+    if (!cpu_adaptation_enabled_ && encode_time_us > 0) {
+        fps = std::min(fps, kMaxEncodeUsage * rtc::kNumMicrosecsPerSec / encode_time_us);
+    }
+
+    return std::max(fps, (double)min_fps_);
+}
+
+void FrameRateAdapterFilter::OnNewMediaFrame(std::shared_ptr<MediaFrame> frame) {
+    if (!out_pin_) {
+        return;
+    }
+
+    if (!enable_) {
+        out_pin_->PushMediaFrame(frame);
+        return;
+    }
+
+    int64_t now_ms = frame->capture_time_ms > 0 ? frame->capture_time_ms :
+        rtc::TimeMillis();
+
+    // 统计输入帧率
+    if (last_input_time_ms_ >= 0 && now_ms > last_input_time_ms_) {
+        double fps = 1000.0 / (now_ms - last_input_time_ms_);
+        input_fps_ = input_fps_ <= 0.0 ? fps :
+            input_fps_ + kInputFpsAlpha * (fps - input_fps_);
+    }
+    last_input_time_ms_ = now_ms;
+
+    int pixels = frame->fmt.sub_fmt.video_fmt.width *
+        frame->fmt.sub_fmt.video_fmt.height;
+    double target_fps = TargetFps(pixels);
+    if (input_fps_ <= 0.0 || target_fps >= input_fps_ * kPassThroughRatio) {
+        next_output_time_ms_ = -1.0;
+        out_pin_->PushMediaFrame(frame);
+        return;
+    }
+
+    // 按照目标帧率计算下一帧的输出时间，允许半个输入帧间隔的误差，
+    // 这样保留下来的帧间隔是均匀的
+    double output_interval_ms = 1000.0 / target_fps;
+    double tolerance_ms = 500.0 / input_fps_;
+    if (next_output_time_ms_ >= 0 && now_ms < next_output_time_ms_ - tolerance_ms) {
+        ++dropped_frames_;
+        return;
+    }
+
+    if (next_output_time_ms_ < 0 || now_ms - next_output_time_ms_ > output_interval_ms) {
+        next_output_time_ms_ = now_ms + output_interval_ms;
+    }
+    else {
+        next_output_time_ms_ += output_interval_ms;
+    }
+
+    out_pin_->PushMediaFrame(frame);
+}
+
+} // namespace xrtc
@@ -0,0 +1,72 @@
+﻿#ifndef XRTCSDK_XRTC_MEDIA_FILTER_FRAME_RATE_ADAPTER_FILTER_H_
+#define XRTCSDK_XRTC_MEDIA_FILTER_FRAME_RATE_ADAPTER_FILTER_H_
+
+#include <atomic>
+
+#include <api/units/data_rate.h>
+#include <rtc_base/third_party/sigslot/sigslot.h>
+
+#include "xrtc/media/base/media_chain.h"
+#include "xrtc/media/filter/cpu_overuse_detector.h"
+
+namespace xrtc {
+
+class X264EncoderFilter;
+
+// 根据目标码率和编码耗时均匀地丢帧，拥塞或者CPU不足时先降低帧率，
+// 避免画质下降或者编码队列堆积。保留下来的帧时间戳不变
+// 配置示例：{"frame_rate_adapter_filter": {"enable": true, "min_fps": 5}}
+class FrameRateAdapterFilter : public MediaObject,
+                               public sigslot::has_slots<>
+{
+public:
+    FrameRateAdapterFilter();
+    ~FrameRateAdapterFilter() override;
+
+    // MediaObject
+    bool Start() override;
+    void Setup(const std::string& json_config) override;
+    void Stop() override;
+    void OnNewMediaFrame(std::shared_ptr<MediaFrame>) override;
+    std::vector<InPin*> GetAllInPins() override {
+        return std::vector<InPin*>({ in_pin_.get() });
+    }
+    std::vector<OutPin*> GetAllOutPins() override {
+        return std::vector<OutPin*>({ out_pin_.get() });
+    }
+
+    // 可以在任意线程调用
+    void SetTargetBitrate(webrtc::DataRate bitrate);
+    // 连接X264EncoderFilter::SignalFrameEncoded
+    void OnFrameEncoded(X264EncoderFilter*, int64_t encode_time_ms);
+    // 连接X264EncoderFilter::SignalCpuAdaptation
+    void OnCpuAdaptation(X264EncoderFilter*, const CpuAdaptation& adaptation);
+    // 编码器开启CPU降级时，CPU不足由降级档位处理，不再按照编码耗时限制帧率，
+    // 否则编码耗时始终被限制在过载阈值以下，降低preset的档位很难触发
+    void SetCpuAdaptationEnabled(bool enabled);
+
+private:
+    double TargetFps(int pixels) const;
+
+private:
+    std::unique_ptr<InPin> in_pin_;
+    std::unique_ptr<OutPin> out_pin_;
+    bool enable_ = true;
+    int min_fps_ = 5;
+    std::atomic<int64_t> target_bitrate_bps_{ 0 };
+    // 平均编码耗时(us)，编码线程写入
+    std::atomic<int64_t> avg_encode_time_us_{ 0 };
+    std::atomic<int> cpu_framerate_step_{ 0 };
+    std::atomic<bool> cpu_adaptation_enabled_{ false };
+
+    // 输入帧率的平滑值
+    double input_fps_ = 0.0;
+    int64_t last_input_time_ms_ = -1;
+    // 下一个允许输出的帧的时间
+    double next_output_time_ms_ = -1.0;
+    int64_t dropped_frames_ = 0;
+};
+
+} // namespace xrtc
+
+#endif // XRTCSDK_XRTC_MEDIA_FILTER_FRAME_RATE_ADAPTER_FILTER_H_
@@ -0,0 +1,379 @@
+﻿#include "xrtc/media/filter/h264_decoder_filter.h"
+
+#include <string.h>
+
+#include <rtc_base/logging.h>
+#include <rtc_base/thread.h>
+
+#include "xrtc/base/xrtc_json.h"
+#include "xrtc/media/base/in_pin.h"
+#include "xrtc/media/base/out_pin.h"
+
+namespace xrtc {
+
+namespace {
+
+// 平面的起始地址和行宽按64字节对齐，满足FFmpeg的SIMD要求
+const int kBufferAlign = 64;
+// 解码器会读取超出图像的少量数据
+const int kBufferPadding = 16 + kBufferAlign;
+// 缓存池的上限，包括解码器的参考帧和下游还没有处理完的图像
+const size_t kMaxBufferPoolSize = 48;
+
+int Align(int value, int align) {
+    return (value + align - 1) & ~(align - 1);
+}
+
+uint8_t* AlignPtr(char* ptr) {
+    return (uint8_t*)(((uintptr_t)ptr + kBufferAlign - 1) & ~(uintptr_t)(kBufferAlign - 1));
+}
+
+} // namespace
+
+H264DecoderFilter::H264DecoderFilter() :
+    MediaObject(MediaObjectId::kMidH264DecoderFilterId),
+    in_pin_(std::make_unique<InPin>(this)),
+    out_pin_(std::make_unique<OutPin>(this))
+{
+    MediaFormat fmt_in;
+    fmt_in.media_type = MainMediaType::kMainTypeVideo;
+    fmt_in.sub_fmt.video_fmt.type = SubMediaType::kSubTypeH264;
+    in_pin_->set_format(fmt_in);
+
+    MediaFormat fmt_out;
+    fmt_out.media_type = MainMediaType::kMainTypeVideo;
+    fmt_out.sub_fmt.video_fmt.type = SubMediaType::kSubTypeI420;
+    out_pin_->set_format(fmt_out);
+}
+
+H264DecoderFilter::~H264DecoderFilter() {
+}
+
+bool H264DecoderFilter::Start() {
+    RTC_LOG(LS_INFO) << "H264DecoderFilter Start";
+
+    if (running_) {
+        RTC_LOG(LS_WARNING) << "H264DecoderFilter already running";
+        return true;
+    }
+
+    running_ = true;
+
+    decode_thread_ = new std::thread([=]() {
+        rtc::SetCurrentThreadName("h264_decode_thread");
+        RTC_LOG(LS_INFO) << "H264DecoderFilter decode thread running";
+
+        if (!InitDecoder()) {
+            RTC_LOG(LS_WARNING) << "h264 decoder init failed";
+            ReleaseDecoder();
+            return;
+        }
+
+        while (running_) {
+            std::shared_ptr<MediaFrame> frame;
+
+            {
+                std::unique_lock<std::mutex> auto_lock(frame_queue_mtx_);
+                if (!frame_queue_.empty()) {
+                    frame = frame_queue_.front();
+                    frame_queue_.pop();
+                }
+
+                if (!frame) {
+                    cond_var_.wait(auto_lock);
+                    continue;
+                }
+            }
+
+            if (!Decode(frame)) {
+                // 解码出错之后的帧参考关系不可信，从下一个关键帧重新开始
+                {
+                    std::unique_lock<std::mutex> auto_lock(frame_queue_mtx_);
+                    wait_keyframe_ = true;
+                }
+                SignalKeyFrameRequest(this);
+            }
+        }
+
+        ReleaseDecoder();
+    });
+
+    return true;
+}
+
+void H264DecoderFilter::Setup(const std::string& json_config) {
+    JsonValue value;
+    value.FromJson(json_config);
+    JsonObject jobj = value.ToObject();
+    if (jobj.Has("h264_decoder_filter")) {
+        JsonObject jh264_decoder_filter = jobj["h264_decoder_filter"].ToObject();
+        max_queue_size_ = (size_t)jh264_decoder_filter["max_queue_size"].ToInt(
+            max_queue_size_);
+        decode_threads_ = (int)jh264_decoder_filter["threads"].ToInt(decode_threads_);
+    }
+}
+
+void H264DecoderFilter::Stop() {
+    RTC_LOG(LS_INFO) << "H264DecoderFilter Stop";
+
+    if (!running_) {
+        return;
+    }
+
+    running_ = false;
+    cond_var_.notify_all();
+
+    if (decode_thread_ && decode_thread_->joinable()) {
+        decode_thread_->join();
+        RTC_LOG(LS_INFO) << "H264DecoderFilter decode_thread join success";
+        delete decode_thread_;
+        decode_thread_ = nullptr;
+    }
+
+    std::unique_lock<std::mutex> auto_lock(frame_queue_mtx_);
+    while (!frame_queue_.empty()) {
+        frame_queue_.pop();
+    }
+    wait_keyframe_ = true;
+}
+
+void H264DecoderFilter::OnNewMediaFrame(std::shared_ptr<MediaFrame> frame) {
+    bool idr = frame->fmt.sub_fmt.video_fmt.idr;
+
+    {
+        std::unique_lock<std::mutex> auto_lock(frame_queue_mtx_);
+        // 解码跟不上时丢弃整个队列，只丢一部分的话后面的帧缺少参考帧
+        if (frame_queue_.size() >= max_queue_size_) {
+            RTC_LOG(LS_WARNING) << "H264DecoderFilter queue overflow, drop "
+                << frame_queue_.size() << " frames";
+            while (!frame_queue_.empty()) {
+                frame_queue_.pop();
+            }
+            wait_keyframe_ = true;
+        }
+
+        if (!wait_keyframe_ || idr) {
+            wait_keyframe_ = false;
+            frame_queue_.push(frame);
+            cond_var_.notify_one();
+            return;
+        }
+    }
+
+    // 在锁外触发，避免和接收端的锁嵌套
+    SignalKeyFrameRequest(this);
+}
+
+bool H264DecoderFilter::InitDecoder() {
+    const AVCodec* codec = avcodec_find_decoder(AV_CODEC_ID_H264);
+    if (!codec) {
+        RTC_LOG(LS_WARNING) << "h264 decoder not found";
+        return false;
+    }
+
+    codec_ctx_ = avcodec_alloc_context3(codec);
+    if (!codec_ctx_) {
+        return false;
+    }
+
+    codec_ctx_->opaque = this;
+    codec_ctx_->get_buffer2 = &H264DecoderFilter::GetBuffer;
+    codec_ctx_->flags |= AV_CODEC_FLAG_LOW_DELAY;
+    // 帧级多线程会增加若干帧的延迟，只使用slice级多线程
+    codec_ctx_->thread_count = decode_threads_;
+    codec_ctx_->thread_type = FF_THREAD_SLICE;
+
+    int ret = avcodec_open2(codec_ctx_, codec, nullptr);
+    if (ret < 0) {
+        RTC_LOG(LS_WARNING) << "avcodec_open2 failed: " << ret;
+        return false;
+    }
+
+    av_packet_ = av_packet_alloc();
+    av_frame_ = av_frame_alloc();
+    if (!av_packet_ || !av_frame_) {
+        return false;
+    }
+
+    return true;
+}
+
+void H264DecoderFilter::ReleaseDecoder() {
+    // 释放解码器时会释放所有的参考帧，之后缓存池中的图像都可以复用
+    if (codec_ctx_) {
+        avcodec_free_context(&codec_ctx_);
+    }
+
+    if (av_packet_) {
+        av_packet_free(&av_packet_);
+    }
+
+    if (av_frame_) {
+        av_frame_free(&av_frame_);
+    }
+}
+
+bool H264DecoderFilter::Decode(std::shared_ptr<MediaFrame> frame) {
+    size_t size = frame->data_len[0];
+    if (packet_buffer_.size() < size + AV_INPUT_BUFFER_PADDING_SIZE) {
+        packet_buffer_.resize(size + AV_INPUT_BUFFER_PADDING_SIZE);
+    }
+    memcpy(packet_buffer_.data(), frame->data[0], size);
+    memset(packet_buffer_.data() + size, 0, AV_INPUT_BUFFER_PADDING_SIZE);
+
+    av_packet_->data = packet_buffer_.data();
+    av_packet_->size = (int)size;
+    av_packet_->pts = frame->ts;
+
+    PendingFrame& pending = pending_frames_[pending_index_];
+    pending.ts = frame->ts;
+    pending.capture_time_ms = frame->capture_time_ms;
+    pending_index_ = (pending_index_ + 1) % (sizeof(pending_frames_) / sizeof(pending_frames_[0]));
+
+    int ret = avcodec_send_packet(codec_ctx_, av_packet_);
+    if (ret < 0) {
+        RTC_LOG(LS_WARNING) << "avcodec_send_packet failed: " << ret
+            << ", ts: " << frame->ts;
+        return false;
+    }
+
+    while (true) {
+        ret = avcodec_receive_frame(codec_ctx_, av_frame_);
+        if (AVERROR(EAGAIN) == ret || AVERROR_EOF == ret) {
+            break;
+        }
+
+        if (ret < 0) {
+            RTC_LOG(LS_WARNING) << "avcodec_receive_frame failed: " << ret;
+            return false;
+        }
+
+        std::shared_ptr<MediaFrame> out_frame = OutputFrame();
+        // 释放输出的引用，解码器仍然可能作为参考帧引用该图像
+        av_frame_unref(av_frame_);
+
+        if (out_frame && out_pin_) {
+            out_pin_->PushMediaFrame(out_frame);
+        }
+    }
+
+    return true;
+}
+
+std::shared_ptr<MediaFrame> H264DecoderFilter::OutputFrame() {
+    if (av_frame_->format != AV_PIX_FMT_YUV420P &&
+        av_frame_->format != AV_PIX_FMT_YUVJ420P)
+    {
+        RTC_LOG(LS_WARNING) << "unsupported pixel format: " << av_frame_->format;
+        return nullptr;
+    }
+
+    FrameBuffer* buffer = (FrameBuffer*)av_buffer_get_opaque(av_frame_->buf[0]);
+    std::shared_ptr<MediaFrame> out_frame = buffer->frame;
+
+    int width = av_frame_->width;
+    int height = av_frame_->height;
+    out_frame->fmt.media_type = MainMediaType::kMainTypeVideo;
+    out_frame->fmt.sub_fmt.video_fmt.type = SubMediaType::kSubTypeI420;
+    out_frame->fmt.sub_fmt.video_fmt.width = width;
+    out_frame->fmt.sub_fmt.video_fmt.height = height;
+    out_frame->fmt.sub_fmt.video_fmt.idr = av_frame_->key_frame != 0;
+
+    // 裁剪之后平面的地址不一定在缓存的起始位置，直接使用解码器给出的地址
+    for (int i = 0; i < 3; ++i) {
+        int plane_height = (0 == i) ? height : (height + 1) / 2;
+        out_frame->data[i] = (char*)av_frame_->data[i];
+        out_frame->stride[i] = av_frame_->linesize[i];
+        out_frame->data_len[i] = av_frame_->linesize[i] * plane_height;
+    }
+
+    out_frame->ts = (uint32_t)av_frame_->pts;
+    out_frame->capture_time_ms = 0;
+    for (const auto& pending : pending_frames_) {
+        if (pending.ts == out_frame->ts) {
+            out_frame->capture_time_ms = pending.capture_time_ms;
+            break;
+        }
+    }
+    memset(out_frame->stage_time_ms, 0, sizeof(out_frame->stage_time_ms));
+
+    return out_frame;
+}
+
+H264DecoderFilter::FrameBuffer* H264DecoderFilter::AcquireBuffer(int size) {
+    // 引用计数为1表示下游已经处理完，只有解码线程会增加引用，不会和下游冲突
+    for (auto& buffer : buffer_pool_) {
+        if (!buffer->decoder_ref && 1 == buffer->frame.use_count()) {
+            // 分辨率变大时重新分配，之后保持不变
+            if (buffer->frame->max_size < size) {
+                buffer->frame = std::make_shared<MediaFrame>(size);
+            }
+            return buffer.get();
+        }
+    }
+
+    if (buffer_pool_.size() >= kMaxBufferPoolSize) {
+        return nullptr;
+    }
+
+    auto buffer = std::make_unique<FrameBuffer>();
+    buffer->frame = std::make_shared<MediaFrame>(size);
+    buffer_pool_.push_back(std::move(buffer));
+    return buffer_pool_.back().get();
+}
+
+int H264DecoderFilter::GetBuffer(AVCodecContext* codec_ctx, AVFrame* av_frame,
+    int flags)
+{
+    if (av_frame->format != AV_PIX_FMT_YUV420P &&
+        av_frame->format != AV_PIX_FMT_YUVJ420P)
+    {
+        return avcodec_default_get_buffer2(codec_ctx, av_frame, flags);
+    }
+
+    H264DecoderFilter* filter = (H264DecoderFilter*)codec_ctx->opaque;
+
+    // 按照解码器的要求扩展宽高，例如对齐到宏块
+    int width = av_frame->width;
+    int height = av_frame->height;
+    int linesize_align[AV_NUM_DATA_POINTERS];
+    avcodec_align_dimensions2(codec_ctx, &width, &height, linesize_align);
+
+    int y_stride = Align(width, kBufferAlign);
+    int uv_stride = Align((width + 1) / 2, kBufferAlign);
+    int y_size = y_stride * height;
+    int uv_size = uv_stride * ((height + 1) / 2);
+    int size = y_size + 2 * uv_size + kBufferPadding;
+
+    FrameBuffer* buffer = filter->AcquireBuffer(size + kBufferAlign);
+    if (!buffer) {
+        RTC_LOG(LS_WARNING) << "H264DecoderFilter buffer pool exhausted";
+        return AVERROR(ENOMEM);
+    }
+
+    uint8_t* data = AlignPtr(buffer->frame->buffer());
+    av_frame->buf[0] = av_buffer_create(data, size,
+        &H264DecoderFilter::ReleaseBuffer, buffer, 0);
+    if (!av_frame->buf[0]) {
+        return AVERROR(ENOMEM);
+    }
+    buffer->decoder_ref = true;
+
+    av_frame->data[0] = data;
+    av_frame->data[1] = data + y_size;
+    av_frame->data[2] = data + y_size + uv_size;
+    av_frame->linesize[0] = y_stride;
+    av_frame->linesize[1] = uv_stride;
+    av_frame->linesize[2] = uv_stride;
+    av_frame->extended_data = av_frame->data;
+
+    return 0;
+}
+
+void H264DecoderFilter::ReleaseBuffer(void* opaque, uint8_t* /*data*/) {
+    // 解码器和输出的所有引用都释放了，在解码线程中回调
+    FrameBuffer* buffer = (FrameBuffer*)opaque;
+    buffer->decoder_ref = false;
+}
+
+} // namespace xrtc
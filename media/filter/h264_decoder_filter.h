@@ -0,0 +1,93 @@
+﻿#ifndef XRTCSDK_XRTC_MEDIA_FILTER_H264_DECODER_FILTER_H_
+#define XRTCSDK_XRTC_MEDIA_FILTER_H264_DECODER_FILTER_H_
+
+#include <queue>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+
+#include <rtc_base/third_party/sigslot/sigslot.h>
+
+#include "xrtc/media/base/media_chain.h"
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+namespace xrtc {
+
+// 使用FFmpeg将接收到的H264帧解码为I420图像
+// 解码在独立的线程中进行，输入队列有上限，队列满时清空队列，从下一个关键帧重新开始解码
+// 等待关键帧期间丢弃的每一帧都会触发SignalKeyFrameRequest，由接收端限制请求的频率
+// 解码器通过get_buffer2直接解码到缓存池的MediaFrame中，稳定之后解码不再分配图像内存
+// 配置示例：{"h264_decoder_filter": {"max_queue_size": 30, "threads": 1}}
+class H264DecoderFilter : public MediaObject {
+public:
+    H264DecoderFilter();
+    ~H264DecoderFilter() override;
+
+    // MediaObject
+    bool Start() override;
+    void Setup(const std::string& json_config) override;
+    void Stop() override;
+    void OnNewMediaFrame(std::shared_ptr<MediaFrame>) override;
+    std::vector<InPin*> GetAllInPins() override {
+        return std::vector<InPin*>({ in_pin_.get() });
+    }
+    std::vector<OutPin*> GetAllOutPins() override {
+        return std::vector<OutPin*>({ out_pin_.get() });
+    }
+
+    // 需要关键帧才能继续解码，在解码线程或者输入帧的线程中触发
+    sigslot::signal1<H264DecoderFilter*> SignalKeyFrameRequest;
+
+private:
+    // 缓存池中的一个图像，解码器可能把它作为参考帧继续引用
+    // 只有缓存池持有frame，并且解码器不再引用时才可以复用
+    struct FrameBuffer {
+        std::shared_ptr<MediaFrame> frame;
+        std::atomic<bool> decoder_ref{ false };
+    };
+
+    // 解码器输入帧的时间信息，按照ts和输出的图像对应
+    struct PendingFrame {
+        uint32_t ts = 0;
+        int64_t capture_time_ms = 0;
+    };
+
+    static int GetBuffer(AVCodecContext* codec_ctx, AVFrame* av_frame, int flags);
+    static void ReleaseBuffer(void* opaque, uint8_t* data);
+
+    bool InitDecoder();
+    void ReleaseDecoder();
+    bool Decode(std::shared_ptr<MediaFrame> frame);
+    FrameBuffer* AcquireBuffer(int size);
+    std::shared_ptr<MediaFrame> OutputFrame();
+
+private:
+    std::unique_ptr<InPin> in_pin_;
+    std::unique_ptr<OutPin> out_pin_;
+    std::queue<std::shared_ptr<MediaFrame>> frame_queue_;
+    std::mutex frame_queue_mtx_;
+    std::atomic<bool> running_{ false };
+    std::thread* decode_thread_ = nullptr;
+    std::condition_variable cond_var_;
+    size_t max_queue_size_ = 30;
+    // 队列溢出或者解码出错之后丢弃非关键帧，由frame_queue_mtx_保护
+    bool wait_keyframe_ = true;
+
+    int decode_threads_ = 1;
+    AVCodecContext* codec_ctx_ = nullptr;
+    AVPacket* av_packet_ = nullptr;
+    AVFrame* av_frame_ = nullptr;
+    // 复用的输入缓存，FFmpeg要求数据后面有AV_INPUT_BUFFER_PADDING_SIZE字节的填充
+    std::vector<uint8_t> packet_buffer_;
+    std::vector<std::unique_ptr<FrameBuffer>> buffer_pool_;
+    PendingFrame pending_frames_[16];
+    size_t pending_index_ = 0;
+};
+
+} // namespace xrtc
+
+#endif // XRTCSDK_XRTC_MEDIA_FILTER_H264_DECODER_FILTER_H_
@@ -0,0 +1,235 @@
+﻿#include "xrtc/media/filter/video_scaler_filter.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include <libyuv.h>
+#include <rtc_base/logging.h>
+#include <rtc_base/time_utils.h>
+
+#include "xrtc/base/xrtc_json.h"
+#include "xrtc/media/base/in_pin.h"
+#include "xrtc/media/base/out_pin.h"
+
+namespace xrtc {
+
+namespace {
+
+struct ScaleFactor {
+    int num;
+    int den;
+};
+
+// 分辨率的级别，相对于采集分辨率的缩放比例
+const ScaleFactor kScaleFactors[] = {
+    { 1, 1 },
+    { 3, 4 },
+    { 1, 2 },
+    { 3, 8 },
+    { 1, 4 },
+};
+const size_t kNumScaleLevels = sizeof(kScaleFactors) / sizeof(kScaleFactors[0]);
+
+// 不同像素数需要的最低码率(kbps)，低于该码率时降低分辨率
+struct ResolutionBitrate {
+    int pixels;
+    int min_kbps;
+};
+
+const ResolutionBitrate kResolutionBitrates[] = {
+    { 320 * 180, 0 },
+    { 480 * 270, 200 },
+    { 640 * 360, 300 },
+    { 960 * 540, 500 },
+    { 1280 * 720, 900 },
+    { 1920 * 1080, 1800 },
+};
+
+// 升级分辨率时，码率需要超过阈值的比例和持续时间
+const double kUpgradeFactor = 1.3;
+const int64_t kUpgradeHoldTimeMs = 3000;
+
+int MinBitrateKbps(int pixels) {
+    for (const auto& item : kResolutionBitrates) {
+        if (pixels <= item.pixels) {
+            return item.min_kbps;
+        }
+    }
+    return kResolutionBitrates[sizeof(kResolutionBitrates) /
+        sizeof(kResolutionBitrates[0]) - 1].min_kbps;
+}
+
+// 缩放后的宽高保持偶数，I420的色度平面是亮度的一半
+int ScaledSize(int size, size_t level) {
+    return (size * kScaleFactors[level].num / kScaleFactors[level].den) & ~1;
+}
+
+} // namespace
+
+VideoScalerFilter::VideoScalerFilter() :
+    MediaObject(MediaObjectId::kMidVideoScalerFilterId),
+    in_pin_(std::make_unique<InPin>(this)),
+    out_pin_(std::make_unique<OutPin>(this))
+{
+    MediaFormat fmt;
+    fmt.media_type = MainMediaType::kMainTypeVideo;
+    fmt.sub_fmt.video_fmt.type = SubMediaType::kSubTypeI420;
+    in_pin_->set_format(fmt);
+    out_pin_->set_format(fmt);
+}
+
+VideoScalerFilter::~VideoScalerFilter() {
+}
+
+bool VideoScalerFilter::Start() {
+    RTC_LOG(LS_INFO) << "VideoScalerFilter Start, enable: " << enable_;
+    return true;
+}
+
+void VideoScalerFilter::Setup(const std::string& json_config) {
+    JsonValue value;
+    value.FromJson(json_config);
+    JsonObject jobj = value.ToObject();
+    if (jobj.Has("video_scaler_filter")) {
+        JsonObject jvideo_scaler_filter = jobj["video_scaler_filter"].ToObject();
+        enable_ = jvideo_scaler_filter["enable"].ToBool(enable_);
+    }
+}
+
+void VideoScalerFilter::Stop() {
+    RTC_LOG(LS_INFO) << "VideoScalerFilter Stop";
+}
+
+void VideoScalerFilter::SetTargetBitrate(webrtc::DataRate bitrate) {
+    if (!bitrate.IsZero()) {
+        target_bitrate_bps_ = bitrate.bps();
+    }
+}
+
+void VideoScalerFilter::OnCpuAdaptation(X264EncoderFilter*,
+    const CpuAdaptation& adaptation)
+{
+    cpu_resolution_step_ = adaptation.resolution_step;
+}
+
+void VideoScalerFilter::OnNewMediaFrame(std::shared_ptr<MediaFrame> frame) {
+    if (!out_pin_) {
+        return;
+    }
+
+    int width = frame->fmt.sub_fmt.video_fmt.width;
+    int height = frame->fmt.sub_fmt.video_fmt.height;
+    if (fixed_scale_down_by_ > 1) {
+        std::shared_ptr<MediaFrame> scaled_frame = ScaleFrame(frame,
+            (width / fixed_scale_down_by_) & ~1, (height / fixed_scale_down_by_) & ~1);
+        if (scaled_frame) {
+            out_pin_->PushMediaFrame(scaled_frame);
+        }
+        return;
+    }
+
+    if (enable_) {
+        UpdateScaleLevel(width, height, rtc::TimeMillis());
+    }
+
+    // CPU过载时在码率决定的级别上继续降低
+    size_t level = std::min(scale_level_ + cpu_resolution_step_, kNumScaleLevels - 1);
+
+    // 不需要缩放时直接转发，不做拷贝
+    if (0 == level) {
+        out_pin_->PushMediaFrame(frame);
+        return;
+    }
+
+    std::shared_ptr<MediaFrame> scaled_frame = ScaleFrame(frame,
+        ScaledSize(width, level), ScaledSize(height, level));
+    if (scaled_frame) {
+        out_pin_->PushMediaFrame(scaled_frame);
+    }
+}
+
+void VideoScalerFilter::UpdateScaleLevel(int width, int height, int64_t now_ms) {
+    int64_t target_kbps = target_bitrate_bps_ / 1000;
+    // 还没有码率估计，保持采集分辨率
+    if (0 == target_kbps) {
+        return;
+    }
+
+    size_t level = scale_level_;
+    // 码率不足时立即降级，可以一次降多级
+    while (level + 1 < kNumScaleLevels && target_kbps <
+        MinBitrateKbps(ScaledSize(width, level) * ScaledSize(height, level)))
+    {
+        ++level;
+    }
+
+    // 码率持续超过上一级的阈值才升级，每次只升一级
+    if (level == scale_level_ && level > 0) {
+        int upper_kbps = MinBitrateKbps(ScaledSize(width, level - 1) *
+            ScaledSize(height, level - 1));
+        if (target_kbps > upper_kbps * kUpgradeFactor) {
+            if (upgrade_start_time_ms_ < 0) {
+                upgrade_start_time_ms_ = now_ms;
+            }
+            else if (now_ms - upgrade_start_time_ms_ >= kUpgradeHoldTimeMs) {
+                --level;
+            }
+        }
+        else {
+            upgrade_start_time_ms_ = -1;
+        }
+    }
+
+    if (level != scale_level_) {
+        RTC_LOG(LS_INFO) << "VideoScalerFilter scale level changed: " << scale_level_
+            << " -> " << level << ", target_kbps: " << target_kbps
+            << ", size: " << ScaledSize(width, level) << "x" << ScaledSize(height, level);
+        scale_level_ = level;
+        upgrade_start_time_ms_ = -1;
+    }
+}
+
+std::shared_ptr<MediaFrame> VideoScalerFilter::ScaleFrame(
+    std::shared_ptr<MediaFrame> frame, int dst_width, int dst_height)
+{
+    int chroma_width = dst_width / 2;
+    int chroma_height = dst_height / 2;
+    int frame_size = dst_width * dst_height + 2 * chroma_width * chroma_height;
+
+    std::shared_ptr<MediaFrame> scaled_frame = std::make_shared<MediaFrame>(frame_size);
+    scaled_frame->fmt = frame->fmt;
+    scaled_frame->fmt.sub_fmt.video_fmt.width = dst_width;
+    scaled_frame->fmt.sub_fmt.video_fmt.height = dst_height;
+    scaled_frame->stride[0] = dst_width;
+    scaled_frame->stride[1] = chroma_width;
+    scaled_frame->stride[2] = chroma_width;
+    scaled_frame->data_len[0] = dst_width * dst_height;
+    scaled_frame->data_len[1] = chroma_width * chroma_height;
+    scaled_frame->data_len[2] = chroma_width * chroma_height;
+    scaled_frame->data[1] = scaled_frame->data[0] + scaled_frame->data_len[0];
+    scaled_frame->data[2] = scaled_frame->data[1] + scaled_frame->data_len[1];
+    scaled_frame->ts = frame->ts;
+    scaled_frame->capture_time_ms = frame->capture_time_ms;
+    memcpy(scaled_frame->stage_time_ms, frame->stage_time_ms,
+        sizeof(scaled_frame->stage_time_ms));
+
+    // libyuv内部会根据CPU选择SIMD实现，box滤波在下采样时质量较好
+    int res = libyuv::I420Scale(
+        (const uint8_t*)frame->data[0], frame->stride[0],
+        (const uint8_t*)frame->data[1], frame->stride[1],
+        (const uint8_t*)frame->data[2], frame->stride[2],
+        frame->fmt.sub_fmt.video_fmt.width, frame->fmt.sub_fmt.video_fmt.height,
+        (uint8_t*)scaled_frame->data[0], scaled_frame->stride[0],
+        (uint8_t*)scaled_frame->data[1], scaled_frame->stride[1],
+        (uint8_t*)scaled_frame->data[2], scaled_frame->stride[2],
+        dst_width, dst_height, libyuv::kFilterBox);
+    if (res != 0) {
+        RTC_LOG(LS_WARNING) << "I420Scale failed: " << res;
+        return nullptr;
+    }
+
+    return scaled_frame;
+}
+
+} // namespace xrtc
@@ -0,0 +1,66 @@
+﻿#ifndef XRTCSDK_XRTC_MEDIA_FILTER_VIDEO_SCALER_FILTER_H_
+#define XRTCSDK_XRTC_MEDIA_FILTER_VIDEO_SCALER_FILTER_H_
+
+#include <atomic>
+
+#include <api/units/data_rate.h>
+#include <rtc_base/third_party/sigslot/sigslot.h>
+
+#include "xrtc/media/base/media_chain.h"
+#include "xrtc/media/filter/cpu_overuse_detector.h"
+
+namespace xrtc {
+
+class X264EncoderFilter;
+
+// 根据目标码率缩放图像，码率低的时候降低编码分辨率，同时降低编码的CPU消耗
+// 分辨率按照固定的缩放比例分级，升级需要码率持续超过阈值一段时间，避免来回切换
+// CPU过载时，在码率决定的级别上再降低resolution_step级
+// 配置示例：{"video_scaler_filter": {"enable": true}}
+class VideoScalerFilter : public MediaObject,
+                          public sigslot::has_slots<>
+{
+public:
+    VideoScalerFilter();
+    ~VideoScalerFilter() override;
+
+    // MediaObject
+    bool Start() override;
+    void Setup(const std::string& json_config) override;
+    void Stop() override;
+    void OnNewMediaFrame(std::shared_ptr<MediaFrame>) override;
+    std::vector<InPin*> GetAllInPins() override {
+        return std::vector<InPin*>({ in_pin_.get() });
+    }
+    std::vector<OutPin*> GetAllOutPins() override {
+        return std::vector<OutPin*>({ out_pin_.get() });
+    }
+
+    // 可以在任意线程调用
+    void SetTargetBitrate(webrtc::DataRate bitrate);
+    // 连接X264EncoderFilter::SignalCpuAdaptation
+    void OnCpuAdaptation(X264EncoderFilter*, const CpuAdaptation& adaptation);
+    // simulcast的低层使用固定的缩小倍数，不再根据码率和CPU调整
+    void SetFixedScale(int scale_down_by) { fixed_scale_down_by_ = scale_down_by; }
+
+private:
+    void UpdateScaleLevel(int width, int height, int64_t now_ms);
+    std::shared_ptr<MediaFrame> ScaleFrame(std::shared_ptr<MediaFrame> frame,
+        int dst_width, int dst_height);
+
+private:
+    std::unique_ptr<InPin> in_pin_;
+    std::unique_ptr<OutPin> out_pin_;
+    bool enable_ = true;
+    int fixed_scale_down_by_ = 1;
+    std::atomic<int64_t> target_bitrate_bps_{ 0 };
+    std::atomic<int> cpu_resolution_step_{ 0 };
+    // 码率决定的缩放级别，0表示不缩放
+    size_t scale_level_ = 0;
+    // 码率开始满足升级条件的时间，-1表示不满足
+    int64_t upgrade_start_time_ms_ = -1;
+};
+
+} // namespace xrtc
+
+#endif // XRTCSDK_XRTC_MEDIA_FILTER_VIDEO_SCALER_FILTER_H_
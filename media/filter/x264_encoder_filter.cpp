@@ -1,17 +1,34 @@
 ﻿#include "xrtc/media/filter/x264_encoder_filter.h"
 
+#include <algorithm>
+
 #include <rtc_base/logging.h>
 #include <rtc_base/thread.h>
+#include <rtc_base/time_utils.h>
+#include <rtc_base/task_utils/to_queued_task.h>
+
+#include "xrtc/base/xrtc_global.h"
 
 #include "xrtc/media/base/in_pin.h"
 #include "xrtc/media/base/out_pin.h"
+#include "xrtc/rtc/modules/pacing/pacing_controller.h"
 
 namespace xrtc {
 
-X264EncoderFilter::X264EncoderFilter() :
+namespace {
+// 超过该值的输入间隔认为是采集暂停，不计入帧间隔
+const int64_t kMaxInputIntervalMs = 1000;
+const double kInputIntervalAlpha = 0.1;
+} // namespace
+
+X264EncoderFilter::X264EncoderFilter(int simulcast_index,
+    ThreadRegistry* thread_registry) :
     MediaObject(MediaObjectId::kMidX264EncoderFilterId),
     in_pin_(std::make_unique<InPin>(this)),
-    out_pin_(std::make_unique<OutPin>(this))
+    out_pin_(std::make_unique<OutPin>(this)),
+    rate_controller_(PacingController::kMaxExpectedQueueLength.ms()),
+    simulcast_index_(simulcast_index),
+    thread_registry_(thread_registry)
 {
     MediaFormat fmt_in;
     fmt_in.media_type = MainMediaType::kMainTypeVideo;
@@ -39,10 +56,12 @@ bool X264EncoderFilter::Start() {
     running_ = true;
 
     encode_thread_ = new std::thread([=]() {
-        rtc::SetCurrentThreadName("x264_encode_thread");
+        ScopedThreadRegistration thread_registration(thread_registry_,
+            ThreadRole::kEncode, "x264_encode_thread");
         RTC_LOG(LS_INFO) << "X264EncoderFilter encode thread running";
 
         // 初始化编码器
+        InitCpuAdaptationLadder();
         if (!InitEncoder()) {
             RTC_LOG(LS_WARNING) << "x264 init failed";
             ReleaseEncoder();
@@ -50,28 +69,22 @@ bool X264EncoderFilter::Start() {
         }
 
         int frame_queue_size = 0;
-        int last_bitrate = latest_bitrate_;
         while (running_) {
-            {
-                //在编码之前，检查码率是否发生变化，如果发生变化
-                //需要重新配置参数
-                int new_bitrate = latest_bitrate_;
-                if(new_bitrate != last_bitrate) {
-                    last_bitrate = new_bitrate;
-                    x264_param_->rc.i_bitrate = new_bitrate * 0.8;
-                    x264_param_->rc.i_vbv_max_bitrate = x264_param_->rc.i_bitrate;//简单做了一个设置
-                    x264_param_->rc.i_vbv_buffer_size = x264_param_->rc.i_bitrate;//简单做了一个设置
-                    x264_encoder_reconfig(x264_, x264_param_);//重新设置才能生效
-                }
-                
+            //在编码之前，检查码率是否需要调整，调整的频率和幅度由rate_controller_控制
+            if (rate_controller_.OnTargetBitrate(latest_bitrate_, rtc::TimeMillis())) {
+                ApplyRateConfig();
+                x264_encoder_reconfig(x264_, x264_param_);//重新设置才能生效
             }
+
             std::shared_ptr<MediaFrame> frame;
+            int64_t enqueue_time_ms = 0;
 
             {
                 std::unique_lock<std::mutex> auto_lock(frame_queue_mtx_);
                 frame_queue_size = frame_queue_.size();
                 if (frame_queue_size > 0) {
-                    frame = frame_queue_.front();
+                    frame = frame_queue_.front().frame;
+                    enqueue_time_ms = frame_queue_.front().enqueue_time_ms;
                     frame_queue_.pop();
                 }
 
@@ -81,12 +94,15 @@ bool X264EncoderFilter::Start() {
                 }
             }
 
+            int64_t encode_start_ms = rtc::TimeMillis();
+
             // 判断图像的宽高是否发生了变化，如果发生了变化，需要重新初始化编码器
             if (encoder_param_.width != frame->fmt.sub_fmt.video_fmt.width ||
                 encoder_param_.height != frame->fmt.sub_fmt.video_fmt.height) 
             {
                 encoder_param_.width = frame->fmt.sub_fmt.video_fmt.width;
                 encoder_param_.height = frame->fmt.sub_fmt.video_fmt.height;
+                FlushEncoder();
                 ReleaseEncoder();
                 if (!InitEncoder()) {
                     ReleaseEncoder();
@@ -99,17 +115,36 @@ bool X264EncoderFilter::Start() {
                 memcpy(x264_picture_->img.plane[i], frame->data[i], frame->data_len[i]);
             }
 
-            // 编码
+            // 重新激活的层需要立即编码关键帧，接收端才能切换到该层
+            x264_picture_->i_type = force_keyframe_.exchange(false) ?
+                X264_TYPE_IDR : X264_TYPE_AUTO;
+
+            // 编码，输出帧的时间在Encode中按照pts找回
+            pending_frame_times_[frame->ts] = { frame->capture_time_ms,
+                enqueue_time_ms, encode_start_ms };
             std::shared_ptr<MediaFrame> out_frame;
-            if (!Encode(frame, out_frame)) {
+            bool encoded = Encode(frame, out_frame);
+            int64_t encode_end_ms = rtc::TimeMillis();
+            SignalFrameEncoded(this, encode_end_ms - encode_start_ms);
+            if (!UpdateCpuAdaptation(encode_end_ms - encode_start_ms,
+                enqueue_time_ms, frame_queue_size, encode_end_ms))
+            {
+                return;
+            }
+
+            if (!encoded) {
                 continue;
             }
 
-            if (out_pin_) {
-                out_pin_->PushMediaFrame(out_frame);
+            // 编码器有缓存时可能没有输出
+            if (!out_frame) {
+                continue;
             }
+
+            DeliverFrame(out_frame, encode_end_ms);
         }
 
+        FlushEncoder();
         ReleaseEncoder();
     });
 
@@ -135,11 +170,29 @@ void X264EncoderFilter::Stop() {
 }
 
 void X264EncoderFilter::OnNewMediaFrame(std::shared_ptr<MediaFrame> frame) {
+    if (!active_) {
+        return;
+    }
+
     std::unique_lock<std::mutex> auto_lock(frame_queue_mtx_);
-    frame_queue_.push(frame);
+    frame_queue_.push({ frame, rtc::TimeMillis() });
     cond_var_.notify_one();
 }
 
+void X264EncoderFilter::SetTemporalLayers(int temporal_layers) {
+    temporal_layers_ = std::max(1, std::min(temporal_layers, 3));
+}
+
+void X264EncoderFilter::SetActive(bool active) {
+    if (active_.exchange(active) != active) {
+        RTC_LOG(LS_INFO) << "X264EncoderFilter simulcast layer " << simulcast_index_
+            << (active ? " resumed" : " paused");
+        if (active) {
+            force_keyframe_ = true;
+        }
+    }
+}
+
 static void LogX264(void*, int level, const char* format, va_list args) {
     char buf[1024];
     va_list args2;
@@ -162,8 +215,9 @@ void X264EncoderFilter::SetBitrate(webrtc::DataRate bitrate) {
 bool X264EncoderFilter::InitEncoder() {
     x264_param_ = new x264_param_t();
     memset(x264_param_, 0, sizeof(x264_param_t));
-    // 设置速率和场景
-    if (x264_param_default_preset(x264_param_, encoder_param_.preset.c_str(),
+    // 设置速率和场景，CPU过载时使用更快的preset
+    const char* preset = x264_preset_names[preset_index_ - cpu_adaptation_.preset_step];
+    if (x264_param_default_preset(x264_param_, preset,
         encoder_param_.tune.c_str())) 
     {
         return false;
@@ -183,6 +237,17 @@ bool X264EncoderFilter::InitEncoder() {
     x264_param_->i_csp = X264_CSP_I420;
     // 不使用B帧, B帧会增大延迟
     x264_param_->i_bframe = 0;
+    // x264不支持不参考的P帧，时间分层使用固定的B帧结构，没有被参考的B帧就是最高的时间层
+    // L1T2: P b P b，L1T3: P b B b P，会增加(2^(T-1) - 1)帧的延迟
+    if (temporal_layers_ > 1) {
+        x264_param_->i_bframe = (1 << (temporal_layers_ - 1)) - 1;
+        x264_param_->i_bframe_adaptive = X264_B_ADAPT_NONE;
+        x264_param_->i_bframe_pyramid = temporal_layers_ > 2 ?
+            X264_B_PYRAMID_NORMAL : X264_B_PYRAMID_NONE;
+        // zerolatency关闭了lookahead，B帧需要先缓存后面的P帧
+        x264_param_->rc.i_lookahead = std::max(x264_param_->rc.i_lookahead,
+            x264_param_->i_bframe);
+    }
     // 设置单Slice
     x264_param_->i_slice_count = 1;
     // 使用单线程
@@ -211,17 +276,30 @@ bool X264EncoderFilter::InitEncoder() {
     if (encoder_param_.buffer_size > 0) {
         x264_param_->rc.i_vbv_buffer_size = encoder_param_.buffer_size;
     }
+
+    // 分辨率或者preset变化重新初始化时，保持当前的码率
+    // 打开编码器时必须开启VBV，之后x264_encoder_reconfig才能修改VBV参数
+    ApplyRateConfig();
     
     // 根据fps来计算两帧间隔，如果是1，表示使用时间戳来计算间隔
-    x264_param_->b_vfr_input = 0;
+    // 帧率自适应会丢帧，使用时间戳(ms)计算间隔，码率控制才准确
+    x264_param_->b_vfr_input = 1;
+    x264_param_->i_timebase_num = 1;
+    x264_param_->i_timebase_den = 1000;
 
     // 设置log参数
     x264_param_->pf_log = LogX264;
     x264_param_->p_log_private = nullptr;
     x264_param_->i_log_level = X264_LOG_DEBUG;
 
-    // 设置profile
-    if (x264_param_apply_profile(x264_param_, encoder_param_.profile.c_str())) {
+    // 设置profile，baseline不支持B帧，SDP中的profile-level-id同样声明为main
+    std::string profile = encoder_param_.profile;
+    if (temporal_layers_ > 1 && "baseline" == profile) {
+        RTC_LOG(LS_INFO) << "X264EncoderFilter temporal layers: " << temporal_layers_
+            << ", use main profile instead of baseline";
+        profile = "main";
+    }
+    if (x264_param_apply_profile(x264_param_, profile.c_str())) {
         return false;
     }
 
@@ -245,11 +323,144 @@ bool X264EncoderFilter::InitEncoder() {
 
     // 设置编码帧的类型
     x264_picture_->i_type = X264_TYPE_AUTO;
-    //初始化最新的码率
-    latest_bitrate_ = encoder_param_.bitrate;
     return true;
 }
 
+void X264EncoderFilter::InitCpuAdaptationLadder() {
+    // x264_preset_names从ultrafast到placebo排列，越靠前越快
+    preset_index_ = 0;
+    for (int i = 0; x264_preset_names[i]; ++i) {
+        if (encoder_param_.preset == x264_preset_names[i]) {
+            preset_index_ = i;
+            break;
+        }
+    }
+
+    cpu_adaptation_ladder_.clear();
+    cpu_adaptation_ = CpuAdaptation();
+    input_interval_ms_ = encoder_param_.fps > 0 ? 1000.0 / encoder_param_.fps : 0.0;
+    last_enqueue_time_ms_ = -1;
+    CpuAdaptation adaptation;
+    cpu_adaptation_ladder_.push_back(adaptation);
+    // 先降低preset，最多两档
+    for (int i = 0; i < 2 && adaptation.preset_step < preset_index_; ++i) {
+        ++adaptation.preset_step;
+        cpu_adaptation_ladder_.push_back(adaptation);
+    }
+    // 再降低分辨率
+    for (int i = 0; i < 2; ++i) {
+        ++adaptation.resolution_step;
+        cpu_adaptation_ladder_.push_back(adaptation);
+    }
+    // 最后降低帧率
+    for (int i = 0; i < 2; ++i) {
+        ++adaptation.framerate_step;
+        cpu_adaptation_ladder_.push_back(adaptation);
+    }
+
+    for (size_t i = 0; i < cpu_adaptation_ladder_.size(); ++i) {
+        cpu_adaptation_ladder_[i].level = (int)i;
+    }
+}
+
+bool X264EncoderFilter::UpdateCpuAdaptation(int64_t encode_time_ms,
+    int64_t enqueue_time_ms, int queue_size, int64_t now_ms)
+{
+    // 使用帧进入队列的间隔，编码跟不上时出队的间隔等于编码耗时，不能反映输入帧率
+    if (last_enqueue_time_ms_ >= 0) {
+        int64_t interval_ms = enqueue_time_ms - last_enqueue_time_ms_;
+        if (interval_ms > 0 && interval_ms <= kMaxInputIntervalMs) {
+            input_interval_ms_ = input_interval_ms_ > 0.0 ?
+                input_interval_ms_ + kInputIntervalAlpha * (interval_ms - input_interval_ms_) :
+                (double)interval_ms;
+        }
+    }
+    last_enqueue_time_ms_ = enqueue_time_ms;
+
+    CpuOveruseDetector::State state = cpu_overuse_detector_.OnFrameEncoded(
+        encode_time_ms, (int64_t)(input_interval_ms_ + 0.5), queue_size, now_ms);
+
+    int level = cpu_adaptation_.level;
+    if (CpuOveruseDetector::State::kOveruse == state &&
+        level + 1 < (int)cpu_adaptation_ladder_.size())
+    {
+        ++level;
+        ++cpu_adaptation_.overuse_count;
+    }
+    else if (CpuOveruseDetector::State::kUnderuse == state && level > 0) {
+        --level;
+        ++cpu_adaptation_.underuse_count;
+    }
+    else {
+        return true;
+    }
+
+    int old_preset_step = cpu_adaptation_.preset_step;
+    const CpuAdaptation& next = cpu_adaptation_ladder_[level];
+    cpu_adaptation_.level = next.level;
+    cpu_adaptation_.preset_step = next.preset_step;
+    cpu_adaptation_.resolution_step = next.resolution_step;
+    cpu_adaptation_.framerate_step = next.framerate_step;
+    cpu_adaptation_.encode_usage_percent = cpu_overuse_detector_.encode_usage_percent();
+    cpu_overuse_detector_.Reset(now_ms);
+
+    RTC_LOG(LS_INFO) << "X264EncoderFilter cpu adaptation changed, level: "
+        << cpu_adaptation_.level
+        << ", preset: " << x264_preset_names[preset_index_ - cpu_adaptation_.preset_step]
+        << ", resolution_step: " << cpu_adaptation_.resolution_step
+        << ", framerate_step: " << cpu_adaptation_.framerate_step
+        << ", encode_usage: " << cpu_adaptation_.encode_usage_percent << "%"
+        << ", queue_size: " << queue_size;
+
+    // preset需要重新打开编码器才能生效
+    if (old_preset_step != cpu_adaptation_.preset_step) {
+        FlushEncoder();
+        ReleaseEncoder();
+        if (!InitEncoder()) {
+            RTC_LOG(LS_WARNING) << "x264 reinit failed after cpu adaptation";
+            ReleaseEncoder();
+            return false;
+        }
+    }
+
+    // 分辨率和帧率由上游的filter处理
+    SignalCpuAdaptation(this, cpu_adaptation_);
+
+    CpuAdaptation adaptation = cpu_adaptation_;
+    XRTCGlobal::Instance()->api_thread()->PostTask(webrtc::ToQueuedTask([=]() {
+        if (XRTCGlobal::Instance()->engine_observer()) {
+            XRTCGlobal::Instance()->engine_observer()->OnCpuAdaptation(adaptation);
+        }
+    }));
+
+    return true;
+}
+
+void X264EncoderFilter::ApplyRateConfig() {
+    if (!rate_controller_.has_config() || "ABR" != encoder_param_.rate_control) {
+        return;
+    }
+
+    const EncoderRateConfig& config = rate_controller_.config();
+    x264_param_->rc.i_bitrate = config.bitrate_kbps;
+    x264_param_->rc.i_vbv_max_bitrate = config.vbv_max_bitrate_kbps;
+    x264_param_->rc.i_vbv_buffer_size = config.vbv_buffer_size_kbits;
+}
+
+void X264EncoderFilter::ReportRateStats(const EncoderRateStats& stats) {
+    RTC_LOG(LS_INFO) << "X264EncoderFilter rate stats, simulcast_index: " << simulcast_index_
+        << ", target_kbps: " << stats.target_bitrate_kbps
+        << ", encoder_kbps: " << stats.encoder_bitrate_kbps
+        << ", achieved_kbps: " << stats.achieved_bitrate_kbps
+        << ", reconfig_count: " << stats.reconfig_count;
+
+    XRTCGlobal::Instance()->api_thread()->PostTask(webrtc::ToQueuedTask([=]() {
+        if (XRTCGlobal::Instance()->engine_observer()) {
+            XRTCGlobal::Instance()->engine_observer()->OnEncoderRateStats(stats);
+        }
+    }));
+}
+
 void X264EncoderFilter::ReleaseEncoder() {
     if (x264_param_) {
         delete x264_param_;
@@ -266,20 +477,62 @@ void X264EncoderFilter::ReleaseEncoder() {
         x264_encoder_close(x264_);
         x264_ = nullptr;
     }
+
+    pending_frame_times_.clear();
+}
+
+void X264EncoderFilter::FlushEncoder() {
+    if (!x264_) {
+        return;
+    }
+
+    while (x264_encoder_delayed_frames(x264_) > 0) {
+        std::shared_ptr<MediaFrame> out_frame;
+        if (!Encode(nullptr, out_frame)) {
+            break;
+        }
+
+        if (out_frame) {
+            DeliverFrame(out_frame, rtc::TimeMillis());
+        }
+    }
+}
+
+void X264EncoderFilter::DeliverFrame(std::shared_ptr<MediaFrame> out_frame,
+    int64_t encode_end_ms)
+{
+    EncoderRateStats rate_stats;
+    if (rate_controller_.OnFrameEncoded(out_frame->data_len[0],
+        encode_end_ms, &rate_stats))
+    {
+        ReportRateStats(rate_stats);
+    }
+
+    out_frame->stage_time_ms[kFrameStageEncodeEnd] = encode_end_ms;
+
+    if (out_pin_) {
+        out_pin_->PushMediaFrame(out_frame);
+    }
 }
 
 bool X264EncoderFilter::Encode(std::shared_ptr<MediaFrame> frame, 
     std::shared_ptr<MediaFrame>& out_frame) 
 {
     // 设置时间戳
-    x264_picture_->i_pts = frame->ts;
+    if (frame) {
+        x264_picture_->i_pts = frame->ts;
+    }
 
     int nal_num;
     x264_nal_t* nal_out;
     x264_picture_t pic_out;
-    int size = x264_encoder_encode(x264_, &nal_out, &nal_num, x264_picture_, &pic_out);
+    int size = x264_encoder_encode(x264_, &nal_out, &nal_num,
+        frame ? x264_picture_ : nullptr, &pic_out);
     if (size < 0) {
         RTC_LOG(LS_WARNING) << "x264_encoder_encode failed: " << size;
+        if (frame) {
+            pending_frame_times_.erase(frame->ts);
+        }
         return false;
     }
 
@@ -331,7 +584,24 @@ bool X264EncoderFilter::Encode(std::shared_ptr<MediaFrame> frame,
     out_frame->fmt.sub_fmt.video_fmt.idr = idr;
     out_frame->ts = pic_out.i_pts;
     out_frame->data_len[0] = data_size;
-    out_frame->capture_time_ms = frame->capture_time_ms;
+    // 记录编码相关阶段的时间，用于统计发送端延迟，编码完成的时间由DeliverFrame设置
+    auto iter = pending_frame_times_.find(pic_out.i_pts);
+    if (iter != pending_frame_times_.end()) {
+        out_frame->capture_time_ms = iter->second.capture_time_ms;
+        out_frame->stage_time_ms[kFrameStageCapture] = iter->second.capture_time_ms;
+        out_frame->stage_time_ms[kFrameStageEncodeQueue] = iter->second.enqueue_time_ms;
+        out_frame->stage_time_ms[kFrameStageEncodeStart] = iter->second.encode_start_ms;
+        pending_frame_times_.erase(iter);
+    }
+    out_frame->simulcast_index = simulcast_index_;
+    // 被参考的B帧在中间层，不被参考的B帧在最高层
+    out_frame->num_temporal_layers = temporal_layers_;
+    if (X264_TYPE_BREF == pic_out.i_type) {
+        out_frame->temporal_id = 1;
+    }
+    else if (X264_TYPE_B == pic_out.i_type) {
+        out_frame->temporal_id = temporal_layers_ - 1;
+    }
 
     int data_index = 0;
     for (size_t i = 0; i < nals.size(); ++i) {
@@ -1,12 +1,16 @@
 ﻿#ifndef XRTCSDK_XRTC_MEDIA_FILTER_X264_ENCODER_FILTER_H_
 #define XRTCSDK_XRTC_MEDIA_FILTER_X264_ENCODER_FILTER_H_
 
+#include <map>
 #include <queue>
 #include <mutex>
 #include <atomic>
 
 #include <api/units/data_rate.h>
+#include <rtc_base/third_party/sigslot/sigslot.h>
 #include "xrtc/media/base/media_chain.h"
+#include "xrtc/media/filter/cpu_overuse_detector.h"
+#include "xrtc/media/filter/encoder_rate_controller.h"
 
 extern "C" {
 #include <x264.h>
@@ -14,6 +18,8 @@ extern "C" {
 
 namespace xrtc {
 
+class ThreadRegistry;
+
 struct X264EncoderParam {
     // 编码速率
     std::string preset = "veryfast";
@@ -39,7 +45,10 @@ struct X264EncoderParam {
 
 class X264EncoderFilter : public MediaObject {
 public:
-    X264EncoderFilter();
+    // simulcast_index为该编码器对应的simulcast层
+    // thread_registry不为空时，编码线程登记到其中
+    explicit X264EncoderFilter(int simulcast_index = 0,
+        ThreadRegistry* thread_registry = nullptr);
     ~X264EncoderFilter() override;
 
     // MediaObject
@@ -54,18 +63,45 @@ public:
         return std::vector<OutPin*>({ out_pin_.get() });
     }
 
+    // 拥塞控制的目标码率，可以在任意线程调用
     void SetBitrate(webrtc::DataRate bitrate);
+    // simulcast时码率不足的层暂停编码，恢复时编码关键帧
+    void SetActive(bool active);
+    int simulcast_index() const { return simulcast_index_; }
+    // 时间层数1~3，需要在Start之前设置
+    void SetTemporalLayers(int temporal_layers);
+    int temporal_layers() const { return temporal_layers_; }
+
+    // 每编码完一帧触发，参数为该帧的编码耗时(ms)，在编码线程中回调
+    sigslot::signal2<X264EncoderFilter*, int64_t> SignalFrameEncoded;
+    // CPU降级状态变化时触发，在编码线程中回调
+    sigslot::signal2<X264EncoderFilter*, const CpuAdaptation&> SignalCpuAdaptation;
 
 private:
     bool InitEncoder();
     void ReleaseEncoder();
+    // frame为空时取出编码器缓存的帧
     bool Encode(std::shared_ptr<MediaFrame> frame,
         std::shared_ptr<MediaFrame>& out_frame);
+    // 输出编码器中因为B帧而延迟的帧，重新初始化编码器和停止之前调用
+    void FlushEncoder();
+    void DeliverFrame(std::shared_ptr<MediaFrame> out_frame, int64_t encode_end_ms);
+    void InitCpuAdaptationLadder();
+    // 返回false表示编码器重新初始化失败，enqueue_time_ms用于统计实际的输入帧间隔
+    bool UpdateCpuAdaptation(int64_t encode_time_ms, int64_t enqueue_time_ms,
+        int queue_size, int64_t now_ms);
+    void ApplyRateConfig();
+    // 切换到api线程，回调XRTCEngineObserver::OnEncoderRateStats
+    void ReportRateStats(const EncoderRateStats& stats);
 
 private:
     std::unique_ptr<InPin> in_pin_;
     std::unique_ptr<OutPin> out_pin_;
-    std::queue<std::shared_ptr<MediaFrame>> frame_queue_;
+    struct QueuedFrame {
+        std::shared_ptr<MediaFrame> frame;
+        int64_t enqueue_time_ms; // 进入编码队列的时间
+    };
+    std::queue<QueuedFrame> frame_queue_;
     std::mutex frame_queue_mtx_;
     std::atomic<bool> running_{ false };
     std::thread* encode_thread_ = nullptr;
@@ -75,7 +111,32 @@ private:
     x264_param_t* x264_param_ = nullptr;
     x264_t* x264_ = nullptr;
     x264_picture_t* x264_picture_ = nullptr;
-    std::atomic<int> latest_bitrate_{ 0 };
+    // 已经送入编码器、还没有输出的帧的时间，key是pts
+    // 有B帧时输出顺序和输入顺序不同，需要按照输出帧的pts查找
+    struct PendingFrameTime {
+        int64_t capture_time_ms;
+        int64_t enqueue_time_ms;
+        int64_t encode_start_ms;
+    };
+    std::map<int64_t, PendingFrameTime> pending_frame_times_;
+    // 单位bps
+    std::atomic<int64_t> latest_bitrate_{ 0 };
+    EncoderRateController rate_controller_;
+    int simulcast_index_ = 0;
+    ThreadRegistry* thread_registry_ = nullptr;
+    int temporal_layers_ = 1;
+    std::atomic<bool> active_{ true };
+    std::atomic<bool> force_keyframe_{ false };
+
+    CpuOveruseDetector cpu_overuse_detector_;
+    // 依次降级的参数，第0项表示没有降级
+    std::vector<CpuAdaptation> cpu_adaptation_ladder_;
+    CpuAdaptation cpu_adaptation_;
+    // 平滑之后的输入帧间隔，采集帧率低于配置或者上游降帧率时编码耗时的占比按实际间隔计算
+    double input_interval_ms_ = 0.0;
+    int64_t last_enqueue_time_ms_ = -1;
+    // 配置的preset在x264_preset_names中的位置
+    int preset_index_ = 0;
 };
 
 } // namespace xrtc
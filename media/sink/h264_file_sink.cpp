@@ -0,0 +1,59 @@
+﻿#include "xrtc/media/sink/h264_file_sink.h"
+
+#include <rtc_base/logging.h>
+
+#include "xrtc/base/xrtc_json.h"
+#include "xrtc/media/base/in_pin.h"
+#include "xrtc/media/base/out_pin.h"
+
+namespace xrtc {
+
+H264FileSink::H264FileSink() :
+    in_pin_(std::make_unique<InPin>(this)),
+    out_pin_(std::make_unique<OutPin>(this))
+{
+    MediaFormat fmt;
+    fmt.media_type = MainMediaType::kMainTypeVideo;
+    fmt.sub_fmt.video_fmt.type = SubMediaType::kSubTypeH264;
+    in_pin_->set_format(fmt);
+    out_pin_->set_format(fmt);
+}
+
+H264FileSink::~H264FileSink() {
+}
+
+bool H264FileSink::Start() {
+    RTC_LOG(LS_INFO) << "H264FileSink Start, path: " << path_;
+    if (writer_.IsOpen()) {
+        return true;
+    }
+
+    return writer_.Open(path_, "h264_file_sink_thread");
+}
+
+void H264FileSink::Setup(const std::string& json_config) {
+    JsonValue value;
+    value.FromJson(json_config);
+    JsonObject jobj = value.ToObject();
+    JsonObject jh264_file_sink = jobj["h264_file_sink"].ToObject();
+    path_ = jh264_file_sink["path"].ToString();
+}
+
+void H264FileSink::Stop() {
+    RTC_LOG(LS_INFO) << "H264FileSink Stop";
+    writer_.Close();
+}
+
+void H264FileSink::OnNewMediaFrame(std::shared_ptr<MediaFrame> frame) {
+    // 先转发给下游，录制不增加发送的延迟
+    if (out_pin_) {
+        out_pin_->PushMediaFrame(frame);
+    }
+
+    // x264输出的NALU已经带有起始码，只需要拷贝到写缓冲区，不阻塞编码线程
+    if (MainMediaType::kMainTypeVideo == frame->fmt.media_type) {
+        writer_.Write(frame->data[0], frame->data_len[0]);
+    }
+}
+
+} // namespace xrtc
@@ -0,0 +1,43 @@
+﻿#ifndef XRTCSDK_XRTC_MEDIA_SINK_H264_FILE_SINK_H_
+#define XRTCSDK_XRTC_MEDIA_SINK_H264_FILE_SINK_H_
+
+#include <string>
+
+#include "xrtc/base/async_file_writer.h"
+#include "xrtc/media/base/media_chain.h"
+
+namespace xrtc {
+
+class InPin;
+class OutPin;
+
+// 将编码后的H264码流保存为Annex-B文件，可以直接用ffplay等工具播放
+// 帧数据原样转发到输出pin，可以串联在编码器和xrtc_media_sink之间
+// 配置示例：{"h264_file_sink": {"path": "push.h264"}}
+class H264FileSink : public MediaObject {
+public:
+    H264FileSink();
+    ~H264FileSink() override;
+
+    // MediaObject
+    bool Start() override;
+    void Setup(const std::string& json_config) override;
+    void Stop() override;
+    void OnNewMediaFrame(std::shared_ptr<MediaFrame>) override;
+    std::vector<InPin*> GetAllInPins() override {
+        return std::vector<InPin*>({ in_pin_.get() });
+    }
+    std::vector<OutPin*> GetAllOutPins() override {
+        return std::vector<OutPin*>({ out_pin_.get() });
+    }
+
+private:
+    std::unique_ptr<InPin> in_pin_;
+    std::unique_ptr<OutPin> out_pin_;
+    std::string path_;
+    AsyncFileWriter writer_;
+};
+
+} // namespace xrtc
+
+#endif // XRTCSDK_XRTC_MEDIA_SINK_H264_FILE_SINK_H_
@@ -0,0 +1,208 @@
+﻿#include "xrtc/media/sink/null_render_sink.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include <algorithm>
+
+#include <rtc_base/logging.h>
+#include <rtc_base/time_utils.h>
+#include <rtc_base/task_utils/to_queued_task.h>
+
+#include "xrtc/base/xrtc_global.h"
+#include "xrtc/base/xrtc_json.h"
+#include "xrtc/media/base/in_pin.h"
+
+namespace xrtc {
+
+namespace {
+// 每个桶1ms，超过1s的延迟都统计到最后一个桶
+const size_t kNumLatencyBuckets = 1000;
+// 统计最近的帧数，30fps下大约10s
+const size_t kMaxNumFrames = 300;
+const int64_t kReportIntervalMs = 5000;
+// ts的间隔超过估计帧间隔的倍数时，认为中间有帧被丢弃
+const double kFrameGapFactor = 1.5;
+const char kY4mFrameHeader[] = "FRAME\n";
+} // namespace
+
+NullRenderSink::NullRenderSink() :
+    in_pin_(std::make_unique<InPin>(this)),
+    latency_histogram_(kNumLatencyBuckets, kMaxNumFrames)
+{
+    MediaFormat fmt;
+    fmt.media_type = MainMediaType::kMainTypeVideo;
+    fmt.sub_fmt.video_fmt.type = SubMediaType::kSubTypeI420;
+    in_pin_->set_format(fmt);
+}
+
+NullRenderSink::~NullRenderSink() {
+    // 先让队列中的任务失效，再等待worker线程上正在执行的任务结束
+    task_safety_.flag()->SetNotAlive();
+    XRTCGlobal::Instance()->worker_thread()->Invoke<void>(RTC_FROM_HERE, []() {});
+}
+
+bool NullRenderSink::Start() {
+    RTC_LOG(LS_INFO) << "NullRenderSink Start, snapshot_path: " << snapshot_path_;
+    if (snapshot_path_.empty() || snapshot_writer_.IsOpen()) {
+        return true;
+    }
+
+    return snapshot_writer_.Open(snapshot_path_, "null_render_snapshot_thread");
+}
+
+void NullRenderSink::Setup(const std::string& json_config) {
+    JsonValue value;
+    value.FromJson(json_config);
+    JsonObject jobj = value.ToObject();
+    if (jobj.Has("null_render_sink")) {
+        JsonObject jnull_render_sink = jobj["null_render_sink"].ToObject();
+        snapshot_path_ = jnull_render_sink["snapshot_path"].ToString();
+        snapshot_interval_ms_ = (int64_t)jnull_render_sink["snapshot_interval_ms"].ToInt(
+            snapshot_interval_ms_);
+    }
+}
+
+void NullRenderSink::Stop() {
+    RTC_LOG(LS_INFO) << "NullRenderSink Stop";
+    snapshot_writer_.Close();
+}
+
+void NullRenderSink::OnNewMediaFrame(std::shared_ptr<MediaFrame> frame) {
+    // 和D3D9RenderSink一样切换到worker线程
+    XRTCGlobal::Instance()->worker_thread()->PostTask(webrtc::ToQueuedTask(
+        task_safety_.flag(), [this, frame]() {
+        DoRender(frame);
+    }));
+}
+
+void NullRenderSink::DoRender(std::shared_ptr<MediaFrame> frame) {
+    int64_t now_ms = rtc::TimeMillis();
+    UpdateStats(*frame, now_ms);
+    MaybeWriteSnapshot(*frame, now_ms);
+    MaybeReportStats(now_ms);
+}
+
+void NullRenderSink::UpdateStats(const MediaFrame& frame, int64_t now_ms) {
+    ++num_frames_;
+
+    if (frame.capture_time_ms > 0 && now_ms >= frame.capture_time_ms) {
+        latency_histogram_.Add(now_ms - frame.capture_time_ms);
+    }
+
+    if (last_render_time_ms_ >= 0) {
+        // ts的单位是ms，相减之后转成有符号数处理回绕
+        int64_t ts_delta = (int32_t)(frame.ts - last_ts_);
+        int64_t render_delta = now_ms - last_render_time_ms_;
+        max_interval_ms_ = std::max(max_interval_ms_, (int)render_delta);
+
+        double d = (double)llabs(render_delta - ts_delta);
+        jitter_ms_ += (d - jitter_ms_) / 16.0;
+
+        if (ts_delta > 0) {
+            if (frame_interval_ms_ > 0 && ts_delta > frame_interval_ms_ * kFrameGapFactor) {
+                dropped_frames_ += (int)(ts_delta / frame_interval_ms_ + 0.5) - 1;
+            }
+            else {
+                // 只用正常的间隔更新帧间隔，丢帧造成的大间隔不参与
+                frame_interval_ms_ = frame_interval_ms_ > 0 ?
+                    frame_interval_ms_ * 0.9 + ts_delta * 0.1 : (double)ts_delta;
+            }
+        }
+    }
+
+    last_render_time_ms_ = now_ms;
+    last_ts_ = frame.ts;
+}
+
+void NullRenderSink::MaybeReportStats(int64_t now_ms) {
+    if (last_report_time_ms_ < 0) {
+        last_report_time_ms_ = now_ms;
+        return;
+    }
+
+    int64_t elapsed_ms = now_ms - last_report_time_ms_;
+    if (elapsed_ms < kReportIntervalMs) {
+        return;
+    }
+
+    RenderStats stats;
+    stats.num_frames = num_frames_;
+    stats.fps = num_frames_ * 1000.0 / elapsed_ms;
+    stats.dropped_frames = dropped_frames_;
+    // InverseCdf返回的是累计概率达到要求的桶的下一个位置
+    if (latency_histogram_.NumValues() > 0) {
+        stats.latency_p50_ms = (int)latency_histogram_.InverseCdf(0.5f) - 1;
+        stats.latency_p90_ms = (int)latency_histogram_.InverseCdf(0.9f) - 1;
+        stats.latency_p99_ms = (int)latency_histogram_.InverseCdf(0.99f) - 1;
+    }
+    stats.jitter_ms = (int)(jitter_ms_ + 0.5);
+    stats.max_interval_ms = max_interval_ms_;
+
+    RTC_LOG(LS_INFO) << "NullRenderSink stats, frames: " << stats.num_frames
+        << ", fps: " << stats.fps
+        << ", dropped: " << stats.dropped_frames
+        << ", latency p50/p90/p99: " << stats.latency_p50_ms
+        << "/" << stats.latency_p90_ms << "/" << stats.latency_p99_ms
+        << ", jitter: " << stats.jitter_ms
+        << ", max_interval: " << stats.max_interval_ms;
+    SignalRenderStats(this, stats);
+
+    num_frames_ = 0;
+    dropped_frames_ = 0;
+    max_interval_ms_ = 0;
+    last_report_time_ms_ = now_ms;
+}
+
+void NullRenderSink::MaybeWriteSnapshot(const MediaFrame& frame, int64_t now_ms) {
+    if (!snapshot_writer_.IsOpen()) {
+        return;
+    }
+
+    if (last_snapshot_time_ms_ >= 0 &&
+        now_ms - last_snapshot_time_ms_ < snapshot_interval_ms_)
+    {
+        return;
+    }
+
+    int width = frame.fmt.sub_fmt.video_fmt.width;
+    int height = frame.fmt.sub_fmt.video_fmt.height;
+    if (0 == snapshot_width_) {
+        // 每个快照作为Y4M的一帧，帧率按照快照的间隔填写
+        char header[128];
+        int len = snprintf(header, sizeof(header),
+            "YUV4MPEG2 W%d H%d F1000:%d Ip A1:1 C420jpeg\n",
+            width, height, (int)std::max<int64_t>(snapshot_interval_ms_, 1));
+        snapshot_writer_.Write(header, len);
+        snapshot_width_ = width;
+        snapshot_height_ = height;
+    }
+    else if (width != snapshot_width_ || height != snapshot_height_) {
+        // Y4M文件只能有一种分辨率
+        return;
+    }
+
+    last_snapshot_time_ms_ = now_ms;
+
+    // 按照行拷贝，去掉stride的填充
+    int chroma_width = (width + 1) / 2;
+    int chroma_height = (height + 1) / 2;
+    snapshot_buffer_.resize(width * height + 2 * chroma_width * chroma_height);
+    uint8_t* dst = snapshot_buffer_.data();
+    for (int i = 0; i < 3; ++i) {
+        int plane_width = (0 == i) ? width : chroma_width;
+        int plane_height = (0 == i) ? height : chroma_height;
+        const char* src = frame.data[i];
+        for (int row = 0; row < plane_height; ++row) {
+            memcpy(dst, src, plane_width);
+            dst += plane_width;
+            src += frame.stride[i];
+        }
+    }
+
+    snapshot_writer_.Write(kY4mFrameHeader, sizeof(kY4mFrameHeader) - 1,
+        snapshot_buffer_.data(), snapshot_buffer_.size());
+}
+
+} // namespace xrtc
@@ -0,0 +1,95 @@
+﻿#ifndef XRTCSDK_XRTC_MEDIA_SINK_NULL_RENDER_SINK_H_
+#define XRTCSDK_XRTC_MEDIA_SINK_NULL_RENDER_SINK_H_
+
+#include <string>
+#include <vector>
+
+#include <rtc_base/third_party/sigslot/sigslot.h>
+#include <rtc_base/task_utils/pending_task_safety_flag.h>
+
+#include "xrtc/base/async_file_writer.h"
+#include "xrtc/media/base/media_chain.h"
+#include "xrtc/rtc/modules/nack/histogram.h"
+
+namespace xrtc {
+
+class InPin;
+
+// 渲染端的统计，每个周期上报一次
+struct RenderStats {
+    // 统计周期内渲染的帧数和帧率
+    int num_frames = 0;
+    double fps = 0.0;
+    // 根据ts的间隔估计的上游丢帧数
+    int dropped_frames = 0;
+    // 采集到渲染的延迟，只统计带有采集时间的帧
+    int latency_p50_ms = 0;
+    int latency_p90_ms = 0;
+    int latency_p99_ms = 0;
+    // 渲染间隔相对于ts间隔的抖动，计算方法和RFC3550的到达抖动相同
+    int jitter_ms = 0;
+    // 统计周期内最大的渲染间隔，用于发现卡顿
+    int max_interval_ms = 0;
+};
+
+// 不显示图像的渲染sink，可以在没有窗口的Linux服务器上运行预览和拉流链路
+// 和D3D9RenderSink一样在worker线程中处理每一帧，统计的时间和实际渲染一致
+// 可选地每隔一段时间保存一帧到Y4M文件，用于检查画面
+// 配置示例：{"null_render_sink": {"snapshot_path": "snapshot.y4m", "snapshot_interval_ms": 5000}}
+class NullRenderSink : public MediaObject {
+public:
+    NullRenderSink();
+    ~NullRenderSink() override;
+
+    // MediaObject
+    bool Start() override;
+    void Setup(const std::string& json_config) override;
+    void Stop() override;
+    void OnNewMediaFrame(std::shared_ptr<MediaFrame>) override;
+    std::vector<InPin*> GetAllInPins() override {
+        return std::vector<InPin*>({ in_pin_.get() });
+    }
+
+    std::vector<OutPin*> GetAllOutPins() override {
+        return std::vector<OutPin*>();
+    }
+
+    // 在worker线程中回调
+    sigslot::signal2<NullRenderSink*, const RenderStats&> SignalRenderStats;
+
+private:
+    void DoRender(std::shared_ptr<MediaFrame> frame);
+    void UpdateStats(const MediaFrame& frame, int64_t now_ms);
+    void MaybeReportStats(int64_t now_ms);
+    void MaybeWriteSnapshot(const MediaFrame& frame, int64_t now_ms);
+
+private:
+    std::unique_ptr<InPin> in_pin_;
+    std::string snapshot_path_;
+    int64_t snapshot_interval_ms_ = 5000;
+    AsyncFileWriter snapshot_writer_;
+
+    // 以下变量只在worker线程访问
+    std::vector<uint8_t> snapshot_buffer_;
+    // Y4M文件头中的分辨率，0表示还没有写入文件头
+    int snapshot_width_ = 0;
+    int snapshot_height_ = 0;
+    int64_t last_snapshot_time_ms_ = -1;
+
+    Histogram latency_histogram_;
+    int64_t last_render_time_ms_ = -1;
+    uint32_t last_ts_ = 0;
+    // 根据ts估计的帧间隔
+    double frame_interval_ms_ = 0.0;
+    double jitter_ms_ = 0.0;
+    int num_frames_ = 0;
+    int dropped_frames_ = 0;
+    int max_interval_ms_ = 0;
+    int64_t last_report_time_ms_ = -1;
+    // 对象销毁之后，还在worker线程队列中的渲染任务不再执行
+    webrtc::ScopedTaskSafety task_safety_;
+};
+
+} // namespace xrtc
+
+#endif // XRTCSDK_XRTC_MEDIA_SINK_NULL_RENDER_SINK_H_
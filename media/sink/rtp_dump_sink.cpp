@@ -0,0 +1,84 @@
+﻿#include "xrtc/media/sink/rtp_dump_sink.h"
+
+#include <rtc_base/logging.h>
+#include <rtc_base/time_utils.h>
+#include <modules/rtp_rtcp/source/byte_io.h>
+
+#include "xrtc/base/xrtc_json.h"
+
+namespace xrtc {
+
+namespace {
+// rtpdump文件格式：
+// "#!rtpplay1.0 address/port\n"
+// 文件头：start_sec(4) start_usec(4) source(4) port(2) padding(2)
+// 每个包：length(2) plen(2) offset_ms(4) data，length包含8字节的包头，
+// RTCP包的plen为0
+const char kFirstLine[] = "#!rtpplay1.0 0.0.0.0/0\n";
+const size_t kFileHeaderSize = 16;
+const size_t kPacketHeaderSize = 8;
+// length字段只有16位
+const size_t kMaxPacketSize = 0xFFFF - kPacketHeaderSize;
+} // namespace
+
+RtpDumpSink::RtpDumpSink() {
+}
+
+RtpDumpSink::~RtpDumpSink() {
+}
+
+bool RtpDumpSink::Start() {
+    RTC_LOG(LS_INFO) << "RtpDumpSink Start, path: " << path_;
+    if (writer_.IsOpen()) {
+        return true;
+    }
+
+    if (!writer_.Open(path_, "rtp_dump_sink_thread")) {
+        return false;
+    }
+
+    int64_t now_us = rtc::TimeUTCMicros();
+    start_time_ms_ = rtc::TimeMillis();
+
+    uint8_t header[kFileHeaderSize] = { 0 };
+    webrtc::ByteWriter<uint32_t>::WriteBigEndian(header,
+        (uint32_t)(now_us / rtc::kNumMicrosecsPerSec));
+    webrtc::ByteWriter<uint32_t>::WriteBigEndian(header + 4,
+        (uint32_t)(now_us % rtc::kNumMicrosecsPerSec));
+    writer_.Write(kFirstLine, sizeof(kFirstLine) - 1, header, sizeof(header));
+
+    return true;
+}
+
+void RtpDumpSink::Setup(const std::string& json_config) {
+    JsonValue value;
+    value.FromJson(json_config);
+    JsonObject jobj = value.ToObject();
+    JsonObject jrtp_dump_sink = jobj["rtp_dump_sink"].ToObject();
+    path_ = jrtp_dump_sink["path"].ToString();
+}
+
+void RtpDumpSink::Stop() {
+    RTC_LOG(LS_INFO) << "RtpDumpSink Stop";
+    writer_.Close();
+}
+
+// 在pacer线程或者网络线程中调用，只做内存拷贝
+void RtpDumpSink::OnPacketSent(PeerConnection*, const uint8_t* data, size_t len,
+    bool is_rtcp, int64_t send_time_ms)
+{
+    if (len > kMaxPacketSize) {
+        return;
+    }
+
+    uint8_t header[kPacketHeaderSize];
+    webrtc::ByteWriter<uint16_t>::WriteBigEndian(header,
+        (uint16_t)(len + kPacketHeaderSize));
+    webrtc::ByteWriter<uint16_t>::WriteBigEndian(header + 2,
+        is_rtcp ? 0 : (uint16_t)len);
+    webrtc::ByteWriter<uint32_t>::WriteBigEndian(header + 4,
+        (uint32_t)(send_time_ms - start_time_ms_));
+    writer_.Write(header, sizeof(header), data, len);
+}
+
+} // namespace xrtc
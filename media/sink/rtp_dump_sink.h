@@ -0,0 +1,47 @@
+﻿#ifndef XRTCSDK_XRTC_MEDIA_SINK_RTP_DUMP_SINK_H_
+#define XRTCSDK_XRTC_MEDIA_SINK_RTP_DUMP_SINK_H_
+
+#include <string>
+
+#include <rtc_base/third_party/sigslot/sigslot.h>
+
+#include "xrtc/base/async_file_writer.h"
+#include "xrtc/media/base/media_chain.h"
+
+namespace xrtc {
+
+class PeerConnection;
+
+// 将发送到网络的RTP和RTCP包保存为rtpdump格式，可以用wireshark或者rtpplay分析
+// 连接到PeerConnection::SignalPacketSent，在发送线程中只拷贝数据，由写线程写入磁盘
+// 配置示例：{"rtp_dump_sink": {"path": "push.rtpdump"}}
+class RtpDumpSink : public MediaObject,
+                    public sigslot::has_slots<>
+{
+public:
+    RtpDumpSink();
+    ~RtpDumpSink() override;
+
+    // MediaObject
+    bool Start() override;
+    void Setup(const std::string& json_config) override;
+    void Stop() override;
+    std::vector<InPin*> GetAllInPins() override {
+        return std::vector<InPin*>();
+    }
+    std::vector<OutPin*> GetAllOutPins() override {
+        return std::vector<OutPin*>();
+    }
+
+    void OnPacketSent(PeerConnection*, const uint8_t* data, size_t len,
+        bool is_rtcp, int64_t send_time_ms);
+
+private:
+    std::string path_;
+    AsyncFileWriter writer_;
+    int64_t start_time_ms_ = 0;
+};
+
+} // namespace xrtc
+
+#endif // XRTCSDK_XRTC_MEDIA_SINK_RTP_DUMP_SINK_H_
@@ -9,6 +9,8 @@
 #include "xrtc/base/xrtc_utils.h"
 #include "xrtc/media/base/in_pin.h"
 #include "xrtc/rtc/modules/rtp_rtcp/rtp_format_h264.h"
+#include "xrtc/media/filter/frame_rate_adapter_filter.h"
+#include "xrtc/media/filter/video_scaler_filter.h"
 #include "xrtc/media/filter/x264_encoder_filter.h"
 namespace xrtc {
 
@@ -27,6 +29,7 @@ XRTCMediaSink::XRTCMediaSink(MediaChain* media_chain) :
     pc_->SignalConnectionState.connect(this, &XRTCMediaSink::OnConnectionState);
     pc_->SignalNetworkInfo.connect(this, &XRTCMediaSink::OnNetworkInfo);
     pc_->SignalTargetTransferRate.connect(this, &XRTCMediaSink::OnTargetTransferRate);
+    pc_->SignalFrameLatencyStats.connect(this, &XRTCMediaSink::OnFrameLatencyStats);
 }
 
 XRTCMediaSink::~XRTCMediaSink() {
@@ -89,6 +92,8 @@ bool XRTCMediaSink::Start() {
         RTCOfferAnswerOptions options;
         options.recv_audio = false;// 推流模式：只发送，不接收
         options.recv_video = false;
+        options.video_simulcast_layers = simulcast_layers_;
+        options.video_temporal_layers = temporal_layers_;
         std::string answer = pc_->CreateAnswer(options, request_params_["uid"]);
         SendAnswer(answer); //发送Answer给服务器
 
@@ -103,6 +108,10 @@ void XRTCMediaSink::Setup(const std::string& json_config) {
     JsonObject jobj = value.ToObject();
     JsonObject jxrtc_media_sink = jobj["xrtc_media_sink"].ToObject();
     url_ = jxrtc_media_sink["url"].ToString();
+    simulcast_layers_ = (int)jxrtc_media_sink["simulcast"].ToInt(1);
+    rate_allocator_ = SimulcastRateAllocator(simulcast_layers_);
+    simulcast_layers_ = (int)rate_allocator_.num_layers();
+    temporal_layers_ = (int)jxrtc_media_sink["temporal_layers"].ToInt(1);
 }
 
 void XRTCMediaSink::Stop() {
@@ -112,8 +121,8 @@ void XRTCMediaSink::Stop() {
 }
 
 void XRTCMediaSink::OnNewMediaFrame(std::shared_ptr<MediaFrame> frame) {
-    // 通过网络线程，将x264压缩后的数据发送到服务器
-    XRTCGlobal::Instance()->network_thread()->PostTask(webrtc::ToQueuedTask([=]() {
+    // 通过连接所在的网络线程，将x264压缩后的数据发送到服务器
+    pc_->network_thread()->PostTask(webrtc::ToQueuedTask([=]() {
         if (MainMediaType::kMainTypeVideo == frame->fmt.media_type) {
             PacketAndSendVideo(frame);
         }
@@ -125,8 +134,10 @@ void XRTCMediaSink::OnNetworkInfo(PeerConnection*, int64_t rtt_ms,
 {
     XRTCGlobal::Instance()->api_thread()->PostTask(
         webrtc::ToQueuedTask([=]() {
-            XRTCGlobal::Instance()->engine_observer()->OnNetworkInfo(
-                rtt_ms, packets_lost, fraction_lost, jitter);
+            if (XRTCGlobal::Instance()->engine_observer()) {
+                XRTCGlobal::Instance()->engine_observer()->OnNetworkInfo(
+                    rtt_ms, packets_lost, fraction_lost, jitter);
+            }
         }));
 }
 
@@ -145,14 +156,46 @@ void XRTCMediaSink::OnConnectionState(PeerConnection*,
     }
 }
 
+//发送端每个阶段的延迟统计，在api线程中回调给上层
+void XRTCMediaSink::OnFrameLatencyStats(PeerConnection*, const FrameLatencyStats& stats) {
+    XRTCGlobal::Instance()->api_thread()->PostTask(
+        webrtc::ToQueuedTask([=]() {
+            if (XRTCGlobal::Instance()->engine_observer()) {
+                XRTCGlobal::Instance()->engine_observer()->OnFrameLatencyStats(stats);
+            }
+        }));
+}
+
 //设置编码器比特率
 void XRTCMediaSink::OnTargetTransferRate(PeerConnection*, const webrtc::TargetTransferRate& target_bitrate) {
     XRTCGlobal::Instance()->worker_thread()->PostTask(
         webrtc::ToQueuedTask([=]() {
-            MediaObject* obj = media_chain_->FindObjectById(MediaObjectId::kMidX264EncoderFilterId);
-            if (obj) {
+            // 按层分配码率，分不到码率的层暂停编码
+            std::vector<webrtc::DataRate> allocation =
+                rate_allocator_.Allocate(target_bitrate.target_bitrate);
+            for (auto obj : media_chain_->FindObjectsById(MediaObjectId::kMidX264EncoderFilterId)) {
                 X264EncoderFilter* encoder_filter = dynamic_cast<X264EncoderFilter*>(obj);
-                encoder_filter->SetBitrate(target_bitrate.target_bitrate);
+                size_t index = encoder_filter->simulcast_index();
+                if (index >= allocation.size()) {
+                    continue;
+                }
+
+                encoder_filter->SetActive(!allocation[index].IsZero());
+                encoder_filter->SetBitrate(allocation[index]);
+            }
+
+            // 码率变化时调整编码分辨率，只有最高层做自适应，低层使用固定的分辨率
+            webrtc::DataRate top_bitrate = allocation.back();
+            MediaObject* obj = media_chain_->FindObjectById(MediaObjectId::kMidVideoScalerFilterId);
+            if (obj) {
+                VideoScalerFilter* scaler_filter = dynamic_cast<VideoScalerFilter*>(obj);
+                scaler_filter->SetTargetBitrate(top_bitrate);
+            }
+
+            obj = media_chain_->FindObjectById(MediaObjectId::kMidFrameRateAdapterFilterId);
+            if (obj) {
+                FrameRateAdapterFilter* adapter_filter = dynamic_cast<FrameRateAdapterFilter*>(obj);
+                adapter_filter->SetTargetBitrate(top_bitrate);
             }
         }));
 }
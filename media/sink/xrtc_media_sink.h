@@ -6,6 +6,7 @@
 
 #include "xrtc/media/base/media_chain.h"
 #include "xrtc/rtc/pc/peer_connection.h"
+#include "xrtc/rtc/video/simulcast_rate_allocator.h"
 
 namespace xrtc {
 
@@ -33,12 +34,15 @@ public:
         return std::vector<OutPin*>();
     }
 
+    PeerConnection* peer_connection() { return pc_.get(); }
+
 private:
     void OnNetworkInfo(PeerConnection*, int64_t rtt_ms,
         int32_t packets_lost, uint8_t fraction_lost,
         uint32_t jitter);
     void OnConnectionState(PeerConnection*, PeerConnectionState pc_state);
     void OnTargetTransferRate(PeerConnection*, const webrtc::TargetTransferRate& target_bitrate);
+    void OnFrameLatencyStats(PeerConnection*, const FrameLatencyStats& stats);
     
     bool ParseReply(const HttpReply& reply, std::string& type, std::string& sdp);
     void SendAnswer(const std::string& answer);
@@ -54,6 +58,11 @@ private:
     std::string action_;
     std::map<std::string, std::string> request_params_;
     std::unique_ptr<PeerConnection> pc_;
+    // simulcast的层数，每一层对应一个编码器
+    int simulcast_layers_ = 1;
+    // 时间分层的层数，和编码器保持一致
+    int temporal_layers_ = 1;
+    SimulcastRateAllocator rate_allocator_;
 };
 
 } // namespace xrtc
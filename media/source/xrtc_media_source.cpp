@@ -0,0 +1,256 @@
+﻿#include "xrtc/media/source/xrtc_media_source.h"
+
+#include <rtc_base/logging.h>
+#include <rtc_base/task_utils/to_queued_task.h>
+
+#include "xrtc/base/xrtc_global.h"
+#include "xrtc/base/xrtc_http.h"
+#include "xrtc/base/xrtc_json.h"
+#include "xrtc/base/xrtc_utils.h"
+#include "xrtc/media/base/out_pin.h"
+
+namespace xrtc {
+
+XRTCMediaSource::XRTCMediaSource(MediaChain* media_chain) :
+    media_chain_(media_chain),
+    video_out_pin_(std::make_unique<OutPin>(this)),
+    pc_(std::make_unique<PeerConnection>())
+{
+    MediaFormat video_fmt;
+    video_fmt.media_type = MainMediaType::kMainTypeVideo;
+    video_fmt.sub_fmt.video_fmt.type = SubMediaType::kSubTypeH264;
+    video_out_pin_->set_format(video_fmt);
+
+    XRTCGlobal::Instance()->http_manager()->AddObject(this);
+
+    pc_->SignalConnectionState.connect(this, &XRTCMediaSource::OnConnectionState);
+    pc_->SignalNetworkInfo.connect(this, &XRTCMediaSource::OnNetworkInfo);
+    pc_->SignalVideoFrame.connect(this, &XRTCMediaSource::OnVideoFrame);
+}
+
+XRTCMediaSource::~XRTCMediaSource() {
+    XRTCGlobal::Instance()->http_manager()->RemoveObject(this);
+}
+
+bool XRTCMediaSource::Start() {
+    // 解析拉流URL
+    if (!ParseUrl(url_, protocol_, host_, action_, request_params_)) {
+        return false;
+    }
+
+    if (action_ != "pull" || request_params_["uid"].empty() || request_params_["streamName"].empty()) {
+        RTC_LOG(LS_WARNING) << "invalid url: " << url_;
+        return false;
+    }
+
+    // 发送信令请求
+    // https://www.str2num.com/signaling/pull?uid=xxx&streamName=xxx&audio=1&video=1
+    std::stringstream body;
+    body << "uid=" << request_params_["uid"]
+        << "&streamName=" << request_params_["streamName"]
+        << "&audio=1&video=1";
+    std::string url = "https://" + host_ + "/signaling/pull";
+    HttpRequest request(url, body.str());
+
+    XRTCGlobal::Instance()->http_manager()->Post(request, [=](HttpReply reply) {
+        RTC_LOG(LS_INFO) << "signaling pull response, url: " << reply.get_url()
+            << ", body: " << reply.get_body()
+            << ", status: " << reply.get_status_code()
+            << ", err_no: " << reply.get_errno()
+            << ", err_msg: " << reply.get_err_msg()
+            << ", response: " << reply.get_resp();
+
+        std::string type;
+        std::string sdp;
+
+        if (!ParseReply(reply, type, sdp)) {
+            if (media_chain_) {
+                media_chain_->OnChainFailed(this, XRTCError::kPullRequestOfferErr);
+            }
+            return;
+        }
+
+        if (pc_->SetRemoteSDP(sdp) != 0) {
+            return;
+        }
+
+        RTCOfferAnswerOptions options;
+        options.send_audio = false;// 拉流模式：只接收，不发送
+        options.send_video = false;
+        options.recv_audio = false;// 还不支持接收音频
+        options.recv_video = true;
+        std::string answer = pc_->CreateAnswer(options, request_params_["uid"]);
+        SendAnswer(answer);
+
+    }, this);
+
+    return true;
+}
+
+void XRTCMediaSource::Setup(const std::string& json_config) {
+    JsonValue value;
+    value.FromJson(json_config);
+    JsonObject jobj = value.ToObject();
+    JsonObject jxrtc_media_source = jobj["xrtc_media_source"].ToObject();
+    url_ = jxrtc_media_source["url"].ToString();
+}
+
+void XRTCMediaSource::Stop() {
+    RTC_LOG(LS_INFO) << "XRTCMediaSource Stop";
+    // 向后台服务发送停止拉流请求
+    SendStop();
+}
+
+void XRTCMediaSource::OnNetworkInfo(PeerConnection*, int64_t rtt_ms,
+    int32_t packets_lost, uint8_t fraction_lost, uint32_t jitter)
+{
+    XRTCGlobal::Instance()->api_thread()->PostTask(
+        webrtc::ToQueuedTask([=]() {
+            if (XRTCGlobal::Instance()->engine_observer()) {
+                XRTCGlobal::Instance()->engine_observer()->OnNetworkInfo(
+                    rtt_ms, packets_lost, fraction_lost, jitter);
+            }
+        }));
+}
+
+void XRTCMediaSource::OnConnectionState(PeerConnection*,
+    PeerConnectionState pc_state)
+{
+    if (PeerConnectionState::kConnected == pc_state) {
+        if (media_chain_) {
+            media_chain_->OnChainSuccess();
+        }
+    }
+    else if (PeerConnectionState::kFailed == pc_state) {
+        if (media_chain_) {
+            media_chain_->OnChainFailed(this, XRTCError::kPullIceConnectionErr);
+        }
+    }
+}
+
+void XRTCMediaSource::OnKeyFrameRequest(H264DecoderFilter*) {
+    pc_->RequestKeyFrame();
+}
+
+// 在网络线程中回调，解码器只是把帧放入队列，不会阻塞网络线程
+void XRTCMediaSource::OnVideoFrame(PeerConnection*, std::shared_ptr<MediaFrame> frame) {
+    if (video_out_pin_) {
+        video_out_pin_->PushMediaFrame(frame);
+    }
+}
+
+bool XRTCMediaSource::ParseReply(const HttpReply& reply, std::string& type,
+    std::string& sdp)
+{
+    if (reply.get_status_code() != 200 || reply.get_errno() != 0) {
+        RTC_LOG(LS_WARNING) << "signaling response error";
+        return false;
+    }
+
+    JsonValue value;
+    if (!value.FromJson(reply.get_resp())) {
+        RTC_LOG(LS_WARNING) << "invalid json response";
+        return false;
+    }
+
+    JsonObject jobj = value.ToObject();
+    int err_no = jobj["errNo"].ToInt();
+    if (err_no != 0) {
+        RTC_LOG(LS_WARNING) << "response errNo is not 0, err_no: " << err_no;
+        return false;
+    }
+
+    JsonObject data = jobj["data"].ToObject();
+    type = data["type"].ToString();
+    sdp = data["sdp"].ToString();
+
+    if (sdp.empty()) {
+        RTC_LOG(LS_WARNING) << "sdp is empty";
+        return false;
+    }
+
+    return true;
+}
+
+void XRTCMediaSource::SendAnswer(const std::string& answer) {
+    if (request_params_["uid"].empty() || request_params_["streamName"].empty()) {
+        RTC_LOG(LS_WARNING) << "send answer failed, invalid url: " << url_;
+        return;
+    }
+
+    std::stringstream body;
+    body << "uid=" << request_params_["uid"]
+        << "&streamName=" << request_params_["streamName"]
+        << "&type=pull"
+        << "&answer=" << HttpManager::UrlEncode(answer);
+
+    std::string url = "https://" + host_ + "/signaling/sendanswer";
+    HttpRequest request(url, body.str());
+    XRTCGlobal::Instance()->http_manager()->Post(request, [=](HttpReply reply) {
+        RTC_LOG(LS_INFO) << "signaling sendanswer response, url: " << reply.get_url()
+            << ", body: " << reply.get_body()
+            << ", status: " << reply.get_status_code()
+            << ", err_no: " << reply.get_errno()
+            << ", err_msg: " << reply.get_err_msg()
+            << ", response: " << reply.get_resp();
+
+        if (reply.get_status_code() != 200 || reply.get_errno() != 0) {
+            RTC_LOG(LS_WARNING) << "signaling sendanswer response error";
+            return;
+        }
+
+        JsonValue value;
+        if (!value.FromJson(reply.get_resp())) {
+            RTC_LOG(LS_WARNING) << "invalid json response";
+            return;
+        }
+
+        JsonObject jobj = value.ToObject();
+        int err_no = jobj["errNo"].ToInt();
+        if (err_no != 0) {
+            RTC_LOG(LS_WARNING) << "response errNo is not 0, err_no: " << err_no;
+            return;
+        }
+
+    }, this);
+}
+
+void XRTCMediaSource::SendStop() {
+    // 发送停止拉流的信令请求
+    // https://www.str2num.com/signaling/stoppull?uid=xxx&streamName=xxx
+    std::stringstream body;
+    body << "uid=" << request_params_["uid"]
+        << "&streamName=" << request_params_["streamName"];
+    std::string url = "https://" + host_ + "/signaling/stoppull";
+    HttpRequest request(url, body.str());
+
+    XRTCGlobal::Instance()->http_manager()->Post(request, [=](HttpReply reply) {
+        RTC_LOG(LS_INFO) << "signaling stoppull response, url: " << reply.get_url()
+            << ", body: " << reply.get_body()
+            << ", status: " << reply.get_status_code()
+            << ", err_no: " << reply.get_errno()
+            << ", err_msg: " << reply.get_err_msg()
+            << ", response: " << reply.get_resp();
+
+        if (reply.get_status_code() != 200 || reply.get_errno() != 0) {
+            RTC_LOG(LS_WARNING) << "signaling stoppull response error";
+            return;
+        }
+
+        JsonValue value;
+        if (!value.FromJson(reply.get_resp())) {
+            RTC_LOG(LS_WARNING) << "invalid json response";
+            return;
+        }
+
+        JsonObject jobj = value.ToObject();
+        int err_no = jobj["errNo"].ToInt();
+        if (err_no != 0) {
+            RTC_LOG(LS_WARNING) << "response errNo is not 0, err_no: " << err_no;
+            return;
+        }
+
+    }, this);
+}
+
+} // namespace xrtc
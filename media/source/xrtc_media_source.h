@@ -0,0 +1,67 @@
+﻿#ifndef XRTCSDK_XRTC_MEDIA_SOURCE_XRTC_MEDIA_SOURCE_H_
+#define XRTCSDK_XRTC_MEDIA_SOURCE_XRTC_MEDIA_SOURCE_H_
+
+#include <string>
+#include <map>
+
+#include "xrtc/media/base/media_chain.h"
+#include "xrtc/rtc/pc/peer_connection.h"
+
+namespace xrtc {
+
+class InPin;
+class OutPin;
+class HttpReply;
+class H264DecoderFilter;
+
+// 拉流的数据源，和XRTCMediaSink对应
+// 通过信令服务和服务器建立只接收的PeerConnection，输出接收到的完整H264帧
+// 配置示例：{"xrtc_media_source": {"url": "xrtc://www.str2num.com/pull?uid=xxx&streamName=xxx"}}
+class XRTCMediaSource : public MediaObject,
+                        public sigslot::has_slots<>
+{
+public:
+    XRTCMediaSource(MediaChain* media_chain);
+    ~XRTCMediaSource() override;
+
+    // MediaObject
+    bool Start() override;
+    void Setup(const std::string& json_config) override;
+    void Stop() override;
+    std::vector<InPin*> GetAllInPins() override {
+        return std::vector<InPin*>();
+    }
+
+    std::vector<OutPin*> GetAllOutPins() override {
+        return std::vector<OutPin*>({ video_out_pin_.get() });
+    }
+
+    PeerConnection* peer_connection() { return pc_.get(); }
+    // 下游解码器需要关键帧，通过PLI向远端请求
+    void OnKeyFrameRequest(H264DecoderFilter*);
+
+private:
+    void OnNetworkInfo(PeerConnection*, int64_t rtt_ms,
+        int32_t packets_lost, uint8_t fraction_lost,
+        uint32_t jitter);
+    void OnConnectionState(PeerConnection*, PeerConnectionState pc_state);
+    void OnVideoFrame(PeerConnection*, std::shared_ptr<MediaFrame> frame);
+
+    bool ParseReply(const HttpReply& reply, std::string& type, std::string& sdp);
+    void SendAnswer(const std::string& answer);
+    void SendStop();
+
+private:
+    MediaChain* media_chain_;
+    std::unique_ptr<OutPin> video_out_pin_;
+    std::string url_;
+    std::string protocol_;
+    std::string host_;
+    std::string action_;
+    std::map<std::string, std::string> request_params_;
+    std::unique_ptr<PeerConnection> pc_;
+};
+
+} // namespace xrtc
+
+#endif // XRTCSDK_XRTC_MEDIA_SOURCE_XRTC_MEDIA_SOURCE_H_
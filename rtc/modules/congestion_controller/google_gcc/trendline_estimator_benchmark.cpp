@@ -0,0 +1,41 @@
+#include "xrtc/rtc/modules/congestion_controller/google_gcc/trendline_estimator.h"
+
+#include <benchmark/benchmark.h>
+#include <system_wrappers/include/clock.h>
+
+namespace xrtc {
+
+namespace {
+const int64_t kSendDeltaMs = 5;
+const size_t kPacketSize = 1200;
+// 每kPhaseLength个包组切换一次，先排队增长出现过载，再排空恢复正常
+const int kPhaseLength = 200;
+
+} // namespace
+
+// 每次迭代输入一个包组的时间差，到达时间由SimulatedClock推进
+void BM_TrendlineEstimatorUpdate(benchmark::State& state) {
+    webrtc::SimulatedClock clock(100000000);
+    TrendlineEstimator estimator;
+    int64_t num_deltas = 0;
+    int64_t num_overusing = 0;
+    for (auto _ : state) {
+        bool queue_building = (num_deltas / kPhaseLength) % 2 == 0;
+        int64_t recv_delta_ms = kSendDeltaMs + (queue_building ? 1 : -1);
+        clock.AdvanceTimeMilliseconds(recv_delta_ms);
+        estimator.Update(webrtc::TimeDelta::Millis(recv_delta_ms),
+            webrtc::TimeDelta::Millis(kSendDeltaMs),
+            webrtc::TimeDelta::Millis(clock.TimeInMilliseconds()),
+            kPacketSize, true);
+        if (estimator.State() == webrtc::BandwidthUsage::kBwOverusing) {
+            ++num_overusing;
+        }
+        ++num_deltas;
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["overusing_ratio"] = benchmark::Counter(
+        (double)num_overusing / num_deltas);
+}
+BENCHMARK(BM_TrendlineEstimatorUpdate);
+
+} // namespace xrtc
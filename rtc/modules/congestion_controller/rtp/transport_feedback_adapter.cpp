@@ -93,7 +93,8 @@ std::vector<webrtc::PacketResult> TransportFeedbackAdapter::ProcessTransportFeed
 
         size_t failed_lookups = 0;//查找失败的数量
         webrtc::TimeDelta packet_offset = webrtc::TimeDelta::Zero();
-        for(const auto& packet : feedback.AllPackets()) {
+        //直接遍历feedback中原始的包状态，不再构造中间的vector
+        feedback.ForEachPacket([&](const rtcp::TransportFeedback::ReceivePacket& packet) {
             int64_t seq_num =seq_num_unwrapper_.Unwrap(packet.sequence_number());
             //因为可能会发生乱序，所以需要判断seq_num是否大于last_ack_seq_num_，这样才保证存储的是最新的
             if(seq_num > last_ack_seq_num_) {
@@ -103,12 +104,12 @@ std::vector<webrtc::PacketResult> TransportFeedbackAdapter::ProcessTransportFeed
             auto it = history_.find(seq_num);
             if( it ==history_.end()) {
                 ++failed_lookups;
-                continue;
+                return;
             }
             //包还没有发送就已经收到了feedback的信息(一般是不存在这个情况)
             if(it->second.sent.send_time.IsFinite()) {
                 RTC_LOG(LS_WARNING) << "TransportFeedbackAdapter::ProcessTransportFeedbackInner: packet has already been sent";
-                continue;
+                return;
             }
 
             PacketFeedback packet_feedback = it->second;
@@ -125,7 +126,7 @@ std::vector<webrtc::PacketResult> TransportFeedbackAdapter::ProcessTransportFeed
             result.sent_packet = packet_feedback.sent;
             result.receive_time = packet_feedback.receive_time;
             packet_results_vector.push_back(result);
-        }
+        });
         return packet_results_vector;
 }
 
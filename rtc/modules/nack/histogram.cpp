@@ -15,7 +15,7 @@
  *  
  **/
 
-#include "modules/video_coding/histogram.h"
+#include "xrtc/rtc/modules/nack/histogram.h"
 
 namespace xrtc {
 
@@ -0,0 +1,195 @@
+/***************************************************************************
+ *
+ * Copyright (c) 2023 str2num.com, Inc. All Rights Reserved
+ * $Id$
+ *
+ **************************************************************************/
+
+
+
+/**
+ * @file nack_list.cpp
+ * @author str2num
+ * @version $Revision$
+ * @brief
+ *
+ **/
+
+#include "xrtc/rtc/modules/nack/nack_list.h"
+
+#include <algorithm>
+
+#include <rtc_base/checks.h>
+#include <rtc_base/numerics/sequence_number_util.h>
+
+namespace xrtc {
+namespace {
+
+const size_t kIndexMask = NackList::kWindowSize - 1;
+const size_t kBitsPerWord = 64;
+
+} // namespace
+
+NackList::NackList(size_t capacity) :
+    slots_(kWindowSize, kInvalidIndex),
+    bitmap_(kWindowSize / kBitsPerWord, 0),
+    entries_(std::min<size_t>(capacity, kInvalidIndex))
+{
+    // 65536是窗口大小的整数倍，seq回绕之后下标仍然连续
+    static_assert((kWindowSize & kIndexMask) == 0, "window size must be power of 2");
+    static_assert(65536 % kWindowSize == 0, "window size must divide 65536");
+
+    free_entries_.reserve(entries_.size());
+    for (size_t i = entries_.size(); i > 0; --i) {
+        free_entries_.push_back(static_cast<uint16_t>(i - 1));
+    }
+}
+
+NackList::~NackList() {
+}
+
+bool NackList::Insert(uint16_t seq_num, uint16_t send_at_seq_num,
+        int64_t created_time)
+{
+    if (free_entries_.empty()) {
+        return false;
+    }
+
+    if (!empty()) {
+        RTC_DCHECK(webrtc::AheadOf(seq_num, newest_seq_num_));
+        // 清理超出窗口的旧包，避免和新包使用同一个位置
+        if (webrtc::ForwardDiff(oldest_seq_num_, seq_num) >= kWindowSize) {
+            EraseOlderThan(static_cast<uint16_t>(seq_num - kWindowSize + 1));
+        }
+    }
+
+    if (empty()) {
+        oldest_seq_num_ = seq_num;
+    }
+    newest_seq_num_ = seq_num;
+
+    uint16_t entry = free_entries_.back();
+    free_entries_.pop_back();
+    entries_[entry] = NackInfo(seq_num, send_at_seq_num, created_time);
+
+    size_t index = seq_num & kIndexMask;
+    slots_[index] = entry;
+    bitmap_[index / kBitsPerWord] |= (uint64_t)1 << (index % kBitsPerWord);
+    ++size_;
+    return true;
+}
+
+NackInfo* NackList::Find(uint16_t seq_num) {
+    if (empty() || webrtc::AheadOf(seq_num, newest_seq_num_) ||
+        webrtc::AheadOf(oldest_seq_num_, seq_num))
+    {
+        return nullptr;
+    }
+
+    uint16_t entry = slots_[seq_num & kIndexMask];
+    if (kInvalidIndex == entry || entries_[entry].seq_num != seq_num) {
+        return nullptr;
+    }
+
+    return &entries_[entry];
+}
+
+void NackList::Erase(uint16_t seq_num) {
+    if (Find(seq_num)) {
+        Release(seq_num);
+    }
+}
+
+size_t NackList::EraseOlderThan(uint16_t seq_num) {
+    if (empty() || !webrtc::AheadOf(seq_num, oldest_seq_num_)) {
+        return 0;
+    }
+
+    size_t count = std::min<size_t>(webrtc::ForwardDiff(oldest_seq_num_, seq_num),
+            webrtc::ForwardDiff(oldest_seq_num_, newest_seq_num_) + 1);
+    size_t erased = 0;
+    uint16_t start = oldest_seq_num_;
+    int offset = 0;
+    while ((offset = FindNext(start, count)) >= 0) {
+        uint16_t found = start + offset;
+        Release(found);
+        ++erased;
+        start = found + 1;
+        count -= offset + 1;
+    }
+
+    oldest_seq_num_ = seq_num;
+    return erased;
+}
+
+void NackList::Clear() {
+    if (!empty()) {
+        EraseOlderThan(newest_seq_num_ + 1);
+    }
+}
+
+NackInfo* NackList::First() {
+    if (empty()) {
+        return nullptr;
+    }
+
+    int offset = FindNext(oldest_seq_num_,
+            webrtc::ForwardDiff(oldest_seq_num_, newest_seq_num_) + 1);
+    if (offset < 0) {
+        return nullptr;
+    }
+
+    // 顺便把oldest_seq_num_移动到最旧的包，下次不用再跳过前面空的区域
+    oldest_seq_num_ += offset;
+    return &entries_[slots_[oldest_seq_num_ & kIndexMask]];
+}
+
+NackInfo* NackList::Next(uint16_t seq_num) {
+    if (empty() || !webrtc::AheadOf(newest_seq_num_, seq_num)) {
+        return nullptr;
+    }
+
+    uint16_t start = seq_num + 1;
+    if (webrtc::AheadOf(oldest_seq_num_, start)) {
+        start = oldest_seq_num_;
+    }
+
+    int offset = FindNext(start, webrtc::ForwardDiff(start, newest_seq_num_) + 1);
+    if (offset < 0) {
+        return nullptr;
+    }
+
+    return &entries_[slots_[(start + offset) & kIndexMask]];
+}
+
+int NackList::FindNext(uint16_t seq_num, size_t count) const {
+    size_t offset = 0;
+    while (offset < count) {
+        size_t index = (seq_num + offset) & kIndexMask;
+        size_t bit = index % kBitsPerWord;
+        uint64_t word = bitmap_[index / kBitsPerWord] >> bit;
+        if (word) {
+            while (!(word & 1)) {
+                word >>= 1;
+                ++offset;
+            }
+            return offset < count ? static_cast<int>(offset) : -1;
+        }
+
+        offset += kBitsPerWord - bit;
+    }
+
+    return -1;
+}
+
+void NackList::Release(uint16_t seq_num) {
+    size_t index = seq_num & kIndexMask;
+    free_entries_.push_back(slots_[index]);
+    slots_[index] = kInvalidIndex;
+    bitmap_[index / kBitsPerWord] &= ~((uint64_t)1 << (index % kBitsPerWord));
+    --size_;
+}
+
+} // namespace xrtc
+
+
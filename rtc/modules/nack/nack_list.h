@@ -0,0 +1,98 @@
+/***************************************************************************
+ *
+ * Copyright (c) 2023 str2num.com, Inc. All Rights Reserved
+ * $Id$
+ *
+ **************************************************************************/
+
+
+
+/**
+ * @file nack_list.h
+ * @author str2num
+ * @version $Revision$
+ * @brief
+ *
+ **/
+
+
+
+#ifndef XRTCSDK_XRTC_RTC_MODULES_NACK_NACK_LIST_H_
+#define XRTCSDK_XRTC_RTC_MODULES_NACK_NACK_LIST_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace xrtc {
+
+struct NackInfo {
+    NackInfo() : seq_num(0), send_at_seq_num(0),
+        created_time(-1), send_at_time(-1),
+        retries(0) {}
+    NackInfo(uint16_t seq_num, uint16_t send_at_seq_num, int64_t created_time) :
+        seq_num(seq_num),
+        send_at_seq_num(send_at_seq_num),
+        created_time(created_time),
+        send_at_time(-1), retries(0) {}
+
+    uint16_t seq_num;
+    uint16_t send_at_seq_num;
+    int64_t created_time;
+    int64_t send_at_time;
+    int retries;
+};
+
+// 等待重传的包列表，按照seq从旧到新排列
+// 使用固定大小的窗口，按照seq直接索引，插入、查找、删除都是O(1)，不需要为每个包分配内存
+// bitmap记录窗口中哪些位置有包，遍历时可以按64位整块跳过空的区域
+// 列表中的seq必须在最近kWindowSize个seq之内，插入更新的seq时会清理超出窗口的旧包
+class NackList {
+public:
+    static constexpr size_t kWindowSize = 1 << 14;
+
+    // capacity是列表中最多可以同时保存的包的个数
+    explicit NackList(size_t capacity);
+    ~NackList();
+
+    size_t size() const { return size_; }
+    bool empty() const { return 0 == size_; }
+
+    // seq_num必须比列表中所有的seq都新，列表已满时返回false
+    bool Insert(uint16_t seq_num, uint16_t send_at_seq_num, int64_t created_time);
+    NackInfo* Find(uint16_t seq_num);
+    void Erase(uint16_t seq_num);
+    // 删除比seq_num旧的所有包，返回删除的个数
+    size_t EraseOlderThan(uint16_t seq_num);
+    void Clear();
+
+    // 按照从旧到新的顺序遍历，遍历过程中可以删除当前的包
+    // for (NackInfo* info = First(); info; info = Next(info->seq_num))
+    NackInfo* First();
+    NackInfo* Next(uint16_t seq_num);
+
+private:
+    // 从seq_num开始向新的方向最多查找count个位置，返回第一个有包的位置相对seq_num的偏移
+    // 找不到返回-1
+    int FindNext(uint16_t seq_num, size_t count) const;
+    void Release(uint16_t seq_num);
+
+private:
+    static constexpr uint16_t kInvalidIndex = 0xFFFF;
+
+    // 窗口中每个位置对应的包在entries_中的下标
+    std::vector<uint16_t> slots_;
+    std::vector<uint64_t> bitmap_;
+    std::vector<NackInfo> entries_;
+    std::vector<uint16_t> free_entries_;
+    size_t size_ = 0;
+    // 列表不为空时，所有的包都在[oldest_seq_num_, newest_seq_num_]之间
+    uint16_t oldest_seq_num_ = 0;
+    uint16_t newest_seq_num_ = 0;
+};
+
+} // namespace xrtc
+
+#endif // XRTCSDK_XRTC_RTC_MODULES_NACK_NACK_LIST_H_
+
+
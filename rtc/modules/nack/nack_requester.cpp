@@ -15,9 +15,11 @@
  *  
  **/
 
-#include "modules/video_coding/nack_requester.h"
+#include "xrtc/rtc/modules/nack/nack_requester.h"
 
 #include <rtc_base/logging.h>
+#include <rtc_base/thread.h>
+#include <rtc_base/task_utils/to_queued_task.h>
 
 namespace xrtc {
 namespace {
@@ -30,28 +32,26 @@ const int kMaxNackPackets = 1000;
 const int kMaxReorderingPackets = 128;
 const int kNumReorderingBuckets = 10;
 
-void nack_time_cb(EventLoop*, TimerWatcher*, void* data) {
-    NackRequester* requester = (NackRequester*)data;
-    requester->ProcessNacks();
-}
-
 } // namespace
 
-NackRequester::NackRequester(webrtc::Clock* clock, EventLoop* el) :
+NackRequester::NackRequester(webrtc::Clock* clock) :
     clock_(clock),
-    el_(el),
+    nack_list_(kMaxNackPackets),
     rtt_ms_(kDefaultRttMs),
     reordering_histogram_(kNumReorderingBuckets, kMaxReorderingPackets)
 {
-    nack_timer_ = el_->create_timer(nack_time_cb, this, true);
-    el_->start_timer(nack_timer_, kUpdateIntervalMs * 1000);
+    ScheduleProcessNacks();
 }
 
 NackRequester::~NackRequester() {
-    if (nack_timer_) {
-        el_->delete_timer(nack_timer_);
-        nack_timer_ = nullptr;
-    }
+}
+
+// 在当前线程定时执行，对象销毁之后task_safety_保证任务不再执行
+void NackRequester::ScheduleProcessNacks() {
+    rtc::Thread::Current()->PostDelayedTask(webrtc::ToQueuedTask(task_safety_, [this]() {
+        ProcessNacks();
+        ScheduleProcessNacks();
+    }), kUpdateIntervalMs);
 }
 
 void NackRequester::ProcessNacks() {
@@ -95,11 +95,11 @@ int NackRequester::OnReceivedPacket(uint16_t seq_num, bool is_keyframe,
     if (webrtc::AheadOf(newest_seq_num_, seq_num)) {
         // 判断seq_num是否已经在等待重传的列表里面
         // 如果存在，需要删除掉，不需要再重传了
-        auto nack_list_it = nack_list_.find(seq_num);
+        NackInfo* nack_info = nack_list_.Find(seq_num);
         int nacks_sent_for_packet = 0;
-        if (nack_list_it != nack_list_.end()) {
-            nacks_sent_for_packet = nack_list_it->second.retries;
-            nack_list_.erase(nack_list_it);
+        if (nack_info) {
+            nacks_sent_for_packet = nack_info->retries;
+            nack_list_.Erase(seq_num);
         }
         
         if (!is_retransmitted) {
@@ -149,9 +149,7 @@ size_t NackRequester::WaitNumberOfPackets(float probability) {
 
 bool NackRequester::RemovePacketsUntilKeyFrame() {
     while (!keyframe_list_.empty()) {
-        auto it = nack_list_.lower_bound(*keyframe_list_.begin());
-        if (it != nack_list_.begin()) {
-            nack_list_.erase(nack_list_.begin(), it);
+        if (nack_list_.EraseOlderThan(*keyframe_list_.begin()) > 0) {
             return true;
         }
 
@@ -166,8 +164,7 @@ bool NackRequester::RemovePacketsUntilKeyFrame() {
 void NackRequester::AddPacketsToNack(uint16_t seq_num_start, uint16_t seq_num_end) { 
     // 清理时间比较久的seq_num
     // 实现了比当前最新的seq_num小于kMaxPacketAge=10000的seq_num的清理
-    auto it = nack_list_.lower_bound(seq_num_end - kMaxPacketAge);
-    nack_list_.erase(nack_list_.begin(), it);
+    nack_list_.EraseOlderThan(seq_num_end - kMaxPacketAge);
     
     // 判断添加完新的seq_num之后，nack_list是否超过限制
     // 1. 计算当前新添加seq_num的个数
@@ -180,17 +177,18 @@ void NackRequester::AddPacketsToNack(uint16_t seq_num_start, uint16_t seq_num_en
 
         // 尽最大努力清理，但是仍然无法满足要求，放弃重传，直接请求关键帧
         if (nack_list_.size() + new_nack_num > kMaxNackPackets) {
-            nack_list_.clear();
-            // TODO: 直接请求关键帧
+            nack_list_.Clear();
             RTC_LOG(LS_WARNING) << "nack_list full, clear nack_list and request keyframe";
+            SignalKeyFrameRequest();
             return;
         }
     }
 
+    // 同一批丢失的包使用相同的创建时间和等待包数，只计算一次
+    int64_t now = clock_->TimeInMilliseconds();
+    uint16_t wait_packets = static_cast<uint16_t>(WaitNumberOfPackets(0.5));
     for (uint16_t seq_num = seq_num_start; seq_num != seq_num_end; ++seq_num) {
-        NackInfo nack_info(seq_num, seq_num + WaitNumberOfPackets(0.5),
-                clock_->TimeInMilliseconds());
-        nack_list_[seq_num] = nack_info;
+        nack_list_.Insert(seq_num, seq_num + wait_packets, now);
     }
 }
 
@@ -199,35 +197,32 @@ std::vector<uint16_t> NackRequester::GetNackBatch(NackFilterOptions options) {
     bool consider_timestamp = (options != kSeqNumOnly);
     int64_t now = clock_->TimeInMilliseconds();
     std::vector<uint16_t> nack_batch;
-    auto it = nack_list_.begin();
-    while (it != nack_list_.end()) {
-        bool delay_timeout = (now - it->second.created_time) >= send_nack_delay_ms_;
+    NackInfo* info = nack_list_.First();
+    while (info) {
+        uint16_t seq_num = info->seq_num;
+        bool delay_timeout = (now - info->created_time) >= send_nack_delay_ms_;
         // 判断基于丢包触发nack的条件是否满足
-        bool can_nack_seq_num_passed = (it->second.send_at_time == -1) &&
-            webrtc::AheadOf(newest_seq_num_, it->second.send_at_seq_num);
+        bool can_nack_seq_num_passed = (info->send_at_time == -1) &&
+            webrtc::AheadOf(newest_seq_num_, info->send_at_seq_num);
         // 判断基于定时触发nack的条件是否满足
         // 保证上一次的重传有充分的时间, 两次重传的间隔设置为rtt的时间
-        bool can_nack_timestamp_passed = (now - it->second.send_at_time) > rtt_ms_;
+        bool can_nack_timestamp_passed = (now - info->send_at_time) > rtt_ms_;
         if (delay_timeout && ((consider_seq_num && can_nack_seq_num_passed) ||
             (consider_timestamp && can_nack_timestamp_passed))) 
         {
             // 触发nack的发送
-            nack_batch.emplace_back(it->second.seq_num);
-            ++it->second.retries;
-            it->second.send_at_time = now;
+            nack_batch.emplace_back(seq_num);
+            ++info->retries;
+            info->send_at_time = now;
             // 当该包重传的次数已经达到10次，不要再重传了
-            if (it->second.retries >= kMaxNackRetries) {
-                nack_list_.erase(it++);
-                RTC_LOG(LS_WARNING) << "sequence number: " << it->second.seq_num
+            if (info->retries >= kMaxNackRetries) {
+                RTC_LOG(LS_WARNING) << "sequence number: " << seq_num
                     << " removed from nack list due to max retries";
-            } else {
-                ++it;
+                nack_list_.Erase(seq_num);
             }
-
-            continue;
         }
 
-        ++it;
+        info = nack_list_.Next(seq_num);
     }
 
     return nack_batch;
@@ -17,32 +17,36 @@
 
 
 
-#ifndef  __MODULES_VIDEO_CODING_NACK_REQUESTER_H_
-#define  __MODULES_VIDEO_CODING_NACK_REQUESTER_H_
+#ifndef XRTCSDK_XRTC_RTC_MODULES_NACK_NACK_REQUESTER_H_
+#define XRTCSDK_XRTC_RTC_MODULES_NACK_NACK_REQUESTER_H_
 
-#include <map>
 #include <vector>
 #include <set>
 
 #include <system_wrappers/include/clock.h>
 #include <rtc_base/numerics/sequence_number_util.h>
 #include <rtc_base/third_party/sigslot/sigslot.h>
+#include <rtc_base/task_utils/pending_task_safety_flag.h>
 
-#include "base/event_loop.h"
-#include "modules/video_coding/histogram.h"
+#include "xrtc/rtc/modules/nack/histogram.h"
+#include "xrtc/rtc/modules/nack/nack_list.h"
 
 namespace xrtc {
 
+// 在创建的线程上定时检查需要重传的包，所有的接口都需要在该线程调用
 class NackRequester {
 public:
-    NackRequester(webrtc::Clock* clock, EventLoop* el);
+    NackRequester(webrtc::Clock* clock);
     ~NackRequester();
    
     void ProcessNacks();
     void UpdateRtt(int64_t rtt_ms) { rtt_ms_ = rtt_ms; }
 
     int OnReceivedPacket(uint16_t seq_num, bool is_keyframe, bool is_retransmitted);
+    // nack列表按照seq从旧到新排列
     sigslot::signal1<const std::vector<uint16_t>&> SignalSendNack;
+    // 等待重传的包太多，放弃重传，需要请求关键帧
+    sigslot::signal0<> SignalKeyFrameRequest;
 
 private:
     enum NackFilterOptions {
@@ -51,44 +55,27 @@ private:
         kSeqNumAndTime, // 同时触发
     };
 
-    struct NackInfo {
-        NackInfo() : seq_num(0), send_at_seq_num(0),
-            created_time(-1), send_at_time(-1), 
-            retries(0) {}
-        NackInfo(uint16_t seq_num, uint16_t send_at_seq_num, int64_t created_time) :
-            seq_num(seq_num), 
-            send_at_seq_num(send_at_seq_num),
-            created_time(created_time),
-            send_at_time(-1), retries(0) {}
-        
-        uint16_t seq_num;
-        uint16_t send_at_seq_num;
-        int64_t created_time;
-        int64_t send_at_time;
-        int retries;
-    };
-    
     void AddPacketsToNack(uint16_t seq_num_start, uint16_t seq_num_end);
     std::vector<uint16_t> GetNackBatch(NackFilterOptions options);
     bool RemovePacketsUntilKeyFrame();
     void UpdateReorderingStat(uint16_t seq_num);
     size_t WaitNumberOfPackets(float probability);
+    void ScheduleProcessNacks();
 
 private:
     webrtc::Clock* clock_;
-    EventLoop* el_;
-    TimerWatcher* nack_timer_ = nullptr;
     bool initialized_ = false;
     uint16_t newest_seq_num_ = 0;
-    std::map<uint16_t, NackInfo, webrtc::DescendingSeqNumComp<uint16_t>> nack_list_;
+    NackList nack_list_;
     std::set<uint16_t, webrtc::DescendingSeqNumComp<uint16_t>> keyframe_list_;
     int64_t rtt_ms_;
     int64_t send_nack_delay_ms_ = 0;
     Histogram reordering_histogram_;
+    webrtc::ScopedTaskSafety task_safety_;
 };
 
 } // namespace xrtc
 
-#endif  //__MODULES_VIDEO_CODING_NACK_REQUESTER_H_
+#endif // XRTCSDK_XRTC_RTC_MODULES_NACK_NACK_REQUESTER_H_
 
 
@@ -0,0 +1,245 @@
+﻿#include "xrtc/rtc/modules/pacing/pacer_scheduler.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <string>
+#include <thread>
+
+#include <rtc_base/logging.h>
+
+#include "xrtc/base/thread_registry.h"
+
+namespace xrtc {
+
+namespace {
+// 表示对象当前没有在堆中调度
+const int64_t kNotScheduled = std::numeric_limits<int64_t>::max();
+// 在该时间内到期的对象在同一次唤醒中处理，减少线程的唤醒次数
+// PacingController按照流逝的时间计算预算，最多提前1ms处理，预算的误差也不超过1ms
+// 空闲的对象不被调度，空闲期间的预算在包入队时由PacingController处理
+const int64_t kCoalesceWindowUs = 1000;
+} // namespace
+
+struct PacerScheduler::Worker {
+    struct Entry {
+        int64_t time_us;
+        PacedProcess* process;
+        bool operator>(const Entry& other) const {
+            return time_us > other.time_us;
+        }
+    };
+
+    std::unique_ptr<std::thread> thread;
+    // 分配到该线程的对象数，由PacerScheduler::mtx_保护
+    size_t num_processes = 0;
+
+    // 以下变量由mtx保护
+    std::mutex mtx;
+    std::condition_variable cond_var;
+    // 等待正在执行的对象结束，Unregister时使用
+    std::condition_variable idle_cond_var;
+    bool stop = false;
+    std::deque<std::pair<PacedProcess*, std::unique_ptr<webrtc::QueuedTask>>> tasks;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap;
+    // 每个对象当前有效的调度时间，堆中时间不一致的项已经过期，弹出时丢弃
+    std::unordered_map<PacedProcess*, int64_t> scheduled_us;
+    PacedProcess* running = nullptr;
+};
+
+PacerScheduler::PacerScheduler(webrtc::Clock* clock, size_t num_threads,
+    ThreadRegistry* thread_registry) :
+    clock_(clock)
+{
+    num_threads = std::max<size_t>(1, num_threads);
+    for (size_t i = 0; i < num_threads; ++i) {
+        auto worker = std::make_unique<Worker>();
+        Worker* w = worker.get();
+        std::string thread_name = "pacer_thread_" + std::to_string(i);
+        worker->thread = std::make_unique<std::thread>([=]() {
+            ScopedThreadRegistration thread_registration(thread_registry,
+                ThreadRole::kPacer, thread_name);
+            WorkerLoop(w);
+        });
+        workers_.push_back(std::move(worker));
+    }
+
+    RTC_LOG(LS_INFO) << "PacerScheduler start, num_threads: " << num_threads;
+}
+
+PacerScheduler::~PacerScheduler() {
+    for (auto& worker : workers_) {
+        {
+            std::unique_lock<std::mutex> auto_lock(worker->mtx);
+            worker->stop = true;
+        }
+        worker->cond_var.notify_all();
+    }
+
+    for (auto& worker : workers_) {
+        if (worker->thread->joinable()) {
+            worker->thread->join();
+        }
+    }
+}
+
+void PacerScheduler::Register(PacedProcess* process) {
+    Worker* worker = nullptr;
+    {
+        std::unique_lock<std::mutex> auto_lock(mtx_);
+        if (process_workers_.count(process)) {
+            return;
+        }
+
+        for (auto& item : workers_) {
+            if (!worker || item->num_processes < worker->num_processes) {
+                worker = item.get();
+            }
+        }
+
+        ++worker->num_processes;
+        process_workers_[process] = worker;
+    }
+
+    std::unique_lock<std::mutex> auto_lock(worker->mtx);
+    worker->scheduled_us[process] = kNotScheduled;
+}
+
+void PacerScheduler::Unregister(PacedProcess* process) {
+    Worker* worker = nullptr;
+    {
+        std::unique_lock<std::mutex> auto_lock(mtx_);
+        auto iter = process_workers_.find(process);
+        if (iter == process_workers_.end()) {
+            return;
+        }
+
+        worker = iter->second;
+        --worker->num_processes;
+        process_workers_.erase(iter);
+    }
+
+    std::deque<std::pair<PacedProcess*, std::unique_ptr<webrtc::QueuedTask>>> dropped_tasks;
+    std::unique_lock<std::mutex> auto_lock(worker->mtx);
+    worker->scheduled_us.erase(process);
+    for (auto iter = worker->tasks.begin(); iter != worker->tasks.end();) {
+        if (iter->first == process) {
+            dropped_tasks.push_back(std::move(*iter));
+            iter = worker->tasks.erase(iter);
+        }
+        else {
+            ++iter;
+        }
+    }
+
+    // 堆中剩余的项在弹出时会被丢弃，只需要等待正在执行的回调结束
+    while (worker->running == process) {
+        worker->idle_cond_var.wait(auto_lock);
+    }
+}
+
+void PacerScheduler::PostTask(PacedProcess* process,
+    std::unique_ptr<webrtc::QueuedTask> task)
+{
+    Worker* worker = FindWorker(process);
+    if (!worker) {
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> auto_lock(worker->mtx);
+        if (!worker->scheduled_us.count(process)) {
+            return;
+        }
+        worker->tasks.emplace_back(process, std::move(task));
+    }
+    worker->cond_var.notify_one();
+}
+
+PacerScheduler::Worker* PacerScheduler::FindWorker(PacedProcess* process) {
+    std::unique_lock<std::mutex> auto_lock(mtx_);
+    auto iter = process_workers_.find(process);
+    return iter != process_workers_.end() ? iter->second : nullptr;
+}
+
+void PacerScheduler::WorkerLoop(Worker* worker) {
+    std::unique_lock<std::mutex> auto_lock(worker->mtx);
+    while (!worker->stop) {
+        // 先执行投递的任务，包入队之后可能需要更早地调度
+        if (!worker->tasks.empty()) {
+            auto item = std::move(worker->tasks.front());
+            worker->tasks.pop_front();
+            RunAndReschedule(worker, item.first, std::move(item.second), auto_lock);
+            continue;
+        }
+
+        if (worker->heap.empty()) {
+            worker->cond_var.wait(auto_lock);
+            continue;
+        }
+
+        int64_t now_us = clock_->TimeInMicroseconds();
+        Worker::Entry top = worker->heap.top();
+        if (top.time_us > now_us + kCoalesceWindowUs) {
+            worker->cond_var.wait_for(auto_lock,
+                std::chrono::microseconds(top.time_us - now_us));
+            continue;
+        }
+
+        worker->heap.pop();
+        auto iter = worker->scheduled_us.find(top.process);
+        if (iter == worker->scheduled_us.end() || iter->second != top.time_us) {
+            // 对象已经注销或者重新调度过
+            continue;
+        }
+
+        iter->second = kNotScheduled;
+        RunAndReschedule(worker, top.process, nullptr, auto_lock);
+    }
+}
+
+void PacerScheduler::RunAndReschedule(Worker* worker, PacedProcess* process,
+    std::unique_ptr<webrtc::QueuedTask> task,
+    std::unique_lock<std::mutex>& lock)
+{
+    worker->running = process;
+    lock.unlock();
+
+    if (task) {
+        if (!task->Run()) {
+            // 任务自己管理生命周期
+            task.release();
+        }
+    }
+    else {
+        process->Process();
+    }
+    task.reset();
+    webrtc::Timestamp next_process_time = process->NextProcessTime();
+
+    lock.lock();
+    worker->running = nullptr;
+    worker->idle_cond_var.notify_all();
+
+    auto iter = worker->scheduled_us.find(process);
+    if (iter == worker->scheduled_us.end()) {
+        return;
+    }
+
+    int64_t next_us = next_process_time.IsFinite() ?
+        next_process_time.us() : kNotScheduled;
+    if (next_us == iter->second) {
+        return;
+    }
+
+    // 旧的项留在堆中，弹出时根据时间不一致丢弃
+    iter->second = next_us;
+    if (next_us != kNotScheduled) {
+        worker->heap.push({ next_us, process });
+    }
+}
+
+} // namespace xrtc
@@ -0,0 +1,70 @@
+﻿#ifndef XRTCSDK_XRTC_RTC_MODULES_PACING_PACER_SCHEDULER_H_
+#define XRTCSDK_XRTC_RTC_MODULES_PACING_PACER_SCHEDULER_H_
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <system_wrappers/include/clock.h>
+#include <api/task_queue/queued_task.h>
+#include <rtc_base/task_utils/to_queued_task.h>
+
+namespace xrtc {
+
+class ThreadRegistry;
+
+// 可以被PacerScheduler调度的对象，所有回调都在分配到的调度线程中执行
+class PacedProcess {
+public:
+    virtual ~PacedProcess() = default;
+    // 到达调度时间时回调
+    virtual void Process() = 0;
+    // 下一次需要调用Process的时间，PlusInfinity表示暂时不需要调度
+    virtual webrtc::Timestamp NextProcessTime() = 0;
+};
+
+// 进程内所有连接共享的pacer调度器，在固定数量的线程上运行所有的PacedProcess
+// 每个线程用最小堆保存各个对象的下一次调度时间，一次唤醒处理所有到期的对象，
+// 空闲的对象不在堆中，唤醒次数和需要发送的包相关，和连接数无关
+// 同一个对象的Process和投递的任务总是在同一个线程中串行执行
+class PacerScheduler {
+public:
+    // thread_registry不为空时，调度线程登记到其中，可以统一配置CPU亲和性和优先级
+    PacerScheduler(webrtc::Clock* clock, size_t num_threads,
+        ThreadRegistry* thread_registry = nullptr);
+    ~PacerScheduler();
+
+    // 分配到对象数最少的线程
+    void Register(PacedProcess* process);
+    // 返回之后不会再回调该对象，还没有执行的任务被丢弃，不能在调度线程中调用
+    void Unregister(PacedProcess* process);
+    // 在对象所在的线程中执行任务，执行之后重新获取下一次调度时间
+    void PostTask(PacedProcess* process, std::unique_ptr<webrtc::QueuedTask> task);
+    template <class Closure>
+    void PostTask(PacedProcess* process, Closure&& closure) {
+        PostTask(process, webrtc::ToQueuedTask(std::forward<Closure>(closure)));
+    }
+
+    size_t num_threads() const { return workers_.size(); }
+
+private:
+    struct Worker;
+    Worker* FindWorker(PacedProcess* process);
+    void WorkerLoop(Worker* worker);
+    // task为空时执行Process，调用时持有worker的锁，执行期间释放
+    void RunAndReschedule(Worker* worker, PacedProcess* process,
+        std::unique_ptr<webrtc::QueuedTask> task,
+        std::unique_lock<std::mutex>& lock);
+
+private:
+    webrtc::Clock* clock_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::mutex mtx_;
+    // 对象分配到的线程，由mtx_保护
+    std::unordered_map<PacedProcess*, Worker*> process_workers_;
+};
+
+} // namespace xrtc
+
+#endif // XRTCSDK_XRTC_RTC_MODULES_PACING_PACER_SCHEDULER_H_
@@ -1,5 +1,7 @@
 ﻿#include "xrtc/rtc/modules/pacing/pacing_controller.h"
 
+#include <algorithm>
+
 #include <rtc_base/logging.h>
 
 namespace xrtc {
@@ -9,7 +11,6 @@ namespace {
 const webrtc::TimeDelta kDefaultMinPacketLimit = webrtc::TimeDelta::Millis(5);
 const webrtc::TimeDelta kMaxElapsedTime = webrtc::TimeDelta::Seconds(2);    
 const webrtc::TimeDelta kMaxProcessingInterval = webrtc::TimeDelta::Millis(30);
-const webrtc::TimeDelta kMaxExpectedQueueLength = webrtc::TimeDelta::Millis(2000);
 
 // 值越小，优先级越高
 const int kFirstPriority = 0;
@@ -47,6 +48,15 @@ PacingController::~PacingController() {
 }
 
 void PacingController::EnqueuePacket(std::unique_ptr<RtpPacketToSend> packet) {
+    // 队列为空时调度器不会定时处理，last_process_time_停留在上一次处理的时间，
+    // 这里把它快进到当前时间，空闲期间最多只计入一个处理周期的预算，
+    // 否则下一次处理会把整个空闲时间算作预算，新的一帧会不经平滑地突发发送
+    if (packet_queue_.Empty()) {
+        webrtc::Timestamp now = clock_->CurrentTime();
+        webrtc::TimeDelta elapsed_time = UpdateTimeAndGetElapsed(now);
+        UpdateBudgetWithElapsedTime(std::min(elapsed_time, min_packet_limit_));
+    }
+
     // 1. 获得RTP packet的优先级
     int priority = GetPriorityForType(*packet->packet_type());
     // 2. 插入packet
@@ -83,6 +93,8 @@ void PacingController::ProcessPackets() {
                     RTC_LOG(LS_INFO) << "large queue, pacing_rate: " << pacing_bitrate_.kbps()
                         << ", min_rate_need: " << min_rate_need.kbps()
                         << ", queue_data_size: " << queue_data_size.bytes()
+                        << ", enhancement_layer_size: "
+                        << packet_queue_.EnhancementLayerSize().bytes()
                         << ", avg_queue_time: " << avg_queue_time.ms()
                         << ", avg_queue_left: " << avg_queue_left.ms();
                 }
@@ -192,6 +204,13 @@ void PacingController::CreateProbeCluster(webrtc::DataRate bitrate,int cluster_i
 }
 
 
+webrtc::TimeDelta PacingController::ExpectedQueueTime() const {
+    if (pacing_bitrate_.IsZero()) {
+        return webrtc::TimeDelta::Zero();
+    }
+    return packet_queue_.Size() / pacing_bitrate_;
+}
+
 void PacingController::EnqueuePacketInternal(int priority, 
     std::unique_ptr<RtpPacketToSend> packet) 
 {
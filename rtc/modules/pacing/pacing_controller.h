@@ -22,6 +22,11 @@ public:
             webrtc::DataSize packet_size) = 0;
     };
 
+    // 默认的最大排队时间，编码器按照该时间设置VBV
+    // 编译期常量，其它编译单元的静态初始化中使用也不依赖初始化顺序
+    static constexpr webrtc::TimeDelta kMaxExpectedQueueLength =
+        webrtc::TimeDelta::Millis(2000);
+
     PacingController(webrtc::Clock* clock,
         PacketSender* packet_sender);
     ~PacingController();
@@ -29,11 +34,17 @@ public:
     void EnqueuePacket(std::unique_ptr<RtpPacketToSend> packet);
     void ProcessPackets();
     webrtc::Timestamp NextSendTime();
+    // 队列为空并且没有探测任务，此时处理不会发送任何数据
+    bool IsIdle() const {
+        return packet_queue_.Empty() && !prober_.IsProbing();
+    }
     void SetPacingBitrate(webrtc::DataRate bitrate);
     void SetQueueTimeLimit(webrtc::TimeDelta limit) {
         queue_time_limit_ = limit;
     }
     void CreateProbeCluster(webrtc::DataRate bitrate,int cluster_id);
+    // 按照当前的发送码率，排空队列需要的时间
+    webrtc::TimeDelta ExpectedQueueTime() const;
 private:
     void EnqueuePacketInternal(int priority,
         std::unique_ptr<RtpPacketToSend> packet);
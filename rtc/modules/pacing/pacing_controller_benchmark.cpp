@@ -0,0 +1,70 @@
+﻿#include "xrtc/rtc/modules/pacing/pacing_controller.h"
+
+#include <memory>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <system_wrappers/include/clock.h>
+
+namespace xrtc {
+
+namespace {
+const size_t kPayloadSize = 1200;
+const int kPacketsPerFrame = 30;
+
+class NullPacketSender : public PacingController::PacketSender {
+public:
+    void SendPacket(std::unique_ptr<RtpPacketToSend> packet,
+        const webrtc::PacedPacketInfo& pacing_info) override
+    {
+        ++packets_sent;
+    }
+
+    std::vector<std::unique_ptr<RtpPacketToSend>> GeneratePadding(
+        webrtc::DataSize packet_size) override
+    {
+        return {};
+    }
+
+    int64_t packets_sent = 0;
+};
+
+} // namespace
+
+// 入队一帧之后，按照NextSendTime推进SimulatedClock，直到队列发送完
+// 参数为pacing码率kbps，码率越低每次处理发送的包越少，处理的次数越多
+void BM_PacingControllerProcessPackets(benchmark::State& state) {
+    webrtc::SimulatedClock clock(100000000);
+    NullPacketSender sender;
+    PacingController pacing_controller(&clock, &sender);
+    pacing_controller.SetPacingBitrate(
+        webrtc::DataRate::KilobitsPerSec(state.range(0)));
+
+    uint16_t seq_num = 0;
+    int64_t num_process = 0;
+    for (auto _ : state) {
+        for (int i = 0; i < kPacketsPerFrame; ++i) {
+            auto packet = std::make_unique<RtpPacketToSend>();
+            packet->SetSsrc(1000);
+            packet->SetSequenceNumber(seq_num++);
+            packet->SetPayloadSize(kPayloadSize);
+            packet->set_packet_type(RtpPacketMediaType::kVideo);
+            pacing_controller.EnqueuePacket(std::move(packet));
+        }
+
+        while (!pacing_controller.IsIdle()) {
+            webrtc::Timestamp next_send_time = pacing_controller.NextSendTime();
+            if (next_send_time > clock.CurrentTime()) {
+                clock.AdvanceTime(next_send_time - clock.CurrentTime());
+            }
+            pacing_controller.ProcessPackets();
+            ++num_process;
+        }
+    }
+    state.SetItemsProcessed(sender.packets_sent);
+    state.counters["process_per_frame"] = benchmark::Counter(
+        (double)num_process / state.iterations());
+}
+BENCHMARK(BM_PacingControllerProcessPackets)->Arg(2500)->Arg(10000)->Arg(50000);
+
+} // namespace xrtc
@@ -73,6 +73,9 @@ std::unique_ptr<RtpPacketToSend> RoundRobinPacketQueue::Pop() {
     stream->packet_queue.pop();
     size_packets_ -= 1;
     size_ -= packet_size;
+    if (rtp_packet->temporal_id() > 0) {
+        enhancement_layer_size_ -= packet_size;
+    }
 
     // 重新计算stream的优先级
     if (stream->packet_queue.empty()) {
@@ -138,6 +141,9 @@ void RoundRobinPacketQueue::Push(const QueuedPacket& packet) {
     UpdateQueueTime(packet.EnqueueTime());//更新队列等待的总时间
     size_packets_ += 1;
     size_ += PacketSize(packet);
+    if (packet.rtp_packet()->temporal_id() > 0) {
+        enhancement_layer_size_ += PacketSize(packet);
+    }
     stream->packet_queue.emplace(packet);
 }
 
@@ -26,6 +26,7 @@ public:
     bool Empty() const;
     webrtc::DataSize Size() const { return size_; }//获得队列当中还存在的数据大小
     size_t SizePackets() const { return size_packets_; }
+    webrtc::DataSize EnhancementLayerSize() const { return enhancement_layer_size_; }
     void UpdateQueueTime(webrtc::Timestamp now);
     webrtc::TimeDelta AverageQueueTime() const;
 
@@ -97,6 +98,7 @@ private:
     size_t size_packets_ = 0;
     webrtc::DataSize max_size_;//累计发送的最大的流的字节数
     webrtc::DataSize size_ = webrtc::DataSize::Zero();//获得排队过程中所有数据包的大小
+    webrtc::DataSize enhancement_layer_size_ = webrtc::DataSize::Zero();//其中增强时间层的大小
     std::unordered_map<uint32_t, Stream> streams_;
     // 按照StreamPrioKey从小到到进行排序
     std::multimap<StreamPrioKey, uint32_t> stream_priorities_;
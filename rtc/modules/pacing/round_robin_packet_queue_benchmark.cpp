@@ -0,0 +1,58 @@
+﻿#include "xrtc/rtc/modules/pacing/round_robin_packet_queue.h"
+
+#include <memory>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+namespace xrtc {
+
+namespace {
+const int kPriority = 3;
+const size_t kPayloadSize = 1200;
+
+std::unique_ptr<RtpPacketToSend> CreatePacket(uint32_t ssrc, uint16_t seq_num) {
+    auto packet = std::make_unique<RtpPacketToSend>();
+    packet->SetSsrc(ssrc);
+    packet->SetSequenceNumber(seq_num);
+    packet->SetPayloadSize(kPayloadSize);
+    packet->set_packet_type(RtpPacketMediaType::kVideo);
+    return packet;
+}
+
+} // namespace
+
+// 多个流交错入队之后全部出队，参数为流的个数和每个流的包数
+// 包在迭代之间循环使用，只统计队列本身的开销
+void BM_RoundRobinPacketQueuePushPop(benchmark::State& state) {
+    const int num_streams = (int)state.range(0);
+    const int packets_per_stream = (int)state.range(1);
+    std::vector<std::unique_ptr<RtpPacketToSend>> packets;
+    for (int i = 0; i < packets_per_stream; ++i) {
+        for (int ssrc = 0; ssrc < num_streams; ++ssrc) {
+            packets.push_back(CreatePacket(1000 + ssrc, (uint16_t)i));
+        }
+    }
+
+    webrtc::Timestamp now = webrtc::Timestamp::Millis(100000);
+    RoundRobinPacketQueue queue(now);
+    uint64_t enqueue_order = 0;
+    for (auto _ : state) {
+        for (auto& packet : packets) {
+            queue.Push(kPriority, now, enqueue_order++, std::move(packet));
+        }
+        now += webrtc::TimeDelta::Millis(1);
+        queue.UpdateQueueTime(now);
+        for (auto& packet : packets) {
+            packet = queue.Pop();
+        }
+        benchmark::DoNotOptimize(queue.Empty());
+    }
+    state.SetItemsProcessed(state.iterations() * packets.size());
+}
+BENCHMARK(BM_RoundRobinPacketQueuePushPop)
+    ->Args({ 1, 30 })
+    ->Args({ 3, 30 })
+    ->Args({ 16, 30 });
+
+} // namespace xrtc
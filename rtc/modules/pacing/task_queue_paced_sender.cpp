@@ -1,90 +1,85 @@
-#include "xrtc/rtc/modules/pacing/task_queue_paced_sender.h"
+﻿#include "xrtc/rtc/modules/pacing/task_queue_paced_sender.h"
+
+#include <algorithm>
 
 namespace xrtc {
 
 TaskQueuePacedSender::TaskQueuePacedSender(webrtc::Clock* clock,
     PacingController::PacketSender* packet_sender,
-    webrtc::TaskQueueFactory* task_queue_factory,
+    PacerScheduler* pacer_scheduler,
     webrtc::TimeDelta hold_back_window) :
     clock_(clock),
-    task_queue_(task_queue_factory->CreateTaskQueue("TaskQueuePacedSender",webrtc::TaskQueueFactory::Priority::NORMAL)),//数据包精确定时发送线程
+    pacer_scheduler_(pacer_scheduler),//数据包精确定时发送，进程内所有连接共享
     pacing_controller_(clock_, packet_sender),
     hold_back_window_(hold_back_window)
 {
     // for test
     pacing_controller_.SetPacingBitrate(webrtc::DataRate::KilobitsPerSec(500));
+    pacer_scheduler_->Register(this);
 }
 
 TaskQueuePacedSender::~TaskQueuePacedSender() {
+    Stop();
+}
+
+void TaskQueuePacedSender::Stop() {
+    // 返回之后调度线程不会再访问该对象，还没有执行的任务被丢弃
+    pacer_scheduler_->Unregister(this);
 }
 
 void TaskQueuePacedSender::EnsureStarted() {
-    task_queue_.PostTask([this]() {
-        MaybeProcessPackets(webrtc::Timestamp::MinusInfinity());
-    });
+    // 空任务执行之后调度器会根据NextProcessTime安排下一次发送
+    pacer_scheduler_->PostTask(this, []() {});
 }
 
 //异步包入队
 void TaskQueuePacedSender::EnqueuePacket(std::unique_ptr<RtpPacketToSend> packet) {
-    task_queue_.PostTask([this, packet_ = std::move(packet)]() mutable {
-        pacing_controller_.EnqueuePacket(std::move(packet_));
-    });
+    pacer_scheduler_->PostTask(this,
+        [this, packet_ = std::move(packet)]() mutable {
+            pacing_controller_.EnqueuePacket(std::move(packet_));
+            UpdateStats();
+        });
 }
 
-//码率设置
+//码率设置，执行之后调度器会立即检查是否需要发送数据包
 void TaskQueuePacedSender::SetPacingRates(webrtc::DataRate pacing_rate) {
-    task_queue_.PostTask([this, pacing_rate]() {
+    pacer_scheduler_->PostTask(this, [this, pacing_rate]() {
         pacing_controller_.SetPacingBitrate(pacing_rate);//设置新的发送码率
-        MaybeProcessPackets(webrtc::Timestamp::MinusInfinity());//立即检查是否需要发送数据包
     });
 }
 
 //带宽探测
 void TaskQueuePacedSender::CreateProbeCluster(webrtc::DataRate bitrate,int cluster_id) {
-    task_queue_.PostTask([this, bitrate, cluster_id]() {
+    pacer_scheduler_->PostTask(this, [this, bitrate, cluster_id]() {
         pacing_controller_.CreateProbeCluster(bitrate, cluster_id);
     });
 }
 
-//定期去执行 pacing_controller_.ProcessPackets();定时发送数据包
-void TaskQueuePacedSender::MaybeProcessPackets(
-    webrtc::Timestamp scheduled_process_time) 
-{
-    /*
-    当传入MinusInfinity时：
-    is_sheculded_call,比较通常为false，会重新计算time_to_next_send
-    next_process_time_.IsMinusInfinity() 为true
-    立即计算下次发送时间，可能立即发送或很短延迟后发送
-    安排下次发送任务（可能是立即或很短延迟）
-    */ 
+//到达调度时间，执行 pacing_controller_.ProcessPackets();定时发送数据包
+void TaskQueuePacedSender::Process() {
+    last_process_time_ = clock_->CurrentTime();
+    pacing_controller_.ProcessPackets();
+    UpdateStats();
+}
 
-    //下一次调度的时间
-    webrtc::Timestamp next_process_time = pacing_controller_.NextSendTime();
-    bool is_sheculded_call = (scheduled_process_time == next_process_time_);
-    if (is_sheculded_call) {
-        // 当前的任务将被执行，需要重新设定下一次任务执行的时间
-        next_process_time_ = webrtc::Timestamp::MinusInfinity();
-        // 执行数据包发送逻辑
-        pacing_controller_.ProcessPackets();
-        //更新最后处理的时间
-        next_process_time = pacing_controller_.NextSendTime();
+webrtc::Timestamp TaskQueuePacedSender::NextProcessTime() {
+    // 队列为空并且没有探测任务时不需要定时唤醒，包入队之后会重新调度
+    if (pacing_controller_.IsIdle()) {
+        return webrtc::Timestamp::PlusInfinity();
     }
 
-    webrtc::Timestamp now = clock_->CurrentTime();
-    // 需要过多长时间之后，再次进行这个调度,时间间隔
-    absl::optional<webrtc::TimeDelta> time_to_next_send;
-    if (next_process_time_.IsMinusInfinity()) {
-        // 当前还没有设定下一次的调度任务，需要创建一个等待的时间
-        time_to_next_send = std::max(next_process_time - now, hold_back_window_);
+    // 两次处理之间至少间隔hold_back_window_，避免预算不足时频繁唤醒
+    webrtc::Timestamp next_process_time = pacing_controller_.NextSendTime();
+    if (last_process_time_.IsFinite()) {
+        next_process_time = std::max(next_process_time,
+            last_process_time_ + hold_back_window_);
     }
+    return next_process_time;
+}
 
-    if (time_to_next_send) {
-        next_process_time_ = next_process_time;
-
-        task_queue_.PostDelayedTask([this, next_process_time]() {
-            MaybeProcessPackets(next_process_time);
-        }, time_to_next_send->ms<uint32_t>());
-    }
+//发送线程之外只能读取这里的快照
+void TaskQueuePacedSender::UpdateStats() {
+    expected_queue_time_ms_ = pacing_controller_.ExpectedQueueTime().ms();
 }
 
 } // namespace xrtc
\ No newline at end of file
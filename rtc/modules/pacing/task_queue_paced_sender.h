@@ -1,40 +1,54 @@
 ﻿#ifndef XRTCSDK_XRTC_RTC_MODULES_PACING_TASK_QUEUE_PACED_SENDER_H_
 #define XRTCSDK_XRTC_RTC_MODULES_PACING_TASK_QUEUE_PACED_SENDER_H_
 
+#include <atomic>
+
 #include <system_wrappers/include/clock.h>
-#include <api/task_queue/task_queue_factory.h>
-#include <rtc_base/task_queue.h>
 
 #include "xrtc/rtc/modules/rtp_rtcp/rtp_packet_to_send.h"
 #include "xrtc/rtc/modules/pacing/pacing_controller.h"
+#include "xrtc/rtc/modules/pacing/pacer_scheduler.h"
 
 namespace xrtc {
 
 //平滑发送任务队列管理层
-class TaskQueuePacedSender {
+//运行在进程共享的PacerScheduler上，所有对PacingController的访问都在分配到的调度线程中执行
+class TaskQueuePacedSender : public PacedProcess {
 public:
     TaskQueuePacedSender(webrtc::Clock* clock,
         PacingController::PacketSender* packet_sender,
-        webrtc::TaskQueueFactory* task_queue_factory,
+        PacerScheduler* pacer_scheduler,
         webrtc::TimeDelta hold_back_window);
-    ~TaskQueuePacedSender();
+    ~TaskQueuePacedSender() override;
 
     void EnsureStarted();
+    // 停止调度，返回之后不会再回调PacketSender，可以重复调用
+    void Stop();
 
     void EnqueuePacket(std::unique_ptr<RtpPacketToSend> packet);
     void SetPacingRates(webrtc::DataRate pacing_rate);
     void CreateProbeCluster(webrtc::DataRate bitrate,int cluster_id);
+    // 可以在任意线程调用，返回最近一次处理之后的排队时间
+    webrtc::TimeDelta ExpectedQueueTime() const {
+        return webrtc::TimeDelta::Millis(expected_queue_time_ms_.load());
+    }
+
+    // PacedProcess
+    void Process() override;
+    webrtc::Timestamp NextProcessTime() override;
+
 private:
-    void MaybeProcessPackets(webrtc::Timestamp scheduled_process_time);
+    void UpdateStats();
 
 private:
     webrtc::Clock* clock_;
-    rtc::TaskQueue task_queue_;
+    PacerScheduler* pacer_scheduler_;
     PacingController pacing_controller_;
-    // 初始值是负的无穷大，表示暂时还没有调度任何任务
-    webrtc::Timestamp next_process_time_ = webrtc::Timestamp::MinusInfinity();//下一个需要调度的时刻
+    // 上一次执行ProcessPackets的时间，初始值表示还没有处理过
+    webrtc::Timestamp last_process_time_ = webrtc::Timestamp::MinusInfinity();
     // 最小的调度周期
     webrtc::TimeDelta hold_back_window_;
+    std::atomic<int64_t> expected_queue_time_ms_{ 0 };
 };
 
 } // namespace xrtc
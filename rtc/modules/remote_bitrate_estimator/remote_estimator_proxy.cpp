@@ -0,0 +1,147 @@
+﻿#include "xrtc/rtc/modules/remote_bitrate_estimator/remote_estimator_proxy.h"
+
+#include <algorithm>
+
+#include <rtc_base/logging.h>
+#include <rtc_base/thread.h>
+#include <rtc_base/task_utils/to_queued_task.h>
+
+namespace xrtc {
+
+namespace {
+// 定时发送反馈的间隔
+const int kSendIntervalMs = 100;
+// 两次定时之间收到的包超过该值时立即发送反馈，高码率时减少反馈的延迟
+const size_t kMaxPacketsBeforeFeedback = 100;
+// 反馈包加上RTCP发送时的其它开销，不能超过一个IP包
+const size_t kMaxFeedbackSizeBytes = 1000;
+// 最多保存的序号个数，长时间没有发送反馈时丢弃最旧的
+const int64_t kMaxNumberOfPackets = 1 << 15;
+} // namespace
+
+RemoteEstimatorProxy::RemoteEstimatorProxy(webrtc::Clock* clock) :
+    clock_(clock)
+{
+    ScheduleSendFeedback();
+}
+
+RemoteEstimatorProxy::~RemoteEstimatorProxy() {
+}
+
+void RemoteEstimatorProxy::IncomingPacket(int64_t arrival_time_us,
+    uint16_t transport_seq, uint32_t media_ssrc)
+{
+    media_ssrc_ = media_ssrc;
+    int64_t seq_num = unwrapper_.Unwrap(transport_seq);
+    if (next_feedback_seq_num_ < 0) {
+        begin_seq_num_ = seq_num;
+        next_feedback_seq_num_ = seq_num;
+    }
+
+    // 已经反馈过的序号，远端已经按照丢包处理
+    if (seq_num < next_feedback_seq_num_) {
+        return;
+    }
+
+    if (seq_num - begin_seq_num_ >= kMaxNumberOfPackets) {
+        int64_t new_begin_seq_num = seq_num - kMaxNumberOfPackets + 1;
+        RTC_LOG(LS_WARNING) << "too many packets without feedback, drop packets before: "
+            << new_begin_seq_num;
+        RemovePacketsBefore(new_begin_seq_num);
+        next_feedback_seq_num_ = std::max(next_feedback_seq_num_, new_begin_seq_num);
+    }
+
+    if (seq_num >= end_seq_num()) {
+        arrival_times_us_.resize(seq_num - begin_seq_num_ + 1, -1);
+    }
+
+    // 重复的包只记录第一次的到达时间
+    int64_t& arrival_time = arrival_times_us_[seq_num - begin_seq_num_];
+    if (arrival_time >= 0) {
+        return;
+    }
+    arrival_time = arrival_time_us;
+
+    if (++packets_since_feedback_ >= kMaxPacketsBeforeFeedback) {
+        SendFeedback();
+    }
+}
+
+// 在当前线程定时执行，对象销毁之后task_safety_保证任务不再执行
+void RemoteEstimatorProxy::ScheduleSendFeedback() {
+    rtc::Thread::Current()->PostDelayedTask(webrtc::ToQueuedTask(task_safety_, [this]() {
+        if (packets_since_feedback_ > 0) {
+            SendFeedback();
+        }
+        ScheduleSendFeedback();
+    }), kSendIntervalMs);
+}
+
+void RemoteEstimatorProxy::SendFeedback() {
+    packets_since_feedback_ = 0;
+    while (next_feedback_seq_num_ >= 0 && next_feedback_seq_num_ < end_seq_num()) {
+        rtcp::TransportFeedback feedback;
+        int64_t next_seq_num = BuildFeedback(next_feedback_seq_num_, &feedback);
+        // 剩下的都是还没有到达的包，等到达之后再反馈
+        if (0 == feedback.GetPacketStatusCount()) {
+            break;
+        }
+
+        next_feedback_seq_num_ = next_seq_num;
+        SignalTransportFeedback(&feedback);
+    }
+
+    RemovePacketsBefore(next_feedback_seq_num_);
+}
+
+int64_t RemoteEstimatorProxy::BuildFeedback(int64_t begin_seq_num,
+    rtcp::TransportFeedback* feedback)
+{
+    int64_t end = end_seq_num();
+    int64_t seq_num = begin_seq_num;
+    while (seq_num < end && ArrivalTimeUs(seq_num) < 0) {
+        ++seq_num;
+    }
+    if (seq_num == end) {
+        return begin_seq_num;
+    }
+
+    // 前面没有收到的包作为丢包一起反馈，参考时间使用第一个收到的包
+    feedback->SetMediaSsrc(media_ssrc_);
+    feedback->SetBase(static_cast<uint16_t>(begin_seq_num), ArrivalTimeUs(seq_num));
+    feedback->SetFeedbackSequenceNumber(feedback_packet_count_++);
+
+    int64_t next_seq_num = begin_seq_num;
+    for (; seq_num < end; ++seq_num) {
+        int64_t arrival_time_us = ArrivalTimeUs(seq_num);
+        if (arrival_time_us < 0) {
+            continue;
+        }
+
+        if (feedback->BlockLength() > kMaxFeedbackSizeBytes ||
+            !feedback->AddReceivedPacket(static_cast<uint16_t>(seq_num), arrival_time_us))
+        {
+            break;
+        }
+        next_seq_num = seq_num + 1;
+    }
+
+    return next_seq_num;
+}
+
+void RemoteEstimatorProxy::RemovePacketsBefore(int64_t seq_num) {
+    if (seq_num <= begin_seq_num_) {
+        return;
+    }
+
+    if (seq_num >= end_seq_num()) {
+        arrival_times_us_.clear();
+    }
+    else {
+        arrival_times_us_.erase(arrival_times_us_.begin(),
+            arrival_times_us_.begin() + (seq_num - begin_seq_num_));
+    }
+    begin_seq_num_ = seq_num;
+}
+
+} // namespace xrtc
@@ -0,0 +1,59 @@
+﻿#ifndef XRTCSDK_XRTC_RTC_MODULES_REMOTE_BITRATE_ESTIMATOR_REMOTE_ESTIMATOR_PROXY_H_
+#define XRTCSDK_XRTC_RTC_MODULES_REMOTE_BITRATE_ESTIMATOR_REMOTE_ESTIMATOR_PROXY_H_
+
+#include <deque>
+
+#include <rtc_base/numerics/sequence_number_util.h>
+#include <rtc_base/task_utils/pending_task_safety_flag.h>
+#include <rtc_base/third_party/sigslot/sigslot.h>
+#include <system_wrappers/include/clock.h>
+
+#include "xrtc/rtc/modules/rtp_rtcp/rtcp_packet/transport_feedback.h"
+
+namespace xrtc {
+
+// 接收端的transport-cc反馈，带宽估计在发送端进行
+// 记录每个transport序号的包的到达时间，定时或者收到一定数量的包之后打包成TransportFeedback，
+// 通过SignalTransportFeedback交给RTCP模块发送，一次放不下时拆分成多个反馈包
+// 已经反馈过的序号不再保存，之后乱序到达的包远端已经按照丢包处理
+// 需要在同一个线程调用，定时任务也在该线程执行
+class RemoteEstimatorProxy {
+public:
+    explicit RemoteEstimatorProxy(webrtc::Clock* clock);
+    ~RemoteEstimatorProxy();
+
+    void IncomingPacket(int64_t arrival_time_us, uint16_t transport_seq,
+        uint32_t media_ssrc);
+
+    sigslot::signal1<rtcp::TransportFeedback*> SignalTransportFeedback;
+
+private:
+    void ScheduleSendFeedback();
+    void SendFeedback();
+    // 从begin_seq_num开始把收到的包加入feedback，返回下一个没有反馈的序号
+    int64_t BuildFeedback(int64_t begin_seq_num, rtcp::TransportFeedback* feedback);
+    void RemovePacketsBefore(int64_t seq_num);
+    int64_t ArrivalTimeUs(int64_t seq_num) const {
+        return arrival_times_us_[seq_num - begin_seq_num_];
+    }
+    int64_t end_seq_num() const {
+        return begin_seq_num_ + arrival_times_us_.size();
+    }
+
+private:
+    webrtc::Clock* clock_;
+    webrtc::SeqNumUnwrapper<uint16_t> unwrapper_;
+    uint32_t media_ssrc_ = 0;
+    uint8_t feedback_packet_count_ = 0;
+    // 从begin_seq_num_开始每个序号的到达时间，-1表示还没有收到
+    std::deque<int64_t> arrival_times_us_;
+    int64_t begin_seq_num_ = 0;
+    // 下一个反馈包开始的序号，-1表示还没有收到包
+    int64_t next_feedback_seq_num_ = -1;
+    size_t packets_since_feedback_ = 0;
+    webrtc::ScopedTaskSafety task_safety_;
+};
+
+} // namespace xrtc
+
+#endif // XRTCSDK_XRTC_RTC_MODULES_REMOTE_BITRATE_ESTIMATOR_REMOTE_ESTIMATOR_PROXY_H_
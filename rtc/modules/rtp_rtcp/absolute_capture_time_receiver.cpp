@@ -0,0 +1,75 @@
+﻿#include "xrtc/rtc/modules/rtp_rtcp/absolute_capture_time_receiver.h"
+
+#include "xrtc/rtc/modules/rtp_rtcp/rtp_header_extensions.h"
+
+namespace xrtc {
+
+namespace {
+// 距离最近一次扩展超过该时间时不再外推，避免时间戳回绕或者发送端重置
+const int64_t kInterpolationMaxIntervalMs = 5000;
+} // namespace
+
+AbsoluteCaptureTimeReceiver::AbsoluteCaptureTimeReceiver(int clock_rate) :
+    clock_rate_khz_(clock_rate / 1000)
+{
+}
+
+AbsoluteCaptureTimeReceiver::~AbsoluteCaptureTimeReceiver() {
+}
+
+void AbsoluteCaptureTimeReceiver::OnSenderReport(webrtc::NtpTime sr_ntp_time,
+    webrtc::Timestamp arrival_time)
+{
+    if (!sr_ntp_time.Valid()) {
+        return;
+    }
+
+    sr_offset_ms_ = arrival_time.ms() - sr_ntp_time.ToMs();
+    has_sr_ = true;
+}
+
+void AbsoluteCaptureTimeReceiver::UpdateRtt(int64_t rtt_ms) {
+    rtt_ms_ = rtt_ms;
+}
+
+void AbsoluteCaptureTimeReceiver::OnRtpPacket(const RtpPacketReceived& packet) {
+    auto capture_time = packet.GetExtension<AbsoluteCaptureTimeExtension>();
+    if (!capture_time) {
+        return;
+    }
+
+    // 采集时钟和发送端不是同一个时钟时(例如经过混流)，需要加上扩展中的偏差
+    int64_t capture_ntp_ms = webrtc::UQ32x32ToInt64Ms(
+        capture_time->absolute_capture_timestamp);
+    if (capture_time->estimated_capture_clock_offset) {
+        capture_ntp_ms += webrtc::Q32x32ToInt64Ms(
+            *capture_time->estimated_capture_clock_offset);
+    }
+
+    last_rtp_timestamp_ = packet.timestamp();
+    last_capture_ntp_ms_ = capture_ntp_ms;
+    has_capture_time_ = true;
+}
+
+int64_t AbsoluteCaptureTimeReceiver::EstimateCaptureTimeMs(
+    uint32_t rtp_timestamp) const
+{
+    if (!has_sr_ || !has_capture_time_ || clock_rate_khz_ <= 0) {
+        return 0;
+    }
+
+    int64_t elapsed_ms = (int32_t)(rtp_timestamp - last_rtp_timestamp_) /
+        clock_rate_khz_;
+    if (elapsed_ms > kInterpolationMaxIntervalMs ||
+        elapsed_ms < -kInterpolationMaxIntervalMs)
+    {
+        return 0;
+    }
+
+    // SR在到达之前已经在网络上传输了单程的时间
+    int64_t capture_time_ms = last_capture_ntp_ms_ + elapsed_ms +
+        sr_offset_ms_ - rtt_ms_ / 2;
+    return capture_time_ms > 0 ? capture_time_ms : 0;
+}
+
+} // namespace xrtc
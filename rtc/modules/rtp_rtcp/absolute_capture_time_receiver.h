@@ -0,0 +1,42 @@
+﻿#ifndef XRTCSDK_XRTC_RTC_MODULES_RTP_RTCP_ABSOLUTE_CAPTURE_TIME_RECEIVER_H_
+#define XRTCSDK_XRTC_RTC_MODULES_RTP_RTCP_ABSOLUTE_CAPTURE_TIME_RECEIVER_H_
+
+#include <api/units/timestamp.h>
+#include <system_wrappers/include/ntp_time.h>
+
+#include "xrtc/rtc/modules/rtp_rtcp/rtp_packet_received.h"
+
+namespace xrtc {
+
+// 把abs-capture-time扩展中发送端NTP时钟的采集时间换算成本地时钟
+// 两端时钟的偏差通过远端SR估计：SR的到达时间减去RTT/2对应SR中的NTP时间
+// 扩展只在部分包中携带，其它帧根据RTP时间戳从最近一次的扩展外推
+// 需要在同一个线程调用
+class AbsoluteCaptureTimeReceiver {
+public:
+    explicit AbsoluteCaptureTimeReceiver(int clock_rate);
+    ~AbsoluteCaptureTimeReceiver();
+
+    // arrival_time是本地时钟
+    void OnSenderReport(webrtc::NtpTime sr_ntp_time, webrtc::Timestamp arrival_time);
+    void UpdateRtt(int64_t rtt_ms);
+    void OnRtpPacket(const RtpPacketReceived& packet);
+
+    // 返回本地时钟的采集时间，没有收到SR或者扩展时返回0
+    int64_t EstimateCaptureTimeMs(uint32_t rtp_timestamp) const;
+
+private:
+    int clock_rate_khz_;
+    // 本地时钟减去发送端NTP时钟，不包括RTT
+    bool has_sr_ = false;
+    int64_t sr_offset_ms_ = 0;
+    int64_t rtt_ms_ = 0;
+    // 最近一次扩展的RTP时间戳和发送端NTP时钟的采集时间
+    bool has_capture_time_ = false;
+    uint32_t last_rtp_timestamp_ = 0;
+    int64_t last_capture_ntp_ms_ = 0;
+};
+
+} // namespace xrtc
+
+#endif // XRTCSDK_XRTC_RTC_MODULES_RTP_RTCP_ABSOLUTE_CAPTURE_TIME_RECEIVER_H_
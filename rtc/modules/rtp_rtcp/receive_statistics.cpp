@@ -0,0 +1,96 @@
+﻿#include "xrtc/rtc/modules/rtp_rtcp/receive_statistics.h"
+
+#include <stdlib.h>
+
+#include <algorithm>
+
+namespace xrtc {
+
+namespace {
+// 和上一个包的时间差超过该值时不更新抖动，例如发送端暂停之后恢复
+const int64_t kMaxJitterUpdateIntervalMs = 5000;
+} // namespace
+
+ReceiveStatistics::ReceiveStatistics(int clock_rate) :
+    clock_rate_(clock_rate)
+{
+}
+
+ReceiveStatistics::~ReceiveStatistics() {
+}
+
+void ReceiveStatistics::OnRtpPacket(const RtpPacketReceived& packet) {
+    int64_t seq = seq_unwrapper_.Unwrap(packet.sequence_number());
+    ++received_packets_;
+
+    if (received_seq_first_ < 0) {
+        ssrc_ = packet.ssrc();
+        received_seq_first_ = seq;
+        received_seq_max_ = seq;
+        last_report_seq_max_ = seq - 1;
+        last_receive_time_ms_ = packet.arrival_time_ms();
+        last_received_timestamp_ = packet.timestamp();
+        return;
+    }
+
+    // 乱序和重传的包只计数，不更新最大序列号和抖动
+    if (seq <= received_seq_max_ || packet.recovered()) {
+        return;
+    }
+
+    received_seq_max_ = seq;
+    UpdateJitter(packet);
+}
+
+// J(i) = J(i-1) + (|D(i-1,i)| - J(i-1)) / 16
+void ReceiveStatistics::UpdateJitter(const RtpPacketReceived& packet) {
+    int64_t receive_diff_ms = packet.arrival_time_ms() - last_receive_time_ms_;
+    uint32_t timestamp = packet.timestamp();
+    if (timestamp != last_received_timestamp_ && receive_diff_ms >= 0 &&
+        receive_diff_ms < kMaxJitterUpdateIntervalMs)
+    {
+        int64_t receive_diff_rtp = receive_diff_ms * clock_rate_ / 1000;
+        int32_t time_diff_samples = (int32_t)(receive_diff_rtp -
+            (int32_t)(timestamp - last_received_timestamp_));
+        time_diff_samples = std::abs(time_diff_samples);
+        // 时间戳跳变时的异常值不参与计算
+        if (time_diff_samples < 450000) {
+            int32_t jitter_diff_q4 = (time_diff_samples << 4) - (int32_t)jitter_q4_;
+            jitter_q4_ += ((jitter_diff_q4 + 8) >> 4);
+        }
+    }
+
+    last_receive_time_ms_ = packet.arrival_time_ms();
+    last_received_timestamp_ = timestamp;
+}
+
+std::vector<rtcp::ReportBlock> ReceiveStatistics::RtcpReportBlocks(size_t max_blocks) {
+    std::vector<rtcp::ReportBlock> result;
+    if (0 == max_blocks || received_seq_first_ < 0) {
+        return result;
+    }
+
+    int64_t expected_since_last = received_seq_max_ - last_report_seq_max_;
+    int64_t received_since_last = received_packets_ - last_report_received_packets_;
+    int64_t lost_since_last = expected_since_last - received_since_last;
+    uint8_t fraction_lost = 0;
+    if (expected_since_last > 0 && lost_since_last > 0) {
+        fraction_lost = (uint8_t)std::min<int64_t>(255,
+            (lost_since_last << 8) / expected_since_last);
+    }
+
+    int64_t expected = received_seq_max_ - received_seq_first_ + 1;
+    rtcp::ReportBlock block;
+    block.SetMediaSsrc(ssrc_);
+    block.SetFractionLost(fraction_lost);
+    block.SetCumulativeLost((int32_t)(expected - received_packets_));
+    block.SetExtHighestSeqNum((uint32_t)received_seq_max_);
+    block.SetJitter(jitter_q4_ >> 4);
+    result.push_back(block);
+
+    last_report_seq_max_ = received_seq_max_;
+    last_report_received_packets_ = received_packets_;
+    return result;
+}
+
+} // namespace xrtc
\ No newline at end of file
@@ -0,0 +1,57 @@
+﻿#ifndef XRTCSDK_XRTC_RTC_MODULES_RTP_RTCP_RECEIVE_STATISTICS_H_
+#define XRTCSDK_XRTC_RTC_MODULES_RTP_RTCP_RECEIVE_STATISTICS_H_
+
+#include <vector>
+
+#include <rtc_base/numerics/sequence_number_util.h>
+
+#include "xrtc/rtc/modules/rtp_rtcp/rtp_packet_received.h"
+#include "xrtc/rtc/modules/rtp_rtcp/rtcp_packet/report_block.h"
+
+namespace xrtc {
+
+// RTCPSender通过该接口获取RR中的report block
+class ReceiveStatisticsProvider {
+public:
+    virtual ~ReceiveStatisticsProvider() = default;
+    // 返回的report block中LSR和DLSR由RTCPSender填写
+    virtual std::vector<rtcp::ReportBlock> RtcpReportBlocks(size_t max_blocks) = 0;
+};
+
+// 一路接收媒体流的统计(RFC 3550 A.3、A.8)：丢包数、丢包率、最大序列号和抖动
+// 需要和RTCPSender在同一个线程调用
+class ReceiveStatistics : public ReceiveStatisticsProvider {
+public:
+    explicit ReceiveStatistics(int clock_rate);
+    ~ReceiveStatistics() override;
+
+    // 包括RTX恢复的包，不包括padding
+    void OnRtpPacket(const RtpPacketReceived& packet);
+
+    // ReceiveStatisticsProvider
+    std::vector<rtcp::ReportBlock> RtcpReportBlocks(size_t max_blocks) override;
+
+private:
+    void UpdateJitter(const RtpPacketReceived& packet);
+
+private:
+    int clock_rate_;
+    uint32_t ssrc_ = 0;
+    webrtc::SeqNumUnwrapper<uint16_t> seq_unwrapper_;
+    // 还没有收到包时为-1
+    int64_t received_seq_first_ = -1;
+    int64_t received_seq_max_ = -1;
+    // 收到的包数，包括重传和重复的包，累计丢包数可能为负
+    uint32_t received_packets_ = 0;
+    // 抖动放大16倍保存，避免计算中的精度损失
+    uint32_t jitter_q4_ = 0;
+    int64_t last_receive_time_ms_ = 0;
+    uint32_t last_received_timestamp_ = 0;
+    // 上一次生成report block时的状态，用于计算这段时间内的丢包率
+    int64_t last_report_seq_max_ = -1;
+    uint32_t last_report_received_packets_ = 0;
+};
+
+} // namespace xrtc
+
+#endif // XRTCSDK_XRTC_RTC_MODULES_RTP_RTCP_RECEIVE_STATISTICS_H_
\ No newline at end of file
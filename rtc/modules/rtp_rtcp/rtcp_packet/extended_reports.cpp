@@ -0,0 +1,172 @@
+﻿#include "xrtc/rtc/modules/rtp_rtcp/rtcp_packet/extended_reports.h"
+
+#include <rtc_base/logging.h>
+#include <modules/rtp_rtcp/source/byte_io.h>
+
+#include "xrtc/rtc/modules/rtp_rtcp/rtcp_packet/common_header.h"
+
+namespace xrtc {
+namespace rtcp {
+
+// From RFC 3611: RTP Control Protocol Extended Reports (RTCP XR).
+//
+//    0                   1                   2                   3
+//    0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+//   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//   |V=2|P|reserved |   PT=XR=207   |             length            |
+//   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//   |                              SSRC                             |
+//   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//   :                         report blocks                         :
+//   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+// 每个block的头部：
+//   |     BT        | type-specific |         block length          |
+// block length是头部之后的32位字的个数
+//
+// Receiver Reference Time Report Block (RRTR), BT=4, block length=2
+//   |                     NTP timestamp, most significant word      |
+//   |                     NTP timestamp, least significant word     |
+//
+// DLRR Report Block, BT=5, block length=3*n
+//   |                 SSRC_1 (SSRC of first receiver)               |
+//   |                         last RR (LRR)                         |
+//   |                   delay since last RR (DLRR)                  |
+size_t ExtendedReports::BlockLength() const {
+    size_t length = kHeaderSize + kXrBaseLength;
+    if (rrtr_ntp_) {
+        length += kRrtrLength;
+    }
+    if (!dlrr_items_.empty()) {
+        length += kBlockHeaderLength + dlrr_items_.size() * kDlrrItemLength;
+    }
+    return length;
+}
+
+bool ExtendedReports::Create(uint8_t* packet,
+    size_t* index,
+    size_t max_length,
+    PacketReadyCallback callback) const
+{
+    while (*index + BlockLength() > max_length) {
+        if (!OnBufferFull(packet, index, callback)) {
+            return false;
+        }
+    }
+
+    CreateHeader(0, kPacketType, HeaderLength(), packet, index);
+    webrtc::ByteWriter<uint32_t>::WriteBigEndian(packet + *index, sender_ssrc());
+    *index += kXrBaseLength;
+
+    if (rrtr_ntp_) {
+        packet[*index] = kRrtrBlockType;
+        packet[*index + 1] = 0;
+        webrtc::ByteWriter<uint16_t>::WriteBigEndian(packet + *index + 2, 2);
+        webrtc::ByteWriter<uint32_t>::WriteBigEndian(packet + *index + 4,
+            rrtr_ntp_->seconds());
+        webrtc::ByteWriter<uint32_t>::WriteBigEndian(packet + *index + 8,
+            rrtr_ntp_->fractions());
+        *index += kRrtrLength;
+    }
+
+    if (!dlrr_items_.empty()) {
+        packet[*index] = kDlrrBlockType;
+        packet[*index + 1] = 0;
+        webrtc::ByteWriter<uint16_t>::WriteBigEndian(packet + *index + 2,
+            (uint16_t)(dlrr_items_.size() * kDlrrItemLength / 4));
+        *index += kBlockHeaderLength;
+        for (const ReceiveTimeInfo& item : dlrr_items_) {
+            webrtc::ByteWriter<uint32_t>::WriteBigEndian(packet + *index, item.ssrc);
+            webrtc::ByteWriter<uint32_t>::WriteBigEndian(packet + *index + 4,
+                item.last_rr);
+            webrtc::ByteWriter<uint32_t>::WriteBigEndian(packet + *index + 8,
+                item.delay_since_last_rr);
+            *index += kDlrrItemLength;
+        }
+    }
+
+    return true;
+}
+
+bool ExtendedReports::Parse(const CommonHeader& packet) {
+    if (packet.payload_size() < kXrBaseLength) {
+        RTC_LOG(LS_WARNING) << "payload length " << packet.payload_size()
+            << " is too small for xr";
+        return false;
+    }
+
+    SetSenderSsrc(webrtc::ByteReader<uint32_t>::ReadBigEndian(packet.payload()));
+    rrtr_ntp_.reset();
+    dlrr_items_.clear();
+
+    const uint8_t* current_block = packet.payload() + kXrBaseLength;
+    const uint8_t* const packet_end = packet.payload() + packet.payload_size();
+    while (current_block + kBlockHeaderLength <= packet_end) {
+        uint8_t block_type = current_block[0];
+        uint16_t block_length = webrtc::ByteReader<uint16_t>::ReadBigEndian(
+            current_block + 2);
+        const uint8_t* next_block = current_block + kBlockHeaderLength +
+            block_length * 4;
+        if (next_block > packet_end) {
+            RTC_LOG(LS_WARNING) << "xr block type: " << (int)block_type
+                << " length exceeds packet";
+            break;
+        }
+
+        // 其它类型的block直接跳过
+        switch (block_type) {
+        case kRrtrBlockType:
+            ParseRrtrBlock(current_block, block_length);
+            break;
+        case kDlrrBlockType:
+            ParseDlrrBlock(current_block, block_length);
+            break;
+        default:
+            break;
+        }
+
+        current_block = next_block;
+    }
+
+    return true;
+}
+
+bool ExtendedReports::AddDlrrItem(const ReceiveTimeInfo& time_info) {
+    if (dlrr_items_.size() >= kMaxNumberOfDlrrItems) {
+        RTC_LOG(LS_WARNING) << "max dlrr items reached";
+        return false;
+    }
+
+    dlrr_items_.push_back(time_info);
+    return true;
+}
+
+void ExtendedReports::ParseRrtrBlock(const uint8_t* block, uint16_t block_length) {
+    if (block_length != 2) {
+        RTC_LOG(LS_WARNING) << "invalid rrtr block length: " << block_length;
+        return;
+    }
+
+    uint32_t seconds = webrtc::ByteReader<uint32_t>::ReadBigEndian(block + 4);
+    uint32_t fractions = webrtc::ByteReader<uint32_t>::ReadBigEndian(block + 8);
+    rrtr_ntp_ = webrtc::NtpTime(seconds, fractions);
+}
+
+void ExtendedReports::ParseDlrrBlock(const uint8_t* block, uint16_t block_length) {
+    if (block_length % 3 != 0) {
+        RTC_LOG(LS_WARNING) << "invalid dlrr block length: " << block_length;
+        return;
+    }
+
+    const uint8_t* item = block + kBlockHeaderLength;
+    for (uint16_t i = 0; i < block_length / 3; ++i) {
+        dlrr_items_.emplace_back(
+            webrtc::ByteReader<uint32_t>::ReadBigEndian(item),
+            webrtc::ByteReader<uint32_t>::ReadBigEndian(item + 4),
+            webrtc::ByteReader<uint32_t>::ReadBigEndian(item + 8));
+        item += kDlrrItemLength;
+    }
+}
+
+} // namespace rtcp
+} // namespace xrtc
\ No newline at end of file
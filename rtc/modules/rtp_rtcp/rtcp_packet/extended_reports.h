@@ -0,0 +1,71 @@
+﻿#ifndef XRTCSDK_XRTC_RTC_MODULES_RTP_RTCP_RTCP_PACKET_EXTENDED_REPORTS_H_
+#define XRTCSDK_XRTC_RTC_MODULES_RTP_RTCP_RTCP_PACKET_EXTENDED_REPORTS_H_
+
+#include <vector>
+
+#include <absl/types/optional.h>
+#include <system_wrappers/include/ntp_time.h>
+
+#include "xrtc/rtc/modules/rtp_rtcp/rtcp_packet.h"
+
+namespace xrtc {
+namespace rtcp {
+
+class CommonHeader;
+
+// DLRR中的一项，时间都是compact NTP格式
+struct ReceiveTimeInfo {
+    ReceiveTimeInfo() = default;
+    ReceiveTimeInfo(uint32_t ssrc, uint32_t last_rr, uint32_t delay_since_last_rr) :
+        ssrc(ssrc), last_rr(last_rr), delay_since_last_rr(delay_since_last_rr) {}
+
+    uint32_t ssrc = 0;
+    uint32_t last_rr = 0;
+    uint32_t delay_since_last_rr = 0;
+};
+
+// RTCP XR(RFC 3611)，只支持RRTR和DLRR，用于只接收的一端计算RTT
+// 接收端发送RRTR，发送端在DLRR中带回RRTR的时间和处理延迟
+class ExtendedReports : public RtcpPacket {
+public:
+    static const uint8_t kPacketType = 207;
+    static const size_t kMaxNumberOfDlrrItems = 50;
+
+    ExtendedReports() = default;
+    ~ExtendedReports() override = default;
+
+    size_t BlockLength() const override;
+
+    bool Create(uint8_t* packet,
+        size_t* index,
+        size_t max_length,
+        PacketReadyCallback callback) const override;
+
+    bool Parse(const CommonHeader& packet);
+
+    void SetRrtr(webrtc::NtpTime ntp) { rrtr_ntp_ = ntp; }
+    bool AddDlrrItem(const ReceiveTimeInfo& time_info);
+
+    const absl::optional<webrtc::NtpTime>& rrtr() const { return rrtr_ntp_; }
+    const std::vector<ReceiveTimeInfo>& dlrr_items() const { return dlrr_items_; }
+
+private:
+    static const size_t kXrBaseLength = 4;
+    static const size_t kBlockHeaderLength = 4;
+    // 包括block的头部
+    static const size_t kRrtrLength = 12;
+    static const size_t kDlrrItemLength = 12;
+    static const uint8_t kRrtrBlockType = 4;
+    static const uint8_t kDlrrBlockType = 5;
+
+    void ParseRrtrBlock(const uint8_t* block, uint16_t block_length);
+    void ParseDlrrBlock(const uint8_t* block, uint16_t block_length);
+
+    absl::optional<webrtc::NtpTime> rrtr_ntp_;
+    std::vector<ReceiveTimeInfo> dlrr_items_;
+};
+
+} // namespace rtcp
+} // namespace xrtc
+
+#endif // XRTCSDK_XRTC_RTC_MODULES_RTP_RTCP_RTCP_PACKET_EXTENDED_REPORTS_H_
\ No newline at end of file
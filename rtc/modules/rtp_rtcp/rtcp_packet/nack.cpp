@@ -1,5 +1,7 @@
 ﻿#include "xrtc/rtc/modules/rtp_rtcp/rtcp_packet/nack.h"
 
+#include <algorithm>
+
 #include <rtc_base/logging.h>
 #include <modules/rtp_rtcp/source/byte_io.h>
 
@@ -9,7 +11,7 @@ namespace xrtc {
 namespace rtcp {
 
 size_t Nack::BlockLength() const {
-    return size_t();
+    return kHeaderSize + kCommonFeedabackLength + packed_.size() * kNackItemLength;
 }
 
 bool Nack::Create(uint8_t* packet, 
@@ -17,7 +19,41 @@ bool Nack::Create(uint8_t* packet,
     size_t max_length, 
     PacketReadyCallback callback) const 
 {
-    return false;
+    // 每个NACK包至少需要包含一个item，放不下时拆分成多个NACK包
+    const size_t kNackHeaderLength = kHeaderSize + kCommonFeedabackLength;
+    for (size_t nack_index = 0; nack_index < packed_.size();) {
+        size_t bytes_left_in_buffer = max_length - *index;
+        if (bytes_left_in_buffer < kNackHeaderLength + kNackItemLength) {
+            if (!OnBufferFull(packet, index, callback)) {
+                return false;
+            }
+            continue;
+        }
+
+        size_t num_nack_fields = std::min((bytes_left_in_buffer - kNackHeaderLength) /
+            kNackItemLength, packed_.size() - nack_index);
+        size_t payload_size_bytes = kCommonFeedabackLength + num_nack_fields * kNackItemLength;
+        CreateHeader(kFeedbackMessageType, kPacketType, payload_size_bytes / 4,
+            packet, index);
+        CreateCommonFeedback(packet + *index);
+        *index += kCommonFeedabackLength;
+
+        size_t end_index = nack_index + num_nack_fields;
+        for (; nack_index < end_index; ++nack_index) {
+            const PackedNack& item = packed_[nack_index];
+            webrtc::ByteWriter<uint16_t>::WriteBigEndian(packet + *index, item.first_pid);
+            webrtc::ByteWriter<uint16_t>::WriteBigEndian(packet + *index + 2, item.bitmask);
+            *index += kNackItemLength;
+        }
+    }
+
+    return true;
+}
+
+void Nack::SetPacketIds(const uint16_t* nack_list, size_t length) {
+    packet_ids_.assign(nack_list, nack_list + length);
+    packed_.clear();
+    Pack();
 }
 
 bool Nack::Parse(const rtcp::CommonHeader& packet) {
@@ -49,6 +85,26 @@ bool Nack::Parse(const rtcp::CommonHeader& packet) {
     return true;
 }
 
+void Nack::Pack() {
+    // 第一个seq之后的16个seq用bitmask表示
+    auto it = packet_ids_.begin();
+    const auto end = packet_ids_.end();
+    while (it != end) {
+        PackedNack item;
+        item.first_pid = *it++;
+        item.bitmask = 0;
+        while (it != end) {
+            uint16_t shift = static_cast<uint16_t>(*it - item.first_pid - 1);
+            if (shift > 15) {
+                break;
+            }
+            item.bitmask |= (1 << shift);
+            ++it;
+        }
+        packed_.push_back(item);
+    }
+}
+
 void Nack::Unpack() {
     for (const PackedNack& nack : packed_) {
         packet_ids_.push_back(nack.first_pid);
@@ -24,6 +24,8 @@ public:
         PacketReadyCallback callback) const override;
 
     bool Parse(const rtcp::CommonHeader& packet);
+    // nack_list需要按照seq从旧到新排列
+    void SetPacketIds(const uint16_t* nack_list, size_t length);
 
     const std::vector<uint16_t> packet_ids() const {
         return packet_ids_;
@@ -36,6 +38,7 @@ private:
         uint16_t bitmask;
     };
 
+    void Pack();
     void Unpack();
 
     std::vector<PackedNack> packed_;
@@ -0,0 +1,55 @@
+﻿#include "xrtc/rtc/modules/rtp_rtcp/rtcp_packet/pli.h"
+
+#include <rtc_base/logging.h>
+
+#include "xrtc/rtc/modules/rtp_rtcp/rtcp_packet/common_header.h"
+
+namespace xrtc {
+namespace rtcp {
+
+// RFC 4585: Feedback format.
+//
+//     0                   1                   2                   3
+//     0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+//    +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//    |V=2|P| FMT=1   |   PT=PSFB=206 |          length=2             |
+//    +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//    |                  SSRC of packet sender                        |
+//    +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//    |                  SSRC of media source                         |
+//    +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// PLI没有FCI
+size_t Pli::BlockLength() const {
+    return kHeaderSize + kCommonFeedbackLength;
+}
+
+bool Pli::Create(uint8_t* packet,
+    size_t* index,
+    size_t max_length,
+    PacketReadyCallback callback) const
+{
+    while (*index + BlockLength() > max_length) {
+        if (!OnBufferFull(packet, index, callback)) {
+            return false;
+        }
+    }
+
+    CreateHeader(kFeedbackMessageType, kPacketType, HeaderLength(), packet, index);
+    CreateCommonFeedback(packet + *index);
+    *index += kCommonFeedbackLength;
+    return true;
+}
+
+bool Pli::Parse(const CommonHeader& packet) {
+    if (packet.payload_size() < kCommonFeedbackLength) {
+        RTC_LOG(LS_WARNING) << "payload length " << packet.payload_size()
+            << " is too small for pli";
+        return false;
+    }
+
+    ParseCommonFeedback(packet.payload());
+    return true;
+}
+
+} // namespace rtcp
+} // namespace xrtc
\ No newline at end of file
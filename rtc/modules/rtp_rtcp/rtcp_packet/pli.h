@@ -0,0 +1,31 @@
+﻿#ifndef XRTCSDK_XRTC_RTC_MODULES_RTP_RTCP_RTCP_PACKET_PLI_H_
+#define XRTCSDK_XRTC_RTC_MODULES_RTP_RTCP_RTCP_PACKET_PLI_H_
+
+#include "xrtc/rtc/modules/rtp_rtcp/rtcp_packet/psfb.h"
+
+namespace xrtc {
+namespace rtcp {
+
+class CommonHeader;
+
+// Picture Loss Indication，请求发送端编码关键帧
+class Pli : public Psfb {
+public:
+    static const uint8_t kFeedbackMessageType = 1;
+    Pli() = default;
+    ~Pli() override = default;
+
+    size_t BlockLength() const override;
+
+    bool Create(uint8_t* packet,
+        size_t* index,
+        size_t max_length,
+        PacketReadyCallback callback) const override;
+
+    bool Parse(const CommonHeader& packet);
+};
+
+} // namespace rtcp
+} // namespace xrtc
+
+#endif // XRTCSDK_XRTC_RTC_MODULES_RTP_RTCP_RTCP_PACKET_PLI_H_
\ No newline at end of file
@@ -0,0 +1,31 @@
+﻿#ifndef XRTCSDK_XRTC_RTC_MODULES_RTP_RTCP_RTCP_PACKET_PSFB_H_
+#define XRTCSDK_XRTC_RTC_MODULES_RTP_RTCP_RTCP_PACKET_PSFB_H_
+
+#include "xrtc/rtc/modules/rtp_rtcp/rtcp_packet.h"
+
+namespace xrtc {
+namespace rtcp {
+
+// 负载相关的反馈包(RFC 4585)，PLI等
+class Psfb : public RtcpPacket {
+public:
+    static const uint8_t kPacketType = 206;
+    Psfb() = default;
+    ~Psfb() override = default;
+
+    void SetMediaSsrc(uint32_t ssrc) { media_ssrc_ = ssrc; }
+    uint32_t media_ssrc() const { return media_ssrc_; }
+
+protected:
+    static const size_t kCommonFeedbackLength = 8;
+    void ParseCommonFeedback(const uint8_t* payload);
+    void CreateCommonFeedback(uint8_t* payload) const;
+
+private:
+    uint32_t media_ssrc_ = 0;
+};
+
+} // namespace rtcp
+} // namespace xrtc
+
+#endif // XRTCSDK_XRTC_RTC_MODULES_RTP_RTCP_RTCP_PACKET_PSFB_H_
\ No newline at end of file
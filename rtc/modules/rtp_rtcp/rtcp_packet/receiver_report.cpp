@@ -15,7 +15,22 @@ bool ReceiverReport::Create(uint8_t* packet,
     size_t max_length, 
     PacketReadyCallback callback) const 
 {
-    return false;
+    while (*index + BlockLength() > max_length) {
+        if (!OnBufferFull(packet, index, callback)) {
+            return false;
+        }
+    }
+
+    CreateHeader(report_blocks_.size(), kPacketType, HeaderLength(), packet, index);
+    webrtc::ByteWriter<uint32_t>::WriteBigEndian(&packet[*index], sender_ssrc());
+    *index += kRrBaseLength;
+
+    for (const ReportBlock& report_block : report_blocks_) {
+        report_block.Create(&packet[*index]);
+        *index += ReportBlock::kLength;
+    }
+
+    return true;
 }
 
 // RTCP receiver report (RFC 3550).
@@ -51,6 +66,15 @@ bool ReceiverReport::Parse(const CommonHeader& packet) {
     return true;
 }
 
+bool ReceiverReport::AddReportBlock(const ReportBlock& block) {
+    if (report_blocks_.size() >= kMaxNumberOfReportBlocks) {
+        RTC_LOG(LS_WARNING) << "max report blocks reached";
+        return false;
+    }
+
+    report_blocks_.push_back(block);
+    return true;
+}
 
 } // namespace rtcp
 } // namespace xrtc
\ No newline at end of file
@@ -13,6 +13,7 @@ namespace rtcp {
 class ReceiverReport : public RtcpPacket {
 public:
     static const uint8_t kPacketType = 201;
+    static const size_t kMaxNumberOfReportBlocks = 0x1f;
 
     ReceiverReport() = default;
     ~ReceiverReport() override = default;
@@ -25,6 +26,8 @@ public:
         PacketReadyCallback callback) const override;
 
     bool Parse(const CommonHeader& packet);
+    // 最多携带kMaxNumberOfReportBlocks个report block
+    bool AddReportBlock(const ReportBlock& block);
 
     const std::vector<ReportBlock>& report_blocks() const {
         return report_blocks_;
@@ -1,5 +1,7 @@
 #include "xrtc/rtc/modules/rtp_rtcp/rtcp_packet/report_block.h"
 
+#include <algorithm>
+
 #include <modules/rtp_rtcp/source/byte_io.h>
 
 namespace xrtc {
@@ -40,5 +42,22 @@ bool ReportBlock::Parse(const uint8_t* buffer, size_t len) {
     return true;
 }
 
+void ReportBlock::SetCumulativeLost(int32_t cumulative_lost) {
+    const int32_t kMaxCumulativeLost = 0x7fffff;
+    const int32_t kMinCumulativeLost = -0x800000;
+    cumulative_packets_lost_ = std::max(kMinCumulativeLost,
+        std::min(kMaxCumulativeLost, cumulative_lost));
+}
+
+void ReportBlock::Create(uint8_t* buffer) const {
+    webrtc::ByteWriter<uint32_t>::WriteBigEndian(&buffer[0], source_ssrc_);
+    webrtc::ByteWriter<uint8_t>::WriteBigEndian(&buffer[4], fraction_lost_);
+    webrtc::ByteWriter<int32_t, 3>::WriteBigEndian(&buffer[5], cumulative_packets_lost_);
+    webrtc::ByteWriter<uint32_t>::WriteBigEndian(&buffer[8], extended_highest_sequence_number_);
+    webrtc::ByteWriter<uint32_t>::WriteBigEndian(&buffer[12], jitter_);
+    webrtc::ByteWriter<uint32_t>::WriteBigEndian(&buffer[16], last_sr_);
+    webrtc::ByteWriter<uint32_t>::WriteBigEndian(&buffer[20], delay_since_last_sr_);
+}
+
 } // namespace rtcp
 } // namespace xrtc
\ No newline at end of file
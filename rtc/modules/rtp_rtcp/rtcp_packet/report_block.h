@@ -13,6 +13,19 @@ public:
     ~ReportBlock() = default;
 
     bool Parse(const uint8_t* buffer, size_t len);
+    // buffer至少需要kLength字节
+    void Create(uint8_t* buffer) const;
+
+    void SetMediaSsrc(uint32_t ssrc) { source_ssrc_ = ssrc; }
+    void SetFractionLost(uint8_t fraction_lost) { fraction_lost_ = fraction_lost; }
+    // 累计丢包数只有24位，超出范围时截断
+    void SetCumulativeLost(int32_t cumulative_lost);
+    void SetExtHighestSeqNum(uint32_t ext_highest_seq_num) {
+        extended_highest_sequence_number_ = ext_highest_seq_num;
+    }
+    void SetJitter(uint32_t jitter) { jitter_ = jitter; }
+    void SetLastSr(uint32_t last_sr) { last_sr_ = last_sr; }
+    void SetDelayLastSr(uint32_t delay_last_sr) { delay_since_last_sr_ = delay_last_sr; }
 
     uint32_t source_ssrc() const { return source_ssrc_; }
     uint32_t last_sr() const { return last_sr_; }
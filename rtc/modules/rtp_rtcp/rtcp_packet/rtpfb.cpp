@@ -10,5 +10,10 @@ void Rtpfb::ParseCommonFeedback(const uint8_t* payload) {
     SetMediaSsrc(webrtc::ByteReader<uint32_t>::ReadBigEndian(payload + 4));
 }
 
+void Rtpfb::CreateCommonFeedback(uint8_t* payload) const {
+    webrtc::ByteWriter<uint32_t>::WriteBigEndian(payload, sender_ssrc());
+    webrtc::ByteWriter<uint32_t>::WriteBigEndian(payload + 4, media_ssrc());
+}
+
 } // namespace rtcp
 } // namespace xrtc
\ No newline at end of file
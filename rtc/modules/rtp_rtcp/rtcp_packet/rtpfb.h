@@ -18,6 +18,7 @@ public:
 protected:
     static const size_t kCommonFeedabackLength = 8;
     void ParseCommonFeedback(const uint8_t* payload);
+    void CreateCommonFeedback(uint8_t* payload) const;
 
 private:
     uint32_t media_ssrc_ = 0;
@@ -1,5 +1,6 @@
 #include "xrtc/rtc/modules/rtp_rtcp/rtcp_packet/sender_report.h"
 
+#include <rtc_base/logging.h>
 #include <modules/rtp_rtcp/source/byte_io.h>
 
 namespace xrtc {
@@ -42,7 +43,38 @@ bool SenderReport::Create(uint8_t* packet,
 
     *index += kSenderBaseLength;
 
-    // TODO: 写入report block
+    for (const ReportBlock& report_block : report_blocks_) {
+        report_block.Create(&packet[*index]);
+        *index += ReportBlock::kLength;
+    }
+
+    return true;
+}
+
+bool SenderReport::Parse(const CommonHeader& packet) {
+    const uint8_t report_count = packet.count();
+    if (packet.payload_size() < kSenderBaseLength + report_count * ReportBlock::kLength) {
+        RTC_LOG(LS_WARNING) << "sr payload_size is not enough, payload_size: "
+            << packet.payload_size() << ", report_count: " << report_count;
+        return false;
+    }
+
+    const uint8_t* payload = packet.payload();
+    SetSenderSsrc(webrtc::ByteReader<uint32_t>::ReadBigEndian(&payload[0]));
+    uint32_t seconds = webrtc::ByteReader<uint32_t>::ReadBigEndian(&payload[4]);
+    uint32_t fractions = webrtc::ByteReader<uint32_t>::ReadBigEndian(&payload[8]);
+    ntp_time_.Set(seconds, fractions);
+    rtp_timestamp_ = webrtc::ByteReader<uint32_t>::ReadBigEndian(&payload[12]);
+    send_packet_count_ = webrtc::ByteReader<uint32_t>::ReadBigEndian(&payload[16]);
+    send_packet_octet_ = webrtc::ByteReader<uint32_t>::ReadBigEndian(&payload[20]);
+
+    const uint8_t* next_report_block = payload + kSenderBaseLength;
+    report_blocks_.resize(report_count);
+    for (auto& report_block : report_blocks_) {
+        report_block.Parse(next_report_block, ReportBlock::kLength);
+        next_report_block += ReportBlock::kLength;
+    }
+
     return true;
 }
 
@@ -7,6 +7,7 @@
 
 #include "xrtc/rtc/modules/rtp_rtcp/rtcp_packet.h"
 #include "xrtc/rtc/modules/rtp_rtcp/rtcp_packet/report_block.h"
+#include "xrtc/rtc/modules/rtp_rtcp/rtcp_packet/common_header.h"
 
 namespace xrtc {
 namespace rtcp {
@@ -38,11 +39,16 @@ public:
     }
     uint32_t send_packet_octet() { return send_packet_octet_; }
 
+    const std::vector<ReportBlock>& report_blocks() const {
+        return report_blocks_;
+    }
+
     size_t BlockLength() const override;
     bool Create(uint8_t* packet,
         size_t* index,
         size_t max_length,
         PacketReadyCallback callback) const override;
+    bool Parse(const CommonHeader& packet);
 
 private:
     static const size_t kSenderBaseLength = 24;
@@ -1,7 +1,10 @@
 #include "xrtc/rtc/modules/rtp_rtcp/rtcp_packet/transport_feedback.h"
 
+#include <string.h>
+
+#include <rtc_base/checks.h>
 #include <rtc_base/logging.h>
-#include<absl/algorithm/container.h>
+#include <rtc_base/numerics/sequence_number_util.h>
 #include <modules/rtp_rtcp/source/byte_io.h>
 namespace xrtc {
 
@@ -15,8 +18,29 @@ const size_t kRtcpTransportFeedbackHeaderSize = 4 + 8 + 8;
 // 至少要包含一个 packet chunk：   2 字节
 const size_t kMinPayloadSizeBytes = 8+8+2;
 const size_t kChunkSizeBytes = 2;
+//RTCP的length字段是16bit，以4字节为单位
+const size_t kMaxSizeBytes = (1 << 16) * 4;
 constexpr int64_t kBaseScaleFactor = TransportFeedback::kDeltaScaleFactor*256;//64ms
 const int64_t kTimeWrapPeriodUs =(1ll<<24)*kBaseScaleFactor;
+
+//状态矢量编码块的解码表，按字节查表一次展开多个RTP包的状态，避免逐bit移位
+struct StatusSymbolTable {
+    constexpr StatusSymbolTable() : one_bit(), two_bit() {
+        for(int v = 0; v < 128; ++v) {
+            for(int i = 0; i < 7; ++i) {
+                one_bit[v][i] = (v >> (6 - i)) & 0x1;
+            }
+        }
+        for(int v = 0; v < 256; ++v) {
+            for(int i = 0; i < 4; ++i) {
+                two_bit[v][i] = (v >> (2 * (3 - i))) & 0x3;
+            }
+        }
+    }
+    uint8_t one_bit[128][7];
+    uint8_t two_bit[256][4];
+};
+constexpr StatusSymbolTable kStatusSymbolTable;
 // Message format
 //
 // 0 1 2 3
@@ -45,12 +69,149 @@ const int64_t kTimeWrapPeriodUs =(1ll<<24)*kBaseScaleFactor;
 // | recv delta | recv delta | zero padding |
 // +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 }
+TransportFeedback::TransportFeedback() :
+    size_bytes_(kRtcpTransportFeedbackHeaderSize) {}
+
+void TransportFeedback::SetBase(uint16_t base_sequence, int64_t ref_timestamp_us) {
+    base_seq_no_ = base_sequence;
+    //参考时间是24bit，以64ms为单位，超出范围时回绕
+    base_time_ticks_ = (ref_timestamp_us % kTimeWrapPeriodUs) / kBaseScaleFactor;
+    last_timestamp_us_ = GetBaseTimeUs();
+}
+
+bool TransportFeedback::AddReceivedPacket(uint16_t sequence_number,
+    int64_t timestamp_us)
+{
+    //与上一个包的时间差换算成250us的单位，四舍五入
+    int64_t delta_full = (timestamp_us - last_timestamp_us_) % kTimeWrapPeriodUs;
+    if(delta_full > kTimeWrapPeriodUs / 2) {
+        delta_full -= kTimeWrapPeriodUs;
+    }
+    delta_full += delta_full < 0 ? -(kDeltaScaleFactor / 2) : kDeltaScaleFactor / 2;
+    delta_full /= kDeltaScaleFactor;
+
+    int16_t delta = static_cast<int16_t>(delta_full);
+    if(delta != delta_full) {
+        RTC_LOG(LS_WARNING) << "delta value too large: " << delta_full;
+        return false;
+    }
+
+    //中间没有收到的包记为丢失
+    uint16_t next_seq_no = base_seq_no_ + num_seq_no_;
+    if(sequence_number != next_seq_no) {
+        uint16_t last_seq_no = next_seq_no - 1;
+        if(!webrtc::AheadOf(sequence_number, last_seq_no)) {
+            return false;
+        }
+        for(; next_seq_no != sequence_number; ++next_seq_no) {
+            if(!AddDeltaSize(0)) {
+                return false;
+            }
+        }
+    }
+
+    //recv delta在0~255之间用1字节表示，否则用2字节
+    uint8_t delta_size = (delta >= 0 && delta <= 0xff) ? 1 : 2;
+    if(!AddDeltaSize(delta_size)) {
+        return false;
+    }
+
+    if(1 == delta_size) {
+        encoded_deltas_.push_back(static_cast<uint8_t>(delta));
+    }else{
+        encoded_deltas_.push_back(static_cast<uint8_t>((delta >> 8) & 0xff));
+        encoded_deltas_.push_back(static_cast<uint8_t>(delta & 0xff));
+    }
+    last_timestamp_us_ += delta * kDeltaScaleFactor;
+    size_bytes_ += delta_size;
+    return true;
+}
+
+bool TransportFeedback::AddDeltaSize(uint8_t delta_size) {
+    if(num_seq_no_ == kMaxReportedPackets) {
+        return false;
+    }
+
+    size_t add_chunk_size = last_chunk_.Empty() ? kChunkSizeBytes : 0;
+    if(size_bytes_ + delta_size + add_chunk_size > kMaxSizeBytes) {
+        return false;
+    }
+
+    if(last_chunk_.CanAdd(delta_size)) {
+        size_bytes_ += add_chunk_size;
+        last_chunk_.Add(delta_size);
+        ++num_seq_no_;
+        return true;
+    }
+
+    //当前chunk已经放不下，输出之后再添加
+    if(size_bytes_ + delta_size + kChunkSizeBytes > kMaxSizeBytes) {
+        return false;
+    }
+
+    encoded_chunks_.push_back(last_chunk_.Emit());
+    size_bytes_ += kChunkSizeBytes;
+    last_chunk_.Add(delta_size);
+    ++num_seq_no_;
+    return true;
+}
+
+//按4字节对齐
 size_t TransportFeedback::BlockLength() const {
-    return 0;
+    return (size_bytes_ + 3) & (~static_cast<size_t>(3));
 }
+
 bool TransportFeedback::Create(uint8_t* packet,size_t* index,
     size_t max_length,PacketReadyCallback callback) const {
-    return false;
+    if(0 == num_seq_no_) {
+        return false;
+    }
+
+    while(*index + BlockLength() > max_length) {
+        if(!OnBufferFull(packet, index, callback)) {
+            return false;
+        }
+    }
+
+    const size_t index_end = *index + BlockLength();
+    const size_t padding_length = BlockLength() - size_bytes_;
+    CreateHeader(kFeedbackMessageType, kPacketType, HeaderLength(),
+        padding_length > 0, packet, index);
+    CreateCommonFeedback(packet + *index);
+    *index += kCommonFeedabackLength;
+
+    webrtc::ByteWriter<uint16_t>::WriteBigEndian(&packet[*index], base_seq_no_);
+    *index += 2;
+    webrtc::ByteWriter<uint16_t>::WriteBigEndian(&packet[*index], num_seq_no_);
+    *index += 2;
+    webrtc::ByteWriter<uint32_t, 3>::WriteBigEndian(&packet[*index], base_time_ticks_);
+    *index += 3;
+    packet[(*index)++] = feedback_seq_;
+
+    for(uint16_t chunk : encoded_chunks_) {
+        webrtc::ByteWriter<uint16_t>::WriteBigEndian(&packet[*index], chunk);
+        *index += kChunkSizeBytes;
+    }
+    if(!last_chunk_.Empty()) {
+        webrtc::ByteWriter<uint16_t>::WriteBigEndian(&packet[*index],
+            last_chunk_.EncodeLast());
+        *index += kChunkSizeBytes;
+    }
+
+    if(include_timestamps_ && !encoded_deltas_.empty()) {
+        memcpy(&packet[*index], encoded_deltas_.data(), encoded_deltas_.size());
+        *index += encoded_deltas_.size();
+    }
+
+    //填充的最后一个字节是填充的长度
+    if(padding_length > 0) {
+        memset(&packet[*index], 0, padding_length - 1);
+        *index += padding_length - 1;
+        packet[(*index)++] = static_cast<uint8_t>(padding_length);
+    }
+
+    RTC_DCHECK_EQ(*index, index_end);
+    return true;
 }
 
 webrtc::TimeDelta TransportFeedback::GetBaseTime() const {
@@ -108,12 +269,16 @@ bool TransportFeedback::Parse(const rtcp::CommonHeader& packet) {
     //数据块的结束位置
     size_t end_index = packet.payload_size();
 
-    //定义一个vector来保存所有的rtp包状态
-    std::vector<uint8_t> delta_sizes;
-    delta_sizes.reserve(status_count);
+    //第一遍只统计状态的个数和recv delta的总长度，不展开保存每个RTP包的状态
+    size_t num_decoded = 0;
+    //0,RTP包没有收到，就没有对应的recv_delta
+    //1,RTP包收到了，数据包间隔比较小，recv_delta使用1字节来表示时间
+    //2，RTP收到了，数据包间隔比较大，recv_delta使用2字节来表示时间
+    size_t recv_delta_size = 0;
+    bool has_invalid_delta = false;
 
     //读取完所有的Packet chunk包的状态信息，才会结束循环
-    while(delta_sizes.size() < status_count) {
+    while(num_decoded < status_count) {
         if(index + kChunkSizeBytes > end_index) {
             RTC_LOG(LS_WARNING) << "Buffer overlow when parsing transport feedback";
             Clear();
@@ -126,87 +291,83 @@ bool TransportFeedback::Parse(const rtcp::CommonHeader& packet) {
         index += kChunkSizeBytes;
 
         //解码chunk
-        last_chunk_.Decode(chunk,status_count - delta_sizes.size());
-        last_chunk_.AppendTo(&delta_sizes);
+        last_chunk_.Decode(chunk,status_count - num_decoded);
+        num_decoded += last_chunk_.size();
+        recv_delta_size += last_chunk_.RecvDeltaSize();
+        has_invalid_delta |= last_chunk_.HasInvalidDelta();
     }
-   
-    num_seq_no_ = status_count;
-    uint16_t seq_no = base_seq_no_;
-    //0,RTP包没有收到，就没有对应的recv_delta
-    //1,RTP包收到了，数据包间隔比较小，recv_delta使用1字节来表示时间
-    //2，RTP收到了，数据包间隔比较大，recv_delta使用2字节来表示时间
-    //所以全部相加刚好等于所有的总数
-    size_t recv_delta_size = absl::c_accumulate(delta_sizes,0);
+
+    size_t chunk_end_index = index;
     //表示存在recv_delta数据块
     if(end_index >= index + recv_delta_size) {
-        for(size_t delta_size : delta_sizes) {
-            if(index + delta_size > end_index) {
-                RTC_LOG(LS_WARNING) << "Buffer overlow when parsing transport feedback";
-                Clear();
-                return false;
-            }
-            switch(delta_size) {
-                case 0:{
-                    if(include_lost_) {
-                        all_packets_.emplace_back(seq_no);
-                    }
-                    break;
-                }
-                case 1:{
-                    int16_t delta =payload[index];
-                    received_packets_.emplace_back(seq_no,delta);
-                    if(include_lost_) {
-                        all_packets_.emplace_back(seq_no);
-                    }
-                    index += delta_size;
-                    break;
-                }
-                case 2:{ 
-                    int16_t delta = webrtc::ByteReader<int16_t>::ReadBigEndian(&payload[index]);
-                    received_packets_.emplace_back(seq_no,delta);
-                    if(include_lost_) {
-                        all_packets_.emplace_back(seq_no);
-                    }
-                    index += delta_size;
-                    break;
-                }
-                case 3:{
-                    RTC_LOG(LS_WARNING) << "invalid seq_no: " << seq_no;
-                    Clear();
-                    return false;
-                }
-                    break;
-                default:
-                    break;
-            }
-            seq_no++;
+        if(has_invalid_delta) {
+            RTC_LOG(LS_WARNING) << "invalid delta size in transport feedback";
+            Clear();
+            return false;
         }
+        index += recv_delta_size;
     }else{ //不包含recv_deltas数据块
         include_timestamps_ = false;
-        for(size_t delta_size : delta_sizes) {
-            if(delta_size>0){
-                received_packets_.emplace_back(seq_no,0);
+    }
+
+    num_seq_no_ = status_count;
+    encoded_.assign(payload + 16, payload + index);
+    encoded_chunk_size_ = chunk_end_index - 16;
+    size_bytes_ = RtcpPacket::kHeaderSize + index;
+    return true;
+}
+
+void TransportFeedback::ForEachPacket(PacketVisitor visitor) const {
+    const uint8_t* chunks = encoded_.data();
+    const uint8_t* deltas = chunks + encoded_chunk_size_;
+    uint16_t seq_no = base_seq_no_;
+    size_t remaining = num_seq_no_;
+    LastChunk chunk;
+    for(size_t i = 0; remaining > 0 && i < encoded_chunk_size_; i += kChunkSizeBytes) {
+        chunk.Decode(webrtc::ByteReader<uint16_t>::ReadBigEndian(&chunks[i]), remaining);
+        remaining -= chunk.size();
+        for(size_t j = 0; j < chunk.size(); ++j, ++seq_no) {
+            uint8_t delta_size = chunk.delta_size(j);
+            if(0 == delta_size) {
+                if(include_lost_) {
+                    visitor(ReceivePacket(seq_no));
+                }
+                continue;
             }
-            if(include_lost_) {
-                if(delta_size>0){
-                    //数据包收到了，但是没有时间信息
-                    all_packets_.emplace_back(seq_no,0);
+
+            //数据包收到了，没有recv delta时间信息为0
+            int16_t delta = 0;
+            if(include_timestamps_) {
+                if(1 == delta_size) {
+                    delta = deltas[0];
                 }else{
-                    //数据包没有收到
-                    all_packets_.emplace_back(seq_no);
+                    delta = webrtc::ByteReader<int16_t>::ReadBigEndian(deltas);
                 }
+                deltas += delta_size;
             }
-            seq_no++;
+            visitor(ReceivePacket(seq_no, delta));
         }
     }
-    size_bytes_ = RtcpPacket::kHeaderSize + index;
-    return true;
+}
+
+size_t TransportFeedback::DecodePackets(rtc::ArrayView<ReceivePacket> packets) const {
+    size_t num_packets = 0;
+    ForEachPacket([&](const ReceivePacket& packet) {
+        if(num_packets < packets.size()) {
+            packets[num_packets++] = packet;
+        }
+    });
+    return num_packets;
 }
 
 void TransportFeedback::Clear() {
     last_chunk_.Clear();
-    all_packets_.clear();
-    received_packets_.clear();
+    encoded_.clear();
+    encoded_chunk_size_ = 0;
+    encoded_chunks_.clear();
+    encoded_deltas_.clear();
+    num_seq_no_ = 0;
+    include_timestamps_ = true;
     size_bytes_ = kRtcpTransportFeedbackHeaderSize;
 }
 
@@ -221,13 +382,27 @@ void TransportFeedback::LastChunk::Decode(uint16_t chunk,size_t max_size) {
     
 }
 
-void TransportFeedback::LastChunk::AppendTo(std::vector<uint8_t>* deltas) {
-    //如果为true则为行程编码数据块
+size_t TransportFeedback::LastChunk::RecvDeltaSize() const {
     if(all_same_) {
-        deltas->insert(deltas->end(),size_,delta_size_[0]);
-    }else{
-        deltas->insert(deltas->end(),delta_size_,delta_size_ + size_);
+        return size_ * delta_size_[0];
+    }
+    size_t recv_delta_size = 0;
+    for(size_t i = 0; i < size_; ++i) {
+        recv_delta_size += delta_size_[i];
     }
+    return recv_delta_size;
+}
+
+bool TransportFeedback::LastChunk::HasInvalidDelta() const {
+    if(all_same_) {
+        return size_ > 0 && delta_size_[0] > kLarge;
+    }
+    for(size_t i = 0; i < size_; ++i) {
+        if(delta_size_[i] > kLarge) {
+            return true;
+        }
+    }
+    return false;
 }
 
 void TransportFeedback::LastChunk::Clear() {
@@ -252,11 +427,9 @@ void TransportFeedback::LastChunk::DecodeOneBit(uint16_t chunk,size_t max_size)
     size_ = std::min(kOneBitCapacity,max_size);
     all_same_ = false;
     has_large_delta_ =false;//一般收到了数据包间隔都比较小
-    //RTP包的状态值
-    for(size_t i = 0; i < size_; ++i) {
-        //通过移动chunk来获得对应位置的RTP包状态
-        delta_size_[i] = (chunk>>(kOneBitCapacity - i - 1)) & 0x1;
-    }
+    //14个状态分成高低两个7bit，每次查表展开7个RTP包的状态
+    memcpy(delta_size_, kStatusSymbolTable.one_bit[(chunk >> 7) & 0x7f], 7);
+    memcpy(delta_size_ + 7, kStatusSymbolTable.one_bit[chunk & 0x7f], 7);
 }
 
 //2bit状态矢量编码块解码
@@ -264,11 +437,95 @@ void TransportFeedback::LastChunk::DecodeTwoBit(uint16_t chunk,size_t max_size)
     size_ = std::min(kTwoBitCapacity,max_size);
     all_same_ = false;
     has_large_delta_ =true;
-    //RTP包的状态值
+    //7个状态分成高8bit(4个)和低6bit(3个)，每次查表展开
+    memcpy(delta_size_, kStatusSymbolTable.two_bit[(chunk >> 6) & 0xff], 4);
+    memcpy(delta_size_ + 4, kStatusSymbolTable.two_bit[(chunk << 2) & 0xff], 3);
+}
+
+bool TransportFeedback::LastChunk::CanAdd(uint8_t delta_size) const {
+    //7个以内任何状态都可以用2bit矢量编码
+    if(size_ < kTwoBitCapacity) {
+        return true;
+    }
+    //没有大的recv delta时可以用1bit矢量编码
+    if(size_ < kOneBitCapacity && !has_large_delta_ && delta_size != kLarge) {
+        return true;
+    }
+    //状态全部相同时可以用行程长度编码
+    if(size_ < kRunLengthCapacity && all_same_ && delta_size_[0] == delta_size) {
+        return true;
+    }
+    return false;
+}
+
+void TransportFeedback::LastChunk::Add(uint8_t delta_size) {
+    if(size_ < kVectorCapacity) {
+        delta_size_[size_] = delta_size;
+    }
+    ++size_;
+    all_same_ = all_same_ && delta_size == delta_size_[0];
+    has_large_delta_ = has_large_delta_ || delta_size == kLarge;
+}
+
+uint16_t TransportFeedback::LastChunk::Emit() {
+    if(all_same_) {
+        uint16_t chunk = EncodeRunLength();
+        Clear();
+        return chunk;
+    }
+
+    if(size_ == kOneBitCapacity) {
+        uint16_t chunk = EncodeOneBit();
+        Clear();
+        return chunk;
+    }
+
+    //输出前7个状态的2bit矢量编码，剩下的状态移到前面
+    RTC_DCHECK(size_ >= kTwoBitCapacity);
+    uint16_t chunk = EncodeTwoBit(kTwoBitCapacity);
+    size_ -= kTwoBitCapacity;
+    all_same_ = true;
+    has_large_delta_ = false;
     for(size_t i = 0; i < size_; ++i) {
-        //通过移动chunk来获得对应位置的RTP包状态
-        delta_size_[i] = (chunk>>(2*(kTwoBitCapacity - i - 1))) & 0x3;
+        uint8_t delta_size = delta_size_[kTwoBitCapacity + i];
+        delta_size_[i] = delta_size;
+        all_same_ = all_same_ && delta_size == delta_size_[0];
+        has_large_delta_ = has_large_delta_ || delta_size == kLarge;
+    }
+    return chunk;
+}
+
+uint16_t TransportFeedback::LastChunk::EncodeLast() const {
+    if(all_same_) {
+        return EncodeRunLength();
+    }
+    if(size_ <= kTwoBitCapacity) {
+        return EncodeTwoBit(size_);
+    }
+    return EncodeOneBit();
+}
+
+//行程长度编码块：0 | 状态(2bit) | 个数(13bit)
+uint16_t TransportFeedback::LastChunk::EncodeRunLength() const {
+    return (delta_size_[0] << 13) | static_cast<uint16_t>(size_);
+}
+
+//1bit状态矢量编码块：1 | 0 | 14个状态
+uint16_t TransportFeedback::LastChunk::EncodeOneBit() const {
+    uint16_t chunk = 0x8000;
+    for(size_t i = 0; i < size_; ++i) {
+        chunk |= delta_size_[i] << (kOneBitCapacity - 1 - i);
+    }
+    return chunk;
+}
+
+//2bit状态矢量编码块：1 | 1 | 7个状态
+uint16_t TransportFeedback::LastChunk::EncodeTwoBit(size_t size) const {
+    uint16_t chunk = 0xc000;
+    for(size_t i = 0; i < size; ++i) {
+        chunk |= delta_size_[i] << 2 * (kTwoBitCapacity - 1 - i);
     }
+    return chunk;
 }
 
 std::string TransportFeedback::ReceivePacket::ToString() const {
@@ -3,6 +3,9 @@
 
 #include <sstream>
 #include<vector>
+#include <absl/container/inlined_vector.h>
+#include <api/array_view.h>
+#include <api/function_view.h>
 #include <api/units/time_delta.h>
 #include "xrtc/rtc/modules/rtp_rtcp/rtcp_packet/rtpfb.h"
 #include "xrtc/rtc/modules/rtp_rtcp/rtcp_packet/transport_feedback.h"
@@ -16,6 +19,10 @@ class TransportFeedback : public Rtpfb {
 public:
     class ReceivePacket{
     public:
+        ReceivePacket():
+            sequence_number_(0),
+            received_(false){}
+
         //通过该方法构造说明收到了该RTP包
         ReceivePacket(uint16_t sequence_number,int16_t delta_ticks):
             sequence_number_(sequence_number),
@@ -39,17 +46,31 @@ public:
     };
     static const uint8_t kFeedbackMessageType = 15;
     static const int kDeltaScaleFactor = 250;//250us
+    //一个feedback包最多能够反馈的RTP包个数
+    static const size_t kMaxReportedPackets = 0xffff;
 
-    const std::vector<ReceivePacket>& AllPackets() const {
-        return all_packets_;
-    }
+    TransportFeedback();
 
-    const std::vector<ReceivePacket>& ReceivedPackets() const {
-        return received_packets_;
-    }
+    using PacketVisitor = rtc::FunctionView<void(const ReceivePacket&)>;
+
+    //按顺序遍历每个RTP包的状态，直接从原始的chunk和recv delta解码，不会产生中间的vector
+    //include_lost_为false时，只会回调收到的包
+    void ForEachPacket(PacketVisitor visitor) const;
+    //解码到调用者提供的内存中，返回写入的个数，空间不够时只写入前面的部分
+    size_t DecodePackets(rtc::ArrayView<ReceivePacket> packets) const;
 
     uint16_t GetPacketStatusCount() const {return num_seq_no_;}
 
+    //接收端构建feedback包，先设置第一个RTP包的序号和参考时间
+    void SetBase(uint16_t base_sequence, int64_t ref_timestamp_us);
+    void SetFeedbackSequenceNumber(uint8_t feedback_sequence) {
+        feedback_seq_ = feedback_sequence;
+    }
+    //按照序号从旧到新添加收到的包，中间没有收到的包记为丢失
+    //包的个数或者大小超过限制，或者与上一个包的时间差超出范围时返回false，
+    //调用者需要用该包开始一个新的feedback包
+    bool AddReceivedPacket(uint16_t sequence_number, int64_t timestamp_us);
+
     webrtc::TimeDelta GetBaseTime() const;
     int64_t  GetBaseTimeUs() const;
     webrtc::TimeDelta GetBaseDelta(int64_t prev_timestamp_us) const;
@@ -63,28 +84,49 @@ public:
         size_t max_length,
         PacketReadyCallback callback) const override;
 private:
-    Class LastChunk{
+    class LastChunk{
     public:
         //解析出来的个数不应该超过总的大小
         void Decode(uint16_t chunk,size_t max_size);
-        void AppendTo(std::vector<uint8_t>* deltas);
         void Clear();
+        size_t size() const { return size_; }
+        uint8_t delta_size(size_t i) const {
+            return all_same_ ? delta_size_[0] : delta_size_[i];
+        }
+        //该chunk对应的recv delta所占的字节数
+        size_t RecvDeltaSize() const;
+        //是否包含无效的状态值3
+        bool HasInvalidDelta() const;
+
+        //构建时使用，按顺序添加RTP包的状态，放不下时先调用Emit输出一个chunk
+        bool Empty() const { return 0 == size_; }
+        bool CanAdd(uint8_t delta_size) const;
+        void Add(uint8_t delta_size);
+        //输出一个完整的chunk，剩下的状态保留在当前chunk中
+        uint16_t Emit();
+        //输出最后一个不完整的chunk
+        uint16_t EncodeLast() const;
     private:
-        static const size_t kRunLengthCapacity = 0x1fff;
-        static const size_t kOneBitCapacity = 14;
-        static const size_t kTwoBitCapacity = 7;
-        static const size_t kVectorCapacity = kOneBitCapacity;
-        static const size_t kLarge = 2; 
+        //std::min按引用传参，需要constexpr才不用在类外定义
+        static constexpr size_t kRunLengthCapacity = 0x1fff;
+        static constexpr size_t kOneBitCapacity = 14;
+        static constexpr size_t kTwoBitCapacity = 7;
+        static constexpr size_t kVectorCapacity = kOneBitCapacity;
+        static constexpr size_t kLarge = 2; 
         void DecodeRunLength(uint16_t chunk,size_t max_size);
         void DecodeOneBit(uint16_t chunk,size_t max_size);
         void DecodeTwoBit(uint16_t chunk,size_t max_size);
+        uint16_t EncodeRunLength() const;
+        uint16_t EncodeOneBit() const;
+        uint16_t EncodeTwoBit(size_t size) const;
     private:
         uint8_t delta_size_ [kVectorCapacity];
         size_t size_ = 0;
-        bool all_same_ = false;
+        bool all_same_ = true;
         bool has_large_delta_ = false;
     };
     void Clear();//对变量进行一个重新的初始
+    bool AddDeltaSize(uint8_t delta_size);
 
 private:
     uint16_t base_seq_no_ = 0;
@@ -92,13 +134,19 @@ private:
     uint32_t base_time_ticks_ = 0;
     uint8_t feedback_seq_ = 0;
     LastChunk last_chunk_;
-    //存放所有的数据包，包含没有收到的数据包
-    std::vector<ReceivePacket> all_packets_;
-    //存放收到的数据包
-    std::vector<ReceivePacket> received_packets_;
+    //保存原始的packet chunk和recv delta，遍历时再解码
+    //一般的feedback包不超过kInlineEncodedSize，不需要分配堆内存
+    static const size_t kInlineEncodedSize = 512;
+    absl::InlinedVector<uint8_t, kInlineEncodedSize> encoded_;
+    //encoded_中packet chunk部分的字节数，后面紧跟着recv delta
+    size_t encoded_chunk_size_ = 0;
     bool include_lost_ = true;//是否存放没有收到的数据包
     bool include_timestamps_ = true;//是否存放时间戳
     size_t size_bytes_ = 0;//存放数据包总大小字节数
+    //构建时使用：已经输出的chunk，以及按顺序序列化好的recv delta
+    std::vector<uint16_t> encoded_chunks_;
+    std::vector<uint8_t> encoded_deltas_;
+    int64_t last_timestamp_us_ = 0;
 };
 
 }//namespace rtcp
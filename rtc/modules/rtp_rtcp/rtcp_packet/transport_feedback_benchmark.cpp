@@ -0,0 +1,124 @@
+#include "xrtc/rtc/modules/rtp_rtcp/rtcp_packet/transport_feedback.h"
+
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "xrtc/rtc/modules/rtp_rtcp/rtcp_packet/common_header.h"
+
+namespace xrtc {
+namespace rtcp {
+
+namespace {
+const uint16_t kBaseSeqNum = 65000;
+const int64_t kBaseTimeUs = 123456789;
+const int64_t kPacketIntervalUs = 2000;
+
+// 构造包含num_packets个RTP包的feedback，每loss_interval个包丢一个，
+// loss_interval为0表示不丢包，返回序列化之后的RTCP包
+std::vector<uint8_t> BuildFeedback(int num_packets, int loss_interval) {
+    TransportFeedback feedback;
+    feedback.SetSenderSsrc(1);
+    feedback.SetMediaSsrc(2);
+    feedback.SetBase(kBaseSeqNum, kBaseTimeUs);
+    int64_t time_us = kBaseTimeUs;
+    for (int i = 0; i < num_packets; ++i) {
+        // 到达间隔有小幅抖动，混合1字节和2字节的recv delta
+        time_us += kPacketIntervalUs + (i % 7 == 0 ? 70000 : 0);
+        if (loss_interval > 0 && i % loss_interval == loss_interval - 1) {
+            continue;
+        }
+        if (!feedback.AddReceivedPacket((uint16_t)(kBaseSeqNum + i), time_us)) {
+            break;
+        }
+    }
+
+    std::vector<uint8_t> buffer(feedback.BlockLength());
+    size_t index = 0;
+    feedback.Create(buffer.data(), &index, buffer.size(),
+        [](rtc::ArrayView<const uint8_t>) {});
+    buffer.resize(index);
+    return buffer;
+}
+
+} // namespace
+
+// 解析一个feedback包，参数为RTP包个数和丢包间隔
+void BM_TransportFeedbackParse(benchmark::State& state) {
+    std::vector<uint8_t> buffer = BuildFeedback((int)state.range(0),
+        (int)state.range(1));
+    CommonHeader header;
+    if (!header.Parse(buffer.data(), buffer.size())) {
+        state.SkipWithError("build feedback failed");
+        return;
+    }
+
+    for (auto _ : state) {
+        TransportFeedback feedback;
+        bool ok = feedback.Parse(header);
+        benchmark::DoNotOptimize(ok);
+        benchmark::DoNotOptimize(feedback);
+    }
+    state.SetBytesProcessed(state.iterations() * buffer.size());
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TransportFeedbackParse)
+    ->Args({ 20, 0 })
+    ->Args({ 100, 0 })
+    ->Args({ 100, 20 })
+    ->Args({ 1000, 3 });
+
+// 解析之后通过visitor遍历所有包的状态，TransportFeedbackAdapter使用的方式
+void BM_TransportFeedbackForEachPacket(benchmark::State& state) {
+    std::vector<uint8_t> buffer = BuildFeedback((int)state.range(0),
+        (int)state.range(1));
+    CommonHeader header;
+    TransportFeedback feedback;
+    if (!header.Parse(buffer.data(), buffer.size()) || !feedback.Parse(header)) {
+        state.SkipWithError("parse feedback failed");
+        return;
+    }
+
+    for (auto _ : state) {
+        int64_t delta_sum = 0;
+        feedback.ForEachPacket([&](const TransportFeedback::ReceivePacket& packet) {
+            delta_sum += packet.delta_ticks();
+        });
+        benchmark::DoNotOptimize(delta_sum);
+    }
+    state.SetItemsProcessed(state.iterations() * feedback.GetPacketStatusCount());
+}
+BENCHMARK(BM_TransportFeedbackForEachPacket)
+    ->Args({ 100, 0 })
+    ->Args({ 100, 20 })
+    ->Args({ 1000, 3 });
+
+// 解码到调用者提供的内存中
+void BM_TransportFeedbackDecodePackets(benchmark::State& state) {
+    std::vector<uint8_t> buffer = BuildFeedback((int)state.range(0),
+        (int)state.range(1));
+    CommonHeader header;
+    TransportFeedback feedback;
+    if (!header.Parse(buffer.data(), buffer.size()) || !feedback.Parse(header)) {
+        state.SkipWithError("parse feedback failed");
+        return;
+    }
+
+    std::vector<TransportFeedback::ReceivePacket> packets(
+        feedback.GetPacketStatusCount());
+    for (auto _ : state) {
+        size_t num_packets = feedback.DecodePackets(
+            rtc::ArrayView<TransportFeedback::ReceivePacket>(packets.data(),
+                packets.size()));
+        benchmark::DoNotOptimize(num_packets);
+        benchmark::DoNotOptimize(packets.data());
+    }
+    state.SetItemsProcessed(state.iterations() * feedback.GetPacketStatusCount());
+}
+BENCHMARK(BM_TransportFeedbackDecodePackets)
+    ->Args({ 100, 0 })
+    ->Args({ 100, 20 })
+    ->Args({ 1000, 3 });
+
+} // namespace rtcp
+} // namespace xrtc
@@ -0,0 +1,60 @@
+#include "xrtc/rtc/modules/rtp_rtcp/rtcp_packet/transport_feedback.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <rtc_base/checks.h>
+
+#include "xrtc/rtc/modules/rtp_rtcp/rtcp_packet/common_header.h"
+
+namespace xrtc {
+namespace rtcp {
+
+namespace {
+// 一个feedback包最多能够反馈的RTP包个数，DecodePackets的空间足够时应该全部解码
+const size_t kMaxDecodedPackets = TransportFeedback::kMaxReportedPackets;
+TransportFeedback::ReceivePacket g_decoded_packets[kMaxDecodedPackets];
+
+void FuzzOneFeedback(const CommonHeader& header) {
+    TransportFeedback feedback;
+    if (!feedback.Parse(header)) {
+        return;
+    }
+
+    // 序号必须连续，包的个数和packet status count一致
+    size_t num_packets = 0;
+    uint16_t next_seq_num = 0;
+    feedback.ForEachPacket([&](const TransportFeedback::ReceivePacket& packet) {
+        if (num_packets > 0) {
+            RTC_CHECK_EQ(next_seq_num, packet.sequence_number());
+        }
+        next_seq_num = packet.sequence_number() + 1;
+        ++num_packets;
+    });
+    RTC_CHECK_EQ(num_packets, feedback.GetPacketStatusCount());
+
+    size_t num_decoded = feedback.DecodePackets(
+        rtc::ArrayView<TransportFeedback::ReceivePacket>(g_decoded_packets,
+            kMaxDecodedPackets));
+    RTC_CHECK_EQ(num_packets, num_decoded);
+}
+
+} // namespace
+
+} // namespace rtcp
+} // namespace xrtc
+
+// libFuzzer的入口，输入按照复合RTCP包逐个解析，只处理transport feedback
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    const uint8_t* end = data + size;
+    xrtc::rtcp::CommonHeader header;
+    while (data < end && header.Parse(data, end - data)) {
+        if (xrtc::rtcp::Rtpfb::kPacketType == header.packet_type() &&
+            xrtc::rtcp::TransportFeedback::kFeedbackMessageType == header.fmt())
+        {
+            xrtc::rtcp::FuzzOneFeedback(header);
+        }
+        data = header.NextPacket();
+    }
+    return 0;
+}
@@ -2,9 +2,11 @@
 
 #include <rtc_base/logging.h>
 
+#include "xrtc/rtc/modules/rtp_rtcp/rtcp_packet/sender_report.h"
 #include "xrtc/rtc/modules/rtp_rtcp/rtcp_packet/receiver_report.h"
 #include "xrtc/rtc/modules/rtp_rtcp/rtcp_packet/nack.h"
 #include "xrtc/rtc/modules/rtp_rtcp/rtcp_packet/transport_feedback.h"
+#include "xrtc/rtc/modules/rtp_rtcp/rtcp_packet/extended_reports.h"
 #include "xrtc/rtc/modules/rtp_rtcp/rtp_utils.h"
 
 namespace xrtc {
@@ -58,6 +60,9 @@ bool RTCPReceiver::ParseCompoundPacket(rtc::ArrayView<const uint8_t> packet,
         }
 
         switch (rtcp_block.packet_type()) {
+        case rtcp::SenderReport::kPacketType: // 200
+            HandleSenderReport(rtcp_block, packet_info);
+            break;
         case rtcp::ReceiverReport::kPacketType: // 201
             HandleReceiverReport(rtcp_block, packet_info);
             break;
@@ -74,6 +79,9 @@ bool RTCPReceiver::ParseCompoundPacket(rtc::ArrayView<const uint8_t> packet,
                 break;
             }
             break;
+        case rtcp::ExtendedReports::kPacketType: // 207
+            HandleExtendedReports(rtcp_block, packet_info);
+            break;
         default:
             RTC_LOG(LS_WARNING) << "rtcp packet not handle, packet_type: " <<
                 (int)(rtcp_block.packet_type());
@@ -84,6 +92,28 @@ bool RTCPReceiver::ParseCompoundPacket(rtc::ArrayView<const uint8_t> packet,
     return false;
 }
 
+// 对端同时发送和接收时，SR中携带对本端媒体流的report block
+void RTCPReceiver::HandleSenderReport(const rtcp::CommonHeader& rtcp_block,
+    PacketInformation& packet_info)
+{
+    rtcp::SenderReport sr;
+    if (!sr.Parse(rtcp_block)) {
+        ++num_skipped_packets_;
+        return;
+    }
+
+    // 记录接收的媒体流的SR，RR的report block中需要带回
+    if (remote_ssrc_ != 0 && sr.sender_ssrc() == remote_ssrc_) {
+        remote_sr_ntp_ = sr.ntp_time();
+        remote_sr_ = CompactNtp(remote_sr_ntp_);
+        last_sr_arrival_time_ = clock_->CurrentTime();
+    }
+
+    for (const rtcp::ReportBlock& report_block : sr.report_blocks()) {
+        HandleReportBlock(report_block, sr.sender_ssrc(), packet_info);
+    }
+}
+
 void RTCPReceiver::HandleReceiverReport(const rtcp::CommonHeader& rtcp_block, 
     PacketInformation& packet_info) 
 {
@@ -123,7 +153,8 @@ void RTCPReceiver::HandleReportBlock(const rtcp::ReportBlock& report_block,
         rtt_ms = CompactNtpRttToMs(rtt_ntp);
 
         if (rtp_rtcp_module_observer_) {
-            rtp_rtcp_module_observer_->OnNetworkInfo(rtt_ms,
+            rtp_rtcp_module_observer_->OnNetworkInfo(report_block.source_ssrc(),
+                rtt_ms,
                 report_block.packets_lost(),//累计丢包数
                 report_block.fraction_lost(),
                 report_block.extended_highest_sequence_number(),//最新序列号
@@ -142,9 +173,15 @@ void RTCPReceiver::HandleNack(const rtcp::CommonHeader& rtcp_block,
         return;
     }
 
+    // 多个流共用同一个RTCP复合包，只处理发给本模块的NACK
+    if (!IsRegisteredSsrc(nack.media_ssrc())) {
+        return;
+    }
+
     if (rtp_rtcp_module_observer_) {
         rtp_rtcp_module_observer_->OnNackReceived(
             audio_ ? webrtc::MediaType::AUDIO : webrtc::MediaType::VIDEO,
+            nack.media_ssrc(),
             nack.packet_ids());
     }
 }
@@ -166,6 +203,74 @@ void RTCPReceiver::HandleTransportFeedback(const rtcp::CommonHeader& rtcp_block,
     }
 }
 
+// RRTR由只接收的对端发送，DLRR是对本端RRTR的回复
+void RTCPReceiver::HandleExtendedReports(const rtcp::CommonHeader& rtcp_block,
+    PacketInformation& packet_info)
+{
+    rtcp::ExtendedReports xr;
+    if (!xr.Parse(rtcp_block)) {
+        ++num_skipped_packets_;
+        return;
+    }
+
+    webrtc::Timestamp now = clock_->CurrentTime();
+    if (xr.rrtr()) {
+        received_rrtrs_.insert_or_assign(xr.sender_ssrc(),
+            std::make_pair(CompactNtp(*xr.rrtr()), now));
+    }
+
+    for (const rtcp::ReceiveTimeInfo& rti : xr.dlrr_items()) {
+        if (rti.ssrc != media_ssrc_ || 0 == rti.last_rr) {
+            continue;
+        }
+
+        uint32_t receive_ntp_time = CompactNtp(clock_->ConvertTimestampToNtpTime(now));
+        uint32_t rtt_ntp = receive_ntp_time - rti.last_rr - rti.delay_since_last_rr;
+        int64_t rtt_ms = CompactNtpRttToMs(rtt_ntp);
+        if (rtp_rtcp_module_observer_) {
+            rtp_rtcp_module_observer_->OnRttUpdated(media_ssrc_, rtt_ms);
+        }
+    }
+}
+
+bool RTCPReceiver::LastReceivedSr(uint32_t* remote_sr,
+    webrtc::Timestamp* arrival_time) const
+{
+    if (0 == remote_sr_) {
+        return false;
+    }
+
+    *remote_sr = remote_sr_;
+    *arrival_time = last_sr_arrival_time_;
+    return true;
+}
+
+bool RTCPReceiver::LastReceivedSrNtp(webrtc::NtpTime* remote_sr_ntp,
+    webrtc::Timestamp* arrival_time) const
+{
+    if (0 == remote_sr_) {
+        return false;
+    }
+
+    *remote_sr_ntp = remote_sr_ntp_;
+    *arrival_time = last_sr_arrival_time_;
+    return true;
+}
+
+std::vector<rtcp::ReceiveTimeInfo> RTCPReceiver::ConsumeReceivedXrReferenceTimeInfo() {
+    std::vector<rtcp::ReceiveTimeInfo> result;
+    webrtc::Timestamp now = clock_->CurrentTime();
+    for (auto& item : received_rrtrs_) {
+        // DLRR的单位是1/65536秒
+        webrtc::TimeDelta delay = now - item.second.second;
+        result.emplace_back(item.first, item.second.first,
+            (uint32_t)(delay.ms() * 65536 / 1000));
+    }
+
+    received_rrtrs_.clear();
+    return result;
+}
+
 bool RTCPReceiver::IsRegisteredSsrc(uint32_t ssrc) {
     for (auto rssrc : registered_ssrcs_) {
         if (rssrc == ssrc) {
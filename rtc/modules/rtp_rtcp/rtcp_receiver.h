@@ -1,13 +1,16 @@
 ﻿#ifndef XRTCSDK_XRTC_RTC_MODULES_RTP_RTCP_RTCP_RECEIVER_H_
 #define XRTCSDK_XRTC_RTC_MODULES_RTP_RTCP_RTCP_RECEIVER_H_
 
+#include <map>
 #include <vector>
 
 #include <api/array_view.h>
+#include <system_wrappers/include/ntp_time.h>
 
 #include "xrtc/rtc/modules/rtp_rtcp/rtp_rtcp_interface.h"
 #include "xrtc/rtc/modules/rtp_rtcp/rtcp_packet/common_header.h"
 #include "xrtc/rtc/modules/rtp_rtcp/rtcp_packet/report_block.h"
+#include "xrtc/rtc/modules/rtp_rtcp/rtcp_packet/extended_reports.h"
 
 namespace xrtc {
 
@@ -17,12 +20,23 @@ public:
     ~RTCPReceiver();
 
     void IncomingRtcpPacket(rtc::ArrayView<const uint8_t> packet);
+    // 接收的媒体流的ssrc，只记录该流的SR
+    void SetRemoteSSRC(uint32_t ssrc) { remote_ssrc_ = ssrc; }
+    // 最后收到的远端SR，没有收到时返回false
+    bool LastReceivedSr(uint32_t* remote_sr, webrtc::Timestamp* arrival_time) const;
+    // 同上，返回完整的NTP时间，用于估计两端时钟的偏差
+    bool LastReceivedSrNtp(webrtc::NtpTime* remote_sr_ntp,
+        webrtc::Timestamp* arrival_time) const;
+    // 返回收到的RRTR并清空，每个RRTR只在DLRR中回复一次
+    std::vector<rtcp::ReceiveTimeInfo> ConsumeReceivedXrReferenceTimeInfo();
 
 private:
     class PacketInformation;
 
     bool ParseCompoundPacket(rtc::ArrayView<const uint8_t> packet,
         PacketInformation& packet_info);
+    void HandleSenderReport(const rtcp::CommonHeader& rtcp_block,
+        PacketInformation& packet_info);
     void HandleReceiverReport(const rtcp::CommonHeader& rtcp_block,
         PacketInformation& packet_info);
     void HandleReportBlock(const rtcp::ReportBlock& report_block,
@@ -31,6 +45,8 @@ private:
         PacketInformation& packet_info);
     void HandleTransportFeedback(const rtcp::CommonHeader& rtcp_block,
         PacketInformation& packet_info);
+    void HandleExtendedReports(const rtcp::CommonHeader& rtcp_block,
+        PacketInformation& packet_info);
         
     bool IsRegisteredSsrc(uint32_t ssrc);
 
@@ -43,6 +59,13 @@ private:
     uint32_t num_skipped_packets_ = 0;
     std::vector<uint32_t> registered_ssrcs_;
     webrtc::Timestamp last_received_rb_ = webrtc::Timestamp::PlusInfinity();
+    uint32_t remote_ssrc_ = 0;
+    // 最后收到的远端SR的NTP时间(compact)，0表示没有收到
+    uint32_t remote_sr_ = 0;
+    webrtc::NtpTime remote_sr_ntp_;
+    webrtc::Timestamp last_sr_arrival_time_ = webrtc::Timestamp::Zero();
+    // 收到的RRTR，key是发送RRTR的ssrc，value是RRTR的时间(compact)和到达时间
+    std::map<uint32_t, std::pair<uint32_t, webrtc::Timestamp>> received_rrtrs_;
 };
 
 } // namespace xrtc
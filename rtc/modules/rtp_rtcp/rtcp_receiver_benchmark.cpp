@@ -0,0 +1,111 @@
+﻿#include "xrtc/rtc/modules/rtp_rtcp/rtcp_receiver.h"
+
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <system_wrappers/include/clock.h>
+
+#include "xrtc/rtc/modules/rtp_rtcp/rtcp_packet/receiver_report.h"
+#include "xrtc/rtc/modules/rtp_rtcp/rtcp_packet/transport_feedback.h"
+
+namespace xrtc {
+
+namespace {
+const uint32_t kLocalSsrc = 0x11111111;
+const uint32_t kRemoteSsrc = 0x22222222;
+const uint16_t kBaseSeqNum = 1000;
+const int64_t kBaseTimeUs = 123456789;
+const int64_t kPacketIntervalUs = 2000;
+
+class NullRtpRtcpModuleObserver : public RtpRtcpModuleObserver {
+public:
+    void OnLocalRtcpPacket(webrtc::MediaType media_type,
+        const uint8_t* data, size_t len) override {}
+    void OnNetworkInfo(uint32_t ssrc, int64_t rtt_ms, int32_t packets_lost,
+        uint8_t fraction_lost, uint32_t extended_highest_sequence_number,
+        uint32_t jitter, webrtc::Timestamp at_time) override
+    {
+        ++network_infos;
+    }
+    void OnNackReceived(webrtc::MediaType media_type, uint32_t ssrc,
+        const std::vector<uint16_t>& nack_list) override {}
+    void OnRttUpdated(uint32_t ssrc, int64_t rtt_ms) override {}
+
+    int64_t network_infos = 0;
+};
+
+class CountingFeedbackObserver : public TransportFeedbackObserver {
+public:
+    void OnAddPacket(const RtpPacketSendInfo& packet_info) override {}
+    void OnTransportFeedback(const rtcp::TransportFeedback& feedback) override {
+        ++feedbacks;
+    }
+
+    int64_t feedbacks = 0;
+};
+
+// 接收端定时发送的复合包：RR(带一个report block) + TransportFeedback
+std::vector<uint8_t> BuildCompoundPacket(int num_packets) {
+    rtcp::ReportBlock report_block;
+    report_block.SetMediaSsrc(kLocalSsrc);
+    report_block.SetFractionLost(3);
+    report_block.SetCumulativeLost(10);
+    report_block.SetExtHighestSeqNum(kBaseSeqNum + num_packets);
+    report_block.SetJitter(90);
+    report_block.SetLastSr(0x12345678);
+    report_block.SetDelayLastSr(0x10000);
+
+    rtcp::ReceiverReport rr;
+    rr.SetSenderSsrc(kRemoteSsrc);
+    rr.AddReportBlock(report_block);
+
+    rtcp::TransportFeedback feedback;
+    feedback.SetSenderSsrc(kRemoteSsrc);
+    feedback.SetMediaSsrc(kLocalSsrc);
+    feedback.SetBase(kBaseSeqNum, kBaseTimeUs);
+    int64_t time_us = kBaseTimeUs;
+    for (int i = 0; i < num_packets; ++i) {
+        time_us += kPacketIntervalUs;
+        feedback.AddReceivedPacket((uint16_t)(kBaseSeqNum + i), time_us);
+    }
+
+    std::vector<uint8_t> buffer(rr.BlockLength() + feedback.BlockLength());
+    size_t index = 0;
+    rr.Create(buffer.data(), &index, buffer.size(),
+        [](rtc::ArrayView<const uint8_t>) {});
+    feedback.Create(buffer.data(), &index, buffer.size(),
+        [](rtc::ArrayView<const uint8_t>) {});
+    buffer.resize(index);
+    return buffer;
+}
+
+} // namespace
+
+// 发送端处理一个RR + TransportFeedback的复合包，包括RTT计算和feedback的解析、回调
+// 参数为feedback中的RTP包个数
+void BM_RtcpReceiverIncoming(benchmark::State& state) {
+    webrtc::SimulatedClock clock(100000000);
+    NullRtpRtcpModuleObserver module_observer;
+    CountingFeedbackObserver feedback_observer;
+    RtpRtcpInterface::Configuration config;
+    config.clock = &clock;
+    config.local_media_ssrc = kLocalSsrc;
+    config.rtp_rtcp_module_observer = &module_observer;
+    config.transport_feedback_observer = &feedback_observer;
+    RTCPReceiver receiver(config);
+
+    std::vector<uint8_t> packet = BuildCompoundPacket((int)state.range(0));
+    for (auto _ : state) {
+        receiver.IncomingRtcpPacket(
+            rtc::ArrayView<const uint8_t>(packet.data(), packet.size()));
+    }
+    if (feedback_observer.feedbacks != state.iterations() ||
+        module_observer.network_infos != state.iterations())
+    {
+        state.SkipWithError("compound packet not fully handled");
+    }
+    state.SetBytesProcessed(state.iterations() * packet.size());
+}
+BENCHMARK(BM_RtcpReceiverIncoming)->Arg(20)->Arg(100);
+
+} // namespace xrtc
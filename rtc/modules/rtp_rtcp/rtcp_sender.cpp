@@ -3,6 +3,10 @@
 #include <rtc_base/logging.h>
 
 #include "xrtc/rtc/modules/rtp_rtcp/rtcp_packet/sender_report.h"
+#include "xrtc/rtc/modules/rtp_rtcp/rtcp_packet/receiver_report.h"
+#include "xrtc/rtc/modules/rtp_rtcp/rtcp_packet/nack.h"
+#include "xrtc/rtc/modules/rtp_rtcp/rtcp_packet/pli.h"
+#include "xrtc/rtc/modules/rtp_rtcp/receive_statistics.h"
 
 namespace xrtc {
 namespace {
@@ -23,11 +27,17 @@ webrtc::TimeDelta GetReportInterval(int report_interval_ms, int default_value) {
 class RTCPSender::RtcpContext {
 public:
     RtcpContext(const FeedbackState& feedback_state,
+        size_t nack_size,
+        const uint16_t* nack_list,
         webrtc::Timestamp now) :
         feedback_state(feedback_state),
+        nack_size(nack_size),
+        nack_list(nack_list),
         now(now) {}
 
     FeedbackState feedback_state;
+    size_t nack_size;
+    const uint16_t* nack_list;
     webrtc::Timestamp now;
 };
 
@@ -40,8 +50,8 @@ public:
 
     ~PacketSender() {}
 
-    void Append(rtcp::RtcpPacket& packet) {
-        packet.Create(buffer_, &index_, max_packet_size_, callback_);
+    bool Append(const rtcp::RtcpPacket& packet) {
+        return packet.Create(buffer_, &index_, max_packet_size_, callback_);
     }
 
     void Send() {
@@ -66,12 +76,18 @@ RTCPSender::RTCPSender(const RtpRtcpInterface::Configuration& config,
     clock_rate_(config.clock_rate),
     max_packet_size_(IP_PACKET_SIZE - 28), // IPv4 + UDP,
     rtp_rtcp_module_observer_(config.rtp_rtcp_module_observer),
+    receive_statistics_(config.receive_statistics),
+    non_sender_rtt_measurement_(config.non_sender_rtt_measurement),
     schedule_next_rtcp_send_(schedule_next_rtcp_send),
     report_interval_ms_(GetReportInterval(config.rtcp_report_interval_ms, 
         config.audio ? kDefaultAudioRtcpIntervalMs : kDefaultVideoRtcpIntervalMs)),
     random_(config.clock->TimeInMilliseconds())
 {
     builders_[kRtcpSr] = &RTCPSender::BuildSr;
+    builders_[kRtcpRr] = &RTCPSender::BuildRr;
+    builders_[kRtcpNack] = &RTCPSender::BuildNack;
+    builders_[kRtcpPli] = &RTCPSender::BuildPli;
+    builders_[kRtcpExtendedReports] = &RTCPSender::BuildExtendedReports;
 }
 
 RTCPSender::~RTCPSender() {
@@ -136,6 +152,25 @@ int RTCPSender::SendRTCP(const FeedbackState& feedback_state,//反馈状态信
     return ret;
 }
 
+bool RTCPSender::SendFeedbackPacket(rtcp::TransportFeedback* packet) {
+    auto callback = [&](rtc::ArrayView<const uint8_t> rtcp_packet) {
+        if (rtp_rtcp_module_observer_) {
+            rtp_rtcp_module_observer_->OnLocalRtcpPacket(
+                audio_ ? webrtc::MediaType::AUDIO : webrtc::MediaType::VIDEO,
+                rtcp_packet.data(), rtcp_packet.size());
+        }
+    };
+    PacketSender sender(callback, max_packet_size_);
+
+    packet->SetSenderSsrc(ssrc_);
+    if (!sender.Append(*packet)) {
+        return false;
+    }
+
+    sender.Send();
+    return true;
+}
+
 // 设置下一次发送报告的时间
 void RTCPSender::SetNextRtcpSendEvaluationDuration(webrtc::TimeDelta duration) {
     next_time_to_send_rtcp_ = clock_->CurrentTime() + duration;
@@ -157,7 +192,8 @@ int RTCPSender::ComputeCompoundRTCPPacket(const FeedbackState& feedback_state,
     if (!can_calculate_rtp_timestamp) {
         // 此时不能发送SR包
         bool send_sr_flag = ConsumeFlag(kRtcpSr);
-        bool send_report_flag = ConsumeFlag(kRtcpReport);
+        // 只接收的时候不需要SR，周期性的报告使用RR
+        bool send_report_flag = sending_ && ConsumeFlag(kRtcpReport);
         bool sender_report = send_sr_flag || send_report_flag;
         // 如果当前仅仅只需要发送SR包，我们直接return
         if (sender_report && AllVolatileFlagsConsumed()) {
@@ -172,7 +208,8 @@ int RTCPSender::ComputeCompoundRTCPPacket(const FeedbackState& feedback_state,
         }
     }
 
-    RtcpContext context(feedback_state, clock_->CurrentTime());
+    RtcpContext context(feedback_state, nack_size, nack_list,
+        clock_->CurrentTime());
     
     // 准备发送报告
     PrepareReport(feedback_state);
@@ -237,6 +274,12 @@ void RTCPSender::PrepareReport(const FeedbackState& feedback_state) {
     ConsumeFlag(kRtcpReport, false);
     // 设置报告标志
     SetFlag(sending_ ? kRtcpSr : kRtcpRr);
+    // 只接收时对端不会在report block中带回LSR，通过XR测量RTT
+    if ((!sending_ && non_sender_rtt_measurement_) ||
+        !feedback_state.last_xr_rtis.empty())
+    {
+        SetFlag(kRtcpExtendedReports);
+    }
 
     if (generate_report) {
         // 设置下一次发送报告的时间
@@ -269,4 +312,74 @@ void RTCPSender::BuildSr(const RtcpContext& context, PacketSender& sender) {
     sender.Append(sr);
 }
 
+// 构建RR包，report block来自接收统计
+void RTCPSender::BuildRr(const RtcpContext& context, PacketSender& sender) {
+    rtcp::ReceiverReport rr;
+    rr.SetSenderSsrc(ssrc_);
+
+    if (receive_statistics_) {
+        std::vector<rtcp::ReportBlock> report_blocks =
+            receive_statistics_->RtcpReportBlocks(
+                rtcp::ReceiverReport::kMaxNumberOfReportBlocks);
+        for (auto& report_block : report_blocks) {
+            // 收到过对端的SR时填写LSR和DLSR，对端据此计算RTT
+            if (context.feedback_state.remote_sr != 0) {
+                webrtc::TimeDelta delay = context.now -
+                    context.feedback_state.last_sr_arrival_time;
+                // DLSR的单位是1/65536秒
+                report_block.SetLastSr(context.feedback_state.remote_sr);
+                report_block.SetDelayLastSr((uint32_t)(delay.ms() * 65536 / 1000));
+            }
+            rr.AddReportBlock(report_block);
+        }
+    }
+
+    sender.Append(rr);
+}
+
+// 构建NACK包
+void RTCPSender::BuildNack(const RtcpContext& context, PacketSender& sender) {
+    if (0 == context.nack_size || 0 == remote_ssrc_) {
+        return;
+    }
+
+    rtcp::Nack nack;
+    nack.SetSenderSsrc(ssrc_);
+    nack.SetMediaSsrc(remote_ssrc_);
+    nack.SetPacketIds(context.nack_list, context.nack_size);
+    sender.Append(nack);
+}
+
+// 构建PLI包，请求对端发送关键帧
+void RTCPSender::BuildPli(const RtcpContext& context, PacketSender& sender) {
+    if (0 == remote_ssrc_) {
+        return;
+    }
+
+    rtcp::Pli pli;
+    pli.SetSenderSsrc(ssrc_);
+    pli.SetMediaSsrc(remote_ssrc_);
+    sender.Append(pli);
+}
+
+// 构建XR包
+void RTCPSender::BuildExtendedReports(const RtcpContext& context,
+    PacketSender& sender)
+{
+    rtcp::ExtendedReports xr;
+    xr.SetSenderSsrc(ssrc_);
+
+    if (!sending_ && non_sender_rtt_measurement_) {
+        xr.SetRrtr(clock_->ConvertTimestampToNtpTime(context.now));
+    }
+
+    for (const rtcp::ReceiveTimeInfo& rti : context.feedback_state.last_xr_rtis) {
+        if (!xr.AddDlrrItem(rti)) {
+            break;
+        }
+    }
+
+    sender.Append(xr);
+}
+
 } // namespace xrtc
\ No newline at end of file
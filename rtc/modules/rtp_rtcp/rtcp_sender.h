@@ -4,6 +4,7 @@
 #include <functional>
 #include <set>
 #include <map>
+#include <vector>
 
 #include <api/units/time_delta.h>
 #include <api/rtp_headers.h>
@@ -11,6 +12,8 @@
 
 #include "xrtc/rtc/modules/rtp_rtcp/rtp_rtcp_interface.h"
 #include "xrtc/rtc/modules/rtp_rtcp/rtp_rtcp_defines.h"
+#include "xrtc/rtc/modules/rtp_rtcp/rtcp_packet/transport_feedback.h"
+#include "xrtc/rtc/modules/rtp_rtcp/rtcp_packet/extended_reports.h"
 
 namespace xrtc {
 
@@ -18,8 +21,13 @@ class RTCPSender {
 public:
     class FeedbackState {
     public:
-        uint32_t packets_sent;
-        size_t media_bytes_sent;
+        uint32_t packets_sent = 0;
+        size_t media_bytes_sent = 0;
+        // 最后收到的远端SR的NTP时间(compact)和到达时间，用于report block中的LSR和DLSR
+        uint32_t remote_sr = 0;
+        webrtc::Timestamp last_sr_arrival_time = webrtc::Timestamp::Zero();
+        // 收到的XR RRTR，需要在DLRR中回复
+        std::vector<rtcp::ReceiveTimeInfo> last_xr_rtis;
     };
 
     RTCPSender(const RtpRtcpInterface::Configuration& config,
@@ -30,6 +38,10 @@ public:
     void SetSendingStatus(bool sending) {
         sending_ = sending;
     }
+    // 接收的媒体流的ssrc，NACK等反馈包中使用
+    void SetRemoteSSRC(uint32_t ssrc) {
+        remote_ssrc_ = ssrc;
+    }
     
     void SetLastRtpTimestamp(uint32_t rtp_timestamp,
         absl::optional<webrtc::Timestamp> last_frame_capture_time);
@@ -39,6 +51,8 @@ public:
         RTCPPacketType packet_type,
         size_t nack_size = 0,
         const uint16_t* nack_list = 0);
+    // transport-cc反馈单独发送，不和报告组成复合包
+    bool SendFeedbackPacket(rtcp::TransportFeedback* packet);
 
 private:
     class RtcpContext;
@@ -71,14 +85,21 @@ private:
     void PrepareReport(const FeedbackState& feedback_state);
 
     void BuildSr(const RtcpContext& context, PacketSender& sender);
+    void BuildRr(const RtcpContext& context, PacketSender& sender);
+    void BuildNack(const RtcpContext& context, PacketSender& sender);
+    void BuildPli(const RtcpContext& context, PacketSender& sender);
+    void BuildExtendedReports(const RtcpContext& context, PacketSender& sender);
 
 private:
     bool audio_;
     webrtc::Clock* clock_;
     uint32_t ssrc_;
+    uint32_t remote_ssrc_ = 0;
     int clock_rate_;
     size_t max_packet_size_;
     RtpRtcpModuleObserver* rtp_rtcp_module_observer_;
+    ReceiveStatisticsProvider* receive_statistics_;
+    bool non_sender_rtt_measurement_;
     std::function<void(webrtc::TimeDelta)> schedule_next_rtcp_send_;
     webrtc::RtcpMode mode_ = webrtc::RtcpMode::kOff;
     webrtc::TimeDelta report_interval_ms_;
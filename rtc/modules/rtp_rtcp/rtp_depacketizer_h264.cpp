@@ -0,0 +1,147 @@
+﻿#include "xrtc/rtc/modules/rtp_rtcp/rtp_depacketizer_h264.h"
+
+#include <string.h>
+
+#include <modules/rtp_rtcp/source/byte_io.h>
+
+#include "xrtc/rtc/modules/rtp_rtcp/rtp_format_h264.h"
+
+namespace xrtc {
+
+namespace {
+
+const uint8_t kStartCode[] = { 0, 0, 0, 1 };
+const size_t kStartCodeSize = sizeof(kStartCode);
+const size_t kNalHeaderSize = 1;
+const size_t kFuAHeaderSize = 2;
+const size_t kStapANaluLengthSize = 2;
+
+const uint8_t kNalTypeMask = 0x1F;
+const uint8_t kNalFNriMask = 0xE0;
+const uint8_t kFuStartBit = 0x80;
+
+void ParseNaluType(uint8_t type, H264PacketInfo* info) {
+    if (NaluType::kIdr == type) {
+        info->has_idr = true;
+    }
+    else if (NaluType::kSps == type) {
+        info->has_sps = true;
+    }
+    else if (NaluType::kPps == type) {
+        info->has_pps = true;
+    }
+}
+
+} // namespace
+
+bool RtpDepacketizerH264::Parse(rtc::ArrayView<const uint8_t> payload,
+    H264PacketInfo* info)
+{
+    *info = H264PacketInfo();
+    if (payload.size() < kNalHeaderSize) {
+        return false;
+    }
+
+    const uint8_t* data = payload.data();
+    uint8_t type = data[0] & kNalTypeMask;
+    if (NaluType::kStapA == type) {
+        // STAP-A: 每个NALU前面有2字节的长度
+        size_t offset = kNalHeaderSize;
+        while (offset < payload.size()) {
+            if (offset + kStapANaluLengthSize > payload.size()) {
+                return false;
+            }
+            size_t nalu_size = webrtc::ByteReader<uint16_t>::ReadBigEndian(data + offset);
+            offset += kStapANaluLengthSize;
+            if (0 == nalu_size || offset + nalu_size > payload.size()) {
+                return false;
+            }
+            ParseNaluType(data[offset] & kNalTypeMask, info);
+            offset += nalu_size;
+        }
+        info->nalu_start = true;
+    }
+    else if (NaluType::kFuA == type) {
+        if (payload.size() <= kFuAHeaderSize) {
+            return false;
+        }
+        // 只在第一个分片中统计NALU的类型
+        info->nalu_start = (data[1] & kFuStartBit) != 0;
+        if (info->nalu_start) {
+            ParseNaluType(data[1] & kNalTypeMask, info);
+        }
+    }
+    else if (type > 0 && type < NaluType::kStapA) {
+        info->nalu_start = true;
+        ParseNaluType(type, info);
+    }
+    else {
+        return false;
+    }
+
+    return true;
+}
+
+size_t RtpDepacketizerH264::AssembledSize(rtc::ArrayView<const uint8_t> payload) {
+    const uint8_t* data = payload.data();
+    uint8_t type = data[0] & kNalTypeMask;
+    if (NaluType::kStapA == type) {
+        size_t size = 0;
+        size_t offset = kNalHeaderSize;
+        while (offset + kStapANaluLengthSize <= payload.size()) {
+            size_t nalu_size = webrtc::ByteReader<uint16_t>::ReadBigEndian(data + offset);
+            offset += kStapANaluLengthSize + nalu_size;
+            size += kStartCodeSize + nalu_size;
+        }
+        return size;
+    }
+    else if (NaluType::kFuA == type) {
+        // 第一个分片需要恢复NALU的起始码和头部
+        if (data[1] & kFuStartBit) {
+            return kStartCodeSize + kNalHeaderSize + payload.size() - kFuAHeaderSize;
+        }
+        return payload.size() - kFuAHeaderSize;
+    }
+
+    return kStartCodeSize + payload.size();
+}
+
+size_t RtpDepacketizerH264::Assemble(rtc::ArrayView<const uint8_t> payload,
+    uint8_t* buffer)
+{
+    const uint8_t* data = payload.data();
+    uint8_t type = data[0] & kNalTypeMask;
+    size_t written = 0;
+    if (NaluType::kStapA == type) {
+        size_t offset = kNalHeaderSize;
+        while (offset + kStapANaluLengthSize <= payload.size()) {
+            size_t nalu_size = webrtc::ByteReader<uint16_t>::ReadBigEndian(data + offset);
+            offset += kStapANaluLengthSize;
+            memcpy(buffer + written, kStartCode, kStartCodeSize);
+            written += kStartCodeSize;
+            memcpy(buffer + written, data + offset, nalu_size);
+            written += nalu_size;
+            offset += nalu_size;
+        }
+    }
+    else if (NaluType::kFuA == type) {
+        if (data[1] & kFuStartBit) {
+            memcpy(buffer + written, kStartCode, kStartCodeSize);
+            written += kStartCodeSize;
+            // F和NRI来自FU indicator，type来自FU header
+            buffer[written++] = (data[0] & kNalFNriMask) | (data[1] & kNalTypeMask);
+        }
+        memcpy(buffer + written, data + kFuAHeaderSize, payload.size() - kFuAHeaderSize);
+        written += payload.size() - kFuAHeaderSize;
+    }
+    else {
+        memcpy(buffer + written, kStartCode, kStartCodeSize);
+        written += kStartCodeSize;
+        memcpy(buffer + written, data, payload.size());
+        written += payload.size();
+    }
+
+    return written;
+}
+
+} // namespace xrtc
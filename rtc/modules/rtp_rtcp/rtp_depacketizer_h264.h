@@ -0,0 +1,30 @@
+﻿#ifndef XRTCSDK_XRTC_RTC_MODULES_RTP_RTCP_RTP_DEPACKETIZER_H264_H_
+#define XRTCSDK_XRTC_RTC_MODULES_RTP_RTCP_RTP_DEPACKETIZER_H264_H_
+
+#include <api/array_view.h>
+
+namespace xrtc {
+
+struct H264PacketInfo {
+    // 包含一个NALU的开始：单个NALU包、STAP-A包、FU-A的第一个分片
+    bool nalu_start = false;
+    bool has_idr = false;
+    bool has_sps = false;
+    bool has_pps = false;
+};
+
+// H264 RTP负载的解包，支持单个NALU、STAP-A和FU-A(RFC 6184)
+// 组帧时直接写入调用者提供的内存，输出Annex-B格式，不做额外的内存分配
+class RtpDepacketizerH264 {
+public:
+    // 解析负载的类型，负载不合法时返回false
+    static bool Parse(rtc::ArrayView<const uint8_t> payload, H264PacketInfo* info);
+    // 负载转换为Annex-B格式之后的大小
+    static size_t AssembledSize(rtc::ArrayView<const uint8_t> payload);
+    // 将负载转换为Annex-B格式写入buffer，返回写入的字节数
+    static size_t Assemble(rtc::ArrayView<const uint8_t> payload, uint8_t* buffer);
+};
+
+} // namespace xrtc
+
+#endif // XRTCSDK_XRTC_RTC_MODULES_RTP_RTCP_RTP_DEPACKETIZER_H264_H_
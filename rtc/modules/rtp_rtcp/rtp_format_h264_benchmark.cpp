@@ -0,0 +1,66 @@
+﻿#include "xrtc/rtc/modules/rtp_rtcp/rtp_format_h264.h"
+
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "xrtc/rtc/modules/rtp_rtcp/rtp_packet_to_send.h"
+
+namespace xrtc {
+
+namespace {
+const uint8_t kStartCode[] = { 0x00, 0x00, 0x00, 0x01 };
+// 720p的编码输出，关键帧带SPS和PPS
+const size_t kSpsSize = 15;
+const size_t kPpsSize = 4;
+const size_t kIdrSliceSize = 60000;
+const size_t kPSliceSize = 6000;
+
+void AppendNalu(std::vector<uint8_t>* frame, uint8_t nalu_header, size_t size) {
+    frame->insert(frame->end(), kStartCode, kStartCode + sizeof(kStartCode));
+    frame->push_back(nalu_header);
+    // 负载不含0，不会出现伪起始码
+    for (size_t i = 1; i < size; ++i) {
+        frame->push_back((uint8_t)(1 + (i * 31) % 255));
+    }
+}
+
+std::vector<uint8_t> BuildFrame(bool keyframe) {
+    std::vector<uint8_t> frame;
+    if (keyframe) {
+        AppendNalu(&frame, 0x67, kSpsSize);
+        AppendNalu(&frame, 0x68, kPpsSize);
+        AppendNalu(&frame, 0x65, kIdrSliceSize);
+    }
+    else {
+        AppendNalu(&frame, 0x41, kPSliceSize);
+    }
+    return frame;
+}
+
+} // namespace
+
+// 一帧分包的完整过程，和PeerConnection::SendEncodedImage一样每个包新建一个RtpPacketToSend
+void BM_RtpPacketizerH264(benchmark::State& state) {
+    std::vector<uint8_t> frame = BuildFrame(state.range(0) != 0);
+    RtpPacketizer::Config config;
+    size_t num_packets = 0;
+    for (auto _ : state) {
+        auto packetizer = RtpPacketizer::Create(webrtc::kVideoCodecH264,
+            rtc::ArrayView<const uint8_t>(frame.data(), frame.size()), config);
+        num_packets = packetizer->NumPackets();
+        while (true) {
+            RtpPacketToSend packet;
+            if (!packetizer->NextPacket(&packet)) {
+                break;
+            }
+            benchmark::DoNotOptimize(packet.data());
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * frame.size());
+    state.SetItemsProcessed(state.iterations() * num_packets);
+}
+// 参数为1表示关键帧，0表示P帧
+BENCHMARK(BM_RtpPacketizerH264)->Arg(1)->Arg(0);
+
+} // namespace xrtc
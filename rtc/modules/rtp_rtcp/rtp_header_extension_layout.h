@@ -0,0 +1,112 @@
+#ifndef XRTCSDK_XRTC_RTC_MODULES_RTP_RTCP_RTP_HEADER_EXTENSION_LAYOUT_H_
+#define XRTCSDK_XRTC_RTC_MODULES_RTP_RTCP_RTP_HEADER_EXTENSION_LAYOUT_H_
+
+#include <array>
+#include <type_traits>
+
+#include <api/array_view.h>
+#include <api/rtp_parameters.h>
+
+#include "xrtc/rtc/modules/rtp_rtcp/rtp_packet.h"
+#include "xrtc/rtc/modules/rtp_rtcp/rtp_header_extension_map.h"
+
+namespace xrtc {
+
+//固定扩展集合的RTP头部布局
+//发送的包都按照Extensions的顺序预留扩展，每个扩展在包中的偏移量只和注册的id、长度有关，
+//协商完成之后计算一次，发送时直接写入已知的偏移量，不需要再查找extension_entries_
+template <typename... Extensions>
+class RtpHeaderExtensionLayout {
+public:
+    RtpHeaderExtensionLayout() { offsets_.fill(0); }
+    explicit RtpHeaderExtensionLayout(const RtpHeaderExtensionMap& map) {
+        Update(map);
+    }
+
+    //扩展注册发生变化之后需要重新计算
+    void Update(const RtpHeaderExtensionMap& map) {
+        const uint8_t ids[] = { map.GetId(Extensions::kId)... };
+        const size_t sizes[] = { Extensions::kValueSizeBytes... };
+
+        //只要有一个扩展需要两字节头，所有的扩展都会被提升为两字节头
+        bool two_bytes_header = false;
+        for (size_t i = 0; i < kNumExtensions; ++i) {
+            if (ids[i] == RtpHeaderExtensionMap::kInvalidId) {
+                continue;
+            }
+            if (ids[i] > webrtc::RtpExtension::kOneByteHeaderExtensionMaxId ||
+                sizes[i] > webrtc::RtpExtension::kOneByteHeaderExtensionMaxValueSize)
+            {
+                two_bytes_header = true;
+            }
+        }
+
+        //固定头部12字节 + profile_id和length 4字节, 不包含CSRC
+        const size_t extensions_offset = 12 + 4;
+        const size_t extension_header_size = two_bytes_header ? 2 : 1;
+        size_t extension_size = 0;
+        for (size_t i = 0; i < kNumExtensions; ++i) {
+            offsets_[i] = 0;
+            if (ids[i] == RtpHeaderExtensionMap::kInvalidId) {
+                continue;
+            }
+            offsets_[i] = extensions_offset + extension_size + extension_header_size;
+            extension_size += extension_header_size + sizes[i];
+        }
+
+        //扩展部分4字节对齐
+        header_size_ = extension_size > 0 ?
+            extensions_offset + (extension_size + 3) / 4 * 4 : 12;
+    }
+
+    //按照布局的顺序预留所有已注册的扩展，保证包中的偏移量和计算出来的一致
+    bool Reserve(RtpPacket* packet) const {
+        bool results[] = { true, (IsRegistered<Extensions>() ?
+            packet->ReserveExtension<Extensions>() : true)... };
+        for (bool result : results) {
+            if (!result) {
+                return false;
+            }
+        }
+        return packet->header_size() == header_size_;
+    }
+
+    //直接写入已知的偏移量，包不是按照该布局预留的扩展时(例如RTX包)，退化为普通的查找写入
+    template <typename Extension, typename... Values>
+    bool Write(RtpPacket* packet, const Values&... values) const {
+        static_assert(IndexOf<Extension, Extensions...>() < kNumExtensions,
+            "extension is not part of the layout");
+        size_t offset = offsets_[IndexOf<Extension, Extensions...>()];
+        if (0 == offset || packet->header_size() != header_size_) {
+            return packet->SetExtension<Extension>(values...);
+        }
+        return Extension::Write(rtc::MakeArrayView(packet->WriteAt(offset),
+            Extension::kValueSizeBytes), values...);
+    }
+
+    template <typename Extension>
+    bool IsRegistered() const {
+        return offsets_[IndexOf<Extension, Extensions...>()] != 0;
+    }
+
+    size_t header_size() const { return header_size_; }
+
+private:
+    template <typename T>
+    static constexpr size_t IndexOf() { return 0; }
+
+    template <typename T, typename First, typename... Rest>
+    static constexpr size_t IndexOf() {
+        return std::is_same<T, First>::value ? 0 : 1 + IndexOf<T, Rest...>();
+    }
+
+private:
+    static constexpr size_t kNumExtensions = sizeof...(Extensions);
+    //扩展数据在包中的偏移量，0表示该扩展没有注册
+    std::array<size_t, kNumExtensions> offsets_;
+    size_t header_size_ = 12;
+};
+
+} // namespace xrtc
+
+#endif // XRTCSDK_XRTC_RTC_MODULES_RTP_RTCP_RTP_HEADER_EXTENSION_LAYOUT_H_
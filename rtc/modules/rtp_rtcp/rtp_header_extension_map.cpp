@@ -10,15 +10,15 @@ namespace{
         RTPExtensionType type;
         absl::string_view uri;
     };
-    const ExtensionInfo kExtensionInfos[] = {
-        {kRtpExtensionTransportSequenceNumber,2,0},
-    };
     template<typename Extension>
-    bool ExtensionInfo CreateExtensionInfo(){
+    ExtensionInfo CreateExtensionInfo(){
         return {Extension::kId,Extension::Uri()};
     }
     const ExtensionInfo kExtensions [] = {
         CreateExtensionInfo<TransportSequenceNumber>(),
+        CreateExtensionInfo<AbsoluteSendTime>(),
+        CreateExtensionInfo<AbsoluteCaptureTimeExtension>(),
+        CreateExtensionInfo<FrameMarkingExtension>(),
     };
     static_assert(arraysize(kExtensions) == static_cast<int>(kRtpExtensionNumberOfExtensions) - 1,"kExtensions expect to list all known extensions");
 }
@@ -1,15 +1,104 @@
 #include "xrtc/rtc/modules/rtp_rtcp/rtp_header_extensions.h"
 #include<modules/rtp_rtcp/source/byte_io.h>
 namespace xrtc {
-    static bool Parse(rtc::ArrayView<const uint8_t> data,uint16_t* transport_sequence_number){
+    bool TransportSequenceNumber::Parse(rtc::ArrayView<const uint8_t> data,uint16_t* transport_sequence_number){
         if(data.size() != kValueSizeBytes){
             return false;
         }
         *transport_sequence_number = webrtc::ByteReader<uint16_t>::ReadBigEndian(data.data());
         return true;
     }
-    static bool Write(rtc::ArrayView<uint8_t> data,uint16_t transport_sequence_number){
+    bool TransportSequenceNumber::Write(rtc::ArrayView<uint8_t> data,uint16_t transport_sequence_number){
          webrtc::ByteWriter<uint16_t>::WriteBigEndian(data.data(),transport_sequence_number);
         return true;
     }
+
+    bool AbsoluteSendTime::Parse(rtc::ArrayView<const uint8_t> data,uint32_t* time_24bits){
+        if(data.size() != kValueSizeBytes){
+            return false;
+        }
+        *time_24bits = webrtc::ByteReader<uint32_t,3>::ReadBigEndian(data.data());
+        return true;
+    }
+
+    bool AbsoluteSendTime::Write(rtc::ArrayView<uint8_t> data,uint32_t time_24bits){
+        if(data.size() != kValueSizeBytes || time_24bits > 0x00FFFFFF){
+            return false;
+        }
+        webrtc::ByteWriter<uint32_t,3>::WriteBigEndian(data.data(),time_24bits);
+        return true;
+    }
+
+    size_t AbsoluteCaptureTimeExtension::ValueSize(const webrtc::AbsoluteCaptureTime& extension){
+        if(extension.estimated_capture_clock_offset.has_value()){
+            return kValueSizeBytes;
+        }
+        return kValueSizeBytesWithoutEstimatedCaptureClockOffset;
+    }
+
+    bool AbsoluteCaptureTimeExtension::Parse(rtc::ArrayView<const uint8_t> data,
+        webrtc::AbsoluteCaptureTime* extension)
+    {
+        if(data.size() != kValueSizeBytes &&
+            data.size() != kValueSizeBytesWithoutEstimatedCaptureClockOffset)
+        {
+            return false;
+        }
+        extension->absolute_capture_timestamp =
+            webrtc::ByteReader<uint64_t>::ReadBigEndian(data.data());
+        if(data.size() != kValueSizeBytesWithoutEstimatedCaptureClockOffset){
+            extension->estimated_capture_clock_offset =
+                webrtc::ByteReader<int64_t>::ReadBigEndian(data.data() + 8);
+        }
+        return true;
+    }
+
+    bool AbsoluteCaptureTimeExtension::Write(rtc::ArrayView<uint8_t> data,
+        const webrtc::AbsoluteCaptureTime& extension)
+    {
+        if(data.size() != ValueSize(extension)){
+            return false;
+        }
+        webrtc::ByteWriter<uint64_t>::WriteBigEndian(data.data(),
+            extension.absolute_capture_timestamp);
+        if(data.size() != kValueSizeBytesWithoutEstimatedCaptureClockOffset){
+            webrtc::ByteWriter<int64_t>::WriteBigEndian(data.data() + 8,
+                extension.estimated_capture_clock_offset.value());
+        }
+        return true;
+    }
+
+    bool FrameMarkingExtension::Parse(rtc::ArrayView<const uint8_t> data,
+        FrameMarking* frame_marking)
+    {
+        if(data.size() != kValueSizeBytes){
+            return false;
+        }
+        frame_marking->start_of_frame = (data[0] & 0x80) != 0;
+        frame_marking->end_of_frame = (data[0] & 0x40) != 0;
+        frame_marking->independent_frame = (data[0] & 0x20) != 0;
+        frame_marking->discardable_frame = (data[0] & 0x10) != 0;
+        frame_marking->base_layer_sync = (data[0] & 0x08) != 0;
+        frame_marking->temporal_id = data[0] & 0x07;
+        frame_marking->layer_id = data[1];
+        frame_marking->tl0_pic_idx = data[2];
+        return true;
+    }
+
+    bool FrameMarkingExtension::Write(rtc::ArrayView<uint8_t> data,
+        const FrameMarking& frame_marking)
+    {
+        if(data.size() != kValueSizeBytes || frame_marking.temporal_id > 0x07){
+            return false;
+        }
+        data[0] = (frame_marking.start_of_frame ? 0x80 : 0) |
+            (frame_marking.end_of_frame ? 0x40 : 0) |
+            (frame_marking.independent_frame ? 0x20 : 0) |
+            (frame_marking.discardable_frame ? 0x10 : 0) |
+            (frame_marking.base_layer_sync ? 0x08 : 0) |
+            frame_marking.temporal_id;
+        data[1] = frame_marking.layer_id;
+        data[2] = frame_marking.tl0_pic_idx;
+        return true;
+    }
 } // namespace xrtc
@@ -3,6 +3,7 @@
 #include "xrtc/rtc/modules/rtp_rtcp/rtp_rtcp_defines.h"
 #include <api/rtp_parameters.h>
 #include<api/array_view.h>
+#include <api/rtp_headers.h>
 
 namespace xrtc {
 //ŵRTPк
@@ -19,6 +20,70 @@ class TransportSequenceNumber{
     }
     static bool Parse(rtc::ArrayView<const uint8_t> data,uint16_t* transport_sequence_number);
     static bool Write(rtc::ArrayView<uint8_t> data,uint16_t transport_sequence_number);
-}
+};
+
+//abs-send-time뿪Ͷ˵ʱ䣬6.18ʾ룬24bit64
+class AbsoluteSendTime {
+    public:
+    using value_type = uint32_t;
+    static const RTPExtensionType kId = kRtpExtensionAbsoluteSendTime;
+    static const size_t kValueSizeBytes = 3;
+    static const absl::string_view Uri() {
+        return webrtc::RtpExtension::kAbsSendTimeUri;
+    }
+    static size_t ValueSize(uint32_t) {
+        return kValueSizeBytes;
+    }
+    static bool Parse(rtc::ArrayView<const uint8_t> data,uint32_t* time_24bits);
+    static bool Write(rtc::ArrayView<uint8_t> data,uint32_t time_24bits);
+
+    //ת6.18
+    static constexpr uint32_t MsTo24Bits(int64_t time_ms) {
+        return static_cast<uint32_t>(((time_ms << 18) + 500) / 1000) & 0x00FFFFFF;
+    }
+};
+
+//abs-capture-time֡Ĳɼʱ(NTPʱ䣬UQ32.32)ԼѡĲɼʱӺͷͶʱӵƫ
+class AbsoluteCaptureTimeExtension {
+    public:
+    using value_type = webrtc::AbsoluteCaptureTime;
+    static const RTPExtensionType kId = kRtpExtensionAbsoluteCaptureTime;
+    static const size_t kValueSizeBytes = 16;
+    static const size_t kValueSizeBytesWithoutEstimatedCaptureClockOffset = 8;
+    static const absl::string_view Uri() {
+        return webrtc::RtpExtension::kAbsoluteCaptureTimeUri;
+    }
+    static size_t ValueSize(const webrtc::AbsoluteCaptureTime& extension);
+    static bool Parse(rtc::ArrayView<const uint8_t> data,webrtc::AbsoluteCaptureTime* extension);
+    static bool Write(rtc::ArrayView<uint8_t> data,const webrtc::AbsoluteCaptureTime& extension);
+};
+
+//frame-marking֡ı߽硢ǷԶԼʱ㣬SFUҪܰʱ㶪֡
+struct FrameMarking {
+    bool start_of_frame = false;
+    bool end_of_frame = false;
+    bool independent_frame = false;//IDR֡
+    bool discardable_frame = false;//ûб֡οӰ
+    bool base_layer_sync = false;//ֻο
+    uint8_t temporal_id = 0;
+    uint8_t layer_id = 0;
+    uint8_t tl0_pic_idx = 0;
+};
+
+//ʹÿʽ̶3ֽ: |S|E|I|D|B| TID | LID | TL0PICIDX |
+class FrameMarkingExtension {
+    public:
+    using value_type = FrameMarking;
+    static const RTPExtensionType kId = kRtpExtensionFrameMarking;
+    static const size_t kValueSizeBytes = 3;
+    static const absl::string_view Uri() {
+        return "http://tools.ietf.org/html/draft-ietf-avtext-framemarking-07";
+    }
+    static size_t ValueSize(const FrameMarking&) {
+        return kValueSizeBytes;
+    }
+    static bool Parse(rtc::ArrayView<const uint8_t> data,FrameMarking* frame_marking);
+    static bool Write(rtc::ArrayView<uint8_t> data,const FrameMarking& frame_marking);
+};
 }
 #endif // XRTCSDK_XRTC_RTC_MODULES_RTP_RTCP_RTP_HEADER_EXTENSIONS_H_
\ No newline at end of file
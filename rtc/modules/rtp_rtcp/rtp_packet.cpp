@@ -65,6 +65,103 @@ void RtpPacket::Clear() {
     WriteAt(0, kRtpVersion << 6);
 }
 
+bool RtpPacket::Parse(const uint8_t* buffer, size_t size) {
+    if (size < kFixedHeaderSize || (buffer[0] >> 6) != kRtpVersion) {
+        return false;
+    }
+
+    bool has_padding = (buffer[0] & 0x20) != 0;
+    bool has_extension = (buffer[0] & 0x10) != 0;
+    size_t num_csrc = buffer[0] & 0x0F;
+    marker_ = (buffer[1] & 0x80) != 0;
+    payload_type_ = buffer[1] & 0x7F;
+    sequence_number_ = webrtc::ByteReader<uint16_t>::ReadBigEndian(buffer + 2);
+    timestamp_ = webrtc::ByteReader<uint32_t>::ReadBigEndian(buffer + 4);
+    ssrc_ = webrtc::ByteReader<uint32_t>::ReadBigEndian(buffer + 8);
+    payload_offset_ = kFixedHeaderSize + num_csrc * 4;
+    if (payload_offset_ > size) {
+        return false;
+    }
+
+    // padding的最后一个字节是padding的长度
+    padding_size_ = 0;
+    if (has_padding) {
+        padding_size_ = buffer[size - 1];
+        if (0 == padding_size_) {
+            return false;
+        }
+    }
+
+    extension_entries_.clear();
+    extension_size_ = 0;
+    if (has_extension) {
+        size_t extensions_offset = payload_offset_ + 4;
+        if (extensions_offset > size) {
+            return false;
+        }
+
+        uint16_t profile_id = webrtc::ByteReader<uint16_t>::ReadBigEndian(
+            buffer + payload_offset_);
+        size_t extensions_capacity = webrtc::ByteReader<uint16_t>::ReadBigEndian(
+            buffer + payload_offset_ + 2) * 4;
+        if (extensions_offset + extensions_capacity > size) {
+            return false;
+        }
+
+        // 两字节头的profile_id低4位是appbits
+        bool one_byte_header = kOneByteHeaderExtensionProfileId == profile_id;
+        bool two_bytes_header = kTwoByteHeaderExtensionProfileId == (profile_id & 0xFFF0);
+        if (one_byte_header || two_bytes_header) {
+            size_t extension_header_size = one_byte_header ?
+                kOneByteHeaderExtensionLength : kTwoByteHeaderExtensionLength;
+            while (extension_size_ + extension_header_size < extensions_capacity) {
+                const uint8_t* header = buffer + extensions_offset + extension_size_;
+                // 扩展之间的填充字节
+                if (0 == header[0]) {
+                    ++extension_size_;
+                    continue;
+                }
+
+                uint8_t id = 0;
+                size_t length = 0;
+                if (one_byte_header) {
+                    id = header[0] >> 4;
+                    length = (header[0] & 0x0F) + 1;
+                    // 15是保留的id，后面的数据不再解析
+                    if (15 == id) {
+                        break;
+                    }
+                }
+                else {
+                    id = header[0];
+                    length = header[1];
+                }
+
+                if (extension_size_ + extension_header_size + length > extensions_capacity) {
+                    RTC_LOG(LS_WARNING) << "invalid extension length, id: " << (int)id;
+                    break;
+                }
+
+                if (!FindExtensionInfo(id)) {
+                    extension_entries_.emplace_back(id, length,
+                        extensions_offset + extension_size_ + extension_header_size);
+                }
+                extension_size_ += extension_header_size + length;
+            }
+        }
+
+        payload_offset_ = extensions_offset + extensions_capacity;
+    }
+
+    if (payload_offset_ + padding_size_ > size) {
+        return false;
+    }
+
+    payload_size_ = size - payload_offset_ - padding_size_;
+    buffer_.SetData(buffer, size);
+    return true;
+}
+
 void RtpPacket::SetMarker(bool marker_bit) {
     marker_ = marker_bit;
     if (marker_bit) {
@@ -16,6 +16,8 @@ public:
     uint16_t sequence_number() const { return sequence_number_; }
     bool marker() const { return marker_; }
     uint32_t timestamp() const { return timestamp_; }
+    uint32_t ssrc() const { return ssrc_; }
+    uint8_t payload_type() const { return payload_type_; }
     rtc::ArrayView<const uint8_t> payload() const {
         return rtc::MakeArrayView(data() + payload_offset_, payload_size_);
     }
@@ -31,6 +33,8 @@ public:
     size_t capacity() { return buffer_.capacity(); }
     size_t FreeCapacity() { return capacity() - size(); }
     void Clear();
+    // 解析接收到的RTP包，失败时包的内容无效
+    bool Parse(const uint8_t* buffer, size_t size);
 
     void SetMarker(bool marker_bit);
     void SetPayloadType(uint8_t payload_type);
@@ -53,9 +57,9 @@ public:
 
     rtc::ArrayView<const uint8_t> FindExtension(RTPExtensionType type)const ;
     template<typename Extension>
-    absl::optional<typename Extension::Value_type> GetExtension() const;
+    absl::optional<typename Extension::value_type> GetExtension() const;
     template<typename Extension,typename ... Values>
-    bool SetExtension(const Value&... values);
+    bool SetExtension(const Values&... values);
 
     template<typename Extension>
     bool ReserveExtension();
@@ -89,8 +93,8 @@ private:
 };
 
 template<typename Extension>
-absl::optional<typename Extension::Value_type> RtpPacket::GetExtension() const{
-    absl::optional<typename Extension::Value_type> result;
+absl::optional<typename Extension::value_type> RtpPacket::GetExtension() const{
+    absl::optional<typename Extension::value_type> result;
     auto raw= FindExtension(Extension::kId);
     if(raw.empty() || !Extension::Parse(raw,&result.emplace())){
         return absl::nullopt;
@@ -98,7 +102,7 @@ absl::optional<typename Extension::Value_type> RtpPacket::GetExtension() const{
     return result;
 }
 template<typename Extension,typename ... Values>
-bool SetExtension(const Value&... values){
+bool RtpPacket::SetExtension(const Values&... values){
     size_t value_size = Extension::ValueSize(values...);
     auto buffer = AllocateExtension(Extension::kId,value_size);
     if(buffer.empty()){
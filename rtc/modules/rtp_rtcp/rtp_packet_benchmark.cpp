@@ -0,0 +1,77 @@
+﻿#include "xrtc/rtc/modules/rtp_rtcp/rtp_packet_to_send.h"
+
+#include <benchmark/benchmark.h>
+
+#include "xrtc/rtc/modules/rtp_rtcp/rtp_header_extension_layout.h"
+#include "xrtc/rtc/modules/rtp_rtcp/rtp_header_extensions.h"
+
+namespace xrtc {
+
+namespace {
+const uint8_t kPayloadType = 107;
+const uint32_t kSsrc = 0x12345678;
+const size_t kPayloadSize = 1200;
+
+// 和PeerConnection注册的扩展一致
+RtpHeaderExtensionMap CreateExtensionMap() {
+    RtpHeaderExtensionMap map;
+    map.RegisterUri(TransportSequenceNumber::kId, TransportSequenceNumber::Uri());
+    map.RegisterUri(AbsoluteSendTime::kId, AbsoluteSendTime::Uri());
+    map.RegisterUri(AbsoluteCaptureTimeExtension::kId,
+        AbsoluteCaptureTimeExtension::Uri());
+    map.RegisterUri(FrameMarkingExtension::kId, FrameMarkingExtension::Uri());
+    return map;
+}
+
+} // namespace
+
+// 一帧中第一个包的头部和扩展的写入过程，和PeerConnection::SendEncodedImage、
+// SendPacket一样：分包时写frame-marking和abs-capture-time，pacer发送时写
+// transport-wide序列号和abs-send-time
+// 参数为1表示使用预先计算好偏移量的RtpHeaderExtensionLayout，0表示每次查找扩展
+void BM_RtpPacketWriteHeaderAndExtensions(benchmark::State& state) {
+    RtpHeaderExtensionMap map = CreateExtensionMap();
+    RtpHeaderExtensionLayout<TransportSequenceNumber,
+        AbsoluteSendTime,
+        FrameMarkingExtension,
+        AbsoluteCaptureTimeExtension> layout(map);
+    bool use_layout = state.range(0) != 0;
+
+    FrameMarking frame_marking;
+    frame_marking.start_of_frame = true;
+    webrtc::AbsoluteCaptureTime capture_time{ 0x1122334455667788ull, 0 };
+    uint16_t seq = 0;
+    uint32_t rtp_timestamp = 0;
+    for (auto _ : state) {
+        RtpPacketToSend packet(&map);
+        packet.SetPayloadType(kPayloadType);
+        packet.SetTimestamp(rtp_timestamp);
+        packet.SetSsrc(kSsrc);
+        packet.SetSequenceNumber(seq);
+        if (use_layout) {
+            layout.Reserve(&packet);
+            layout.Write<FrameMarkingExtension>(&packet, frame_marking);
+            layout.Write<AbsoluteCaptureTimeExtension>(&packet, capture_time);
+            packet.AllocatePayload(kPayloadSize);
+            layout.Write<TransportSequenceNumber>(&packet, seq);
+            layout.Write<AbsoluteSendTime>(&packet, rtp_timestamp);
+        }
+        else {
+            // 发送时才写入的扩展需要在填充负载之前预留
+            packet.ReserveExtension<TransportSequenceNumber>();
+            packet.ReserveExtension<AbsoluteSendTime>();
+            packet.SetExtension<FrameMarkingExtension>(frame_marking);
+            packet.SetExtension<AbsoluteCaptureTimeExtension>(capture_time);
+            packet.AllocatePayload(kPayloadSize);
+            packet.SetExtension<TransportSequenceNumber>(seq);
+            packet.SetExtension<AbsoluteSendTime>(rtp_timestamp);
+        }
+        benchmark::DoNotOptimize(packet.data());
+        ++seq;
+        rtp_timestamp += 3000;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RtpPacketWriteHeaderAndExtensions)->Arg(1)->Arg(0);
+
+} // namespace xrtc
@@ -0,0 +1,15 @@
+﻿#include "xrtc/rtc/modules/rtp_rtcp/rtp_packet_received.h"
+
+namespace xrtc {
+
+RtpPacketReceived::RtpPacketReceived() :
+    RtpPacket()
+{
+}
+
+RtpPacketReceived::RtpPacketReceived(const RtpHeaderExtensionMap* extensions) :
+    RtpPacket(extensions)
+{
+}
+
+} // namespace xrtc
@@ -0,0 +1,37 @@
+﻿#ifndef XRTCSDK_XRTC_RTC_MODULES_RTP_RTCP_RTP_PACKET_RECEIVED_H_
+#define XRTCSDK_XRTC_RTC_MODULES_RTP_RTCP_RTP_PACKET_RECEIVED_H_
+
+#include "xrtc/rtc/modules/rtp_rtcp/rtp_packet.h"
+
+namespace xrtc {
+
+class RtpPacketReceived : public RtpPacket {
+public:
+    RtpPacketReceived();
+    RtpPacketReceived(const RtpHeaderExtensionMap* extensions);
+
+    void set_arrival_time_ms(int64_t arrival_time_ms) {
+        arrival_time_ms_ = arrival_time_ms;
+    }
+
+    int64_t arrival_time_ms() const {
+        return arrival_time_ms_;
+    }
+
+    // 通过RTX重传恢复的包
+    void set_recovered(bool recovered) {
+        recovered_ = recovered;
+    }
+
+    bool recovered() const {
+        return recovered_;
+    }
+
+private:
+    int64_t arrival_time_ms_ = 0;
+    bool recovered_ = false;
+};
+
+} // namespace xrtc
+
+#endif // XRTCSDK_XRTC_RTC_MODULES_RTP_RTCP_RTP_PACKET_RECEIVED_H_
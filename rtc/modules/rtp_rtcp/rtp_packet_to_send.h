@@ -21,8 +21,18 @@ void set_packet_type(RtpPacketMediaType type) {
         return packet_type_;
     }
 
+    // 所属帧的时间层，0为基础层
+    void set_temporal_id(int temporal_id) {
+        temporal_id_ = temporal_id;
+    }
+
+    int temporal_id() const {
+        return temporal_id_;
+    }
+
 private:
     absl::optional<RtpPacketMediaType> packet_type_;
+    int temporal_id_ = 0;
 };
 
 } // namespace xrtc
@@ -16,12 +16,20 @@ class RtpPacket;
 enum RTPExtensionType : int {
     kRtpExtensionNone,
     kRtpExtensionTransportSequenceNumber,
+    kRtpExtensionAbsoluteSendTime,
+    kRtpExtensionAbsoluteCaptureTime,
+    kRtpExtensionFrameMarking,
     kRtpExtensionNumberOfExtensions,
-}
-    enum RTCPPacketType : uint32_t {
+};
+
+enum RTCPPacketType : uint32_t {
     kRtcpReport = 0x0001,
     kRtcpSr = 0x0002,
     kRtcpRr = 0x0004,
+    kRtcpNack = 0x0008,
+    kRtcpPli = 0x0010,
+    // RTCP XR，只接收时携带RRTR，收到RRTR之后回复DLRR
+    kRtcpExtendedReports = 0x0020,
 };
 
 class RtpPacketCounter {
@@ -39,6 +39,28 @@ void ModuleRtpRtcpImpl::SetSendingStatus(bool sending) {
     rtcp_sender_.SetSendingStatus(sending);
 }
 
+void ModuleRtpRtcpImpl::SetRemoteSSRC(uint32_t ssrc) {
+    rtcp_sender_.SetRemoteSSRC(ssrc);
+    rtcp_receiver_.SetRemoteSSRC(ssrc);
+}
+
+void ModuleRtpRtcpImpl::SendNack(const std::vector<uint16_t>& nack_list) {
+    if (nack_list.empty()) {
+        return;
+    }
+
+    rtcp_sender_.SendRTCP(GetFeedbackState(), kRtcpNack,
+        nack_list.size(), nack_list.data());
+}
+
+void ModuleRtpRtcpImpl::SendPictureLossIndication() {
+    rtcp_sender_.SendRTCP(GetFeedbackState(), kRtcpPli);
+}
+
+bool ModuleRtpRtcpImpl::SendFeedbackPacket(rtcp::TransportFeedback* packet) {
+    return rtcp_sender_.SendFeedbackPacket(packet);
+}
+
 //在发送RTP视频帧时触发RTCP报告的生成和发送
 void ModuleRtpRtcpImpl::OnSendingRtpFrame(uint32_t rtp_timestamp, 
     int64_t capture_time_ms,
@@ -115,6 +137,10 @@ RTCPSender::FeedbackState ModuleRtpRtcpImpl::GetFeedbackState() {
             + rtx_rtp_stats_.transmmited.payload_bytes;
     }
 
+    rtcp_receiver_.LastReceivedSr(&feedback_state.remote_sr,
+        &feedback_state.last_sr_arrival_time);
+    feedback_state.last_xr_rtis = rtcp_receiver_.ConsumeReceivedXrReferenceTimeInfo();
+
     return feedback_state;
 }
 
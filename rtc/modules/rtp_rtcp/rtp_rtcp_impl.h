@@ -20,6 +20,12 @@ public:
         bool is_rtx, bool is_retransmit);
     void SetRTCPStatus(webrtc::RtcpMode mode);
     void SetSendingStatus(bool sending);
+    void SetRemoteSSRC(uint32_t ssrc);
+    // 发送generic NACK请求重传，nack_list需要按照seq从旧到新排列
+    void SendNack(const std::vector<uint16_t>& nack_list);
+    // 发送PLI请求关键帧，频率由调用方控制
+    void SendPictureLossIndication();
+    bool SendFeedbackPacket(rtcp::TransportFeedback* packet);
     void OnSendingRtpFrame(uint32_t rtp_timestamp,
         int64_t capture_time_ms,
         bool forced_report);
@@ -27,6 +33,12 @@ public:
         IncomingRtcpPacket(rtc::MakeArrayView(packet, length));
     }
     void IncomingRtcpPacket(rtc::ArrayView<const uint8_t> packet);
+    // 最后收到的远端SR的NTP时间和本地到达时间，没有收到时返回false
+    bool LastReceivedSrNtp(webrtc::NtpTime* remote_sr_ntp,
+        webrtc::Timestamp* arrival_time) const
+    {
+        return rtcp_receiver_.LastReceivedSrNtp(remote_sr_ntp, arrival_time);
+    }
 
 private:
     void ScheduleNextRtcpSend(webrtc::TimeDelta duration);
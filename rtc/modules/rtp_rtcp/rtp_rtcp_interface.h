@@ -8,11 +8,15 @@
 #include "xrtc/rtc/modules/rtp_rtcp/rtp_rtcp_defines.h"
 namespace xrtc {
 
+class ReceiveStatisticsProvider;
+
 class RtpRtcpModuleObserver {
 public:
     virtual void OnLocalRtcpPacket(webrtc::MediaType media_type,
         const uint8_t* data, size_t len) = 0;
+    // ssrc为report block对应的媒体流，simulcast时用于区分不同的层
     virtual void OnNetworkInfo(
+                            uint32_t ssrc,
                             int64_t rtt_ms,
                             int32_t packets_lost,
                             uint8_t fraction_lost,
@@ -21,7 +25,10 @@ public:
                             webrtc::Timestamp at_time) = 0;
     virtual void OnNackReceived(
         webrtc::MediaType media_type,
+        uint32_t ssrc,
         const std::vector<uint16_t>& nack_list) = 0;
+    // 只接收时通过XR的RRTR/DLRR计算的RTT，ssrc为本端发送RTCP使用的ssrc
+    virtual void OnRttUpdated(uint32_t ssrc, int64_t rtt_ms) = 0;
 };
 
 class RtpRtcpInterface {
@@ -36,6 +43,10 @@ public:
         int rtcp_report_interval_ms = 0;
         RtpRtcpModuleObserver* rtp_rtcp_module_observer = nullptr;
         TransportFeedbackObserver* transport_feedback_observer = nullptr;
+        // 接收统计，不为空时RR中携带report block
+        ReceiveStatisticsProvider* receive_statistics = nullptr;
+        // 不发送媒体时通过XR RRTR/DLRR测量RTT
+        bool non_sender_rtt_measurement = false;
     };
 };
 
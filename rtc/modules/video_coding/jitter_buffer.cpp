@@ -0,0 +1,224 @@
+﻿#include "xrtc/rtc/modules/video_coding/jitter_buffer.h"
+
+#include <algorithm>
+
+#include <rtc_base/logging.h>
+
+namespace xrtc {
+
+namespace {
+const int64_t kDefaultMinDelayMs = 0;
+const int64_t kDefaultMaxDelayMs = 1000;
+// 等待依赖的帧过多，说明依赖已经中断
+const size_t kMaxPendingFrames = 30;
+const size_t kMaxReadyFrames = 100;
+const size_t kMaxPaddingSeqNums = 1000;
+// 缓存时间每秒最多变化的量，避免播放速度突变
+const int64_t kMaxDelayChangeMsPerSecond = 100;
+// 偏移增大时缓慢跟随，用于适应收发两端的时钟漂移
+const double kTimestampOffsetDriftAlpha = 0.002;
+} // namespace
+
+JitterBuffer::JitterBuffer(webrtc::Clock* clock) :
+    clock_(clock),
+    min_delay_ms_(kDefaultMinDelayMs),
+    max_delay_ms_(kDefaultMaxDelayMs)
+{
+}
+
+JitterBuffer::~JitterBuffer() {
+}
+
+void JitterBuffer::SetDelayBounds(int64_t min_delay_ms, int64_t max_delay_ms) {
+    min_delay_ms_ = std::max(min_delay_ms, (int64_t)0);
+    max_delay_ms_ = std::max(max_delay_ms, min_delay_ms_);
+    RTC_LOG(LS_INFO) << "JitterBuffer delay bounds: [" << min_delay_ms_
+        << ", " << max_delay_ms_ << "]";
+}
+
+bool JitterBuffer::InsertFrame(AssembledFrame frame) {
+    // 关键帧不依赖前面的帧
+    if (frame.keyframe) {
+        OnDecodableFrame(frame);
+        PropagateDecodability();
+        return true;
+    }
+
+    if (!has_decodable_frame_) {
+        RTC_LOG(LS_INFO) << "drop delta frame before keyframe, ts: " << frame.timestamp;
+        return false;
+    }
+
+    if (!webrtc::AheadOf(frame.first_seq_num, last_decodable_seq_num_)) {
+        return true;
+    }
+
+    SkipPadding();
+    if (static_cast<uint16_t>(last_decodable_seq_num_ + 1) == frame.first_seq_num) {
+        OnDecodableFrame(frame);
+        PropagateDecodability();
+        return true;
+    }
+
+    if (pending_frames_.size() >= kMaxPendingFrames) {
+        RTC_LOG(LS_WARNING) << "too many pending frames, wait for keyframe";
+        pending_frames_.clear();
+        return false;
+    }
+    pending_frames_[frame.first_seq_num] = std::move(frame);
+    return true;
+}
+
+void JitterBuffer::InsertPadding(uint16_t seq_num) {
+    if (has_decodable_frame_ && !webrtc::AheadOf(seq_num, last_decodable_seq_num_)) {
+        return;
+    }
+
+    if (padding_seq_nums_.size() >= kMaxPaddingSeqNums) {
+        padding_seq_nums_.erase(padding_seq_nums_.begin());
+    }
+    padding_seq_nums_.insert(seq_num);
+    PropagateDecodability();
+}
+
+bool JitterBuffer::NextFrame(AssembledFrame* frame, int64_t* wait_ms) {
+    int64_t now_ms = clock_->TimeInMilliseconds();
+    UpdateCurrentDelay(now_ms);
+
+    if (ready_frames_.empty()) {
+        *wait_ms = -1;
+        return false;
+    }
+
+    ReadyFrame& ready = ready_frames_.front();
+    int64_t render_time_ms = ready.render_time_ms + current_delay_ms_;
+    if (render_time_ms > now_ms) {
+        *wait_ms = render_time_ms - now_ms;
+        return false;
+    }
+
+    *frame = std::move(ready.frame);
+    ready_frames_.pop_front();
+    *wait_ms = 0;
+    return true;
+}
+
+void JitterBuffer::Clear() {
+    has_decodable_frame_ = false;
+    pending_frames_.clear();
+    padding_seq_nums_.clear();
+    ready_frames_.clear();
+    has_prev_frame_ = false;
+}
+
+JitterBufferStats JitterBuffer::GetStats() const {
+    JitterBufferStats stats;
+    stats.jitter_ms = jitter_estimator_.GetJitterEstimateMs();
+    stats.target_delay_ms = TargetDelayMs();
+    stats.current_delay_ms = current_delay_ms_;
+    stats.num_ready_frames = ready_frames_.size();
+    stats.num_pending_frames = pending_frames_.size();
+    return stats;
+}
+
+void JitterBuffer::OnDecodableFrame(AssembledFrame& frame) {
+    has_decodable_frame_ = true;
+    last_decodable_seq_num_ = frame.last_seq_num;
+
+    int64_t timestamp_ms = timestamp_unwrapper_.Unwrap(frame.timestamp) / 90;
+    UpdateJitter(frame, timestamp_ms);
+
+    // 输出太慢时丢弃最早的帧，关键帧之后的帧不再依赖它们
+    if (ready_frames_.size() >= kMaxReadyFrames && frame.keyframe) {
+        RTC_LOG(LS_WARNING) << "too many ready frames, drop: " << ready_frames_.size();
+        ready_frames_.clear();
+    }
+
+    ReadyFrame ready;
+    ready.render_time_ms = timestamp_ms + (int64_t)timestamp_offset_ms_;
+    ready.frame = std::move(frame);
+    ready_frames_.push_back(std::move(ready));
+}
+
+void JitterBuffer::PropagateDecodability() {
+    while (has_decodable_frame_ && !pending_frames_.empty()) {
+        SkipPadding();
+        auto it = pending_frames_.begin();
+        if (!webrtc::AheadOf(it->first, last_decodable_seq_num_)) {
+            pending_frames_.erase(it);
+            continue;
+        }
+
+        if (it->first != static_cast<uint16_t>(last_decodable_seq_num_ + 1)) {
+            break;
+        }
+
+        AssembledFrame frame = std::move(it->second);
+        pending_frames_.erase(it);
+        OnDecodableFrame(frame);
+    }
+}
+
+void JitterBuffer::SkipPadding() {
+    while (!padding_seq_nums_.empty()) {
+        uint16_t seq_num = *padding_seq_nums_.begin();
+        if (seq_num == static_cast<uint16_t>(last_decodable_seq_num_ + 1)) {
+            last_decodable_seq_num_ = seq_num;
+        }
+        else if (webrtc::AheadOf(seq_num, last_decodable_seq_num_)) {
+            break;
+        }
+        padding_seq_nums_.erase(padding_seq_nums_.begin());
+    }
+}
+
+void JitterBuffer::UpdateJitter(const AssembledFrame& frame, int64_t timestamp_ms) {
+    double offset_ms = (double)(frame.receive_time_ms - timestamp_ms);
+    if (!has_timestamp_offset_ || offset_ms < timestamp_offset_ms_) {
+        timestamp_offset_ms_ = offset_ms;
+        has_timestamp_offset_ = true;
+    }
+    else {
+        timestamp_offset_ms_ += kTimestampOffsetDriftAlpha * (offset_ms - timestamp_offset_ms_);
+    }
+
+    // 只使用时间戳递增的帧估计抖动，B帧的时间戳会回退
+    if (has_prev_frame_ && timestamp_ms > prev_timestamp_ms_) {
+        int64_t frame_delay_ms = (frame.receive_time_ms - prev_receive_time_ms_) -
+            (timestamp_ms - prev_timestamp_ms_);
+        jitter_estimator_.UpdateEstimate(frame_delay_ms, frame.frame->data_len[0]);
+    }
+
+    if (!has_prev_frame_ || timestamp_ms > prev_timestamp_ms_) {
+        has_prev_frame_ = true;
+        prev_timestamp_ms_ = timestamp_ms;
+        prev_receive_time_ms_ = frame.receive_time_ms;
+    }
+}
+
+void JitterBuffer::UpdateCurrentDelay(int64_t now_ms) {
+    int64_t target_delay_ms = TargetDelayMs();
+    if (last_delay_update_ms_ < 0) {
+        current_delay_ms_ = target_delay_ms;
+        last_delay_update_ms_ = now_ms;
+        return;
+    }
+
+    int64_t max_change_ms = (now_ms - last_delay_update_ms_) *
+        kMaxDelayChangeMsPerSecond / 1000;
+    if (0 == max_change_ms) {
+        return;
+    }
+
+    int64_t delta_ms = target_delay_ms - current_delay_ms_;
+    delta_ms = std::max(std::min(delta_ms, max_change_ms), -max_change_ms);
+    current_delay_ms_ += delta_ms;
+    last_delay_update_ms_ = now_ms;
+}
+
+int64_t JitterBuffer::TargetDelayMs() const {
+    int64_t jitter_ms = jitter_estimator_.GetJitterEstimateMs();
+    return std::max(min_delay_ms_, std::min(jitter_ms, max_delay_ms_));
+}
+
+} // namespace xrtc
@@ -0,0 +1,93 @@
+﻿#ifndef XRTCSDK_XRTC_RTC_MODULES_VIDEO_CODING_JITTER_BUFFER_H_
+#define XRTCSDK_XRTC_RTC_MODULES_VIDEO_CODING_JITTER_BUFFER_H_
+
+#include <deque>
+#include <map>
+#include <set>
+
+#include <rtc_base/numerics/sequence_number_util.h>
+#include <system_wrappers/include/clock.h>
+
+#include "xrtc/rtc/modules/video_coding/jitter_estimator.h"
+#include "xrtc/rtc/modules/video_coding/packet_buffer.h"
+
+namespace xrtc {
+
+struct JitterBufferStats {
+    // 估计的网络抖动
+    int64_t jitter_ms = 0;
+    // 目标缓存时间，抖动估计限制在[min, max]之间
+    int64_t target_delay_ms = 0;
+    // 当前实际使用的缓存时间，逐渐向目标值靠近
+    int64_t current_delay_ms = 0;
+    // 可以解码，等待输出的帧数
+    size_t num_ready_frames = 0;
+    // 依赖没有满足，等待前面的帧的帧数
+    size_t num_pending_frames = 0;
+};
+
+// 帧级别的抖动缓存
+// 可解码性：关键帧总是可以解码；增量帧需要紧接在上一个可解码帧之后(seq连续，中间只有padding)
+// 才能解码，否则一直等待，直到前面的帧补齐或者收到新的关键帧
+// 输出时间：按照时间戳换算的本地时间加上缓存时间，缓存时间由抖动估计决定，限制在[min, max]之间
+// 非线程安全，需要在同一个线程调用
+class JitterBuffer {
+public:
+    explicit JitterBuffer(webrtc::Clock* clock);
+    ~JitterBuffer();
+
+    void SetDelayBounds(int64_t min_delay_ms, int64_t max_delay_ms);
+    // 返回false表示帧的依赖已经中断，需要请求关键帧
+    bool InsertFrame(AssembledFrame frame);
+    void InsertPadding(uint16_t seq_num);
+    // 取出下一个到达输出时间的帧，没有时返回false
+    // wait_ms是下一个帧需要等待的时间，-1表示还没有可以解码的帧
+    bool NextFrame(AssembledFrame* frame, int64_t* wait_ms);
+    void Clear();
+
+    bool has_decodable_frame() const { return has_decodable_frame_; }
+    // 最后一个可解码帧的最后一个包的seq，之前的包都不再需要
+    uint16_t last_decodable_seq_num() const { return last_decodable_seq_num_; }
+    JitterBufferStats GetStats() const;
+
+private:
+    struct ReadyFrame {
+        AssembledFrame frame;
+        int64_t render_time_ms = 0;
+    };
+
+    void OnDecodableFrame(AssembledFrame& frame);
+    void PropagateDecodability();
+    void SkipPadding();
+    void UpdateJitter(const AssembledFrame& frame, int64_t timestamp_ms);
+    void UpdateCurrentDelay(int64_t now_ms);
+    int64_t TargetDelayMs() const;
+
+private:
+    webrtc::Clock* clock_;
+    int64_t min_delay_ms_;
+    int64_t max_delay_ms_;
+    JitterEstimator jitter_estimator_;
+    bool has_decodable_frame_ = false;
+    uint16_t last_decodable_seq_num_ = 0;
+    // 依赖还没有满足的帧，按照第一个包的seq从旧到新排序
+    std::map<uint16_t, AssembledFrame, webrtc::DescendingSeqNumComp<uint16_t>>
+        pending_frames_;
+    // 收到的padding包的seq，检查seq连续时跳过
+    std::set<uint16_t, webrtc::DescendingSeqNumComp<uint16_t>> padding_seq_nums_;
+    std::deque<ReadyFrame> ready_frames_;
+    webrtc::SeqNumUnwrapper<uint32_t> timestamp_unwrapper_;
+    // 本地时间与时间戳的偏移，取接近最小值，即网络延迟最小时的偏移
+    bool has_timestamp_offset_ = false;
+    double timestamp_offset_ms_ = 0;
+    // 上一个用于抖动估计的帧
+    bool has_prev_frame_ = false;
+    int64_t prev_timestamp_ms_ = 0;
+    int64_t prev_receive_time_ms_ = 0;
+    int64_t current_delay_ms_ = 0;
+    int64_t last_delay_update_ms_ = -1;
+};
+
+} // namespace xrtc
+
+#endif // XRTCSDK_XRTC_RTC_MODULES_VIDEO_CODING_JITTER_BUFFER_H_
@@ -0,0 +1,184 @@
+﻿#include "xrtc/rtc/modules/video_coding/jitter_buffer.h"
+
+#include <memory>
+#include <vector>
+
+#include <system_wrappers/include/clock.h>
+#include <test/gtest.h>
+
+namespace xrtc {
+
+namespace {
+const int64_t kFrameIntervalMs = 33;
+const size_t kFrameSize = 1000;
+
+// seq从first_seq_num到last_seq_num的一帧，时间戳按照90kHz换算
+AssembledFrame CreateFrame(uint16_t first_seq_num, uint16_t last_seq_num,
+    int64_t timestamp_ms, int64_t receive_time_ms, bool keyframe)
+{
+    AssembledFrame frame;
+    frame.first_seq_num = first_seq_num;
+    frame.last_seq_num = last_seq_num;
+    frame.timestamp = (uint32_t)(timestamp_ms * 90);
+    frame.keyframe = keyframe;
+    frame.receive_time_ms = receive_time_ms;
+    frame.frame = std::make_shared<MediaFrame>(kFrameSize);
+    frame.frame->data_len[0] = kFrameSize;
+    frame.frame->ts = (uint32_t)timestamp_ms;
+    return frame;
+}
+
+class JitterBufferTest : public ::testing::Test {
+protected:
+    JitterBufferTest() : clock_(1000000), jitter_buffer_(&clock_) {}
+
+    // 取出当前已经到达输出时间的所有帧
+    std::vector<uint32_t> ReleaseFrames() {
+        std::vector<uint32_t> timestamps;
+        AssembledFrame frame;
+        int64_t wait_ms = 0;
+        while (jitter_buffer_.NextFrame(&frame, &wait_ms)) {
+            timestamps.push_back(frame.frame->ts);
+        }
+        return timestamps;
+    }
+
+    int64_t NowMs() { return clock_.TimeInMilliseconds(); }
+
+    webrtc::SimulatedClock clock_;
+    JitterBuffer jitter_buffer_;
+};
+
+} // namespace
+
+TEST_F(JitterBufferTest, OutputsFramesInDecodeOrder) {
+    jitter_buffer_.SetDelayBounds(0, 0);
+    int64_t now_ms = NowMs();
+    EXPECT_TRUE(jitter_buffer_.InsertFrame(CreateFrame(0, 1, 0, now_ms, true)));
+    // 第三帧先于第二帧组帧完成
+    EXPECT_TRUE(jitter_buffer_.InsertFrame(CreateFrame(4, 5, 66, now_ms, false)));
+    EXPECT_EQ(1u, jitter_buffer_.GetStats().num_pending_frames);
+    EXPECT_TRUE(jitter_buffer_.InsertFrame(CreateFrame(2, 3, 33, now_ms, false)));
+    EXPECT_EQ(0u, jitter_buffer_.GetStats().num_pending_frames);
+    EXPECT_EQ(5, jitter_buffer_.last_decodable_seq_num());
+
+    clock_.AdvanceTimeMilliseconds(2 * kFrameIntervalMs);
+    std::vector<uint32_t> expected = { 0, 33, 66 };
+    EXPECT_EQ(expected, ReleaseFrames());
+}
+
+TEST_F(JitterBufferTest, ReleasesFramesAtTimestampPlusDelay) {
+    const int64_t kDelayMs = 100;
+    jitter_buffer_.SetDelayBounds(kDelayMs, kDelayMs);
+    int64_t start_ms = NowMs();
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_TRUE(jitter_buffer_.InsertFrame(CreateFrame(i, i,
+            i * kFrameIntervalMs, NowMs(), 0 == i)));
+        clock_.AdvanceTimeMilliseconds(kFrameIntervalMs);
+    }
+
+    // 每一帧在到达之后缓存kDelayMs再输出，输出间隔和时间戳间隔相同
+    for (int i = 0; i < 3; ++i) {
+        AssembledFrame frame;
+        int64_t wait_ms = 0;
+        EXPECT_FALSE(jitter_buffer_.NextFrame(&frame, &wait_ms));
+        EXPECT_EQ(start_ms + i * kFrameIntervalMs + kDelayMs, NowMs() + wait_ms);
+        clock_.AdvanceTimeMilliseconds(wait_ms);
+        EXPECT_EQ(std::vector<uint32_t>{ (uint32_t)(i * kFrameIntervalMs) },
+            ReleaseFrames());
+    }
+}
+
+TEST_F(JitterBufferTest, DelayStaysWithinBounds) {
+    const int64_t kMinDelayMs = 50;
+    const int64_t kMaxDelayMs = 150;
+    jitter_buffer_.SetDelayBounds(kMinDelayMs, kMaxDelayMs);
+
+    // 没有抖动时使用最小缓存时间
+    EXPECT_TRUE(jitter_buffer_.InsertFrame(CreateFrame(0, 0, 0, NowMs(), true)));
+    AssembledFrame frame;
+    int64_t wait_ms = 0;
+    EXPECT_FALSE(jitter_buffer_.NextFrame(&frame, &wait_ms));
+    EXPECT_EQ(kMinDelayMs, wait_ms);
+    clock_.AdvanceTimeMilliseconds(wait_ms);
+    EXPECT_TRUE(jitter_buffer_.NextFrame(&frame, &wait_ms));
+
+    // 到达时间交替延迟0和400ms，估计的抖动超过上限
+    int64_t start_ms = NowMs();
+    for (int i = 1; i < 300; ++i) {
+        int64_t timestamp_ms = i * kFrameIntervalMs;
+        clock_.AdvanceTimeMilliseconds(kFrameIntervalMs);
+        int64_t receive_time_ms = start_ms + timestamp_ms + (i % 2 ? 400 : 0);
+        EXPECT_TRUE(jitter_buffer_.InsertFrame(CreateFrame(i, i, timestamp_ms,
+            receive_time_ms, false)));
+        ReleaseFrames();
+
+        JitterBufferStats stats = jitter_buffer_.GetStats();
+        EXPECT_GE(stats.target_delay_ms, kMinDelayMs);
+        EXPECT_LE(stats.target_delay_ms, kMaxDelayMs);
+        EXPECT_GE(stats.current_delay_ms, kMinDelayMs);
+        EXPECT_LE(stats.current_delay_ms, kMaxDelayMs);
+    }
+
+    JitterBufferStats stats = jitter_buffer_.GetStats();
+    EXPECT_GT(stats.jitter_ms, kMaxDelayMs);
+    EXPECT_EQ(kMaxDelayMs, stats.target_delay_ms);
+}
+
+TEST_F(JitterBufferTest, WaitsForMissingReferenceFrame) {
+    jitter_buffer_.SetDelayBounds(0, 0);
+    int64_t now_ms = NowMs();
+    EXPECT_TRUE(jitter_buffer_.InsertFrame(CreateFrame(0, 0, 0, now_ms, true)));
+    // seq 1的帧丢失，后面的帧依赖它，不能输出
+    EXPECT_TRUE(jitter_buffer_.InsertFrame(CreateFrame(2, 2, 66, now_ms, false)));
+    EXPECT_TRUE(jitter_buffer_.InsertFrame(CreateFrame(3, 3, 99, now_ms, false)));
+
+    clock_.AdvanceTimeMilliseconds(200);
+    EXPECT_EQ(std::vector<uint32_t>{ 0 }, ReleaseFrames());
+    EXPECT_EQ(2u, jitter_buffer_.GetStats().num_pending_frames);
+    EXPECT_EQ(0, jitter_buffer_.last_decodable_seq_num());
+
+    // 重传补齐之后依次输出
+    EXPECT_TRUE(jitter_buffer_.InsertFrame(CreateFrame(1, 1, 33, NowMs(), false)));
+    std::vector<uint32_t> expected = { 33, 66, 99 };
+    EXPECT_EQ(expected, ReleaseFrames());
+    EXPECT_EQ(3, jitter_buffer_.last_decodable_seq_num());
+}
+
+TEST_F(JitterBufferTest, PaddingFillsSequenceGap) {
+    jitter_buffer_.SetDelayBounds(0, 0);
+    int64_t now_ms = NowMs();
+    EXPECT_TRUE(jitter_buffer_.InsertFrame(CreateFrame(0, 0, 0, now_ms, true)));
+    EXPECT_TRUE(jitter_buffer_.InsertFrame(CreateFrame(2, 2, 33, now_ms, false)));
+    EXPECT_EQ(1u, jitter_buffer_.GetStats().num_pending_frames);
+
+    // seq 1是padding，不是丢失的帧
+    jitter_buffer_.InsertPadding(1);
+    EXPECT_EQ(0u, jitter_buffer_.GetStats().num_pending_frames);
+    EXPECT_EQ(2, jitter_buffer_.last_decodable_seq_num());
+}
+
+TEST_F(JitterBufferTest, DeltaFrameBeforeKeyFrameRequestsKeyFrame) {
+    EXPECT_FALSE(jitter_buffer_.InsertFrame(CreateFrame(0, 0, 0, NowMs(), false)));
+    EXPECT_FALSE(jitter_buffer_.has_decodable_frame());
+}
+
+TEST_F(JitterBufferTest, TooManyFramesWaitingForReferenceRequestsKeyFrame) {
+    EXPECT_TRUE(jitter_buffer_.InsertFrame(CreateFrame(0, 0, 0, NowMs(), true)));
+
+    // 参考帧一直没有收到，等待的帧超过上限之后需要关键帧
+    bool ok = true;
+    for (int i = 2; i < 100 && ok; ++i) {
+        ok = jitter_buffer_.InsertFrame(CreateFrame(i, i, i * kFrameIntervalMs,
+            NowMs(), false));
+    }
+    EXPECT_FALSE(ok);
+    EXPECT_EQ(0u, jitter_buffer_.GetStats().num_pending_frames);
+
+    // 新的关键帧恢复解码
+    EXPECT_TRUE(jitter_buffer_.InsertFrame(CreateFrame(200, 201, 200 * kFrameIntervalMs,
+        NowMs(), true)));
+    EXPECT_EQ(201, jitter_buffer_.last_decodable_seq_num());
+}
+
+} // namespace xrtc
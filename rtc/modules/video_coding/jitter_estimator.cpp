@@ -0,0 +1,163 @@
+﻿#include "xrtc/rtc/modules/video_coding/jitter_estimator.h"
+
+#include <math.h>
+
+#include <algorithm>
+
+namespace xrtc {
+
+namespace {
+const double kPhi = 0.97;
+const double kPsi = 0.9999;
+const double kThetaLow = 0.000001;
+const double kNoiseStdDevs = 2.33;
+const double kNoiseStdDevOffset = 30.0;
+const double kNumStdDevDelayOutlier = 15.0;
+const double kNumStdDevFrameSizeOutlier = 3.0;
+const size_t kAlphaCountMax = 400;
+const double kAlphaCount = 0.9975;
+// 过程噪声
+const double kQ[2] = { 2.5e-10, 1e-10 };
+} // namespace
+
+JitterEstimator::JitterEstimator() {
+    Reset();
+}
+
+JitterEstimator::~JitterEstimator() {
+}
+
+void JitterEstimator::Reset() {
+    // 初始斜率相当于512kbps的传输速度
+    theta_[0] = 1 / (512e3 / 8);
+    theta_[1] = 0;
+    theta_cov_[0][0] = 1e-4;
+    theta_cov_[1][1] = 1e2;
+    theta_cov_[0][1] = theta_cov_[1][0] = 0;
+    avg_frame_size_ = 500;
+    var_frame_size_ = 100;
+    max_frame_size_ = 500;
+    prev_frame_size_ = 0;
+    avg_noise_ = 0;
+    var_noise_ = 4.0;
+    sample_count_ = 0;
+}
+
+void JitterEstimator::UpdateEstimate(int64_t frame_delay_ms, size_t frame_size) {
+    if (0 == frame_size) {
+        return;
+    }
+
+    double delta_frame_size = 0;
+    if (prev_frame_size_ > 0) {
+        delta_frame_size = frame_size - prev_frame_size_;
+    }
+    prev_frame_size_ = frame_size;
+
+    // 关键帧这类特别大的帧不计入平均大小，避免平均值被拉高
+    double avg_frame_size = kPhi * avg_frame_size_ + (1 - kPhi) * frame_size;
+    if (frame_size < avg_frame_size_ + 2 * sqrt(var_frame_size_)) {
+        avg_frame_size_ = avg_frame_size;
+    }
+    var_frame_size_ = std::max(kPhi * var_frame_size_ + (1 - kPhi) *
+        (frame_size - avg_frame_size) * (frame_size - avg_frame_size), 1.0);
+    max_frame_size_ = std::max(kPsi * max_frame_size_, (double)frame_size);
+
+    double deviation = DeviationFromExpectedDelay((double)frame_delay_ms,
+        delta_frame_size);
+    // 偏差过大的样本认为是异常值，只按照限制后的值更新噪声
+    if (fabs(deviation) < kNumStdDevDelayOutlier * sqrt(var_noise_) ||
+        frame_size > avg_frame_size_ + kNumStdDevFrameSizeOutlier * sqrt(var_frame_size_))
+    {
+        EstimateRandomJitter(deviation);
+        KalmanEstimate((double)frame_delay_ms, delta_frame_size);
+    }
+    else {
+        double limit = kNumStdDevDelayOutlier * sqrt(var_noise_);
+        EstimateRandomJitter(deviation >= 0 ? limit : -limit);
+    }
+}
+
+int64_t JitterEstimator::GetJitterEstimateMs() const {
+    double noise_threshold = kNoiseStdDevs * sqrt(var_noise_) - kNoiseStdDevOffset;
+    if (noise_threshold < 1.0) {
+        noise_threshold = 1.0;
+    }
+
+    double jitter_ms = theta_[0] * (max_frame_size_ - avg_frame_size_) + noise_threshold;
+    return std::max((int64_t)(jitter_ms + 0.5), (int64_t)0);
+}
+
+void JitterEstimator::KalmanEstimate(double frame_delay_ms,
+    double delta_frame_size)
+{
+    // 预测的协方差
+    double m[2][2];
+    m[0][0] = theta_cov_[0][0] + kQ[0];
+    m[0][1] = theta_cov_[0][1];
+    m[1][0] = theta_cov_[1][0];
+    m[1][1] = theta_cov_[1][1] + kQ[1];
+
+    // 观测向量h = [delta_frame_size, 1]
+    double mh[2];
+    mh[0] = m[0][0] * delta_frame_size + m[0][1];
+    mh[1] = m[1][0] * delta_frame_size + m[1][1];
+
+    // 帧大小变化越大，测量越可信
+    double sigma = (300.0 * exp(-fabs(delta_frame_size) / (1e0 * max_frame_size_)) + 1) *
+        sqrt(var_noise_);
+    if (sigma < 1.0) {
+        sigma = 1.0;
+    }
+
+    double hmh_sigma = delta_frame_size * mh[0] + mh[1] + sigma;
+    if (fabs(hmh_sigma) < 1e-9) {
+        return;
+    }
+
+    double kalman_gain[2];
+    kalman_gain[0] = mh[0] / hmh_sigma;
+    kalman_gain[1] = mh[1] / hmh_sigma;
+
+    double measure_res = frame_delay_ms - (delta_frame_size * theta_[0] + theta_[1]);
+    theta_[0] += kalman_gain[0] * measure_res;
+    theta_[1] += kalman_gain[1] * measure_res;
+    if (theta_[0] < kThetaLow) {
+        theta_[0] = kThetaLow;
+    }
+
+    // cov = (I - K * h') * M
+    theta_cov_[0][0] = (1 - kalman_gain[0] * delta_frame_size) * m[0][0] -
+        kalman_gain[0] * m[1][0];
+    theta_cov_[0][1] = (1 - kalman_gain[0] * delta_frame_size) * m[0][1] -
+        kalman_gain[0] * m[1][1];
+    theta_cov_[1][0] = m[1][0] * (1 - kalman_gain[1]) -
+        kalman_gain[1] * delta_frame_size * m[0][0];
+    theta_cov_[1][1] = m[1][1] * (1 - kalman_gain[1]) -
+        kalman_gain[1] * delta_frame_size * m[0][1];
+}
+
+void JitterEstimator::EstimateRandomJitter(double deviation) {
+    ++sample_count_;
+    if (sample_count_ > kAlphaCountMax) {
+        sample_count_ = kAlphaCountMax;
+    }
+
+    // 开始时样本少，使用较小的平滑系数，尽快收敛
+    double alpha = (double)(sample_count_ - 1) / (double)sample_count_;
+    alpha = std::min(alpha, kAlphaCount);
+
+    double avg_noise = alpha * avg_noise_ + (1 - alpha) * deviation;
+    double var_noise = alpha * var_noise_ + (1 - alpha) *
+        (deviation - avg_noise_) * (deviation - avg_noise_);
+    avg_noise_ = avg_noise;
+    var_noise_ = std::max(var_noise, 1.0);
+}
+
+double JitterEstimator::DeviationFromExpectedDelay(double frame_delay_ms,
+    double delta_frame_size) const
+{
+    return frame_delay_ms - (theta_[0] * delta_frame_size + theta_[1]);
+}
+
+} // namespace xrtc
@@ -0,0 +1,45 @@
+﻿#ifndef XRTCSDK_XRTC_RTC_MODULES_VIDEO_CODING_JITTER_ESTIMATOR_H_
+#define XRTCSDK_XRTC_RTC_MODULES_VIDEO_CODING_JITTER_ESTIMATOR_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace xrtc {
+
+// 帧间延迟抖动的估计，参考webrtc的VCMJitterEstimator
+// 帧的延迟变化 = 接收时间差 - 时间戳差，分成两部分：
+// 与帧大小的变化成正比的部分(传输大帧需要的时间)，用卡尔曼滤波估计斜率和偏移
+// 剩余的随机部分，用指数平均估计方差
+class JitterEstimator {
+public:
+    JitterEstimator();
+    ~JitterEstimator();
+
+    // frame_delay_ms: 接收时间差 - 时间戳差，frame_size: 帧的字节数
+    void UpdateEstimate(int64_t frame_delay_ms, size_t frame_size);
+    // 需要的抖动缓存时间(ms)
+    int64_t GetJitterEstimateMs() const;
+    void Reset();
+
+private:
+    void KalmanEstimate(double frame_delay_ms, double delta_frame_size);
+    void EstimateRandomJitter(double deviation);
+    double DeviationFromExpectedDelay(double frame_delay_ms,
+        double delta_frame_size) const;
+
+private:
+    // 卡尔曼滤波的状态：[斜率(ms/byte), 偏移(ms)]及其协方差
+    double theta_[2];
+    double theta_cov_[2][2];
+    double avg_frame_size_;
+    double var_frame_size_;
+    double max_frame_size_;
+    double prev_frame_size_ = 0;
+    double avg_noise_;
+    double var_noise_;
+    size_t sample_count_ = 0;
+};
+
+} // namespace xrtc
+
+#endif // XRTCSDK_XRTC_RTC_MODULES_VIDEO_CODING_JITTER_ESTIMATOR_H_
@@ -0,0 +1,266 @@
+﻿#include "xrtc/rtc/modules/video_coding/packet_buffer.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include <rtc_base/checks.h>
+#include <rtc_base/logging.h>
+#include <rtc_base/numerics/sequence_number_util.h>
+
+#include "xrtc/rtc/modules/rtp_rtcp/rtp_header_extensions.h"
+
+namespace xrtc {
+
+const size_t PacketBuffer::kDefaultCapacity;
+const size_t PacketBuffer::kMaxPayloadSize;
+
+PacketBuffer::PacketBuffer(size_t capacity) :
+    buffer_(capacity)
+{
+    RTC_DCHECK(capacity > 0 && (capacity & (capacity - 1)) == 0);
+}
+
+PacketBuffer::~PacketBuffer() {
+}
+
+PacketBuffer::InsertResult PacketBuffer::InsertPacket(
+    const RtpPacketReceived& packet)
+{
+    InsertResult result;
+    rtc::ArrayView<const uint8_t> payload = packet.payload();
+    if (payload.size() > kMaxPayloadSize) {
+        RTC_LOG(LS_WARNING) << "rtp payload too large: " << payload.size()
+            << ", seq: " << packet.sequence_number();
+        return result;
+    }
+
+    H264PacketInfo info;
+    if (!RtpDepacketizerH264::Parse(payload, &info)) {
+        RTC_LOG(LS_WARNING) << "invalid h264 payload, seq: " << packet.sequence_number();
+        return result;
+    }
+
+    uint16_t seq_num = packet.sequence_number();
+    if (!first_packet_received_) {
+        first_seq_num_ = seq_num;
+        first_packet_received_ = true;
+    }
+    else if (webrtc::AheadOf(first_seq_num_, seq_num)) {
+        // 已经清除过的包，不再接收
+        if (is_cleared_to_first_seq_num_) {
+            return result;
+        }
+        first_seq_num_ = seq_num;
+    }
+
+    Slot& slot = GetSlot(seq_num);
+    if (slot.used) {
+        // 重复的包
+        if (slot.seq_num == seq_num) {
+            return result;
+        }
+
+        // 缓存已满，丢弃所有的包，等待关键帧
+        RTC_LOG(LS_WARNING) << "packet buffer full, clear all packets, seq: " << seq_num;
+        Clear();
+        first_seq_num_ = seq_num;
+        first_packet_received_ = true;
+        result.buffer_cleared = true;
+    }
+
+    slot.used = true;
+    slot.continuous = false;
+    slot.marker = packet.marker();
+    slot.seq_num = seq_num;
+    slot.timestamp = packet.timestamp();
+    slot.receive_time_ms = packet.arrival_time_ms();
+    auto frame_marking = packet.GetExtension<FrameMarkingExtension>();
+    slot.frame_start = frame_marking && frame_marking->start_of_frame;
+    slot.info = info;
+    slot.payload_size = payload.size();
+    memcpy(slot.payload, payload.data(), payload.size());
+
+    FindFrames(seq_num, &result);
+    return result;
+}
+
+void PacketBuffer::ClearTo(uint16_t seq_num) {
+    if (!first_packet_received_) {
+        return;
+    }
+
+    if (is_cleared_to_first_seq_num_ && webrtc::AheadOf(first_seq_num_, seq_num)) {
+        return;
+    }
+
+    size_t diff = webrtc::ForwardDiff<uint16_t>(first_seq_num_, seq_num) + 1;
+    size_t iterations = std::min(diff, buffer_.size());
+    for (size_t i = 0; i < iterations; ++i) {
+        Slot& slot = GetSlot(first_seq_num_ + i);
+        if (slot.used && !webrtc::AheadOf(slot.seq_num, seq_num)) {
+            slot.used = false;
+            slot.continuous = false;
+        }
+    }
+
+    first_seq_num_ = seq_num + 1;
+    is_cleared_to_first_seq_num_ = true;
+    UpdateLastFrameEnd(seq_num);
+}
+
+void PacketBuffer::Clear() {
+    for (Slot& slot : buffer_) {
+        slot.used = false;
+        slot.continuous = false;
+    }
+    first_packet_received_ = false;
+    is_cleared_to_first_seq_num_ = false;
+    has_last_frame_end_ = false;
+}
+
+bool PacketBuffer::PotentialNewFrame(uint16_t seq_num) const {
+    const Slot& slot = GetSlot(seq_num);
+    if (!slot.used || slot.seq_num != seq_num) {
+        return false;
+    }
+
+    const Slot& prev = GetSlot(seq_num - 1);
+    bool prev_received = prev.used && prev.seq_num == static_cast<uint16_t>(seq_num - 1);
+
+    // 帧中间的NALU也是nalu_start，不能作为帧的起点，否则前面的包丢失时会组成不完整的帧
+    // 只有以下情况确定是帧的第一个包：frame-marking的S标志，前一个包属于上一帧，
+    // 前一个包所在的帧已经组帧或者被清除，以SPS开始的关键帧
+    if (slot.info.nalu_start) {
+        if (slot.frame_start) {
+            return true;
+        }
+
+        if (prev_received) {
+            return prev.timestamp != slot.timestamp || prev.continuous;
+        }
+
+        if (has_last_frame_end_ &&
+            last_frame_end_seq_num_ == static_cast<uint16_t>(seq_num - 1))
+        {
+            return true;
+        }
+
+        return slot.info.has_sps;
+    }
+
+    // FU-A的中间分片，需要前一个包存在并且连续
+    if (!prev_received) {
+        return false;
+    }
+
+    return prev.timestamp == slot.timestamp && prev.continuous;
+}
+
+void PacketBuffer::FindFrames(uint16_t seq_num, InsertResult* result) {
+    for (size_t i = 0; i < buffer_.size() && PotentialNewFrame(seq_num); ++i) {
+        Slot& slot = GetSlot(seq_num);
+        slot.continuous = true;
+
+        if (slot.marker) {
+            // 向前查找相同时间戳的包，找到帧的第一个包
+            uint16_t start_seq_num = seq_num;
+            bool has_idr = slot.info.has_idr;
+            bool has_sps = slot.info.has_sps;
+            bool has_pps = slot.info.has_pps;
+            size_t tested_packets = 1;
+            while (tested_packets < buffer_.size()) {
+                uint16_t prev_seq_num = start_seq_num - 1;
+                const Slot& prev = GetSlot(prev_seq_num);
+                if (!prev.used || prev.seq_num != prev_seq_num ||
+                    prev.timestamp != slot.timestamp)
+                {
+                    break;
+                }
+
+                has_idr |= prev.info.has_idr;
+                has_sps |= prev.info.has_sps;
+                has_pps |= prev.info.has_pps;
+                start_seq_num = prev_seq_num;
+                ++tested_packets;
+            }
+
+            // 没有参数集的IDR帧无法解码，丢弃并请求新的关键帧
+            if (has_idr && (!has_sps || !has_pps)) {
+                RTC_LOG(LS_WARNING) << "drop idr frame without sps/pps, ts: "
+                    << slot.timestamp << ", sps: " << has_sps << ", pps: " << has_pps;
+                DropFrame(start_seq_num, seq_num);
+                result->keyframe_requested = true;
+            }
+            else {
+                result->frames.push_back(AssembleFrame(start_seq_num, seq_num, has_idr));
+            }
+        }
+
+        ++seq_num;
+    }
+}
+
+void PacketBuffer::DropFrame(uint16_t first_seq_num, uint16_t last_seq_num) {
+    size_t num_packets = webrtc::ForwardDiff<uint16_t>(first_seq_num, last_seq_num) + 1;
+    for (size_t i = 0; i < num_packets; ++i) {
+        Slot& slot = GetSlot(first_seq_num + i);
+        slot.used = false;
+        slot.continuous = false;
+    }
+    UpdateLastFrameEnd(last_seq_num);
+}
+
+void PacketBuffer::UpdateLastFrameEnd(uint16_t seq_num) {
+    if (!has_last_frame_end_ || webrtc::AheadOf(seq_num, last_frame_end_seq_num_)) {
+        last_frame_end_seq_num_ = seq_num;
+        has_last_frame_end_ = true;
+    }
+}
+
+AssembledFrame PacketBuffer::AssembleFrame(uint16_t first_seq_num,
+    uint16_t last_seq_num, bool keyframe)
+{
+    size_t num_packets = webrtc::ForwardDiff<uint16_t>(first_seq_num, last_seq_num) + 1;
+    size_t frame_size = 0;
+    for (size_t i = 0; i < num_packets; ++i) {
+        const Slot& slot = GetSlot(first_seq_num + i);
+        frame_size += RtpDepacketizerH264::AssembledSize(
+            rtc::MakeArrayView(slot.payload, slot.payload_size));
+    }
+
+    const Slot& last_slot = GetSlot(last_seq_num);
+    AssembledFrame assembled;
+    assembled.first_seq_num = first_seq_num;
+    assembled.last_seq_num = last_seq_num;
+    assembled.timestamp = last_slot.timestamp;
+    assembled.keyframe = keyframe;
+    assembled.receive_time_ms = last_slot.receive_time_ms;
+
+    std::shared_ptr<MediaFrame> frame = std::make_shared<MediaFrame>(frame_size);
+    frame->fmt.media_type = MainMediaType::kMainTypeVideo;
+    frame->fmt.sub_fmt.video_fmt.type = SubMediaType::kSubTypeH264;
+    // 分辨率需要解码之后才能确定
+    frame->fmt.sub_fmt.video_fmt.width = 0;
+    frame->fmt.sub_fmt.video_fmt.height = 0;
+    frame->fmt.sub_fmt.video_fmt.idr = keyframe;
+    // 视频的频率是90000
+    frame->ts = last_slot.timestamp / 90;
+
+    size_t written = 0;
+    for (size_t i = 0; i < num_packets; ++i) {
+        Slot& slot = GetSlot(first_seq_num + i);
+        written += RtpDepacketizerH264::Assemble(
+            rtc::MakeArrayView(slot.payload, slot.payload_size),
+            (uint8_t*)frame->data[0] + written);
+        slot.used = false;
+        slot.continuous = false;
+    }
+    frame->data_len[0] = written;
+    assembled.frame = frame;
+    UpdateLastFrameEnd(last_seq_num);
+
+    return assembled;
+}
+
+} // namespace xrtc
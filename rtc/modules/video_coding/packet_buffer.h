@@ -0,0 +1,91 @@
+﻿#ifndef XRTCSDK_XRTC_RTC_MODULES_VIDEO_CODING_PACKET_BUFFER_H_
+#define XRTCSDK_XRTC_RTC_MODULES_VIDEO_CODING_PACKET_BUFFER_H_
+
+#include <memory>
+#include <vector>
+
+#include "xrtc/media/base/media_frame.h"
+#include "xrtc/rtc/modules/rtp_rtcp/rtp_depacketizer_h264.h"
+#include "xrtc/rtc/modules/rtp_rtcp/rtp_packet_received.h"
+
+namespace xrtc {
+
+// 由连续的RTP包组成的一个完整的帧
+struct AssembledFrame {
+    uint16_t first_seq_num = 0;
+    uint16_t last_seq_num = 0;
+    uint32_t timestamp = 0;
+    bool keyframe = false;
+    // 帧的最后一个包到达的时间
+    int64_t receive_time_ms = 0;
+    // H264 Annex-B格式的帧数据
+    std::shared_ptr<MediaFrame> frame;
+};
+
+// 按照sequence number索引的接收包缓存，收齐一帧的所有包之后组成完整的帧
+// 缓存是固定大小的环形数组，在构造时一次性分配，插入包时只拷贝负载，不做内存分配
+class PacketBuffer {
+public:
+    struct InsertResult {
+        std::vector<AssembledFrame> frames;
+        // 缓存已满被清空，需要请求关键帧
+        bool buffer_cleared = false;
+        // 收到了缺少SPS/PPS的关键帧，已经丢弃，需要请求关键帧
+        bool keyframe_requested = false;
+    };
+
+    // capacity必须是2的幂，这样seq回绕之后索引仍然连续
+    explicit PacketBuffer(size_t capacity = kDefaultCapacity);
+    ~PacketBuffer();
+
+    InsertResult InsertPacket(const RtpPacketReceived& packet);
+    // 清除seq_num及之前的包，之后再收到这些包直接丢弃
+    void ClearTo(uint16_t seq_num);
+    void Clear();
+
+    static const size_t kDefaultCapacity = 512;
+    static const size_t kMaxPayloadSize = 1500;
+
+private:
+    struct Slot {
+        bool used = false;
+        // 从帧的第一个包到当前包都已经收到
+        bool continuous = false;
+        bool marker = false;
+        uint16_t seq_num = 0;
+        uint32_t timestamp = 0;
+        int64_t receive_time_ms = 0;
+        // frame-marking扩展的S标志，没有扩展时为false
+        bool frame_start = false;
+        H264PacketInfo info;
+        size_t payload_size = 0;
+        uint8_t payload[kMaxPayloadSize];
+    };
+
+    bool PotentialNewFrame(uint16_t seq_num) const;
+    void FindFrames(uint16_t seq_num, InsertResult* result);
+    void DropFrame(uint16_t first_seq_num, uint16_t last_seq_num);
+    void UpdateLastFrameEnd(uint16_t seq_num);
+    AssembledFrame AssembleFrame(uint16_t first_seq_num, uint16_t last_seq_num,
+        bool keyframe);
+    Slot& GetSlot(uint16_t seq_num) {
+        return buffer_[seq_num & (buffer_.size() - 1)];
+    }
+    const Slot& GetSlot(uint16_t seq_num) const {
+        return buffer_[seq_num & (buffer_.size() - 1)];
+    }
+
+private:
+    std::vector<Slot> buffer_;
+    bool first_packet_received_ = false;
+    // 缓存中允许的最小的seq
+    uint16_t first_seq_num_ = 0;
+    bool is_cleared_to_first_seq_num_ = false;
+    // 最近一个已经组帧或者清除的帧的最后一个包，下一个包一定是帧的开始
+    bool has_last_frame_end_ = false;
+    uint16_t last_frame_end_seq_num_ = 0;
+};
+
+} // namespace xrtc
+
+#endif // XRTCSDK_XRTC_RTC_MODULES_VIDEO_CODING_PACKET_BUFFER_H_
@@ -1,5 +1,6 @@
 ﻿#include "xrtc/rtc/pc/peer_connection.h"
 
+#include <algorithm>
 #include <vector>
 
 #include <rtc_base/logging.h>
@@ -7,7 +8,8 @@
 #include <rtc_base/helpers.h>
 #include <rtc_base_network/sent_packet.h>
 #include <rtc_base/time_utils.h>
-#include <api/task_queue/default_task_queue_factory.h>
+#include <rtc_base/task_utils/to_queued_task.h>
+#include <system_wrappers/include/ntp_time.h>
 #include <ice/candidate.h>
 
 #include "xrtc/rtc/modules/rtp_rtcp/rtp_packet_to_send.h"
@@ -20,37 +22,85 @@ namespace xrtc {
 namespace {
 const size_t RTC_PACKET_CACHE_SIZE = 2048;
 const size_t kMaxPaddingLength = 224;
+// pacer的排队时间超过该值时丢弃一个时间层，低于恢复值时恢复一个时间层
+const int64_t kTemporalLayerDropQueueMs = 300;
+const int64_t kTemporalLayerRestoreQueueMs = 50;
+const int64_t kTemporalLayerChangeIntervalMs = 1000;
+// 超过该时间没有发送帧的simulcast层认为已经暂停
+const int64_t kVideoLayerInactiveTimeoutMs = 2000;
 }//namespace
 
-PeerConnection::PeerConnection() :
-    transport_controller_(std::make_unique<TransportController>()),///底层传输管理，处理 ICE 连接
+PeerConnection::PeerConnection(const std::string& shard_key) :
+    network_shard_(XRTCGlobal::Instance()->AcquireNetworkShard(shard_key)),
+    transport_controller_(std::make_unique<TransportController>(
+        network_shard_->network_thread.get(),
+        network_shard_->port_allocator.get())),///底层传输管理，处理 ICE 连接
     clock_(webrtc::Clock::GetRealTimeClock()),
-    video_cache_(RTC_PACKET_CACHE_SIZE),//视频缓存
-    task_queue_factory_(webrtc::CreateDefaultTaskQueueFactory()),//创建异步任务线程工厂
     transport_send_(std::make_unique<RtpTransportControllerSend>(clock_,//拥塞控制器
-        this, task_queue_factory_.get()))
+        this, XRTCGlobal::Instance()->pacer_scheduler(),
+        network_shard_->controller_task_queue.get())),
+    task_safety_(webrtc::PendingTaskSafetyFlag::CreateDetached())
 {
     transport_controller_->SignalIceState.connect(this,
         &PeerConnection::OnIceState);
     transport_controller_->SignalRtcpPacketReceived.connect(this,
         &PeerConnection::OnRtcpPacketReceived);
+    transport_controller_->SignalRtpPacketReceived.connect(this,
+        &PeerConnection::OnRtpPacketReceived);
 
     //注册扩展
     rtp_header_extension_map_.RegisterUri(TransportSequenceNumber::kId,TransportSequenceNumber::Uri());
+    rtp_header_extension_map_.RegisterUri(AbsoluteSendTime::kId,AbsoluteSendTime::Uri());
+    rtp_header_extension_map_.RegisterUri(AbsoluteCaptureTimeExtension::kId,
+        AbsoluteCaptureTimeExtension::Uri());
+    rtp_header_extension_map_.RegisterUri(FrameMarkingExtension::kId,
+        FrameMarkingExtension::Uri());
+    //扩展注册完成之后，预先计算好每个扩展在包中的偏移量
+    send_extension_layout_.Update(rtp_header_extension_map_);
+    capture_time_extension_layout_.Update(rtp_header_extension_map_);
+    received_packet_ = RtpPacketReceived(&rtp_header_extension_map_);
     transport_send_->SignalTargetTransferRate.connect(this,&PeerConnection::OnTargetTransferRate);//设置目标码率
 }
 
 PeerConnection::~PeerConnection() {
-    XRTCGlobal::Instance()->network_thread()->Invoke<void>(RTC_FROM_HERE, [=]() {
-        if (video_send_stream_) {
-            delete video_send_stream_;
-            video_send_stream_ = nullptr;
+    network_thread()->Invoke<void>(RTC_FROM_HERE, [=]() {
+        task_safety_->SetNotAlive();
+        // 1. 停止接收RTP/RTCP，之后发送流的RTCPReceiver不会再回调transport_feedback_observer
+        transport_controller_->SignalIceState.disconnect(this);
+        transport_controller_->SignalRtcpPacketReceived.disconnect(this);
+        transport_controller_->SignalRtpPacketReceived.disconnect(this);
+        // 2. 停止pacer，pacer线程不会再调用SendPacket和GeneratePadding访问发送流
+        transport_send_->StopPacer();
+
+        // 3. 删除收发流
+        for (auto& layer : video_layers_) {
+            if (layer.send_stream) {
+                delete layer.send_stream;
+                layer.send_stream = nullptr;
+            }
         }
         if (audio_send_stream_) {
             delete audio_send_stream_;
             audio_send_stream_ = nullptr;
         }
+        if (remote_estimator_proxy_) {
+            delete remote_estimator_proxy_;
+            remote_estimator_proxy_ = nullptr;
+        }
+        if (video_receive_stream_) {
+            delete video_receive_stream_;
+            video_receive_stream_ = nullptr;
+        }
+
+        // 4. 最后释放拥塞控制，已经投递到网络线程的发送任务看到空指针后直接返回
+        transport_send_.reset();
     });
+
+    XRTCGlobal::Instance()->ReleaseNetworkShard(network_shard_);
+}
+
+rtc::Thread* PeerConnection::network_thread() const {
+    return network_shard_->network_thread.get();
 }
 
 // a=attr_name:attr_value
@@ -261,7 +311,9 @@ std::string PeerConnection::CreateAnswer(const RTCOfferAnswerOptions& options,
     }
 
     if (options.send_video || options.recv_video) {
-        auto video_content = std::make_shared<VideoContentDescription>();
+        auto video_content = std::make_shared<VideoContentDescription>(
+            options.send_video && options.video_temporal_layers > 1 ?
+            kH264ProfileLevelIdMain : kH264ProfileLevelIdBaseline);
         video_content->set_direction(GetDirection(options.send_video, options.recv_video));
         video_content->set_rtcp_mux(options.use_rtcp_mux);//启用RTCP Mux: set_rtcp_mux 表示将RTP（媒体数据）和RTCP（控制信令）在同一个网络端口上传输。
         local_desc_->AddContent(video_content);//将这个 m=video 块添加到一个完整的会话描述 (local_desc_) 中
@@ -269,22 +321,45 @@ std::string PeerConnection::CreateAnswer(const RTCOfferAnswerOptions& options,
 
         // 如果发送视频，需要创建stream
         if (options.send_video) {
+            // simulcast时每一层都有自己的视频流ssrc和RTX（重传）流ssrc
+            int num_layers = std::max(1, options.video_simulcast_layers);
+            video_layers_.resize(num_layers);
+            for (auto& layer : video_layers_) {
+                layer.ssrc = rtc::CreateRandomId();
+                layer.rtx_ssrc = rtc::CreateRandomId();
+                layer.cache.resize(RTC_PACKET_CACHE_SIZE);
+            }
+
             std::string id = rtc::CreateRandomString(16);
             StreamParams video_stream;
             video_stream.id = id;//
             video_stream.stream_id = stream_id;
             video_stream.cname = cname;
-            local_video_ssrc_ = rtc::CreateRandomId();//主视频流ssrc
-            local_video_rtx_ssrc_ = rtc::CreateRandomId();// RTX（重传） 流ssrc
-            video_stream.ssrcs.push_back(local_video_ssrc_);
-            video_stream.ssrcs.push_back(local_video_rtx_ssrc_);
-            
-            // 将两个SSRC分组，声明关系,local_video_rtx_ssrc_为local_video_ssrc_的重传包流
-            SsrcGroup sg;
-            sg.semantics = "FID";
-            sg.ssrcs.push_back(local_video_ssrc_);
-            sg.ssrcs.push_back(local_video_rtx_ssrc_);
-            video_stream.ssrc_groups.push_back(sg);
+            for (auto& layer : video_layers_) {
+                video_stream.ssrcs.push_back(layer.ssrc);
+            }
+            for (auto& layer : video_layers_) {
+                video_stream.ssrcs.push_back(layer.rtx_ssrc);
+            }
+
+            // 多层时用SIM分组声明各层的关系，按分辨率从低到高排列
+            if (video_layers_.size() > 1) {
+                SsrcGroup sim_group;
+                sim_group.semantics = "SIM";
+                for (auto& layer : video_layers_) {
+                    sim_group.ssrcs.push_back(layer.ssrc);
+                }
+                video_stream.ssrc_groups.push_back(sim_group);
+            }
+
+            // 将两个SSRC分组，声明关系,rtx_ssrc为ssrc的重传包流
+            for (auto& layer : video_layers_) {
+                SsrcGroup sg;
+                sg.semantics = "FID";
+                sg.ssrcs.push_back(layer.ssrc);
+                sg.ssrcs.push_back(layer.rtx_ssrc);
+                video_stream.ssrc_groups.push_back(sg);
+            }
 
             video_content->AddStream(video_stream);
 
@@ -293,11 +368,17 @@ std::string PeerConnection::CreateAnswer(const RTCOfferAnswerOptions& options,
             video_rtx_stream.id = id;
             video_rtx_stream.stream_id = stream_id;
             video_rtx_stream.cname = cname;
-            video_rtx_stream.ssrcs.push_back(local_video_rtx_ssrc_);
+            for (auto& layer : video_layers_) {
+                video_rtx_stream.ssrcs.push_back(layer.rtx_ssrc);
+            }
             video_content->AddStream(video_rtx_stream);
 
             CreateVideoSendStream(video_content.get());
         }
+
+        if (options.recv_video) {
+            CreateVideoReceiveStream(options);
+        }
     }
 
     // 创建BUNDLE
@@ -350,39 +431,91 @@ bool PeerConnection::SendEncodedAudio(std::shared_ptr<MediaFrame> frame) {
 
 //视频数据发送
 bool PeerConnection::SendEncodedImage(std::shared_ptr<MediaFrame> frame) {
-    if (pc_state_ != PeerConnectionState::kConnected) {
+    // 析构时transport_send_先于该对象在网络线程中释放
+    if (pc_state_ != PeerConnectionState::kConnected || !transport_send_) {
         return true;
     }
 
+    // simulcast时根据帧所属的层选择ssrc和发送流
+    if (frame->simulcast_index < 0 ||
+        frame->simulcast_index >= (int)video_layers_.size())
+    {
+        return false;
+    }
+    VideoLayer& layer = video_layers_[frame->simulcast_index];
+    layer.last_frame_time_ms = rtc::TimeMillis();
+    bool is_top_layer = frame->simulcast_index + 1 == (int)video_layers_.size();
+
+    // 拥塞时丢弃高时间层的帧，在分配序列号之前丢弃，接收端不会认为丢包
+    if (ShouldDropTemporalLayer(*frame)) {
+        return true;
+    }
+
+    //同一帧的所有包使用相同的frame-marking，只有起止标记不同
+    FrameMarking frame_marking;
+    frame_marking.independent_frame = frame->fmt.sub_fmt.video_fmt.idr;
+    frame_marking.temporal_id = frame->temporal_id;
+    frame_marking.discardable_frame = frame->num_temporal_layers > 1 &&
+        frame->temporal_id == frame->num_temporal_layers - 1;
+    frame_marking.base_layer_sync = 1 == frame->temporal_id;
+    if (0 == frame->temporal_id) {
+        ++layer.tl0_pic_idx;
+    }
+    frame_marking.tl0_pic_idx = layer.tl0_pic_idx;
+
     // 视频的频率90000, 1s中90000份 1ms => 90
     uint32_t rtp_timestamp = frame->ts * 90;
     
     
-    if (video_send_stream_) {
+    if (layer.send_stream) {
         //定时发送RTCP包
-        video_send_stream_->OnSendingRtpFrame(rtp_timestamp,
+        layer.send_stream->OnSendingRtpFrame(rtp_timestamp,
             frame->capture_time_ms,
             frame->fmt.sub_fmt.video_fmt.idr);//当有IDR帧的时候强制发送
     }
 
+    //帧的采集时间转换成NTP时间，采集时钟和发送端是同一个时钟，偏差为0
+    absl::optional<webrtc::AbsoluteCaptureTime> capture_time;
+    if (frame->capture_time_ms > 0) {
+        int64_t capture_ntp_ms = clock_->ConvertTimestampToNtpTimeInMilliseconds(
+            frame->capture_time_ms);
+        capture_time = webrtc::AbsoluteCaptureTime{
+            webrtc::Int64MsToUQ32x32(capture_ntp_ms), 0 };
+    }
+
     //创建H.264分包器
+    //abs-capture-time只在帧的第一个包中携带，第一个包的头部更大，需要减少负载
     RtpPacketizer::Config config;
+    if (capture_time) {
+        int reduction_len = (int)(capture_time_extension_layout_.header_size() -
+            send_extension_layout_.header_size());
+        config.limits.first_packet_reduction_len = reduction_len;
+        config.limits.single_packet_reduction_len = reduction_len;
+    }
     auto packetizer = RtpPacketizer::Create(webrtc::kVideoCodecH264,
         rtc::ArrayView<const uint8_t>((uint8_t*)frame->data[0], frame->data_len[0]),
         config);
 
-    //循环创建和发送RTP包
+    //循环创建RTP包
+    std::vector<std::unique_ptr<RtpPacketToSend>> packets;
+    size_t num_packets = packetizer->NumPackets();
     while (true) {
         //创建RTP包
         auto single_packet = std::make_shared<RtpPacketToSend>(&rtp_header_extension_map_);
         //设置RTP头部字段
         single_packet->SetPayloadType(video_pt_);
         single_packet->SetTimestamp(rtp_timestamp);
-        single_packet->SetSsrc(local_video_ssrc_);
+        single_packet->SetSsrc(layer.ssrc);
         
         //给RTP头部扩展分布内存空间
-        //预留空间
-        single_packet->ReserveExtension<TransportSequenceNumber>();
+        //按照固定的布局预留空间，发送时直接写入已知的偏移量
+        bool with_capture_time = capture_time && packets.empty();
+        if (with_capture_time) {
+            capture_time_extension_layout_.Reserve(single_packet.get());
+        }
+        else {
+            send_extension_layout_.Reserve(single_packet.get());
+        }
 
         //填充负载数据
         if (!packetizer->NextPacket(single_packet.get())) {
@@ -390,30 +523,85 @@ bool PeerConnection::SendEncodedImage(std::shared_ptr<MediaFrame> frame) {
         }
 
         //设置序列号和包类型
-        single_packet->SetSequenceNumber(video_seq_++);
+        single_packet->SetSequenceNumber(layer.seq++);
         single_packet->set_packet_type(RtpPacketType::kVideo);
-        //给头部扩展包里的data中写入会话级别的序列号从1000开始
-        single_packet->SetExtension<TransportSequenceNumber>(transport_seq_++);
+        single_packet->set_temporal_id(frame->temporal_id);
+        frame_marking.start_of_frame = packets.empty();
+        frame_marking.end_of_frame = packets.size() + 1 == num_packets;
+        //会话级别的序列号和abs-send-time在pacer真正发送的时候再写入，见SendPacket
+        if (with_capture_time) {
+            capture_time_extension_layout_.Write<FrameMarkingExtension>(
+                single_packet.get(), frame_marking);
+            capture_time_extension_layout_.Write<AbsoluteCaptureTimeExtension>(
+                single_packet.get(), *capture_time);
+        }
+        else {
+            send_extension_layout_.Write<FrameMarkingExtension>(single_packet.get(),
+                frame_marking);
+        }
 
         //更新统计信息
-        if (video_send_stream_) {
-            video_send_stream_->UpdateRtpStats(single_packet, false, false);
+        if (layer.send_stream) {
+            layer.send_stream->UpdateRtpStats(single_packet, false, false);
         }
 
         //缓存包（用于重传）
-        AddVideoCache(single_packet);
+        AddVideoCache(&layer, single_packet);
         // 发送数据包到传输层
         // TODO, transport_name此处写死，后面可以换成变量
         // transport_controller_->SendPacket("audio", (const char*)single_packet->data(),
         //     single_packet->size());
-        auto packet = std::make_unique<RtpPacketToSend>(*single_packet);
+        packets.push_back(std::make_unique<RtpPacketToSend>(*single_packet));
+    }
+    frame->stage_time_ms[kFrameStagePacketize] = rtc::TimeMillis();
+
+    //交给pacer平滑发送
+    for (auto& packet : packets) {
         transport_send_->EnqueuePacket(std::move(packet));
     }
+    frame->stage_time_ms[kFrameStagePacerEnqueue] = rtc::TimeMillis();
+    //各层的RTP时间戳相同，只统计最高层的延迟
+    if (is_top_layer) {
+        latency_tracer_.OnFrameEnqueued(rtp_timestamp, frame->stage_time_ms);
+    }
 
     return true;
 }
 
 
+bool PeerConnection::ShouldDropTemporalLayer(const MediaFrame& frame) {
+    if (frame.num_temporal_layers <= 1) {
+        return false;
+    }
+
+    //每次只调整一层，调整之后等待一段时间，让队列的变化反映出来
+    int64_t now_ms = rtc::TimeMillis();
+    if (now_ms - last_temporal_layer_change_ms_ >= kTemporalLayerChangeIntervalMs) {
+        int64_t queue_ms = transport_send_->GetPacerQueuingDelay().ms();
+        int dropped = dropped_temporal_layers_;
+        if (queue_ms > kTemporalLayerDropQueueMs &&
+            dropped + 1 < frame.num_temporal_layers)
+        {
+            ++dropped;
+        }
+        else if (queue_ms < kTemporalLayerRestoreQueueMs && dropped > 0) {
+            --dropped;
+        }
+
+        if (dropped != dropped_temporal_layers_) {
+            RTC_LOG(LS_INFO) << "temporal layers changed, dropped: "
+                << dropped_temporal_layers_ << " -> " << dropped
+                << ", pacer queue_ms: " << queue_ms;
+            dropped_temporal_layers_ = dropped;
+            last_temporal_layer_change_ms_ = now_ms;
+        }
+    }
+
+    //基础层始终发送
+    return frame.temporal_id > 0 &&
+        frame.temporal_id >= frame.num_temporal_layers - dropped_temporal_layers_;
+}
+
 void PeerConnection::OnLocalRtcpPacket(webrtc::MediaType media_type, 
     const uint8_t* data, 
     size_t len) 
@@ -424,35 +612,77 @@ void PeerConnection::OnLocalRtcpPacket(webrtc::MediaType media_type,
     }
 
     transport_controller_->SendPacket("audio", (const char*)data, len);
+    SignalPacketSent(this, data, len, true, rtc::TimeMillis());
 }
 
-void PeerConnection::OnNetworkInfo(int64_t rtt_ms, 
+void PeerConnection::OnNetworkInfo(uint32_t ssrc,
+    int64_t rtt_ms, 
     int32_t packets_lost, 
     uint8_t fraction_lost, 
     uint32_t extended_highest_sequence_number,
     uint32_t jitter,
     webrtc::Timestamp at_time) 
 {
-    transport_send->OnNetworkUpdate(rtt_ms,packets_lost,extended_highest_sequence_number,at_time);
-    SignalNetworkInfo(this, rtt_ms, packets_lost, fraction_lost, jitter);
+    // 收发共用同一个传输通道，任何一个report block计算的RTT都可以用于NACK
+    if (video_receive_stream_ && rtt_ms > 0) {
+        video_receive_stream_->UpdateRtt(rtt_ms);
+    }
+
+    VideoLayer* layer = FindVideoLayer(ssrc);
+    if (!layer || !transport_send_) {
+        return;
+    }
+
+    //丢包统计依赖同一个流的序列号，每一层分别计算增量之后汇总给拥塞控制
+    //simulcast时最高层可能因为码率不足暂停，只使用最高层会看不到其它层的丢包
+    int32_t expected_packets = 0;
+    int32_t lost_packets = 0;
+    if (layer->has_report) {
+        expected_packets = (int32_t)(extended_highest_sequence_number -
+            layer->extended_highest_sequence_number);
+        lost_packets = packets_lost - layer->packets_lost;
+    }
+    transport_send_->OnNetworkUpdate(rtt_ms, lost_packets, expected_packets, at_time);
+    layer->has_report = true;
+    layer->packets_lost = packets_lost;
+    layer->extended_highest_sequence_number = extended_highest_sequence_number;
+
+    //上报的统计使用正在发送的最高层
+    if (layer == HighestActiveVideoLayer()) {
+        SignalNetworkInfo(this, rtt_ms, packets_lost, fraction_lost, jitter);
+    }
 }
 
 void PeerConnection::OnNackReceived(webrtc::MediaType media_type, 
+    uint32_t ssrc,
     const std::vector<uint16_t>& nack_list) 
 {
+    VideoLayer* layer = FindVideoLayer(ssrc);
+    if (!layer) {
+        return;
+    }
+
     for (auto nack_id : nack_list) {
-        auto packet = FindVideoCache(nack_id);
+        auto packet = FindVideoCache(layer, nack_id);
         if (packet) {
             // 重传数据
-            if (video_send_stream_) {
-                auto rtx_packet = video_send_stream_->BuildRtxPacket(packet.get(),&rtp_header_extension_map_);
+            if (layer->send_stream) {
+                auto rtx_packet = layer->send_stream->BuildRtxPacket(packet.get(),&rtp_header_extension_map_);
                 transport_controller_->SendPacket("audio", (const char*)rtx_packet->data(),
                     rtx_packet->size());
+                SignalPacketSent(this, rtx_packet->data(), rtx_packet->size(), false,
+                    rtc::TimeMillis());
             }
         }
     }
 }
 
+void PeerConnection::OnRttUpdated(uint32_t ssrc, int64_t rtt_ms) {
+    if (video_receive_stream_ && rtt_ms > 0) {
+        video_receive_stream_->UpdateRtt(rtt_ms);
+    }
+}
+
 void PeerConnection::SendPacket(std::unique_ptr<RtpPacketToSend> packet,const webrtc::PacedPacketInfo& pacing_info) {
     if(pc_state != PeerConnectionState::kConnected) {
         return;
@@ -460,7 +690,20 @@ void PeerConnection::SendPacket(std::unique_ptr<RtpPacketToSend> packet,const we
 
     packet->set_packet_type(RtpPacketType::kVideo);
     uint16_t packet_id = transport_seq_++;
-    packet->SetExtension<TransportSequenceNumber>(packet_id);
+    //扩展的偏移量已经预先计算好，直接写入，根据头部大小区分包使用的布局
+    //包离开发送端的时间，和abs-capture-time一样使用NTP时间
+    uint32_t abs_send_time = AbsoluteSendTime::MsTo24Bits(
+        clock_->CurrentNtpInMilliseconds());
+    if (packet->header_size() == capture_time_extension_layout_.header_size()) {
+        capture_time_extension_layout_.Write<TransportSequenceNumber>(packet.get(),
+            packet_id);
+        capture_time_extension_layout_.Write<AbsoluteSendTime>(packet.get(),
+            abs_send_time);
+    }
+    else {
+        send_extension_layout_.Write<TransportSequenceNumber>(packet.get(), packet_id);
+        send_extension_layout_.Write<AbsoluteSendTime>(packet.get(), abs_send_time);
+    }
     AddPacketToTransportFeedback(packet_id,pacing_info,packet.get());
 
     // RTC_LOG(LS_WARNING) << "============Send Packet,cluster_id: " 
@@ -471,16 +714,30 @@ void PeerConnection::SendPacket(std::unique_ptr<RtpPacketToSend> packet,const we
     transport_controller_->SendPacket("audio", (const char*)packet->data(), packet->size());
     rtc::SentPacket sent;
     sent.send_time_ms = rtc::TimeMillis();
-    if(auto packet_id = packet->GetExtension<TransportSequenceNumber>()){
-        sent.packet_id = *packet_id;
-    }
+    sent.packet_id = packet_id;
     transport_send_->OnSentPacket(sent);
+    SignalPacketSent(this, packet->data(), packet->size(), false, sent.send_time_ms);
+
+    //一帧的最后一个包发送完成，统计该帧各阶段的延迟
+    if (packet->marker() && packet->packet_type() == RtpPacketMediaType::kVideo &&
+        !video_layers_.empty() && packet->ssrc() == video_layers_.back().ssrc)
+    {
+        latency_tracer_.OnLastPacketSent(packet->timestamp(), sent.send_time_ms);
+        FrameLatencyStats stats;
+        if (latency_tracer_.MaybeGetStats(sent.send_time_ms, &stats)) {
+            SignalFrameLatencyStats(this, stats);
+        }
+    }
 }
 
 //产生填充包
 std::vector<std::unique_ptr<RtpPacketToSend>> PeerConnection::GeneratePadding(webrtc::DataSize packet_size) 
 {
     std::vector<std::unique_ptr<RtpPacketToSend>> padding_packets;
+    if (video_layers_.empty()) {
+        return padding_packets;
+    }
+
     size_t bytes_left = packet_size.bytes();
     //TODO:可以比默认的最大值小
     size_t padding_in_packet = kMaxPaddingLength;
@@ -488,15 +745,16 @@ std::vector<std::unique_ptr<RtpPacketToSend>> PeerConnection::GeneratePadding(we
         auto padding_packet = std::make_unique<RtpPacketToSend>(&rtp_header_extension_map_);
         padding_packet->set_packet_type(RtpPacketMediaType::kPadding);
         padding_packet->SetMarker(false);
-        padding_packet->SetSsrc(local_video_rtx_ssrc_);
+        //padding使用最高层的RTX流发送
+        padding_packet->SetSsrc(video_layers_.back().rtx_ssrc);
         padding_packet->SetPayloadType(video_rtx_pt_);
-        padding_packet->ReserveExtension<TransportSequenceNumber>();
+        send_extension_layout_.Reserve(padding_packet.get());
         padding_packet->SetPadding(padding_in_packet); 
 
         bytes_left -= std::min(bytes_left, padding_in_packet);
 
-        if(video_send_stream_) {
-            auto rtx_packet = video_send_stream_->BuildRtxPacket(padding_packet.get(),&rtp_header_extension_map_);
+        if(video_layers_.back().send_stream) {
+            auto rtx_packet = video_layers_.back().send_stream->BuildRtxPacket(padding_packet.get(),&rtp_header_extension_map_);
             padding_packets.push_back(std::move(rtx_packet));
         }
     }
@@ -551,9 +809,88 @@ void PeerConnection::OnIceState(TransportController*,
 void PeerConnection::OnRtcpPacketReceived(TransportController*, 
     const char* data, size_t len, int64_t) 
 {
-    if (video_send_stream_) {
-        video_send_stream_->DeliverRtcp((const uint8_t*)data, len);
+    //每一层的发送流都需要处理RTCP，各自只处理自己ssrc相关的内容
+    for (auto& layer : video_layers_) {
+        if (layer.send_stream) {
+            layer.send_stream->DeliverRtcp((const uint8_t*)data, len);
+        }
+    }
+
+    if (video_receive_stream_) {
+        video_receive_stream_->DeliverRtcp((const uint8_t*)data, len);
+    }
+}
+
+//RTP包处理，目前只接收视频
+void PeerConnection::OnRtpPacketReceived(TransportController*,
+    const char* data, size_t len, int64_t)
+{
+    if (!video_receive_stream_) {
+        return;
     }
+
+    if (!received_packet_.Parse((const uint8_t*)data, len)) {
+        RTC_LOG(LS_WARNING) << "parse rtp packet failed, len: " << len;
+        return;
+    }
+    int64_t now_us = clock_->TimeInMicroseconds();
+    received_packet_.set_arrival_time_ms(now_us / 1000);
+    received_packet_.set_recovered(false);
+
+    // transport-cc按照传输通道统计，RTX和padding包也需要反馈
+    absl::optional<uint16_t> transport_seq =
+        received_packet_.GetExtension<TransportSequenceNumber>();
+    if (transport_seq && remote_estimator_proxy_) {
+        remote_estimator_proxy_->IncomingPacket(now_us, *transport_seq,
+            received_packet_.ssrc());
+    }
+
+    video_receive_stream_->OnRtpPacket(received_packet_);
+}
+
+//创建视频接收流，远端的ssrc从收到的包中获得
+void PeerConnection::CreateVideoReceiveStream(const RTCOfferAnswerOptions& options) {
+    VideoReceiveStreamConfig config;
+    config.rtp.local_ssrc = rtc::CreateRandomId();
+    config.rtp.payload_type = video_pt_;
+    config.rtp.rtx.payload_type = video_rtx_pt_;
+    config.rtp_rtcp_module_observer = this;
+
+    // 用网络线程创建，NACK的定时任务在网络线程执行
+    network_thread()->Invoke<void>(RTC_FROM_HERE, [=]() {
+        video_receive_stream_ = new VideoReceiveStream(clock_, config);
+        video_receive_stream_->SetDelayBounds(options.video_min_delay_ms,
+            options.video_max_delay_ms);
+        video_receive_stream_->SignalFrame.connect(this,
+            &PeerConnection::OnReceivedVideoFrame);
+        video_receive_stream_->SignalKeyFrameRequest.connect(this,
+            &PeerConnection::OnKeyFrameRequest);
+
+        // 远端根据接收端的反馈做带宽估计
+        remote_estimator_proxy_ = new RemoteEstimatorProxy(clock_);
+        remote_estimator_proxy_->SignalTransportFeedback.connect(video_receive_stream_,
+            &VideoReceiveStream::SendTransportFeedback);
+    });
+}
+
+void PeerConnection::OnReceivedVideoFrame(VideoReceiveStream*,
+    std::shared_ptr<MediaFrame> frame)
+{
+    SignalVideoFrame(this, frame);
+}
+
+// VideoReceiveStream已经限制了请求的频率
+void PeerConnection::OnKeyFrameRequest(VideoReceiveStream* stream) {
+    RTC_LOG(LS_INFO) << "request keyframe, remote ssrc: " << stream->remote_ssrc();
+    stream->SendPictureLossIndication();
+}
+
+void PeerConnection::RequestKeyFrame() {
+    network_thread()->PostTask(webrtc::ToQueuedTask(task_safety_, [this]() {
+        if (video_receive_stream_) {
+            video_receive_stream_->RequestKeyFrame();
+        }
+    }));
 }
 
 //创建音频流
@@ -571,7 +908,7 @@ void PeerConnection::CreateAudioSendStream(AudioContentDescription* audio_conten
             config.rtp_rtcp_module_observer = this;
 
             // 用网络线程创建
-            XRTCGlobal::Instance()->network_thread()->Invoke<void>(RTC_FROM_HERE,
+            network_thread()->Invoke<void>(RTC_FROM_HERE,
                 [=]() {
                     audio_send_stream_ = new AudioSendStream(clock_, config);
                 });
@@ -588,51 +925,74 @@ void PeerConnection::CreateVideoSendStream(VideoContentDescription* video_conten
         return;
     }
 
-    // 暂时只考虑推送一路视频
-    for (auto stream : video_content->streams()) 
-    {
-        if (!stream.ssrcs.empty()) 
-        {
-            VideoSendStreamConfig config;
-            config.rtp.ssrc = stream.ssrcs[0];
-            config.rtp.payload_type = video_pt_;
-            config.rtp_rtcp_module_observer = this;
+    // 每一层创建一个发送流，simulcast时只有一路视频
+    for (auto& layer : video_layers_) {
+        VideoSendStreamConfig config;
+        config.rtp.ssrc = layer.ssrc;
+        config.rtp.payload_type = video_pt_;
+        config.rtp_rtcp_module_observer = this;
+        //TransportFeedback是传输级别的，所有层共用一个transport序列号，
+        //RTCP会分发给每一层，只让第一层交给拥塞控制器，否则同一个feedback会被处理多次，
+        //丢失的包在每次处理时都会重复计入丢包
+        if (&layer == &video_layers_.front()) {
             config.transport_feedback_observer = transport_send_.get();//拥塞控制器
-            //设置重传包
-            if (stream.ssrcs.size() > 1) {
-                config.rtp.rtx.ssrc = stream.ssrcs[1];
-                config.rtp.rtx.payload_type = video_rtx_pt_;
-            }
+        }
+        //设置重传包
+        config.rtp.rtx.ssrc = layer.rtx_ssrc;
+        config.rtp.rtx.payload_type = video_rtx_pt_;
+
+        // 用网络线程创建
+        VideoLayer* video_layer = &layer;
+        network_thread()->Invoke<void>(RTC_FROM_HERE,
+            [=]() {
+                video_layer->send_stream = new VideoSendStream(clock_, config);
+            });
+    }
+}
 
-            // 用网络线程创建
-            XRTCGlobal::Instance()->network_thread()->Invoke<void>(RTC_FROM_HERE,
-                [=]() {
-                    video_send_stream_ = new VideoSendStream(clock_, config);
-                });
+PeerConnection::VideoLayer* PeerConnection::FindVideoLayer(uint32_t ssrc) {
+    for (auto& layer : video_layers_) {
+        if (layer.ssrc == ssrc) {
+            return &layer;
         }
+    }
+    return nullptr;
+}
 
-        break;
+PeerConnection::VideoLayer* PeerConnection::HighestActiveVideoLayer() {
+    int64_t now_ms = rtc::TimeMillis();
+    for (auto iter = video_layers_.rbegin(); iter != video_layers_.rend(); ++iter) {
+        if (iter->last_frame_time_ms >= 0 &&
+            now_ms - iter->last_frame_time_ms < kVideoLayerInactiveTimeoutMs)
+        {
+            return &(*iter);
+        }
     }
+    return nullptr;
 }
 
 //RTP视频包缓存机制
-void PeerConnection::AddVideoCache(std::shared_ptr<RtpPacketToSend> packet) {
+void PeerConnection::AddVideoCache(VideoLayer* layer,
+    std::shared_ptr<RtpPacketToSend> packet)
+{
     uint16_t seq = packet->sequence_number();// 获取RTP序列号
     size_t index = seq % RTC_PACKET_CACHE_SIZE;// 计算环形数组索引
 
     // 避免重复存储相同序列号的包
-    if (video_cache_[index] && video_cache_[index]->sequence_number() == seq) {
+    if (layer->cache[index] && layer->cache[index]->sequence_number() == seq) {
         return;
     }
 
-    video_cache_[index] = packet;// 存储包到缓存
+    layer->cache[index] = packet;// 存储包到缓存
 }
 
 //查找视频缓存
-std::shared_ptr<RtpPacketToSend> PeerConnection::FindVideoCache(uint16_t seq) {
+std::shared_ptr<RtpPacketToSend> PeerConnection::FindVideoCache(VideoLayer* layer,
+    uint16_t seq)
+{
     size_t index = seq % RTC_PACKET_CACHE_SIZE;
-    if (video_cache_[index] && video_cache_[index]->sequence_number() == seq) {
-        return video_cache_[index];
+    if (layer->cache[index] && layer->cache[index]->sequence_number() == seq) {
+        return layer->cache[index];
     }
 
     return nullptr;
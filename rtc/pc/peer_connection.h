@@ -6,7 +6,8 @@
 #include <vector>
 
 #include <system_wrappers/include/clock.h>
-#include <api/task_queue/task_queue_factory.h>
+#include <rtc_base/thread.h>
+#include <rtc_base/task_utils/pending_task_safety_flag.h>
 
 #include "xrtc/media/base/media_frame.h"
 #include "xrtc/rtc/pc/session_description.h"
@@ -14,12 +15,20 @@
 #include "xrtc/rtc/pc/peer_connection_def.h"
 #include "xrtc/rtc/pc/rtp_transport_controller_send.h"
 #include "xrtc/rtc/video/video_send_stream.h"
+#include "xrtc/rtc/video/video_receive_stream.h"
+#include "xrtc/rtc/video/frame_latency_tracer.h"
 //#include "xrtc/rtc/audio/audio_send_stream.h"
 #include "xrtc/rtc/modules/rtp_rtcp/rtp_rtcp_interface.h"
 #include "xrtc/rtc/modules/rtp_rtcp/rtp_header_extension_map.h"
+#include "xrtc/rtc/modules/rtp_rtcp/rtp_header_extension_layout.h"
+#include "xrtc/rtc/modules/rtp_rtcp/rtp_header_extensions.h"
+#include "xrtc/rtc/modules/rtp_rtcp/rtp_packet_received.h"
+#include "xrtc/rtc/modules/remote_bitrate_estimator/remote_estimator_proxy.h"
 
 namespace xrtc {
 
+struct NetworkShard;
+
 struct RTCOfferAnswerOptions {
     bool send_audio = true;
     bool send_video = true;
@@ -27,6 +36,13 @@ struct RTCOfferAnswerOptions {
     bool recv_video = true;
     bool use_rtp_mux = true;
     bool use_rtcp_mux = true;
+    // simulcast的层数，1表示不使用simulcast
+    int video_simulcast_layers = 1;
+    // 时间分层的层数，大于1时编码器使用B帧，需要声明main profile
+    int video_temporal_layers = 1;
+    // 接收视频的抖动缓存时间范围
+    int video_min_delay_ms = 0;
+    int video_max_delay_ms = 1000;
 };
 
 class PeerConnection : public sigslot::has_slots<>,
@@ -34,19 +50,26 @@ class PeerConnection : public sigslot::has_slots<>,
                        public PacingController::PacketSender
 {
 public:
-    PeerConnection();
+    // 分配到连接数最少的网络分片，shard_key不为空时按照hash分配
+    explicit PeerConnection(const std::string& shard_key = "");
     ~PeerConnection();
 
+    // 该连接所在的网络线程，ICE和RTP/RTCP都在这个线程处理
+    rtc::Thread* network_thread() const;
+
     int SetRemoteSDP(const std::string& sdp);
     std::string CreateAnswer(const RTCOfferAnswerOptions& options,
         const std::string& stream_id);
     //bool SendEncodedAudio(std::shared_ptr<MediaFrame> frame);
     bool SendEncodedImage(std::shared_ptr<MediaFrame> frame);
+    // 请求远端发送关键帧，例如解码出错，可以在任意线程调用
+    void RequestKeyFrame();
 
     // RtpRtcpModuleObserver
     void OnLocalRtcpPacket(webrtc::MediaType media_type,
         const uint8_t* data, size_t len) override;
     void OnNetworkInfo(
+        uint32_t ssrc,
         int64_t rtt_ms,
         int32_t packets_lost,
         uint8_t fraction_lost,
@@ -54,7 +77,9 @@ public:
         uint32_t jitter,
         webrtc::Timestamp at_time) override;
     void OnNackReceived(webrtc::MediaType media_type,
+        uint32_t ssrc,
         const std::vector<uint16_t>& nack_list) override;
+    void OnRttUpdated(uint32_t ssrc, int64_t rtt_ms) override;
 
     // PacingController::PacketSender
     void SendPacket(std::unique_ptr<RtpPacketToSend> packet,const webrtc::PacedPacketInfo& pacing_info) override;
@@ -64,42 +89,85 @@ public:
     sigslot::signal5<PeerConnection*, int64_t, int32_t, uint8_t, uint32_t>
         SignalNetworkInfo;
     sigslot::signal2<PeerConnection*, const webrtc::TargetTransferRate&> SignalTargetTransferRate;
+    sigslot::signal2<PeerConnection*, const FrameLatencyStats&> SignalFrameLatencyStats;
+    // 每个RTP/RTCP包发送到网络之后触发，用于录制发送的数据，参数依次为数据、长度、是否RTCP、发送时间
+    sigslot::signal5<PeerConnection*, const uint8_t*, size_t, bool, int64_t> SignalPacketSent;
+    // 接收到的完整的H264帧(Annex-B)，在网络线程触发
+    sigslot::signal2<PeerConnection*, std::shared_ptr<MediaFrame>> SignalVideoFrame;
 
 private:
     void OnIceState(TransportController*, ice::IceTransportState ice_state);
     void OnRtcpPacketReceived(TransportController*, const char* data,
         size_t len, int64_t);
+    void OnRtpPacketReceived(TransportController*, const char* data,
+        size_t len, int64_t);
+    void CreateVideoReceiveStream(const RTCOfferAnswerOptions& options);
+    void OnReceivedVideoFrame(VideoReceiveStream*, std::shared_ptr<MediaFrame> frame);
+    void OnKeyFrameRequest(VideoReceiveStream*);
     //void CreateAudioSendStream(AudioContentDescription* audio_content);
     void CreateVideoSendStream(VideoContentDescription* video_content);
-    void AddVideoCache(std::shared_ptr<RtpPacketToSend> packet);
-    std::shared_ptr<RtpPacketToSend> FindVideoCache(uint16_t seq);
+    struct VideoLayer;
+    VideoLayer* FindVideoLayer(uint32_t ssrc);
+    // 正在发送的最高层，没有时返回nullptr
+    VideoLayer* HighestActiveVideoLayer();
+    bool ShouldDropTemporalLayer(const MediaFrame& frame);
+    void AddVideoCache(VideoLayer* layer, std::shared_ptr<RtpPacketToSend> packet);
+    std::shared_ptr<RtpPacketToSend> FindVideoCache(VideoLayer* layer, uint16_t seq);
     void AddPacketToTransportFeedback(uint16_t packet_id,const webrtc::PacedPacketInfo& pacing_info,RtpPacketToSend* packet);
     void OnTargetTransferRate(RtpTransportControllerSend*, const webrtc::TargetTransferRate& target_bitrate);
 private:
+    // simulcast的一层，每层有独立的SSRC、RTX SSRC、序列号和发送流
+    struct VideoLayer {
+        uint32_t ssrc = 0;
+        uint32_t rtx_ssrc = 0;
+        // 按照规范该值的初始值需要随机
+        uint16_t seq = 1000;
+        VideoSendStream* send_stream = nullptr;
+        std::vector<std::shared_ptr<RtpPacketToSend>> cache;//RTP已发送数据包缓存，用于NACK
+        uint8_t tl0_pic_idx = 0;//基础时间层帧的计数，frame-marking中使用
+        int64_t last_frame_time_ms = -1;//最后一次发送该层的帧的时间，判断该层是否在发送
+        // 最近一次report block中的累计丢包数和最大序列号，用于计算各层的丢包增量
+        bool has_report = false;
+        int32_t packets_lost = 0;
+        uint32_t extended_highest_sequence_number = 0;
+    };
+
+    NetworkShard* network_shard_;//所在的网络分片，需要在传输相关的成员之前初始化
     std::unique_ptr<SessionDescription> remote_desc_;//远端会话描述
     std::unique_ptr<SessionDescription> local_desc_;//本地会话描述
     std::unique_ptr<TransportController> transport_controller_;//底层传输管理，处理 ICE 连接
     RtpHeaderExtensionMap rtp_header_extension_map_;//RTP头部扩展
+    RtpHeaderExtensionLayout<TransportSequenceNumber,
+        AbsoluteSendTime,
+        FrameMarkingExtension> send_extension_layout_;//发送包的扩展布局
+    //有采集时间的帧的第一个包使用的布局，额外携带abs-capture-time
+    RtpHeaderExtensionLayout<TransportSequenceNumber,
+        AbsoluteSendTime,
+        FrameMarkingExtension,
+        AbsoluteCaptureTimeExtension> capture_time_extension_layout_;
     
     //uint32_t local_audio_ssrc_ = 0;
-    uint32_t local_video_ssrc_ = 0;
-    uint32_t local_video_rtx_ssrc_ = 0;
     //uint32_t audio_pt_ = 0;
     uint8_t video_pt_ = 0;
     uint8_t video_rtx_pt_ = 0;
 
     // 按照规范该值的初始值需要随机
-    uint16_t video_seq_ = 1000;
     uint16_t audio_seq_ = 1000;
     uint16_t transport_seq_ = 1000;//会话级别的计数
     
     PeerConnectionState pc_state_ = PeerConnectionState::kNew;//连接状态枚举
     webrtc::Clock* clock_;
     //AudioSendStream* audio_send_stream_ = nullptr;
-    VideoSendStream* video_send_stream_ = nullptr;//视频流发送
-    std::vector<std::shared_ptr<RtpPacketToSend>> video_cache_;//RTP已发送数据包缓存，用于NACK
-    std::unique_ptr<webrtc::TaskQueueFactory> task_queue_factory_;//异步任务队列工厂
+    std::vector<VideoLayer> video_layers_;//视频流的每一层，按分辨率从低到高排列
+    VideoReceiveStream* video_receive_stream_ = nullptr;//接收的视频流
+    RemoteEstimatorProxy* remote_estimator_proxy_ = nullptr;//接收端的transport-cc反馈
+    RtpPacketReceived received_packet_;//重复使用，避免每个接收的包分配内存
     std::unique_ptr<RtpTransportControllerSend> transport_send_;//RTP传输控制器
+    FrameLatencyTracer latency_tracer_;//发送端每一帧各阶段的延迟统计
+    int dropped_temporal_layers_ = 0;//拥塞时丢弃的最高时间层数
+    int64_t last_temporal_layer_change_ms_ = 0;
+    // 投递到网络线程的任务使用，在网络线程中失效
+    rtc::scoped_refptr<webrtc::PendingTaskSafetyFlag> task_safety_;
 };
 
 } // namespace xrtc
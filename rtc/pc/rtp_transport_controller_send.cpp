@@ -1,19 +1,23 @@
 ﻿#include "xrtc/rtc/pc/rtp_transport_controller_send.h"
 #include <rtc_base/logging.h>
+#include <rtc_base/event.h>
+#include <rtc_base/task_utils/to_queued_task.h>
 #include "xrtc/rtc/modules/rtp_rtcp/rtcp_packet/transport_feedback.h"
 #include "xrtc/rtc/modules/congestion_controller/google_gcc/google_cc_network_controller.h"
 namespace xrtc {
 
 RtpTransportControllerSend::RtpTransportControllerSend(webrtc::Clock* clock,
     PacingController::PacketSender* packet_sender,
-    webrtc::TaskQueueFactory* task_queue_factory) :
+    PacerScheduler* pacer_scheduler,
+    rtc::TaskQueue* task_queue) :
     clock_(clock),
     task_queue_pacer_(std::make_unique<TaskQueuePacedSender>(
         clock, 
         packet_sender, 
-        task_queue_factory,
-        webrtc::TimeDelta::Millis(1)),
-    task_queue_(task_queue_factory->CreateTaskQueue("rtp_send_task_queue",webrtc::TaskQueueFactory::Priority::NORMAL))
+        pacer_scheduler,
+        webrtc::TimeDelta::Millis(1))),
+    task_queue_(task_queue),
+    task_safety_(webrtc::PendingTaskSafetyFlag::CreateDetached())
 {
     task_queue_pacer_->EnsureStarted();//开启定时发送RTP数据包
 
@@ -26,6 +30,14 @@ RtpTransportControllerSend::RtpTransportControllerSend(webrtc::Clock* clock,
 }
 
 RtpTransportControllerSend::~RtpTransportControllerSend() {
+    // 定时任务需要在任务队列中停止
+    rtc::Event done;
+    task_queue_->PostTask([this, &done]() {
+        controller_task_.Stop();
+        task_safety_->SetNotAlive();
+        done.Set();
+    });
+    done.Wait(rtc::Event::kForever);
 }
 
 void RtpTransportControllerSend::EnqueuePacket(std::unique_ptr<RtpPacketToSend> packet) {
@@ -39,7 +51,7 @@ void RtpTransportControllerSend::OnNetworkOk(bool network_ok) {
     msg.network_available = network_ok;
 
     //以下是一个独立的线程，用于处理网络状态的更新
-    task_queue_.PostTask([this, msg]() {
+    task_queue_->PostTask(webrtc::ToQueuedTask(task_safety_, [this, msg]() {
         //网络状态没有变化，直接返回
         if(network_ok_ == msg.network_available) {
             return;
@@ -55,66 +67,55 @@ void RtpTransportControllerSend::OnNetworkOk(bool network_ok) {
             PostUpdate(controller_->OnNetworkOk(constraints));
         }
         controller_->OnNetworkOk(constraints);
-    });
+    }));
 }
 
 void RtpTransportControllerSend::OnSentPacket(const rtc::SentPacket& sent_packet) {
-    task_queue_.PostTask([this, sent_packet]() {
+    task_queue_->PostTask(webrtc::ToQueuedTask(task_safety_, [this, sent_packet]() {
         auto packet_msg = transport_feedback_adapter_.ProcessSentPacket(sent_packet);
         if(packet_msg && controller_) {
             PostUpdate(controller_->OnSentPacket(*packet_msg));
         }
-    });
+    }));
 }
 
 void RtpTransportControllerSend::OnAddPacket(const RtpPacketSendInfo& send_info) {
     webrtc::Timestamp creation_time = webrtc::Timestamp::Millis(clock_->TimeInMilliseconds());
-    task_queue_.PostTask([this, creation_time, send_info]() {
+    task_queue_->PostTask(webrtc::ToQueuedTask(task_safety_, [this, creation_time, send_info]() {
         transport_feedback_adapter_.AddPacket(creation_time, 0, send_info);
-    });
+    }));
 }
 
 void RtpTransportControllerSend::OnNetworkUpdate(int64_t rtt_ms,
-    int32_t packets_lost,//累计丢包数
-    uint32_t extended_highest_sequence_number,//当前收到最大的序列号
+    int32_t lost_packets,//这段时间丢失的包数
+    int32_t expected_packets,//这段时间期待收到的包数
     webrtc::Timestamp at_time) {
 
-    //将丢包信息传入到拥塞控制模块
-    task_queue_.PostTask([this, packets_lost,extended_highest_sequence_number,at_time]() {
-        if(last_extended_high_seq_num_ == 0){
-            last_extended_high_seq_num_ = extended_highest_sequence_number;
-            last_packets_lost_ = packets_lost;
-            return;
-        }
-        int32_t total_lost_packets = 0;
-        int32_t total_packets = 0;
-
-        //这段时间期待收到的总的报的个数
-        total_packets = extended_highest_sequence_number - last_extended_high_seq_num_;
-        total_lost_packets = packets_lost - last_packets_lost_;
-        last_extended_high_seq_num_ = extended_highest_sequence_number;
-        last_packets_lost_ = packets_lost;
-        if(controller_) {
-            controller_->OnTransportLoss(total_lost_packets,total_packets,at_time);
-        }
-    });
+    //将丢包信息传入到拥塞控制模块，第一个report block没有增量
+    if(expected_packets > 0) {
+        task_queue_->PostTask(webrtc::ToQueuedTask(task_safety_, [this, lost_packets,expected_packets,at_time]() {
+            if(controller_) {
+                controller_->OnTransportLoss(lost_packets,expected_packets,at_time);
+            }
+        }));
+    }
 
     //将RTT信息传入到拥塞控制模块
-    task_queue_.PostTask([this, rtt_ms]() {
+    task_queue_->PostTask(webrtc::ToQueuedTask(task_safety_, [this, rtt_ms]() {
         if(controller_) {
             controller_->OnRttUpdate(rtt_ms);
         }
-    });
+    }));
 }
 void RtpTransportControllerSend::OnTransportFeedback(const rtcp::TransportFeedback& feedback) {
     webrtc::Timestamp feedback_time = webrtc::Timestamp::Millis(clock_->TimeInMilliseconds());
-    task_queue_.PostTask([this, feedback, feedback_time]() {
+    task_queue_->PostTask(webrtc::ToQueuedTask(task_safety_, [this, feedback, feedback_time]() {
         absl::optional<webrtc::TransportpacketsFeedback> feedback_msg =
         transport_feedback_adapter_.ProcessTransportFeedback(feedback, feedback_time);
         if(feedback_msg && controller_) {
             PostUpdate(controller_->OnTransportpacketsFeedback(*feedback_msg));
         }
-    });
+    }));
 }
 
 void RtpTransportControllerSend::MaybeCreateController() {
@@ -156,8 +157,8 @@ void RtpTransportControllerSend::UpdateControllerWithTimeInterval() {
 void RtpTransportControllerSend::StartProcessPeroidicTasks() {
     controller_task_.Stop();
     if (process_interval_.IsFinite()) {
-        webrtc::RepeatingTaskHandle::DelayedStart(
-            task_queue_.Get(), process_interval_, [=]() {
+        controller_task_ = webrtc::RepeatingTaskHandle::DelayedStart(
+            task_queue_->Get(), process_interval_, [=]() {
                 UpdateControllerWithTimeInterval();
                 return process_interval_;
             });
@@ -4,7 +4,9 @@
 #include <system_wrappers/include/clock.h>
 #include <rtc_base/network/sent_packet.h>
 #include <rtc_base/third_party/sigslot/sigslot.h>
+#include <rtc_base/task_queue.h>
 #include <rtc_base/task_utils/repeating_task.h>
+#include <rtc_base/task_utils/pending_task_safety_flag.h>
 
 #include "xrtc/rtc/modules/rtp_rtcp/rtp_packet_to_send.h"
 #include "xrtc/rtc/modules/pacing/task_queue_paced_sender.h"
@@ -14,18 +16,29 @@
 namespace xrtc {
 
  //RTP包发送控制类
+ //pacer_scheduler由进程内所有连接共享，task_queue由同一个网络分片上的连接共享，都不随该对象销毁
 class RtpTransportControllerSend: public TransportFeedbackObserver {
 public:
     RtpTransportControllerSend(webrtc::Clock* clock,
         PacingController::PacketSender* packet_sender,
-        webrtc::TaskQueueFactory* task_queue_factory);
+        PacerScheduler* pacer_scheduler,
+        rtc::TaskQueue* task_queue);
     ~RtpTransportControllerSend();
     void EnqueuePacket(std::unique_ptr<RtpPacketToSend> packet);
+    // 停止pacer，返回之后不会再回调PacketSender的SendPacket和GeneratePadding
+    void StopPacer() {
+        task_queue_pacer_->Stop();
+    }
+    // pacer队列的排队时间，可以在任意线程调用
+    webrtc::TimeDelta GetPacerQueuingDelay() const {
+        return task_queue_pacer_->ExpectedQueueTime();
+    }
     void OnNetworkOk(bool network_ok);
     void OnSentPacket(const rtc::SentPacket& sent_packet);
+    // lost_packets和expected_packets是距离上一次report block的增量，可以是多个流之和
     void OnNetworkUpdate(int64_t rtt_ms,
-        int32_t packets_lost,
-        uint32_t extended_highest_sequence_number,
+        int32_t lost_packets,
+        int32_t expected_packets,
         webrtc::Timestamp at_time);
     void OnAddPacket(const RtpPacketSendInfo& send_info) override;
     void OnTransportFeedback(const rtcp::TransportFeedback& feedback) override;
@@ -44,12 +57,12 @@ private:
     bool network_ok_ = false;
 
     TransportFeedbackAdapter transport_feedback_adapter_;
-    int32_t last_packets_lost_ = 0;
-    uint32_t last_extended_highest_sequence_number_ = 0;
 
     webrtc::RepeatingTaskHandle controller_task_;//用于管理和控制重复性任务的句柄
     webrtc::TimeDelta process_interval_ = webrtc::TimeDelta::Millis(25);//定时器25ms触发一次
-    rtc::TaskQueue task_queue_;//后面所有的拥塞控制的调用都放在这里面
+    rtc::TaskQueue* task_queue_;//后面所有的拥塞控制的调用都放在这里面
+    // 只在task_queue_中访问，析构之后已经投递的任务会被跳过
+    rtc::scoped_refptr<webrtc::PendingTaskSafetyFlag> task_safety_;
 };
 
 } // namespace xrtc
@@ -39,7 +39,9 @@ AudioContentDescription::AudioContentDescription() {
     codecs_.push_back(codec);
 }
 
-VideoContentDescription::VideoContentDescription() {
+VideoContentDescription::VideoContentDescription(
+    const std::string& h264_profile_level_id)
+{
     auto codec = std::make_shared<VideoCodecInfo>();
     codec->id = 107;
     codec->name = "H264";
@@ -55,7 +57,7 @@ VideoContentDescription::VideoContentDescription() {
     // 添加codec param
     codec->codec_param["level-asymmetry-allowed"] = "1";
     codec->codec_param["packetization-mode"] = "1";
-    codec->codec_param["profile-level-id"] = "42e01f";
+    codec->codec_param["profile-level-id"] = h264_profile_level_id;
 
     codecs_.push_back(codec);
 
@@ -207,7 +209,7 @@ static void BuildSsrc(MediaContentDescription* media_content,
                 continue;
             }
 
-            ss << "a=ssrc-group:FID";
+            ss << "a=ssrc-group:" << group.semantics;
             for (auto ssrc : group.ssrcs) {
                 ss << " " << ssrc;
             }
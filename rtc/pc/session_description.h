@@ -28,6 +28,12 @@ enum class RtpDirection {
     kInactive,  // 不活跃：既不发送也不接收
 };
 
+// H264的profile-level-id，level都是3.1
+// Constrained Baseline，不支持B帧
+const char kH264ProfileLevelIdBaseline[] = "42e01f";
+// Main，时间分层使用B帧时编码器切换到main profile
+const char kH264ProfileLevelIdMain[] = "4d001f";
+
 //内容组类
 class ContentGroup {
 public:
@@ -99,7 +105,9 @@ public:
 
 class VideoContentDescription : public MediaContentDescription {
 public:
-    VideoContentDescription();
+    // h264_profile_level_id需要和编码器实际使用的profile一致
+    explicit VideoContentDescription(
+        const std::string& h264_profile_level_id = kH264ProfileLevelIdBaseline);
 
     webrtc::MediaType type() override { return webrtc::MediaType::VIDEO; }
     std::string mid() override { return "video"; }
@@ -1,14 +1,13 @@
 ﻿#include "xrtc/rtc/pc/transport_controller.h"
 
-#include "xrtc/base/xrtc_global.h"
 #include "xrtc/rtc/pc/session_description.h"
 #include "xrtc/rtc/modules/rtp_rtcp/rtp_utils.h"
 
 namespace xrtc {
 
-TransportController::TransportController() :
-    ice_agent_(new ice::IceAgent(XRTCGlobal::Instance()->network_thread(),
-        XRTCGlobal::Instance()->port_allocator()))
+TransportController::TransportController(rtc::Thread* network_thread,
+    ice::PortAllocator* port_allocator) :
+    ice_agent_(new ice::IceAgent(network_thread, port_allocator))
 {
     ice_agent_->SignalIceState.connect(this,
         &TransportController::OnIceState);
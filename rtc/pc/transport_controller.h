@@ -10,7 +10,8 @@ class SessionDescription;
 // 该类的作用：SDP处理和ICE传输通道管理、BUNDLE优化处理、数据包收发管理、信号转发和状态管理
 class TransportController : public sigslot::has_slots<> {
 public:
-    TransportController();
+    // ICE在network_thread中运行，同一个分片上的连接共享port_allocator
+    TransportController(rtc::Thread* network_thread, ice::PortAllocator* port_allocator);
     ~TransportController();
 
     int SetRemoteSDP(SessionDescription* desc);
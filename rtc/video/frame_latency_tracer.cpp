@@ -0,0 +1,131 @@
+﻿#include "xrtc/rtc/video/frame_latency_tracer.h"
+
+#include <modules/include/module_common_types_public.h>
+
+namespace xrtc {
+
+namespace {
+// 每个桶1ms，超过1s的延迟都统计到最后一个桶
+const size_t kNumLatencyBuckets = 1000;
+// 统计最近的帧数，30fps下大约10s
+const size_t kMaxNumFrames = 300;
+const int64_t kReportIntervalMs = 5000;
+
+void FillPercentiles(const Histogram& histogram,
+    FrameLatencyStats::Percentiles* percentiles)
+{
+    if (histogram.NumValues() == 0) {
+        return;
+    }
+
+    // InverseCdf返回的是累计概率达到要求的桶的下一个位置
+    percentiles->p50_ms = (int)histogram.InverseCdf(0.5f) - 1;
+    percentiles->p90_ms = (int)histogram.InverseCdf(0.9f) - 1;
+    percentiles->p99_ms = (int)histogram.InverseCdf(0.99f) - 1;
+}
+
+} // namespace
+
+FrameLatencyTracer::FrameLatencyTracer() :
+    total_histogram_(kNumLatencyBuckets, kMaxNumFrames)
+{
+    stage_histograms_.reserve(kFrameStageNum);
+    for (int i = 0; i < kFrameStageNum; ++i) {
+        stage_histograms_.emplace_back(kNumLatencyBuckets, kMaxNumFrames);
+    }
+}
+
+FrameLatencyTracer::~FrameLatencyTracer() {
+}
+
+void FrameLatencyTracer::OnFrameEnqueued(uint32_t rtp_timestamp,
+    const int64_t* stage_time_ms)
+{
+    size_t write_index = write_index_.load(std::memory_order_relaxed);
+    size_t next_index = (write_index + 1) % kQueueSize;
+    // 队列已满，pacer线程来不及处理，放弃该帧的统计
+    if (next_index == read_index_.load(std::memory_order_acquire)) {
+        ++dropped_frames_;
+        return;
+    }
+
+    FrameRecord& record = records_[write_index];
+    record.rtp_timestamp = rtp_timestamp;
+    for (int i = 0; i < kFrameStageNum; ++i) {
+        record.stage_time_ms[i] = stage_time_ms[i];
+    }
+    write_index_.store(next_index, std::memory_order_release);
+}
+
+void FrameLatencyTracer::OnLastPacketSent(uint32_t rtp_timestamp, int64_t now_ms) {
+    size_t read_index = read_index_.load(std::memory_order_relaxed);
+    size_t write_index = write_index_.load(std::memory_order_acquire);
+    while (read_index != write_index) {
+        FrameRecord& record = records_[read_index];
+        // 比当前帧还新的记录，留到后面处理
+        if (record.rtp_timestamp != rtp_timestamp &&
+            webrtc::IsNewerTimestamp(record.rtp_timestamp, rtp_timestamp))
+        {
+            break;
+        }
+
+        read_index = (read_index + 1) % kQueueSize;
+        // 更旧的记录，说明该帧的最后一个包没有经过pacer发送(例如队列超时被丢弃)
+        if (record.rtp_timestamp != rtp_timestamp) {
+            continue;
+        }
+
+        record.stage_time_ms[kFrameStageLastPacketSent] = now_ms;
+        AddFrame(record);
+        break;
+    }
+
+    read_index_.store(read_index, std::memory_order_release);
+}
+
+void FrameLatencyTracer::AddFrame(const FrameRecord& record) {
+    const int64_t* stage_time_ms = record.stage_time_ms;
+    int64_t prev_time_ms = stage_time_ms[kFrameStageCapture];
+    for (int i = kFrameStageCapture + 1; i < kFrameStageNum; ++i) {
+        // 没有记录的阶段，例如非编码器产生的帧
+        if (stage_time_ms[i] <= 0 || prev_time_ms <= 0) {
+            prev_time_ms = stage_time_ms[i];
+            continue;
+        }
+        int64_t delta = stage_time_ms[i] - prev_time_ms;
+        stage_histograms_[i].Add(delta > 0 ? (size_t)delta : 0);
+        prev_time_ms = stage_time_ms[i];
+    }
+
+    if (stage_time_ms[kFrameStageCapture] > 0) {
+        int64_t total = stage_time_ms[kFrameStageLastPacketSent] -
+            stage_time_ms[kFrameStageCapture];
+        total_histogram_.Add(total > 0 ? (size_t)total : 0);
+    }
+
+    ++num_frames_;
+}
+
+bool FrameLatencyTracer::MaybeGetStats(int64_t now_ms, FrameLatencyStats* stats) {
+    if (last_report_time_ms_ < 0) {
+        last_report_time_ms_ = now_ms;
+        return false;
+    }
+
+    if (now_ms - last_report_time_ms_ < kReportIntervalMs || 0 == num_frames_) {
+        return false;
+    }
+
+    for (int i = kFrameStageCapture + 1; i < kFrameStageNum; ++i) {
+        FillPercentiles(stage_histograms_[i], &stats->stages[i]);
+    }
+    FillPercentiles(total_histogram_, &stats->total);
+    stats->num_frames = num_frames_;
+    stats->dropped_frames = dropped_frames_.exchange(0);
+
+    num_frames_ = 0;
+    last_report_time_ms_ = now_ms;
+    return true;
+}
+
+} // namespace xrtc
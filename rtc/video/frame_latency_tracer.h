@@ -0,0 +1,71 @@
+﻿#ifndef XRTCSDK_XRTC_RTC_VIDEO_FRAME_LATENCY_TRACER_H_
+#define XRTCSDK_XRTC_RTC_VIDEO_FRAME_LATENCY_TRACER_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <vector>
+
+#include "xrtc/media/base/media_frame.h"
+#include "xrtc/rtc/modules/nack/histogram.h"
+
+namespace xrtc {
+
+// 发送端每个阶段延迟的分位数统计
+struct FrameLatencyStats {
+    struct Percentiles {
+        int p50_ms = 0;
+        int p90_ms = 0;
+        int p99_ms = 0;
+    };
+
+    // stages[i]为阶段i相对于阶段i-1的耗时，stages[kFrameStageCapture]没有意义
+    Percentiles stages[kFrameStageNum];
+    // 采集到最后一个包发送到网络的总耗时
+    Percentiles total;
+    // 统计窗口内的帧数
+    int num_frames = 0;
+    // 因为记录队列满而丢弃的帧数
+    int dropped_frames = 0;
+};
+
+// 统计发送端每一帧在各个阶段的延迟
+// 打包所在的网络线程写入，pacer线程读取，两者之间通过单生产者单消费者的无锁队列传递
+class FrameLatencyTracer {
+public:
+    FrameLatencyTracer();
+    ~FrameLatencyTracer();
+
+    // 网络线程：一帧完成打包并进入pacer队列之后调用
+    void OnFrameEnqueued(uint32_t rtp_timestamp, const int64_t* stage_time_ms);
+    // pacer线程：一帧的最后一个包发送到网络之后调用
+    void OnLastPacketSent(uint32_t rtp_timestamp, int64_t now_ms);
+    // pacer线程：到达上报周期时返回true，并填充统计结果
+    bool MaybeGetStats(int64_t now_ms, FrameLatencyStats* stats);
+
+private:
+    struct FrameRecord {
+        uint32_t rtp_timestamp = 0;
+        int64_t stage_time_ms[kFrameStageNum] = { 0 };
+    };
+
+    void AddFrame(const FrameRecord& record);
+
+private:
+    // 队列的容量，需要能够容纳pacer队列中所有未发送的帧
+    static const size_t kQueueSize = 256;
+    FrameRecord records_[kQueueSize];
+    std::atomic<size_t> read_index_{ 0 };
+    std::atomic<size_t> write_index_{ 0 };
+    std::atomic<int> dropped_frames_{ 0 };
+
+    // 以下变量只在pacer线程访问
+    std::vector<Histogram> stage_histograms_;
+    Histogram total_histogram_;
+    int64_t last_report_time_ms_ = -1;
+    int num_frames_ = 0;
+};
+
+} // namespace xrtc
+
+#endif // XRTCSDK_XRTC_RTC_VIDEO_FRAME_LATENCY_TRACER_H_
@@ -0,0 +1,94 @@
+﻿#include "xrtc/rtc/video/simulcast_rate_allocator.h"
+
+#include <algorithm>
+
+namespace xrtc {
+
+namespace {
+const int kMaxSimulcastLayers = 3;
+
+// 三层simulcast的默认配置，少于三层时去掉最低的层
+const struct {
+    int scale_down_by;
+    int min_kbps;
+    int target_kbps;
+    int max_kbps;
+} kDefaultLayers[kMaxSimulcastLayers] = {
+    { 4, 50, 150, 200 },
+    { 2, 150, 500, 700 },
+    { 1, 300, 1200, 2500 },
+};
+} // namespace
+
+SimulcastRateAllocator::SimulcastRateAllocator(int num_layers) :
+    layers_(DefaultLayers(num_layers))
+{
+}
+
+SimulcastRateAllocator::~SimulcastRateAllocator() {
+}
+
+std::vector<SimulcastLayerConfig> SimulcastRateAllocator::DefaultLayers(
+    int num_layers)
+{
+    num_layers = std::max(1, std::min(num_layers, kMaxSimulcastLayers));
+
+    std::vector<SimulcastLayerConfig> layers;
+    for (int i = kMaxSimulcastLayers - num_layers; i < kMaxSimulcastLayers; ++i) {
+        SimulcastLayerConfig layer;
+        layer.scale_down_by = kDefaultLayers[i].scale_down_by;
+        layer.min_bitrate = webrtc::DataRate::KilobitsPerSec(kDefaultLayers[i].min_kbps);
+        layer.target_bitrate = webrtc::DataRate::KilobitsPerSec(kDefaultLayers[i].target_kbps);
+        layer.max_bitrate = webrtc::DataRate::KilobitsPerSec(kDefaultLayers[i].max_kbps);
+        layers.push_back(layer);
+    }
+
+    return layers;
+}
+
+std::vector<webrtc::DataRate> SimulcastRateAllocator::Allocate(
+    webrtc::DataRate total_bitrate) const
+{
+    std::vector<webrtc::DataRate> allocation(layers_.size(), webrtc::DataRate::Zero());
+    // 只有一层时，全部码率都给该层
+    if (layers_.size() <= 1) {
+        if (!allocation.empty()) {
+            allocation[0] = total_bitrate;
+        }
+        return allocation;
+    }
+
+    // 依次满足每一层的最低码率
+    webrtc::DataRate left = total_bitrate;
+    size_t num_active = 0;
+    for (size_t i = 0; i < layers_.size(); ++i) {
+        if (left < layers_[i].min_bitrate) {
+            break;
+        }
+        allocation[i] = layers_[i].min_bitrate;
+        left -= layers_[i].min_bitrate;
+        ++num_active;
+    }
+
+    // 最低层始终保持活跃，即使码率不够最低码率
+    if (0 == num_active) {
+        allocation[0] = total_bitrate;
+        return allocation;
+    }
+
+    // 非最高的活跃层补足到目标码率
+    for (size_t i = 0; i + 1 < num_active && !left.IsZero(); ++i) {
+        webrtc::DataRate add = std::min(left,
+            layers_[i].target_bitrate - allocation[i]);
+        allocation[i] += add;
+        left -= add;
+    }
+
+    // 剩余的码率都给最高的活跃层，不超过最大码率
+    size_t top = num_active - 1;
+    allocation[top] = std::min(allocation[top] + left, layers_[top].max_bitrate);
+
+    return allocation;
+}
+
+} // namespace xrtc
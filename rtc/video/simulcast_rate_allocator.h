@@ -0,0 +1,40 @@
+﻿#ifndef XRTCSDK_XRTC_RTC_VIDEO_SIMULCAST_RATE_ALLOCATOR_H_
+#define XRTCSDK_XRTC_RTC_VIDEO_SIMULCAST_RATE_ALLOCATOR_H_
+
+#include <vector>
+
+#include <api/units/data_rate.h>
+
+namespace xrtc {
+
+// simulcast每一层的码率配置，按分辨率从低到高排列
+struct SimulcastLayerConfig {
+    // 分辨率相对于采集分辨率的缩小倍数
+    int scale_down_by = 1;
+    webrtc::DataRate min_bitrate;
+    webrtc::DataRate target_bitrate;
+    webrtc::DataRate max_bitrate;
+};
+
+// 将拥塞控制的目标码率分配给simulcast的每一层
+// 低层优先：依次满足每一层的最低码率，再把低层补足到目标码率，剩余的都给最高的活跃层
+// 码率不够最低码率的层分配为0，表示暂停编码；最低层始终保持活跃
+class SimulcastRateAllocator {
+public:
+    explicit SimulcastRateAllocator(int num_layers = 1);
+    ~SimulcastRateAllocator();
+
+    static std::vector<SimulcastLayerConfig> DefaultLayers(int num_layers);
+
+    std::vector<webrtc::DataRate> Allocate(webrtc::DataRate total_bitrate) const;
+
+    const std::vector<SimulcastLayerConfig>& layers() const { return layers_; }
+    size_t num_layers() const { return layers_.size(); }
+
+private:
+    std::vector<SimulcastLayerConfig> layers_;
+};
+
+} // namespace xrtc
+
+#endif // XRTCSDK_XRTC_RTC_VIDEO_SIMULCAST_RATE_ALLOCATOR_H_
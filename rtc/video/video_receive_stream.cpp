@@ -0,0 +1,257 @@
+﻿#include "xrtc/rtc/video/video_receive_stream.h"
+
+#include <string.h>
+
+#include <modules/rtp_rtcp/source/byte_io.h>
+#include <rtc_base/logging.h>
+#include <rtc_base/thread.h>
+#include <rtc_base/task_utils/to_queued_task.h>
+
+namespace xrtc {
+
+namespace {
+const size_t kRtxHeaderSize = 2;
+const int64_t kKeyFrameRequestIntervalMs = 500;
+
+std::unique_ptr<ModuleRtpRtcpImpl> CreateRtpRtcpModule(webrtc::Clock* clock,
+    const VideoReceiveStreamConfig& vrconfig,
+    ReceiveStatisticsProvider* receive_statistics)
+{
+    RtpRtcpInterface::Configuration config;
+    config.audio = false;
+    config.receiver_only = true;// 只接收，周期性发送RR
+    config.clock = clock;
+    config.local_media_ssrc = vrconfig.rtp.local_ssrc;
+    config.payload_type = vrconfig.rtp.payload_type;
+    config.rtcp_report_interval_ms = vrconfig.rtcp_report_interval_ms;
+    config.clock_rate = vrconfig.rtp.clock_rate;
+    config.rtp_rtcp_module_observer = vrconfig.rtp_rtcp_module_observer;
+    config.receive_statistics = receive_statistics;
+    // 只接收时对端的SR中没有本端的report block，需要通过XR测量RTT
+    config.non_sender_rtt_measurement = true;
+
+    return std::make_unique<ModuleRtpRtcpImpl>(config);
+}
+
+} // namespace
+
+VideoReceiveStream::VideoReceiveStream(webrtc::Clock* clock,
+    const VideoReceiveStreamConfig& config) :
+    config_(config),
+    receive_statistics_(config.rtp.clock_rate),
+    rtp_rtcp_(CreateRtpRtcpModule(clock, config, &receive_statistics_)),
+    capture_time_receiver_(config.rtp.clock_rate),
+    nack_requester_(clock),
+    jitter_buffer_(clock),
+    clock_(clock)
+{
+    rtx_buffer_.reserve(PacketBuffer::kMaxPayloadSize + 100);
+    rtp_rtcp_->SetRTCPStatus(webrtc::RtcpMode::kCompound);
+    nack_requester_.SignalSendNack.connect(this, &VideoReceiveStream::OnSendNack);
+    nack_requester_.SignalKeyFrameRequest.connect(this,
+        &VideoReceiveStream::OnNackKeyFrameRequest);
+}
+
+VideoReceiveStream::~VideoReceiveStream() {
+}
+
+void VideoReceiveStream::DeliverRtcp(const uint8_t* packet, size_t length) {
+    rtp_rtcp_->IncomingRtcpPacket(packet, length);
+
+    webrtc::NtpTime sr_ntp_time;
+    webrtc::Timestamp arrival_time = webrtc::Timestamp::Zero();
+    if (rtp_rtcp_->LastReceivedSrNtp(&sr_ntp_time, &arrival_time)) {
+        capture_time_receiver_.OnSenderReport(sr_ntp_time, arrival_time);
+    }
+}
+
+void VideoReceiveStream::UpdateRtt(int64_t rtt_ms) {
+    nack_requester_.UpdateRtt(rtt_ms);
+    capture_time_receiver_.UpdateRtt(rtt_ms);
+}
+
+void VideoReceiveStream::SendTransportFeedback(rtcp::TransportFeedback* feedback) {
+    rtp_rtcp_->SendFeedbackPacket(feedback);
+}
+
+void VideoReceiveStream::SetDelayBounds(int64_t min_delay_ms, int64_t max_delay_ms) {
+    jitter_buffer_.SetDelayBounds(min_delay_ms, max_delay_ms);
+}
+
+JitterBufferStats VideoReceiveStream::GetJitterBufferStats() const {
+    return jitter_buffer_.GetStats();
+}
+
+bool VideoReceiveStream::OnRtpPacket(const RtpPacketReceived& packet) {
+    if (packet.payload_type() == config_.rtp.payload_type) {
+        if (0 == remote_ssrc_) {
+            remote_ssrc_ = packet.ssrc();
+            rtp_rtcp_->SetRemoteSSRC(remote_ssrc_);
+            RTC_LOG(LS_INFO) << "video receive stream remote ssrc: " << remote_ssrc_;
+        }
+
+        if (packet.ssrc() != remote_ssrc_) {
+            return false;
+        }
+
+        OnMediaPacket(packet);
+        return true;
+    }
+
+    if (config_.rtp.rtx.payload_type > 0 &&
+        packet.payload_type() == config_.rtp.rtx.payload_type)
+    {
+        if (0 == remote_rtx_ssrc_) {
+            remote_rtx_ssrc_ = packet.ssrc();
+            RTC_LOG(LS_INFO) << "video receive stream remote rtx ssrc: " << remote_rtx_ssrc_;
+        }
+
+        if (packet.ssrc() != remote_rtx_ssrc_) {
+            return false;
+        }
+
+        OnRtxPacket(packet);
+        return true;
+    }
+
+    return false;
+}
+
+void VideoReceiveStream::OnMediaPacket(const RtpPacketReceived& packet) {
+    // padding包也占用序列号，需要计入接收统计
+    receive_statistics_.OnRtpPacket(packet);
+    capture_time_receiver_.OnRtpPacket(packet);
+
+    if (0 == packet.payload_size()) {
+        nack_requester_.OnReceivedPacket(packet.sequence_number(), false,
+            packet.recovered());
+        OnPaddingPacket(packet.sequence_number());
+        return;
+    }
+
+    // 关键帧的起始包，丢包过多时NackRequester清理到最近的关键帧
+    H264PacketInfo info;
+    bool is_keyframe = RtpDepacketizerH264::Parse(packet.payload(), &info) &&
+        info.nalu_start && (info.has_idr || info.has_sps);
+    nack_requester_.OnReceivedPacket(packet.sequence_number(), is_keyframe,
+        packet.recovered());
+
+    OnInsertResult(packet_buffer_.InsertPacket(packet));
+}
+
+void VideoReceiveStream::OnRtxPacket(const RtpPacketReceived& packet) {
+    // RTX的padding包，只用于带宽探测
+    if (packet.payload_size() <= kRtxHeaderSize || 0 == remote_ssrc_) {
+        return;
+    }
+
+    // 恢复原始的包：负载的前2个字节是原始的seq，头部使用媒体流的ssrc和负载类型
+    // 扩展保持不变，去掉padding
+    rtc::ArrayView<const uint8_t> payload = packet.payload();
+    size_t header_size = packet.header_size();
+    rtx_buffer_.resize(header_size + payload.size() - kRtxHeaderSize);
+    memcpy(rtx_buffer_.data(), packet.data(), header_size);
+    memcpy(rtx_buffer_.data() + header_size, payload.data() + kRtxHeaderSize,
+        payload.size() - kRtxHeaderSize);
+
+    rtx_buffer_[0] &= ~0x20;
+    rtx_buffer_[1] = (rtx_buffer_[1] & 0x80) | (uint8_t)config_.rtp.payload_type;
+    webrtc::ByteWriter<uint16_t>::WriteBigEndian(rtx_buffer_.data() + 2,
+        webrtc::ByteReader<uint16_t>::ReadBigEndian(payload.data()));
+    webrtc::ByteWriter<uint32_t>::WriteBigEndian(rtx_buffer_.data() + 8, remote_ssrc_);
+
+    if (!recovered_packet_.Parse(rtx_buffer_.data(), rtx_buffer_.size())) {
+        RTC_LOG(LS_WARNING) << "parse rtx packet failed, rtx seq: "
+            << packet.sequence_number();
+        return;
+    }
+    recovered_packet_.set_arrival_time_ms(packet.arrival_time_ms());
+    recovered_packet_.set_recovered(true);
+
+    OnMediaPacket(recovered_packet_);
+}
+
+void VideoReceiveStream::OnPaddingPacket(uint16_t seq_num) {
+    jitter_buffer_.InsertPadding(seq_num);
+    ReleaseFrames();
+}
+
+void VideoReceiveStream::OnInsertResult(PacketBuffer::InsertResult result) {
+    if (result.buffer_cleared) {
+        jitter_buffer_.Clear();
+        RequestKeyFrame();
+    }
+
+    if (result.keyframe_requested) {
+        RequestKeyFrame();
+    }
+
+    if (result.frames.empty()) {
+        return;
+    }
+
+    for (auto& frame : result.frames) {
+        frame.frame->capture_time_ms =
+            capture_time_receiver_.EstimateCaptureTimeMs(frame.timestamp);
+        if (!jitter_buffer_.InsertFrame(std::move(frame))) {
+            RequestKeyFrame();
+        }
+    }
+
+    // 可以解码的帧之前的包都不再需要
+    if (jitter_buffer_.has_decodable_frame()) {
+        packet_buffer_.ClearTo(jitter_buffer_.last_decodable_seq_num());
+    }
+
+    ReleaseFrames();
+}
+
+void VideoReceiveStream::ReleaseFrames() {
+    AssembledFrame frame;
+    int64_t wait_ms = 0;
+    while (jitter_buffer_.NextFrame(&frame, &wait_ms)) {
+        SignalFrame(this, frame.frame);
+    }
+
+    if (wait_ms < 0) {
+        return;
+    }
+
+    // 已经有更早的定时任务，到时会重新计算
+    int64_t release_time_ms = clock_->TimeInMilliseconds() + wait_ms;
+    if (release_task_time_ms_ >= 0 && release_task_time_ms_ <= release_time_ms) {
+        return;
+    }
+
+    release_task_time_ms_ = release_time_ms;
+    rtc::Thread::Current()->PostDelayedTask(webrtc::ToQueuedTask(task_safety_, [=]() {
+        release_task_time_ms_ = -1;
+        ReleaseFrames();
+    }), wait_ms);
+}
+
+void VideoReceiveStream::OnSendNack(const std::vector<uint16_t>& nack_list) {
+    rtp_rtcp_->SendNack(nack_list);
+}
+
+void VideoReceiveStream::OnNackKeyFrameRequest() {
+    RequestKeyFrame();
+}
+
+void VideoReceiveStream::RequestKeyFrame() {
+    int64_t now_ms = clock_->TimeInMilliseconds();
+    if (last_keyframe_request_ms_ >= 0 &&
+        now_ms - last_keyframe_request_ms_ < kKeyFrameRequestIntervalMs)
+    {
+        return;
+    }
+
+    last_keyframe_request_ms_ = now_ms;
+    SignalKeyFrameRequest(this);
+}
+
+void VideoReceiveStream::SendPictureLossIndication() {
+    rtp_rtcp_->SendPictureLossIndication();
+}
+
+} // namespace xrtc
@@ -0,0 +1,88 @@
+﻿#ifndef XRTCSDK_XRTC_RTC_VIDEO_VIDEO_RECEIVE_STREAM_H_
+#define XRTCSDK_XRTC_RTC_VIDEO_VIDEO_RECEIVE_STREAM_H_
+
+#include <memory>
+#include <vector>
+
+#include <rtc_base/task_utils/pending_task_safety_flag.h>
+#include <rtc_base/third_party/sigslot/sigslot.h>
+#include <system_wrappers/include/clock.h>
+
+#include "xrtc/media/base/media_frame.h"
+#include "xrtc/rtc/video/video_receive_stream_config.h"
+#include "xrtc/rtc/modules/nack/nack_requester.h"
+#include "xrtc/rtc/modules/rtp_rtcp/rtp_packet_received.h"
+#include "xrtc/rtc/modules/rtp_rtcp/rtp_rtcp_impl.h"
+#include "xrtc/rtc/modules/rtp_rtcp/absolute_capture_time_receiver.h"
+#include "xrtc/rtc/modules/rtp_rtcp/receive_statistics.h"
+#include "xrtc/rtc/modules/video_coding/jitter_buffer.h"
+#include "xrtc/rtc/modules/video_coding/packet_buffer.h"
+
+namespace xrtc {
+
+// 接收一路H264视频，将RTP包组成完整的帧，经过抖动缓存之后按照解码顺序输出
+// 远端的ssrc从第一个负载类型匹配的包中获得，RTX包恢复成原始的包之后再插入缓存
+// 在第一个关键帧之前，以及帧的依赖中断时，丢弃增量帧并请求关键帧
+// 丢包通过NackRequester检测，使用generic NACK请求重传
+// 周期性的RR携带接收统计，并通过XR RRTR/DLRR测量RTT
+// 输出帧的capture_time_ms由abs-capture-time扩展换算成本地时钟，无法估计时为0
+// 需要在同一个线程调用，输出帧的定时任务也在该线程执行
+class VideoReceiveStream : public sigslot::has_slots<> {
+public:
+    VideoReceiveStream(webrtc::Clock* clock, const VideoReceiveStreamConfig& config);
+    ~VideoReceiveStream();
+
+    void DeliverRtcp(const uint8_t* packet, size_t length);
+    void UpdateRtt(int64_t rtt_ms);
+    // 通过该流的RTCP模块发送transport-cc反馈
+    void SendTransportFeedback(rtcp::TransportFeedback* feedback);
+
+    void SetDelayBounds(int64_t min_delay_ms, int64_t max_delay_ms);
+    JitterBufferStats GetJitterBufferStats() const;
+
+    // 不属于该流的包返回false
+    bool OnRtpPacket(const RtpPacketReceived& packet);
+    // 需要关键帧时调用，例如解码出错，限制了请求的频率
+    void RequestKeyFrame();
+    // 响应SignalKeyFrameRequest，发送PLI
+    void SendPictureLossIndication();
+
+    uint32_t remote_ssrc() const { return remote_ssrc_; }
+    uint32_t remote_rtx_ssrc() const { return remote_rtx_ssrc_; }
+
+    sigslot::signal2<VideoReceiveStream*, std::shared_ptr<MediaFrame>> SignalFrame;
+    sigslot::signal1<VideoReceiveStream*> SignalKeyFrameRequest;
+
+private:
+    void OnMediaPacket(const RtpPacketReceived& packet);
+    void OnRtxPacket(const RtpPacketReceived& packet);
+    void OnPaddingPacket(uint16_t seq_num);
+    void OnInsertResult(PacketBuffer::InsertResult result);
+    void ReleaseFrames();
+    void OnSendNack(const std::vector<uint16_t>& nack_list);
+    void OnNackKeyFrameRequest();
+
+private:
+    VideoReceiveStreamConfig config_;
+    // 需要在rtp_rtcp_之前创建
+    ReceiveStatistics receive_statistics_;
+    std::unique_ptr<ModuleRtpRtcpImpl> rtp_rtcp_;
+    AbsoluteCaptureTimeReceiver capture_time_receiver_;
+    NackRequester nack_requester_;
+    uint32_t remote_ssrc_ = 0;
+    uint32_t remote_rtx_ssrc_ = 0;
+    PacketBuffer packet_buffer_;
+    JitterBuffer jitter_buffer_;
+    // RTX恢复之后的包，重复使用，避免每个包分配内存
+    RtpPacketReceived recovered_packet_;
+    std::vector<uint8_t> rtx_buffer_;
+    int64_t last_keyframe_request_ms_ = -1;
+    // 已经投递的输出帧定时任务的执行时间，-1表示没有
+    int64_t release_task_time_ms_ = -1;
+    webrtc::Clock* clock_;
+    webrtc::ScopedTaskSafety task_safety_;
+};
+
+} // namespace xrtc
+
+#endif // XRTCSDK_XRTC_RTC_VIDEO_VIDEO_RECEIVE_STREAM_H_